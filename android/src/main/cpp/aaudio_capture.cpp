@@ -0,0 +1,424 @@
+#include "aaudio_capture.h"
+#include "spectrogram_history.h"
+#include "subscriber_graph.h"
+
+#include <algorithm>
+#include <android/log.h>
+#include <cmath>
+#include <dlfcn.h>
+#include <time.h>
+#include <type_traits>
+
+#define LOG_TAG "AAudioCapture"
+#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, LOG_TAG, __VA_ARGS__)
+
+namespace realtimeaudio {
+
+namespace {
+
+// AAudio entry points resolved at runtime (libaaudio.so exists from API 26).
+struct AAudioApi {
+  aaudio_result_t (*createStreamBuilder)(AAudioStreamBuilder **) = nullptr;
+  void (*setDirection)(AAudioStreamBuilder *, aaudio_direction_t) = nullptr;
+  void (*setSampleRate)(AAudioStreamBuilder *, int32_t) = nullptr;
+  void (*setChannelCount)(AAudioStreamBuilder *, int32_t) = nullptr;
+  void (*setFormat)(AAudioStreamBuilder *, aaudio_format_t) = nullptr;
+  void (*setPerformanceMode)(AAudioStreamBuilder *,
+                             aaudio_performance_mode_t) = nullptr;
+  void (*setSharingMode)(AAudioStreamBuilder *, aaudio_sharing_mode_t) = nullptr;
+  void (*setDataCallback)(AAudioStreamBuilder *, AAudioStream_dataCallback,
+                          void *) = nullptr;
+  void (*setErrorCallback)(AAudioStreamBuilder *, AAudioStream_errorCallback,
+                           void *) = nullptr;
+  void (*setInputPreset)(AAudioStreamBuilder *,
+                         aaudio_input_preset_t) = nullptr; // API 28+
+  aaudio_result_t (*openStream)(AAudioStreamBuilder *, AAudioStream **) = nullptr;
+  aaudio_result_t (*deleteBuilder)(AAudioStreamBuilder *) = nullptr;
+  aaudio_result_t (*requestStart)(AAudioStream *) = nullptr;
+  aaudio_result_t (*requestStop)(AAudioStream *) = nullptr;
+  aaudio_result_t (*close)(AAudioStream *) = nullptr;
+  aaudio_result_t (*waitForStateChange)(AAudioStream *, aaudio_stream_state_t,
+                                        aaudio_stream_state_t *,
+                                        int64_t) = nullptr;
+  int32_t (*getSampleRate)(AAudioStream *) = nullptr;
+  int32_t (*getXRunCount)(AAudioStream *) = nullptr;
+
+  bool loaded = false;
+
+  AAudioApi() {
+    void *lib = dlopen("libaaudio.so", RTLD_NOW);
+    if (lib == nullptr)
+      return;
+    // Kept open for the life of the process
+    bool ok = true;
+    auto bind = [&](auto &fn, const char *name, bool required) {
+      fn = reinterpret_cast<std::remove_reference_t<decltype(fn)>>(
+          dlsym(lib, name));
+      if (fn == nullptr && required)
+        ok = false;
+    };
+    bind(createStreamBuilder, "AAudio_createStreamBuilder", true);
+    bind(setDirection, "AAudioStreamBuilder_setDirection", true);
+    bind(setSampleRate, "AAudioStreamBuilder_setSampleRate", true);
+    bind(setChannelCount, "AAudioStreamBuilder_setChannelCount", true);
+    bind(setFormat, "AAudioStreamBuilder_setFormat", true);
+    bind(setPerformanceMode, "AAudioStreamBuilder_setPerformanceMode", true);
+    bind(setSharingMode, "AAudioStreamBuilder_setSharingMode", true);
+    bind(setDataCallback, "AAudioStreamBuilder_setDataCallback", true);
+    bind(setErrorCallback, "AAudioStreamBuilder_setErrorCallback", true);
+    bind(setInputPreset, "AAudioStreamBuilder_setInputPreset", false);
+    bind(openStream, "AAudioStreamBuilder_openStream", true);
+    bind(deleteBuilder, "AAudioStreamBuilder_delete", true);
+    bind(requestStart, "AAudioStream_requestStart", true);
+    bind(requestStop, "AAudioStream_requestStop", true);
+    bind(close, "AAudioStream_close", true);
+    bind(waitForStateChange, "AAudioStream_waitForStateChange", true);
+    bind(getSampleRate, "AAudioStream_getSampleRate", true);
+    bind(getXRunCount, "AAudioStream_getXRunCount", true);
+    loaded = ok;
+  }
+};
+
+const AAudioApi &api() {
+  static const AAudioApi instance;
+  return instance;
+}
+
+int64_t monotonicNs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Wall clock in ms, matching System.currentTimeMillis() on the Kotlin path
+double wallClockMs() {
+  timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1e6;
+}
+
+} // namespace
+
+bool AAudioCapture::isSupported() { return api().loaded; }
+
+AAudioCapture::AAudioCapture(Analyzer *analyzer, FrameQueue *queue,
+                             std::shared_ptr<FrameStore> store)
+    : analyzer_(analyzer), queue_(queue), store_(std::move(store)) {
+  // Preallocate so the callback never allocates for output
+  magnitudes_.assign(queue_->capacity(), 0.0f);
+}
+
+AAudioCapture::~AAudioCapture() { stop(); }
+
+bool AAudioCapture::start(const CaptureConfig &config) {
+  const AAudioApi &aa = api();
+  if (!aa.loaded || stream_ != nullptr)
+    return false;
+
+  buffer_size_ = std::max(1, config.bufferSize);
+  callback_rate_hz_ = std::max(1, config.callbackRateHz);
+  silent_rate_hz_ = std::max(0, config.silentRateHz);
+  emit_fft_ = config.emitFft;
+  features_ = config.features;
+  affinity_ = coreAffinityFromInt(config.cpuAffinity);
+  // Reads sysfs once, here rather than in the first callback
+  CpuTopology::get();
+  band_layout_.store(config.bandLayout, std::memory_order_relaxed);
+  setFftConfig(config.fftSize, config.downsampleBins, config.hopSize);
+  setSmoothing(config.smoothingEnabled, config.smoothingFactor);
+
+  AAudioStreamBuilder *builder = nullptr;
+  if (aa.createStreamBuilder(&builder) != AAUDIO_OK)
+    return false;
+  aa.setDirection(builder, AAUDIO_DIRECTION_INPUT);
+  aa.setSampleRate(builder, config.sampleRate);
+  channels_ = analyzer_->inputChannels();
+  aa.setChannelCount(builder, channels_);
+  aa.setFormat(builder, AAUDIO_FORMAT_PCM_I16);
+  aa.setPerformanceMode(builder, AAUDIO_PERFORMANCE_MODE_LOW_LATENCY);
+  // Falls back to shared mode when the device cannot grant exclusive
+  aa.setSharingMode(builder, AAUDIO_SHARING_MODE_EXCLUSIVE);
+  if (aa.setInputPreset != nullptr) {
+    // Same tuning as the AudioRecord VOICE_RECOGNITION source
+    aa.setInputPreset(builder, AAUDIO_INPUT_PRESET_VOICE_RECOGNITION);
+  }
+  aa.setDataCallback(builder, &AAudioCapture::dataCallback, this);
+  aa.setErrorCallback(builder, &AAudioCapture::errorCallback, this);
+
+  aaudio_result_t result = aa.openStream(builder, &stream_);
+  aa.deleteBuilder(builder);
+  if (result != AAUDIO_OK) {
+    LOGW("openStream failed: %d", (int)result);
+    stream_ = nullptr;
+    return false;
+  }
+  sample_rate_ = aa.getSampleRate(stream_);
+  // Before the first callback, which is the only other analyzer user
+  analyzer_->setFeatures(features_, (float)sample_rate_);
+  if (analyzer_->metersEnabled()) {
+    // Configured for the requested rate; resize for the one we got
+    analyzer_->setMeters(true, analyzer_->meterSettings(),
+                         (float)sample_rate_);
+  }
+  if (analyzer_->voiceActivityEnabled()) {
+    analyzer_->setVoiceActivity(true, analyzer_->voiceActivitySettings(),
+                                (float)sample_rate_);
+  }
+  if (SubscriberGraph *subscribers = analyzer_->subscribers())
+    subscribers->setSpectrum(fft_size_.load(), (float)sample_rate_);
+  applied_bands_ = -2; // force setBands() on the first callback
+
+  block_sum_sq_ = 0.0;
+  block_peak_ = 0.0f;
+  block_samples_ = 0;
+  for (int c = 0; c < Analyzer::kMaxChannels; ++c) {
+    block_channel_sum_sq_[c] = 0.0;
+    block_channel_peak_[c] = 0.0f;
+  }
+  last_bins_ = 0;
+  last_fft_size_ = 0;
+  next_emit_ns_ = 0;
+  voice_changed_ = false;
+  last_xruns_ = 0;
+  thread_tuned_ = false;
+
+  result = aa.requestStart(stream_);
+  if (result != AAUDIO_OK) {
+    LOGW("requestStart failed: %d", (int)result);
+    aa.close(stream_);
+    stream_ = nullptr;
+    return false;
+  }
+  return true;
+}
+
+void AAudioCapture::stop() {
+  if (stream_ == nullptr)
+    return;
+  // requestStop() is asynchronous: wait until callbacks have ceased before
+  // closing, since the callback dereferences this object
+  const AAudioApi &aa = api();
+  if (aa.requestStop(stream_) == AAUDIO_OK) {
+    aaudio_stream_state_t state = AAUDIO_STREAM_STATE_STOPPING;
+    while (state == AAUDIO_STREAM_STATE_STOPPING) {
+      if (aa.waitForStateChange(stream_, state, &state, 500000000LL) !=
+          AAUDIO_OK)
+        break;
+    }
+  }
+  aa.close(stream_);
+  stream_ = nullptr;
+}
+
+int32_t AAudioCapture::xRunCount() const {
+  return stream_ ? api().getXRunCount(stream_) : 0;
+}
+
+void AAudioCapture::setFftConfig(int fftSize, int downsampleBins,
+                                 int hopSize) {
+  // Build the plan here rather than in the callback; the release store
+  // orders it before the size the callback acts on
+  if (fftSize != fft_size_.load(std::memory_order_relaxed))
+    analyzer_->preparePlan(fftSize);
+  fft_size_.store(fftSize, std::memory_order_release);
+  downsample_bins_.store(downsampleBins, std::memory_order_relaxed);
+  hop_size_.store(std::max(0, std::min(hopSize, fftSize)),
+                  std::memory_order_relaxed);
+}
+
+void AAudioCapture::setSmoothing(bool enabled, float factor) {
+  smoothing_enabled_.store(enabled, std::memory_order_relaxed);
+  smoothing_factor_.store(std::max(0.0f, std::min(factor, 1.0f)),
+                          std::memory_order_relaxed);
+}
+
+aaudio_data_callback_result_t
+AAudioCapture::dataCallback(AAudioStream *stream, void *userData,
+                            void *audioData, int32_t numFrames) {
+  auto *self = static_cast<AAudioCapture *>(userData);
+  if (numFrames > 0)
+    self->process(static_cast<const int16_t *>(audioData), numFrames);
+  return AAUDIO_CALLBACK_RESULT_CONTINUE;
+}
+
+void AAudioCapture::errorCallback(AAudioStream *stream, void *userData,
+                                  aaudio_result_t error) {
+  // Called on an AAudio thread; the stream is closed by stop()
+  LOGW("stream error: %d", (int)error);
+}
+
+void AAudioCapture::process(const int16_t *pcm, int32_t frames) {
+  if (!thread_tuned_) {
+    // AAudio owns the thread, so this is the first chance to reach it
+    tuneAudioThread(affinity_, true, analyzer_->perfStats());
+    thread_tuned_ = true;
+  }
+  const int fftSize = fft_size_.load(std::memory_order_acquire);
+  analyzer_->setHopSize(hop_size_.load(std::memory_order_relaxed));
+  const int bands = downsample_bins_.load(std::memory_order_relaxed);
+  const int layout = band_layout_.load(std::memory_order_relaxed);
+  if (bands != applied_bands_ || layout != applied_layout_) {
+    analyzer_->setBands(bandLayoutFromInt(layout), bands, (float)sample_rate_);
+    applied_bands_ = bands;
+    applied_layout_ = layout;
+  }
+  if (fftSize != last_fft_size_) {
+    // Native history restarts; don't re-send the old frame
+    last_bins_ = 0;
+    last_fft_size_ = fftSize;
+  }
+
+  const bool blockDone = block_samples_ + frames >= buffer_size_;
+  const int64_t nowNs = monotonicNs();
+  // A closed voice gate drops the rate to silent_rate_hz_ (none at 0)
+  const bool gated = analyzer_->gated();
+  const bool scheduled = blockDone && nowNs >= next_emit_ns_ &&
+                         (!gated || silent_rate_hz_ > 0);
+  // Subscribers run on their own schedules, off the same transform
+  SubscriberGraph *subscribers = analyzer_->subscribers();
+  const int wanted =
+      blockDone && subscribers != nullptr ? subscribers->poll(nowNs) : 0;
+  // Features need the magnitudes even when the spectrum is not shipped.
+  // While gated they are offered on every callback: the analyzer skips the
+  // transform until the gate opens, then takes that frame at once.
+  const bool withFft = ((scheduled || gated) && (emit_fft_ || features_ != 0)) ||
+                       (wanted & SubscriberGraph::kSpectral) != 0;
+
+  FrameStats stats;
+  int bins = analyzer_->processPcm16(pcm, frames * channels_, fftSize,
+                                     withFft ? magnitudes_.data() : nullptr,
+                                     (int)magnitudes_.size(), &stats);
+  if (bins > 0)
+    last_bins_ = bins;
+  voice_changed_ = voice_changed_ || analyzer_->voiceActivity().changed;
+
+  block_sum_sq_ += (double)stats.rms * stats.rms * frames;
+  block_peak_ = std::max(block_peak_, stats.peak);
+  if (channels_ > 1) {
+    for (int c = 0; c < Analyzer::kMaxChannels; ++c) {
+      const FrameStats &levels = analyzer_->channelLevels(c);
+      block_channel_sum_sq_[c] += (double)levels.rms * levels.rms * frames;
+      block_channel_peak_[c] = std::max(block_channel_peak_[c], levels.peak);
+    }
+  }
+  block_samples_ += frames;
+  if (!blockDone)
+    return;
+
+  // Transitions go out at once, whatever the schedule
+  const bool due = scheduled || voice_changed_;
+  if (PerfStats *perf = analyzer_->perfStats()) {
+    // A block is this path's "read"; overruns are the stream's xruns
+    perf->countRead(due);
+    const int32_t xruns = api().getXRunCount(stream_);
+    if (xruns > last_xruns_)
+      perf->countOverruns((uint64_t)(xruns - last_xruns_));
+    last_xruns_ = std::max(last_xruns_, xruns);
+    sampleAudioCore(perf);
+  }
+
+  float rms = (float)std::sqrt(block_sum_sq_ / block_samples_);
+  float peak = block_peak_;
+  block_sum_sq_ = 0.0;
+  block_peak_ = 0.0f;
+  for (int c = 0; c < Analyzer::kMaxChannels; ++c) {
+    channel_levels_[c].rms =
+        (float)std::sqrt(block_channel_sum_sq_[c] / block_samples_);
+    channel_levels_[c].peak = block_channel_peak_[c];
+    block_channel_sum_sq_[c] = 0.0;
+    block_channel_peak_[c] = 0.0f;
+  }
+  block_samples_ = 0;
+
+  FrameStats levels;
+  levels.rms = rms;
+  levels.peak = peak;
+  analyzer_->setSmoothing(smoothing_enabled_.load(std::memory_order_relaxed),
+                          smoothing_factor_.load(std::memory_order_relaxed));
+  analyzer_->smoothLevels(&levels);
+  rms = levels.rms;
+  peak = levels.peak;
+
+  if ((wanted & SubscriberGraph::kDue) != 0) {
+    const bool spectral = (wanted & SubscriberGraph::kSpectral) != 0 &&
+                          !analyzer_->gated();
+    subscribers->publish(*queue_, *analyzer_, magnitudes_.data(),
+                         spectral ? last_bins_ : 0, rms, peak, wallClockMs(),
+                         (uint32_t)buffer_size_, nowNs);
+  }
+  if (!due)
+    return;
+  // Between hops the most recent STFT frame is re-sent; while gated there
+  // is none. The frame that opened the gate may come from an earlier
+  // callback of the block.
+  const bool silent = analyzer_->gated();
+  const bool ship = emit_fft_ && !silent && (withFft || voice_changed_);
+  emit(ship ? last_bins_ : 0, rms, peak, voice_changed_);
+
+  const int rate = silent ? silent_rate_hz_ : callback_rate_hz_;
+  const int64_t intervalNs = 1000000000LL / std::max(rate, 1);
+  next_emit_ns_ += intervalNs;
+  if (voice_changed_ || next_emit_ns_ <= nowNs) {
+    // A transition, or fell behind (first frame or a stall): resync
+    next_emit_ns_ = nowNs + intervalNs;
+  }
+  voice_changed_ = false;
+}
+
+void AAudioCapture::emit(int bins, float rms, float peak,
+                         bool voiceChanged) {
+  PerfStats *perf = analyzer_->perfStats();
+  PerfScope scope(perf, PerfStage::Publish);
+  const double timestampMs = wallClockMs();
+  const float *spectrum = magnitudes_.data();
+  SpectrogramHistory *history = analyzer_->history();
+
+  if (store_) {
+    float *dst = store_->beginFrame();
+    int count = bins > 0 ? analyzer_->mapBands(spectrum, bins, dst,
+                                               (int)store_->capacity())
+                         : 0;
+    if (history != nullptr && count > 0)
+      history->push(dst, (uint32_t)count, timestampMs);
+    store_->endFrame((uint32_t)count, rms, peak, timestampMs);
+    // The shared frame has no room for the gate: queue the transition
+    // alone so the delivery thread can report it
+    if (!voiceChanged)
+      return;
+    bins = 0;
+  }
+
+  // Band-mapped straight into the queue slot
+  float *dst = queue_->beginPush();
+  FrameInfo info;
+  info.timestampMs = timestampMs;
+  info.rms = rms;
+  info.peak = peak;
+  info.bins = bins > 0 ? (uint32_t)analyzer_->mapBands(spectrum, bins, dst,
+                                                       (int)queue_->capacity())
+                       : 0;
+  if (history != nullptr && info.bins > 0)
+    history->push(dst, info.bins, timestampMs);
+  info.bufferSize = (uint32_t)buffer_size_;
+  info.fftSize = (uint32_t)last_fft_size_;
+  info.pushedNs = PerfStats::nowNs();
+  info.features = analyzer_->features();
+  info.meters = analyzer_->meters();
+  info.voice = analyzer_->voiceActivity();
+  // The callback that switched the gate may be an earlier one of the block
+  info.voice.changed = voiceChanged;
+  if (channels_ > 1) {
+    // Channel spectra follow the main bins, mapped like them
+    info.channels = Analyzer::kMaxChannels;
+    info.channelLevels[0] = channel_levels_[0];
+    info.channelLevels[1] = channel_levels_[1];
+    if (info.bins > 0)
+      info.channelBins = (uint32_t)analyzer_->mapChannelBands(
+          dst + info.bins, (int)(queue_->capacity() - info.bins));
+  }
+  queue_->endPush(info);
+  if (perf != nullptr)
+    perf->observeQueue(queue_->size(), queue_->dropped());
+}
+
+} // namespace realtimeaudio
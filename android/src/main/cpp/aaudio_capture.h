@@ -0,0 +1,138 @@
+#ifndef REALTIMEAUDIO_AAUDIO_CAPTURE_H
+#define REALTIMEAUDIO_AAUDIO_CAPTURE_H
+
+#include "analyzer.h"
+#include "audio_thread.h"
+#include "frame_queue.h"
+#include "frame_store.h"
+
+#include <aaudio/AAudio.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace realtimeaudio {
+
+struct CaptureConfig {
+  int sampleRate = 48000;
+  int bufferSize = 1024; // samples per analysis block (levels, scheduling)
+  int fftSize = 1024;
+  int hopSize = 0;
+  int downsampleBins = -1; // band count, <= 0 ships raw bins
+  int bandLayout = 0;      // BandLayout value
+  int callbackRateHz = 30;
+  // Emission rate while the analyzer's voice gate is closed; 0 sends only
+  // its transitions
+  int silentRateHz = 0;
+  bool emitFft = true;
+  uint32_t features = 0; // FeatureFlags computed on every analyzed frame
+  bool smoothingEnabled = true;
+  float smoothingFactor = 0.5f;
+  int cpuAffinity = 0; // CoreAffinity of the callback thread
+};
+
+// Native low-latency microphone capture through AAudio. The analysis runs in
+// the AAudio data callback: PCM16 goes straight into the Analyzer, and due
+// frames are pushed into a FrameQueue (or published to a FrameStore), so no
+// Java thread or JNI call sits on the capture path.
+//
+// Callbacks arrive in bursts of a few hundred samples at most, so levels are
+// accumulated over `bufferSize` frames before a block counts as a "read"
+// (same RMS/peak semantics as the AudioRecord path); with the analyzer's
+// PerfStats set, such blocks count as reads and stream xruns as overruns.
+// The stream opens with the analyzer's input channel count, so the stereo
+// channel modes capture interleaved stereo. With the analyzer's voice gate
+// enabled, frames drop to `silentRateHz` while it is closed, and every
+// opening or closing is emitted at once (also into the queue when frames
+// are shared, so the delivery thread can report it).
+//
+// The first callback tunes AAudio's callback thread (tuneAudioThread): it
+// keeps the SCHED_FIFO AAudio usually grants, or gets audio-class nice
+// otherwise, and is pinned per `cpuAffinity`. Each block samples the core
+// it ran on into the PerfStats.
+//
+// AAudio is loaded with dlopen so the library still loads on API < 26, where
+// isSupported() returns false and callers keep using AudioRecord.
+class AAudioCapture {
+public:
+  static bool isSupported();
+
+  // `analyzer` and `queue` are not owned and must outlive the capture.
+  // `store` (optional) switches output to shared frames.
+  AAudioCapture(Analyzer *analyzer, FrameQueue *queue,
+                std::shared_ptr<FrameStore> store);
+  ~AAudioCapture();
+
+  AAudioCapture(const AAudioCapture &) = delete;
+  AAudioCapture &operator=(const AAudioCapture &) = delete;
+
+  // Opens and starts the input stream. Returns false on failure (no
+  // permission, no input device, unsupported configuration).
+  bool start(const CaptureConfig &config);
+  void stop();
+
+  // Rate the device actually runs at (valid after start()).
+  int sampleRate() const { return sample_rate_; }
+  int32_t xRunCount() const;
+
+  // May be called from any thread while running.
+  void setFftConfig(int fftSize, int downsampleBins, int hopSize);
+  void setBandLayout(int layout) {
+    band_layout_.store(layout, std::memory_order_relaxed);
+  }
+  void setSmoothing(bool enabled, float factor);
+
+private:
+  static aaudio_data_callback_result_t
+  dataCallback(AAudioStream *stream, void *userData, void *audioData,
+               int32_t numFrames);
+  static void errorCallback(AAudioStream *stream, void *userData,
+                            aaudio_result_t error);
+
+  void process(const int16_t *pcm, int32_t frames);
+  void emit(int bins, float rms, float peak, bool voiceChanged);
+
+  Analyzer *analyzer_;
+  FrameQueue *queue_;
+  std::shared_ptr<FrameStore> store_;
+  AAudioStream *stream_ = nullptr;
+  int sample_rate_ = 0;
+  int channels_ = 1;
+  int buffer_size_ = 1024;
+  int callback_rate_hz_ = 30;
+  int silent_rate_hz_ = 0;
+  bool emit_fft_ = true;
+  uint32_t features_ = 0;
+  CoreAffinity affinity_ = CoreAffinity::Any;
+
+  // Written by control threads, read in the callback
+  std::atomic<int> fft_size_{1024};
+  std::atomic<int> hop_size_{0};
+  std::atomic<int> downsample_bins_{-1};
+  std::atomic<int> band_layout_{0};
+  std::atomic<bool> smoothing_enabled_{true};
+  std::atomic<float> smoothing_factor_{0.5f};
+
+  // Callback-thread state
+  bool thread_tuned_ = false;
+  std::vector<float> magnitudes_;
+  int applied_bands_ = -2;
+  int applied_layout_ = -1;
+  double block_sum_sq_ = 0.0;
+  float block_peak_ = 0.0f;
+  int block_samples_ = 0; // frames
+  // Per-channel block levels (stereo channel modes)
+  double block_channel_sum_sq_[Analyzer::kMaxChannels] = {};
+  float block_channel_peak_[Analyzer::kMaxChannels] = {};
+  FrameStats channel_levels_[Analyzer::kMaxChannels];
+  int last_bins_ = 0;
+  int last_fft_size_ = 0;
+  int64_t next_emit_ns_ = 0;
+  bool voice_changed_ = false; // gate opened or closed during this block
+  int32_t last_xruns_ = 0; // reported to the analyzer's PerfStats
+};
+
+} // namespace realtimeaudio
+
+#endif // REALTIMEAUDIO_AAUDIO_CAPTURE_H
@@ -1,100 +1,227 @@
-#include "kiss_fft/kiss_fftr.h"
-#include <cmath>
-#include <cstring>
+#include "analyzer.h"
+#include <algorithm>
 #include <jni.h>
-#include <vector>
-
-// Global state for reuse
-static kiss_fftr_cfg cfg = nullptr;
-static int current_nfft = 0;
-static std::vector<float> window;
-static std::vector<kiss_fft_cpx> fft_out;
-static std::vector<float> fft_in; // To hold windowed input
-
-extern "C" JNIEXPORT void JNICALL Java_com_realtimeaudio_AudioEngine_computeFft(
-    JNIEnv *env, jobject thiz, jfloatArray input, jfloatArray output,
-    jint nfft) {
-  if (nfft <= 0)
-    return;
+#include <new>
+
+using realtimeaudio::Analyzer;
+using realtimeaudio::bandLayoutFromInt;
+using realtimeaudio::channelModeFromInt;
+using realtimeaudio::FrameStats;
+using realtimeaudio::fftBackendFromInt;
+using realtimeaudio::windowTypeFromInt;
+
+static inline Analyzer *fromHandle(jlong handle) {
+  return reinterpret_cast<Analyzer *>(handle);
+}
 
-  // 1. Reallocate configuration if size changed
-  if (cfg == nullptr || current_nfft != nfft) {
-    if (cfg)
-      free(cfg);
-    cfg = kiss_fftr_alloc(nfft, 0, nullptr, nullptr);
-    if (cfg == nullptr) {
-      // FFT allocation failed
-      return;
-    }
-    current_nfft = nfft;
-
-    // Precompute Hann Window
-    window.resize(nfft);
-    fft_in.resize(nfft);
-    fft_out.resize(nfft / 2 + 1); // Real FFT output size
-
-    for (int i = 0; i < nfft; ++i) {
-      window[i] = 0.5f * (1.0f - cosf(2.0f * M_PI * i / (nfft - 1)));
-    }
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_realtimeaudio_AudioEngine_nativeCreate(JNIEnv *env, jobject thiz,
+                                                jint nfft, jint backend,
+                                                jint window,
+                                                jint channelMode) {
+  Analyzer *analyzer = new (std::nothrow)
+      Analyzer(nfft, fftBackendFromInt(backend), windowTypeFromInt(window),
+               channelModeFromInt(channelMode));
+  if (analyzer == nullptr)
+    return 0;
+  if (!analyzer->isValid()) {
+    // FFT allocation failed
+    delete analyzer;
+    return 0;
   }
+  return reinterpret_cast<jlong>(analyzer);
+}
 
-  // 2. Get input data
-  jfloat *inData = env->GetFloatArrayElements(input, nullptr);
-  jfloat *outData = env->GetFloatArrayElements(output, nullptr);
-  
-  if (inData == nullptr || outData == nullptr) {
-    if (inData != nullptr) env->ReleaseFloatArrayElements(input, inData, 0);
-    if (outData != nullptr) env->ReleaseFloatArrayElements(output, outData, 0);
-    return;
+// Builds the plan for `nfft` on the calling (control) thread; the processing
+// thread adopts it when it first sees the new size.
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_realtimeaudio_AudioEngine_nativePreparePlan(JNIEnv *env, jobject thiz,
+                                                     jlong handle, jint nfft) {
+  Analyzer *analyzer = fromHandle(handle);
+  if (analyzer == nullptr)
+    return JNI_FALSE;
+  return analyzer->preparePlan((int)nfft) ? JNI_TRUE : JNI_FALSE;
+}
+
+// Array fallback: PCM16 -> stats (+ spectrum when withFft and a hop is due)
+// in one native pass. `count` is in samples, interleaved in the stereo
+// channel modes. `stats` receives the smoothed [rms, peak]; returns the
+// number of bins written.
+extern "C" JNIEXPORT jint JNICALL Java_com_realtimeaudio_AudioEngine_processPcm(
+    JNIEnv *env, jobject thiz, jlong handle, jshortArray pcm, jint count,
+    jfloatArray output, jfloatArray stats, jint nfft, jint hopSize,
+    jboolean withFft) {
+  Analyzer *analyzer = fromHandle(handle);
+  if (analyzer == nullptr || count <= 0)
+    return 0;
+  if (env->GetArrayLength(pcm) < count || env->GetArrayLength(stats) < 2)
+    return 0;
+
+  jshort *pcmData = env->GetShortArrayElements(pcm, nullptr);
+  if (pcmData == nullptr)
+    return 0;
+
+  jfloat *outData = nullptr;
+  jsize outSize = 0;
+  if (withFft) {
+    outData = env->GetFloatArrayElements(output, nullptr);
+    outSize = env->GetArrayLength(output);
   }
-  
-  if (cfg == nullptr) {
-    env->ReleaseFloatArrayElements(input, inData, 0);
+
+  FrameStats frameStats;
+  analyzer->setHopSize((int)hopSize);
+  int bins = analyzer->processPcm16(pcmData, (int)count, (int)nfft, outData,
+                                    (int)outSize, &frameStats);
+
+  // Input is read-only, so never copy it back
+  env->ReleaseShortArrayElements(pcm, pcmData, JNI_ABORT);
+  if (outData != nullptr)
     env->ReleaseFloatArrayElements(output, outData, 0);
-    return;
-  }
 
-  // 3. Apply Window
-  for (int i = 0; i < nfft; ++i) {
-    fft_in[i] = inData[i] * window[i];
-  }
+  analyzer->smoothLevels(&frameStats);
+  jfloat statValues[2] = {frameStats.rms, frameStats.peak};
+  env->SetFloatArrayRegion(stats, 0, 2, statValues);
+  return bins;
+}
 
-  // 4. Perform FFT
-  kiss_fftr(cfg, fft_in.data(), fft_out.data());
-
-  // 5. Compute Magnitude (and normalize)
-  // Output size is expected to be sufficient (usually passed as nfft/2 in Java,
-  // but here we just fill what we can) The user requested: "normalize FFT
-  // output to range 0.0 – 1.0" For normalization, usually we divide by N/2, but
-  // we also want generic 0-1 range. Let's assume standard magnitude
-  // normalization.
-
-  // We only output the first nfft/2 bins (Nyquist excluded usually or just
-  // nfft/2) The JNI signature implies we fill 'output'.
-  jsize outSize = env->GetArrayLength(output);
-  int bins = std::min((int)outSize, (int)(nfft / 2));
-
-  for (int i = 0; i < bins; ++i) {
-    float re = fft_out[i].r;
-    float im = fft_out[i].i;
-    float mag = sqrtf(re * re + im * im);
-
-    // Normalize
-    // Simple normalization: mag / (nfft / 2)
-    // Note: KissFFT is unnormalized. Forward transform sums.
-    outData[i] = mag / (float)(nfft / 2);
+// Resolves the addresses of the direct ByteBuffers once and keeps them on the
+// analyzer; processPcmDirect then runs without touching any JNI arrays.
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_realtimeaudio_AudioEngine_nativeSetBuffers(JNIEnv *env, jobject thiz,
+                                                    jlong handle, jobject pcm,
+                                                    jobject output,
+                                                    jobject stats) {
+  Analyzer *analyzer = fromHandle(handle);
+  if (analyzer == nullptr || pcm == nullptr || output == nullptr ||
+      stats == nullptr)
+    return JNI_FALSE;
+
+  void *pcmAddr = env->GetDirectBufferAddress(pcm);
+  void *outAddr = env->GetDirectBufferAddress(output);
+  void *statsAddr = env->GetDirectBufferAddress(stats);
+  jlong pcmBytes = env->GetDirectBufferCapacity(pcm);
+  jlong outBytes = env->GetDirectBufferCapacity(output);
+  jlong statsBytes = env->GetDirectBufferCapacity(stats);
+
+  // Heap (non-direct) buffers report a null address / -1 capacity
+  if (pcmAddr == nullptr || outAddr == nullptr || statsAddr == nullptr ||
+      pcmBytes <= 0 || outBytes <= 0 ||
+      statsBytes < (jlong)(2 * sizeof(float))) {
+    analyzer->setBuffers(nullptr, 0, nullptr, 0, nullptr);
+    return JNI_FALSE;
   }
 
-  // 6. Release arrays
-  env->ReleaseFloatArrayElements(input, inData, 0);
-  env->ReleaseFloatArrayElements(output, outData, 0);
+  analyzer->setBuffers(static_cast<const int16_t *>(pcmAddr),
+                       (int)(pcmBytes / sizeof(int16_t)),
+                       static_cast<float *>(outAddr),
+                       (int)(outBytes / sizeof(float)),
+                       static_cast<float *>(statsAddr));
+  return JNI_TRUE;
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_realtimeaudio_AudioEngine_processPcmDirect(JNIEnv *env, jobject thiz,
+                                                    jlong handle, jint count,
+                                                    jint nfft,
+                                                    jint hopSize,
+                                                    jboolean withFft) {
+  Analyzer *analyzer = fromHandle(handle);
+  if (analyzer == nullptr)
+    return 0;
+  analyzer->setHopSize((int)hopSize);
+  return analyzer->processRegistered((int)count, (int)nfft, withFft);
 }
 
 extern "C" JNIEXPORT void JNICALL
-Java_com_realtimeaudio_AudioEngine_cleanupFft(JNIEnv *env, jobject thiz) {
-  if (cfg) {
-    free(cfg);
-    cfg = nullptr;
-  }
-  current_nfft = 0;
+Java_com_realtimeaudio_AudioEngine_cleanupFft(JNIEnv *env, jobject thiz,
+                                              jlong handle) {
+  delete fromHandle(handle);
+}
+
+// Band layout for emitted spectra (processing thread only). `bands` <= 0
+// ships raw bins.
+extern "C" JNIEXPORT void JNICALL Java_com_realtimeaudio_AudioEngine_nativeSetBands(
+    JNIEnv *env, jobject thiz, jlong handle, jint layout, jint bands,
+    jint sampleRate) {
+  Analyzer *analyzer = fromHandle(handle);
+  if (analyzer == nullptr)
+    return;
+  analyzer->setBands(bandLayoutFromInt(layout), bands, (float)sampleRate);
+}
+
+// Spectral features (FeatureFlags) computed on every frame from then on
+// (processing thread only).
+extern "C" JNIEXPORT void JNICALL
+Java_com_realtimeaudio_AudioEngine_nativeSetFeatures(JNIEnv *env,
+                                                     jobject thiz,
+                                                     jlong handle, jint mask,
+                                                     jint sampleRate) {
+  Analyzer *analyzer = fromHandle(handle);
+  if (analyzer == nullptr)
+    return;
+  analyzer->setFeatures((uint32_t)std::max<jint>(mask, 0), (float)sampleRate);
+}
+
+// Sliding-window RMS, peak hold and LUFS meters over every read from then on
+// (before capture starts; allocates). Times are in milliseconds.
+extern "C" JNIEXPORT void JNICALL
+Java_com_realtimeaudio_AudioEngine_nativeSetMeters(
+    JNIEnv *env, jobject thiz, jlong handle, jboolean enabled, jfloat windowMs,
+    jfloat attackMs, jfloat releaseMs, jfloat holdMs, jint sampleRate) {
+  Analyzer *analyzer = fromHandle(handle);
+  if (analyzer == nullptr)
+    return;
+  realtimeaudio::MeterSettings settings;
+  settings.windowMs = windowMs;
+  settings.attackMs = attackMs;
+  settings.releaseMs = releaseMs;
+  settings.holdMs = holdMs;
+  analyzer->setMeters(enabled == JNI_TRUE, settings, (float)sampleRate);
+}
+
+// Voice activity gate over every read from then on (before capture starts).
+// Levels are in dBFS, times in milliseconds.
+extern "C" JNIEXPORT void JNICALL
+Java_com_realtimeaudio_AudioEngine_nativeSetVoiceActivity(
+    JNIEnv *env, jobject thiz, jlong handle, jboolean enabled,
+    jfloat thresholdDb, jfloat hysteresisDb, jfloat noiseMarginDb,
+    jfloat attackMs, jfloat releaseMs, jint sampleRate) {
+  Analyzer *analyzer = fromHandle(handle);
+  if (analyzer == nullptr)
+    return;
+  realtimeaudio::VoiceActivitySettings settings;
+  settings.thresholdDb = thresholdDb;
+  settings.hysteresisDb = hysteresisDb;
+  settings.noiseMarginDb = noiseMarginDb;
+  settings.attackMs = attackMs;
+  settings.releaseMs = releaseMs;
+  analyzer->setVoiceActivity(enabled == JNI_TRUE, settings,
+                             (float)sampleRate);
+}
+
+// Gate state after the latest read: bit 0 open, bit 1 opened or closed by
+// that read (AudioEngine.VAD_*). Open while the gate is disabled.
+extern "C" JNIEXPORT jint JNICALL
+Java_com_realtimeaudio_AudioEngine_nativeVoiceActivity(JNIEnv *env,
+                                                       jobject thiz,
+                                                       jlong handle) {
+  Analyzer *analyzer = fromHandle(handle);
+  if (analyzer == nullptr || !analyzer->voiceActivityEnabled())
+    return 1;
+  const realtimeaudio::VoiceActivity &vad = analyzer->voiceActivity();
+  return (vad.active ? 1 : 0) | (vad.changed ? 2 : 0);
+}
+
+// Level smoothing applied to the stats of processPcm / processPcmDirect
+// (processing thread only).
+extern "C" JNIEXPORT void JNICALL
+Java_com_realtimeaudio_AudioEngine_nativeSetSmoothing(JNIEnv *env,
+                                                      jobject thiz,
+                                                      jlong handle,
+                                                      jboolean enabled,
+                                                      jfloat factor) {
+  Analyzer *analyzer = fromHandle(handle);
+  if (analyzer == nullptr)
+    return;
+  analyzer->setSmoothing(enabled == JNI_TRUE, factor);
 }
@@ -0,0 +1,23 @@
+#include "audio_thread.h"
+#include "perf_stats.h"
+
+#include <jni.h>
+
+using realtimeaudio::PerfStats;
+
+// Called first thing on the AudioRecord capture thread, after it raised
+// itself to THREAD_PRIORITY_URGENT_AUDIO: pins it per `affinity`
+// (AFFINITY_*) and records its scheduling in `perfHandle`. Returns whether
+// it was pinned.
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_realtimeaudio_AudioEngine_nativeTuneAudioThread(JNIEnv *env,
+                                                         jobject thiz,
+                                                         jlong perfHandle,
+                                                         jint affinity) {
+  return realtimeaudio::tuneAudioThread(
+             realtimeaudio::coreAffinityFromInt(affinity), false,
+             reinterpret_cast<PerfStats *>(perfHandle))
+             ? JNI_TRUE
+             : JNI_FALSE;
+}
+
@@ -0,0 +1,129 @@
+#include "audio_thread.h"
+
+#include <algorithm>
+#include <android/log.h>
+#include <cerrno>
+#include <cstdio>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#define LOG_TAG "AudioThread"
+#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, LOG_TAG, __VA_ARGS__)
+
+namespace realtimeaudio {
+
+namespace {
+
+// 0 when the core has no cpufreq entry
+long maxFrequencyKhz(int cpu) {
+  char path[96];
+  std::snprintf(path, sizeof(path),
+                "/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_max_freq", cpu);
+  FILE *file = std::fopen(path, "r");
+  if (file == nullptr)
+    return 0;
+  long khz = 0;
+  if (std::fscanf(file, "%ld", &khz) != 1)
+    khz = 0;
+  std::fclose(file);
+  return khz;
+}
+
+} // namespace
+
+CoreAffinity coreAffinityFromInt(int value) {
+  switch (value) {
+  case (int)CoreAffinity::Little:
+    return CoreAffinity::Little;
+  case (int)CoreAffinity::Big:
+    return CoreAffinity::Big;
+  default:
+    return CoreAffinity::Any;
+  }
+}
+
+const CpuTopology &CpuTopology::get() {
+  static const CpuTopology instance;
+  return instance;
+}
+
+CpuTopology::CpuTopology() {
+  const long configured = sysconf(_SC_NPROCESSORS_CONF);
+  cpus_ = (int)std::max(1L, std::min<long>(configured, kMaxCpus));
+
+  long khz[kMaxCpus] = {};
+  long slowest = 0, fastest = 0;
+  for (int cpu = 0; cpu < cpus_; ++cpu) {
+    khz[cpu] = maxFrequencyKhz(cpu);
+    if (khz[cpu] <= 0)
+      continue;
+    slowest = slowest == 0 ? khz[cpu] : std::min(slowest, khz[cpu]);
+    fastest = std::max(fastest, khz[cpu]);
+  }
+  for (int cpu = 0; cpu < cpus_; ++cpu) {
+    if (khz[cpu] <= 0)
+      classes_[cpu] = CoreClass::Unknown;
+    else if (khz[cpu] == fastest)
+      classes_[cpu] = CoreClass::Big;
+    else if (khz[cpu] == slowest)
+      classes_[cpu] = CoreClass::Little;
+    else
+      classes_[cpu] = CoreClass::Mid;
+  }
+}
+
+CoreClass CpuTopology::classOf(int cpu) const {
+  return cpu >= 0 && cpu < cpus_ ? classes_[cpu] : CoreClass::Unknown;
+}
+
+bool CpuTopology::coresFor(CoreAffinity affinity, cpu_set_t *out) const {
+  if (affinity == CoreAffinity::Any)
+    return false;
+  CPU_ZERO(out);
+  int count = 0;
+  for (int cpu = 0; cpu < cpus_; ++cpu) {
+    const CoreClass c = classes_[cpu];
+    if (c == CoreClass::Unknown)
+      return false;
+    const bool little = c == CoreClass::Little;
+    if (little == (affinity == CoreAffinity::Little)) {
+      CPU_SET(cpu, out);
+      ++count;
+    }
+  }
+  return count > 0 && count < cpus_;
+}
+
+bool tuneAudioThread(CoreAffinity affinity, bool promote, PerfStats *stats) {
+  const int policy = sched_getscheduler(0);
+  const bool realtime = policy == SCHED_FIFO || policy == SCHED_RR;
+  const pid_t tid = gettid();
+  if (promote && !realtime &&
+      setpriority(PRIO_PROCESS, (id_t)tid, kUrgentAudioNice) != 0) {
+    LOGW("setpriority(%d) failed: %d", kUrgentAudioNice, errno);
+  }
+  errno = 0;
+  int nice = getpriority(PRIO_PROCESS, (id_t)tid);
+  if (errno != 0)
+    nice = 0;
+
+  bool pinned = false;
+  cpu_set_t cores;
+  if (CpuTopology::get().coresFor(affinity, &cores)) {
+    pinned = sched_setaffinity(0, sizeof(cores), &cores) == 0;
+    if (!pinned)
+      LOGW("sched_setaffinity failed: %d", errno);
+  }
+  if (stats != nullptr)
+    stats->setThread(realtime, nice, pinned);
+  return pinned;
+}
+
+void sampleAudioCore(PerfStats *stats) {
+  if (stats == nullptr)
+    return;
+  const int cpu = sched_getcpu();
+  stats->countCore(cpu, (int)CpuTopology::get().classOf(cpu));
+}
+
+} // namespace realtimeaudio
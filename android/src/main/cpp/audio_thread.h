@@ -0,0 +1,65 @@
+#ifndef REALTIMEAUDIO_AUDIO_THREAD_H
+#define REALTIMEAUDIO_AUDIO_THREAD_H
+
+#include "perf_stats.h"
+
+#include <sched.h>
+
+namespace realtimeaudio {
+
+// Cluster of a core, by its maximum frequency. Values are shared with
+// kPerfCoreClasses and the JS names.
+enum class CoreClass : int {
+  Unknown = 0, // no cpufreq data (some emulators)
+  Little = 1,  // slowest cluster
+  Mid = 2,     // between the slowest and the fastest
+  Big = 3,     // fastest cluster, or every core when there is only one
+};
+
+// Cores the capture thread may run on; values match AudioEngine.AFFINITY_*.
+enum class CoreAffinity : int {
+  Any = 0,
+  Little = 1, // the slowest cluster only
+  Big = 2,    // every core outside the slowest cluster
+};
+
+CoreAffinity coreAffinityFromInt(int value);
+
+// Core clusters as the kernel describes them: every
+// /sys/devices/system/cpu/cpuN/cpufreq/cpuinfo_max_freq, ranked. Read once,
+// on first use, so touch it before the audio callback starts.
+class CpuTopology {
+public:
+  static constexpr int kMaxCpus = 64;
+
+  static const CpuTopology &get();
+
+  int cpus() const { return cpus_; }
+  CoreClass classOf(int cpu) const;
+  // Cores allowed by `affinity`. False when there is nothing to restrict:
+  // Any, unknown clusters, or a set that would be empty or every core.
+  bool coresFor(CoreAffinity affinity, cpu_set_t *out) const;
+
+private:
+  CpuTopology();
+
+  int cpus_ = 0;
+  CoreClass classes_[kMaxCpus] = {};
+};
+
+// Nice level of Android's THREAD_PRIORITY_URGENT_AUDIO
+constexpr int kUrgentAudioNice = -19;
+
+// Moves the calling thread to audio scheduling and, per `affinity`, onto one
+// core class, then records the result in `stats` (may be null). `promote`
+// sets kUrgentAudioNice unless the thread already runs SCHED_FIFO / RR, as
+// AAudio callbacks usually do; threads promoted from Java pass false.
+// Returns whether the thread was pinned.
+bool tuneAudioThread(CoreAffinity affinity, bool promote, PerfStats *stats);
+
+// Counts the core the calling thread is on in `stats`; one getcpu call.
+void sampleAudioCore(PerfStats *stats);
+
+} // namespace realtimeaudio
+
+#endif // REALTIMEAUDIO_AUDIO_THREAD_H
@@ -0,0 +1,249 @@
+#include "analyzer.h"
+#include "frame_bindings.h"
+#include "frame_queue.h"
+#include "frame_store.h"
+#include "spectrogram_history.h"
+
+#include <algorithm>
+#include <jni.h>
+#include <memory>
+#include <new>
+
+using realtimeaudio::Analyzer;
+using realtimeaudio::FrameInfo;
+using realtimeaudio::FrameQueue;
+using realtimeaudio::FrameStore;
+using realtimeaudio::MeterLevels;
+using realtimeaudio::PerfScope;
+using realtimeaudio::PerfStage;
+using realtimeaudio::PerfStats;
+using realtimeaudio::SpectralFeatures;
+using realtimeaudio::SpectrogramHistory;
+using realtimeaudio::VoiceActivity;
+
+namespace jsi = facebook::jsi;
+
+// Handles own a heap-allocated shared_ptr so the JS ArrayBuffer can keep the
+// memory alive after the module releases its reference.
+static inline std::shared_ptr<FrameStore> *storeFromHandle(jlong handle) {
+  return reinterpret_cast<std::shared_ptr<FrameStore> *>(handle);
+}
+
+// Installs the frame ArrayBuffer into the JS runtime (called on the JS
+// thread). Reuses `existing` so a reloaded runtime sees the same memory.
+// Returns the store handle, or 0 on failure.
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_realtimeaudio_RealtimeAudioAnalyzerModule_nativeInstallFrameBuffer(
+    JNIEnv *env, jobject thiz, jlong jsRuntime, jlong existing,
+    jint capacity) {
+  auto *runtime = reinterpret_cast<jsi::Runtime *>(jsRuntime);
+  if (runtime == nullptr || capacity <= 0)
+    return 0;
+
+  std::shared_ptr<FrameStore> *handle = storeFromHandle(existing);
+  if (handle == nullptr) {
+    handle = new (std::nothrow) std::shared_ptr<FrameStore>(
+        std::make_shared<FrameStore>((uint32_t)capacity));
+    if (handle == nullptr)
+      return 0;
+  }
+  realtimeaudio::installFrameBindings(*runtime, *handle);
+  return reinterpret_cast<jlong>(handle);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_realtimeaudio_RealtimeAudioAnalyzerModule_nativeReleaseFrameBuffer(
+    JNIEnv *env, jobject thiz, jlong handle) {
+  delete storeFromHandle(handle);
+}
+
+// Fills `dst` (room for `capacity` floats) from `count` bins of `data`, or of
+// the analyzer's registered direct output when `data` is null. Bins are
+// band-mapped when the analyzer has a band layout, copied otherwise.
+// Returns the floats written.
+static jint fillFrame(JNIEnv *env, Analyzer *analyzer, jfloatArray data,
+                      jint count, float *dst, jint capacity) {
+  if (count <= 0)
+    return 0;
+  auto mapOrCopy = [&](const float *src, jint bins) -> jint {
+    if (analyzer != nullptr)
+      return analyzer->mapBands(src, bins, dst, capacity);
+    bins = std::min(bins, capacity);
+    std::copy(src, src + bins, dst);
+    return bins;
+  };
+
+  if (data != nullptr) {
+    count = std::min(count, env->GetArrayLength(data));
+    auto *src =
+        static_cast<const float *>(env->GetPrimitiveArrayCritical(data, nullptr));
+    if (src == nullptr)
+      return 0;
+    jint written = mapOrCopy(src, count);
+    env->ReleasePrimitiveArrayCritical(data, const_cast<float *>(src), JNI_ABORT);
+    return written;
+  }
+
+  const float *src = analyzer ? analyzer->registeredOutput() : nullptr;
+  if (src == nullptr)
+    return 0;
+  return mapOrCopy(src, std::min(count, (jint)analyzer->registeredOutputCapacity()));
+}
+
+// Appends the mapped bins to the analyzer's spectrogram history, if any.
+static void recordHistory(Analyzer *analyzer, const float *bins, jint count,
+                          jdouble timestampMs) {
+  SpectrogramHistory *history = analyzer ? analyzer->history() : nullptr;
+  if (history != nullptr && count > 0)
+    history->push(bins, (uint32_t)count, timestampMs);
+}
+
+// Publishes one frame from the processing thread. Bins come from `data` when
+// given (array path), otherwise from the analyzer's registered direct output;
+// `count` 0 publishes levels only.
+extern "C" JNIEXPORT void JNICALL Java_com_realtimeaudio_AudioEngine_publishFrame(
+    JNIEnv *env, jobject thiz, jlong storeHandle, jlong analyzerHandle,
+    jfloatArray data, jint count, jfloat rms, jfloat peak,
+    jdouble timestampMs) {
+  std::shared_ptr<FrameStore> *handle = storeFromHandle(storeHandle);
+  if (handle == nullptr)
+    return;
+  FrameStore &store = **handle;
+  Analyzer *analyzer = reinterpret_cast<Analyzer *>(analyzerHandle);
+  PerfScope scope(analyzer ? analyzer->perfStats() : nullptr,
+                  PerfStage::Publish);
+
+  float *dst = store.beginFrame();
+  jint bins = fillFrame(env, analyzer, data, count, dst,
+                        (jint)store.capacity());
+  recordHistory(analyzer, dst, bins, timestampMs);
+  store.endFrame((uint32_t)bins, rms, peak, timestampMs);
+}
+
+// --- Capture -> delivery frame queue (owned by AudioEngine) ---
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_realtimeaudio_AudioEngine_nativeCreateFrameQueue(JNIEnv *env,
+                                                          jobject thiz,
+                                                          jint slots,
+                                                          jint capacity) {
+  if (slots <= 0 || capacity <= 0)
+    return 0;
+  return reinterpret_cast<jlong>(
+      new (std::nothrow) FrameQueue((uint32_t)slots, (uint32_t)capacity));
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_realtimeaudio_AudioEngine_nativeReleaseFrameQueue(JNIEnv *env,
+                                                           jobject thiz,
+                                                           jlong handle) {
+  delete reinterpret_cast<FrameQueue *>(handle);
+}
+
+// Producer side, called from the capture thread; never blocks. Bins are
+// taken (and band-mapped) as for publishFrame().
+extern "C" JNIEXPORT void JNICALL Java_com_realtimeaudio_AudioEngine_pushFrame(
+    JNIEnv *env, jobject thiz, jlong queueHandle, jlong analyzerHandle,
+    jfloatArray data, jint count, jfloat rms, jfloat peak, jdouble timestampMs,
+    jint bufferSize, jint fftSize) {
+  FrameQueue *queue = reinterpret_cast<FrameQueue *>(queueHandle);
+  if (queue == nullptr)
+    return;
+  Analyzer *analyzer = reinterpret_cast<Analyzer *>(analyzerHandle);
+  PerfStats *perf = analyzer ? analyzer->perfStats() : nullptr;
+  PerfScope scope(perf, PerfStage::Publish);
+
+  float *dst = queue->beginPush();
+  jint bins = fillFrame(env, analyzer, data, count, dst,
+                        (jint)queue->capacity());
+  recordHistory(analyzer, dst, bins, timestampMs);
+
+  FrameInfo info;
+  info.timestampMs = timestampMs;
+  info.rms = rms;
+  info.peak = peak;
+  info.bins = (uint32_t)bins;
+  info.bufferSize = (uint32_t)std::max<jint>(bufferSize, 0);
+  info.fftSize = (uint32_t)std::max<jint>(fftSize, 0);
+  info.pushedNs = PerfStats::nowNs();
+  if (analyzer != nullptr) {
+    info.features = analyzer->features();
+    info.meters = analyzer->meters();
+    info.voice = analyzer->voiceActivity();
+    if (analyzer->channelMode() != realtimeaudio::ChannelMode::Mono) {
+      // Channel spectra follow the main bins, mapped like them
+      info.channels = Analyzer::kMaxChannels;
+      info.channelLevels[0] = analyzer->channelLevels(0);
+      info.channelLevels[1] = analyzer->channelLevels(1);
+      if (bins > 0)
+        info.channelBins = (uint32_t)analyzer->mapChannelBands(
+            dst + bins, (int)queue->capacity() - bins);
+    }
+  }
+  queue->endPush(info);
+  if (perf != nullptr)
+    perf->observeQueue(queue->size(), queue->dropped());
+}
+
+static constexpr jsize kPopMetaValues = 28;
+
+// Consumer side, called from the delivery thread. Copies the oldest frame's
+// bins (then its channel spectra) into `out` and [timestamp, rms, peak,
+// bufferSize, fftSize, centroid, flux, rolloff, flatness, onset, pitch,
+// pitchConfidence, channels, channelBins, rms0, peak0, rms1, peak1] into
+// `meta`, followed by the meters [rms, peak, peakHold, momentaryLufs,
+// shortTermLufs], the voice activity gate [active, changed, levelDb,
+// noiseFloorDb] and the subscriber id (-1 for the main stream). The time
+// the frame spent queued is recorded into `perfHandle` (optional). Returns
+// the bin count, or -1 when the queue is empty.
+extern "C" JNIEXPORT jint JNICALL Java_com_realtimeaudio_AudioEngine_popFrame(
+    JNIEnv *env, jobject thiz, jlong queueHandle, jlong perfHandle,
+    jfloatArray out, jdoubleArray meta) {
+  FrameQueue *queue = reinterpret_cast<FrameQueue *>(queueHandle);
+  if (queue == nullptr || env->GetArrayLength(meta) < kPopMetaValues)
+    return -1;
+
+  const jsize outCapacity = env->GetArrayLength(out);
+  auto *dst = static_cast<float *>(env->GetPrimitiveArrayCritical(out, nullptr));
+  if (dst == nullptr)
+    return -1;
+  FrameInfo info;
+  const bool ok = queue->pop(info, dst, (uint32_t)outCapacity);
+  env->ReleasePrimitiveArrayCritical(out, dst, ok ? 0 : JNI_ABORT);
+  if (!ok)
+    return -1;
+  if (PerfStats *perf = reinterpret_cast<PerfStats *>(perfHandle))
+    perf->record(PerfStage::Queue, PerfStats::nowNs() - info.pushedNs);
+
+  const SpectralFeatures &f = info.features;
+  const MeterLevels &m = info.meters;
+  const VoiceActivity &v = info.voice;
+  const jdouble values[kPopMetaValues] = {info.timestampMs, info.rms, info.peak,
+                              (jdouble)info.bufferSize, (jdouble)info.fftSize,
+                              f.centroid, f.flux, f.rolloff, f.flatness,
+                              f.onset ? 1.0 : 0.0, f.pitch, f.pitchConfidence,
+                              (jdouble)info.channels, (jdouble)info.channelBins,
+                              info.channelLevels[0].rms,
+                              info.channelLevels[0].peak,
+                              info.channelLevels[1].rms,
+                              info.channelLevels[1].peak,
+                              m.rms, m.peak, m.peakHold, m.momentaryLufs,
+                              m.shortTermLufs, v.active ? 1.0 : 0.0,
+                              v.changed ? 1.0 : 0.0, v.levelDb,
+                              v.noiseFloorDb, (jdouble)info.subscriber};
+  env->SetDoubleArrayRegion(meta, 0, kPopMetaValues, values);
+  return (jint)info.bins;
+}
+
+// [pushed, delivered, dropped] since the queue was created.
+extern "C" JNIEXPORT void JNICALL
+Java_com_realtimeaudio_AudioEngine_nativeQueueStats(JNIEnv *env, jobject thiz,
+                                                    jlong queueHandle,
+                                                    jlongArray out) {
+  FrameQueue *queue = reinterpret_cast<FrameQueue *>(queueHandle);
+  if (queue == nullptr || env->GetArrayLength(out) < 3)
+    return;
+  const jlong values[3] = {(jlong)queue->pushed(), (jlong)queue->popped(),
+                           (jlong)queue->dropped()};
+  env->SetLongArrayRegion(out, 0, 3, values);
+}
@@ -0,0 +1,100 @@
+#include "aaudio_capture.h"
+
+#include <algorithm>
+#include <jni.h>
+#include <memory>
+#include <new>
+
+using realtimeaudio::AAudioCapture;
+using realtimeaudio::Analyzer;
+using realtimeaudio::CaptureConfig;
+using realtimeaudio::FrameQueue;
+using realtimeaudio::FrameStore;
+
+static inline AAudioCapture *captureFromHandle(jlong handle) {
+  return reinterpret_cast<AAudioCapture *>(handle);
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_realtimeaudio_AudioEngine_nativeCaptureSupported(JNIEnv *env,
+                                                          jobject thiz) {
+  return AAudioCapture::isSupported() ? JNI_TRUE : JNI_FALSE;
+}
+
+// Opens and starts an AAudio input stream whose callback drives the analyzer
+// and feeds `queueHandle` (or the FrameStore behind `storeHandle`, when not
+// 0). Returns the capture handle, or 0 if the stream could not be started.
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_realtimeaudio_AudioEngine_nativeStartCapture(
+    JNIEnv *env, jobject thiz, jlong analyzerHandle, jlong queueHandle,
+    jlong storeHandle, jint sampleRate, jint bufferSize, jint fftSize,
+    jint hopSize, jint downsampleBins, jint bandLayout, jint callbackRateHz,
+    jint silentRateHz, jboolean emitFft, jint features,
+    jboolean smoothingEnabled, jfloat smoothingFactor, jint cpuAffinity) {
+  auto *analyzer = reinterpret_cast<Analyzer *>(analyzerHandle);
+  auto *queue = reinterpret_cast<FrameQueue *>(queueHandle);
+  if (analyzer == nullptr || queue == nullptr || !AAudioCapture::isSupported())
+    return 0;
+
+  // Keep the shared frames alive for the life of the stream
+  std::shared_ptr<FrameStore> store;
+  if (storeHandle != 0)
+    store = *reinterpret_cast<std::shared_ptr<FrameStore> *>(storeHandle);
+
+  AAudioCapture *capture =
+      new (std::nothrow) AAudioCapture(analyzer, queue, std::move(store));
+  if (capture == nullptr)
+    return 0;
+
+  CaptureConfig config;
+  config.sampleRate = sampleRate;
+  config.bufferSize = bufferSize;
+  config.fftSize = fftSize;
+  config.hopSize = hopSize;
+  config.downsampleBins = downsampleBins;
+  config.bandLayout = bandLayout;
+  config.callbackRateHz = callbackRateHz;
+  config.silentRateHz = silentRateHz;
+  config.emitFft = emitFft == JNI_TRUE;
+  config.features = (uint32_t)std::max<jint>(features, 0);
+  config.smoothingEnabled = smoothingEnabled == JNI_TRUE;
+  config.smoothingFactor = smoothingFactor;
+  config.cpuAffinity = cpuAffinity;
+  if (!capture->start(config)) {
+    delete capture;
+    return 0;
+  }
+  return reinterpret_cast<jlong>(capture);
+}
+
+// Stops the stream (no callbacks run after this returns) and frees it.
+extern "C" JNIEXPORT void JNICALL
+Java_com_realtimeaudio_AudioEngine_nativeStopCapture(JNIEnv *env, jobject thiz,
+                                                     jlong handle) {
+  delete captureFromHandle(handle);
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_realtimeaudio_AudioEngine_nativeCaptureSampleRate(JNIEnv *env,
+                                                           jobject thiz,
+                                                           jlong handle) {
+  AAudioCapture *capture = captureFromHandle(handle);
+  return capture ? capture->sampleRate() : 0;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_realtimeaudio_AudioEngine_nativeCaptureSetFftConfig(
+    JNIEnv *env, jobject thiz, jlong handle, jint fftSize, jint downsampleBins,
+    jint hopSize, jint bandLayout) {
+  if (AAudioCapture *capture = captureFromHandle(handle)) {
+    capture->setBandLayout(bandLayout);
+    capture->setFftConfig(fftSize, downsampleBins, hopSize);
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_realtimeaudio_AudioEngine_nativeCaptureSetSmoothing(
+    JNIEnv *env, jobject thiz, jlong handle, jboolean enabled, jfloat factor) {
+  if (AAudioCapture *capture = captureFromHandle(handle))
+    capture->setSmoothing(enabled == JNI_TRUE, factor);
+}
@@ -0,0 +1,142 @@
+#include "analyzer.h"
+#include "audio_thread.h"
+#include "perf_stats.h"
+
+#include <jni.h>
+#include <new>
+
+using realtimeaudio::Analyzer;
+using realtimeaudio::kPerfBuckets;
+using realtimeaudio::kPerfCoreClasses;
+using realtimeaudio::kPerfStageCount;
+using realtimeaudio::PerfSnapshot;
+using realtimeaudio::PerfStage;
+using realtimeaudio::PerfStageStats;
+using realtimeaudio::PerfStats;
+using realtimeaudio::PerfThreadStats;
+
+// Layout of nativePerfSnapshot(): header, one block per PerfStage, then the
+// capture thread
+static constexpr int kHeaderValues = 7;
+static constexpr int kStageValues = 6 + kPerfBuckets;
+static constexpr int kThreadValues = 7 + kPerfCoreClasses;
+static constexpr int kSnapshotValues =
+    kHeaderValues + kPerfStageCount * kStageValues + kThreadValues;
+
+static inline PerfStats *perfFromHandle(jlong handle) {
+  return reinterpret_cast<PerfStats *>(handle);
+}
+
+// One per AudioEngine, kept across sessions so stats stay readable after
+// stop(); freed by nativeReleasePerfStats().
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_realtimeaudio_AudioEngine_nativeCreatePerfStats(JNIEnv *env,
+                                                         jobject thiz) {
+  return reinterpret_cast<jlong>(new (std::nothrow) PerfStats());
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_realtimeaudio_AudioEngine_nativeReleasePerfStats(JNIEnv *env,
+                                                          jobject thiz,
+                                                          jlong handle) {
+  delete perfFromHandle(handle);
+}
+
+// The analyzer then times its own stages; `perfHandle` must outlive it.
+extern "C" JNIEXPORT void JNICALL
+Java_com_realtimeaudio_AudioEngine_nativeSetPerfStats(JNIEnv *env,
+                                                      jobject thiz,
+                                                      jlong analyzerHandle,
+                                                      jlong perfHandle) {
+  if (Analyzer *analyzer = reinterpret_cast<Analyzer *>(analyzerHandle))
+    analyzer->setPerfStats(perfFromHandle(perfHandle));
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_realtimeaudio_AudioEngine_nativePerfReset(JNIEnv *env, jobject thiz,
+                                                   jlong handle,
+                                                   jboolean tracing) {
+  if (PerfStats *stats = perfFromHandle(handle)) {
+    stats->reset();
+    stats->setTracing(tracing == JNI_TRUE);
+  }
+}
+
+// Stages timed in Kotlin (read, deliver), as PERF_STAGE_* values
+extern "C" JNIEXPORT void JNICALL
+Java_com_realtimeaudio_AudioEngine_nativePerfRecord(JNIEnv *env, jobject thiz,
+                                                    jlong handle, jint stage,
+                                                    jlong durationNs) {
+  if (PerfStats *stats = perfFromHandle(handle))
+    stats->record((PerfStage)stage, durationNs);
+}
+
+// One AudioRecord read: whether it was emitted and whether processing it
+// overran its audio duration. Called on the capture thread, so it also
+// samples the core the read ran on.
+extern "C" JNIEXPORT void JNICALL
+Java_com_realtimeaudio_AudioEngine_nativePerfCountRead(JNIEnv *env,
+                                                       jobject thiz,
+                                                       jlong handle,
+                                                       jboolean emitted,
+                                                       jboolean overrun) {
+  PerfStats *stats = perfFromHandle(handle);
+  if (stats == nullptr)
+    return;
+  stats->countRead(emitted == JNI_TRUE);
+  if (overrun == JNI_TRUE)
+    stats->countOverruns(1);
+  realtimeaudio::sampleAudioCore(stats);
+}
+
+// Fills `out` with [elapsedMs, reads, rateLimited, overruns, queueDepth,
+// maxQueueDepth, queueDropped], then per PerfStage [count, meanUs, p50Us,
+// p95Us, p99Us, maxUs, histogram...], then [tuned, realtime, nice, pinned,
+// cpu, coreClass, migrations, reads per core class...]. Returns false if
+// `out` is too short.
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_realtimeaudio_AudioEngine_nativePerfSnapshot(JNIEnv *env,
+                                                      jobject thiz,
+                                                      jlong handle,
+                                                      jdoubleArray out) {
+  PerfStats *stats = perfFromHandle(handle);
+  if (stats == nullptr || env->GetArrayLength(out) < kSnapshotValues)
+    return JNI_FALSE;
+
+  PerfSnapshot snapshot;
+  stats->snapshot(&snapshot);
+
+  jdouble values[kSnapshotValues];
+  values[0] = snapshot.elapsedMs;
+  values[1] = (jdouble)snapshot.reads;
+  values[2] = (jdouble)snapshot.rateLimited;
+  values[3] = (jdouble)snapshot.overruns;
+  values[4] = (jdouble)snapshot.queueDepth;
+  values[5] = (jdouble)snapshot.maxQueueDepth;
+  values[6] = (jdouble)snapshot.queueDropped;
+  for (int i = 0; i < kPerfStageCount; ++i) {
+    const PerfStageStats &s = snapshot.stages[i];
+    jdouble *block = values + kHeaderValues + i * kStageValues;
+    block[0] = (jdouble)s.count;
+    block[1] = s.meanUs;
+    block[2] = s.p50Us;
+    block[3] = s.p95Us;
+    block[4] = s.p99Us;
+    block[5] = s.maxUs;
+    for (int b = 0; b < kPerfBuckets; ++b)
+      block[6 + b] = (jdouble)s.histogram[b];
+  }
+  const PerfThreadStats &t = snapshot.thread;
+  jdouble *thread = values + kHeaderValues + kPerfStageCount * kStageValues;
+  thread[0] = t.tuned ? 1.0 : 0.0;
+  thread[1] = t.realtime ? 1.0 : 0.0;
+  thread[2] = (jdouble)t.nice;
+  thread[3] = t.pinned ? 1.0 : 0.0;
+  thread[4] = (jdouble)t.cpu;
+  thread[5] = (jdouble)t.coreClass;
+  thread[6] = (jdouble)t.migrations;
+  for (int c = 0; c < kPerfCoreClasses; ++c)
+    thread[7 + c] = (jdouble)t.coreReads[c];
+  env->SetDoubleArrayRegion(out, 0, kSnapshotValues, values);
+  return JNI_TRUE;
+}
@@ -0,0 +1,61 @@
+#include "analyzer.h"
+#include "frame_bindings.h"
+#include "spectrogram_history.h"
+
+#include <jni.h>
+#include <memory>
+#include <new>
+
+using realtimeaudio::Analyzer;
+using realtimeaudio::SpectrogramHistory;
+
+namespace jsi = facebook::jsi;
+
+// As for the frame store, a handle owns a heap-allocated shared_ptr so the
+// JS ArrayBuffer can keep the memory alive after the module lets go.
+static inline std::shared_ptr<SpectrogramHistory> *
+historyFromHandle(jlong handle) {
+  return reinterpret_cast<std::shared_ptr<SpectrogramHistory> *>(handle);
+}
+
+// Allocates a history and installs it into the JS runtime (called on the JS
+// thread). Returns the handle, or 0 on failure.
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_realtimeaudio_RealtimeAudioAnalyzerModule_nativeInstallSpectrogramHistory(
+    JNIEnv *env, jobject thiz, jlong jsRuntime, jint frames, jint maxBins,
+    jint format, jfloat minDb, jfloat maxDb) {
+  auto *runtime = reinterpret_cast<jsi::Runtime *>(jsRuntime);
+  if (runtime == nullptr || frames <= 0 || maxBins <= 0)
+    return 0;
+
+  std::shared_ptr<SpectrogramHistory> *handle;
+  try {
+    handle = new std::shared_ptr<SpectrogramHistory>(
+        std::make_shared<SpectrogramHistory>(
+            (uint32_t)frames, (uint32_t)maxBins,
+            realtimeaudio::spectrogramFormatFromInt(format), minDb, maxDb));
+  } catch (const std::bad_alloc &) {
+    return 0;
+  }
+  realtimeaudio::installHistoryBindings(*runtime, *handle);
+  return reinterpret_cast<jlong>(handle);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_realtimeaudio_RealtimeAudioAnalyzerModule_nativeReleaseSpectrogramHistory(
+    JNIEnv *env, jobject thiz, jlong handle) {
+  delete historyFromHandle(handle);
+}
+
+// Published frames of the analyzer are appended to the history from now on;
+// 0 detaches it. The history must outlive the analyzer's session.
+extern "C" JNIEXPORT void JNICALL
+Java_com_realtimeaudio_AudioEngine_nativeSetHistory(JNIEnv *env, jobject thiz,
+                                                    jlong analyzerHandle,
+                                                    jlong historyHandle) {
+  Analyzer *analyzer = reinterpret_cast<Analyzer *>(analyzerHandle);
+  if (analyzer == nullptr)
+    return;
+  std::shared_ptr<SpectrogramHistory> *handle = historyFromHandle(historyHandle);
+  analyzer->setHistory(handle != nullptr ? handle->get() : nullptr);
+}
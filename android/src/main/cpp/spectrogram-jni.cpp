@@ -0,0 +1,86 @@
+#include "spectrogram.h"
+#include "wav_reader.h"
+#include <climits>
+#include <jni.h>
+#include <string>
+
+using realtimeaudio::bandLayoutFromInt;
+using realtimeaudio::computeSpectrogram;
+using realtimeaudio::fftBackendFromInt;
+using realtimeaudio::readWav;
+using realtimeaudio::Spectrogram;
+using realtimeaudio::SpectrogramOptions;
+using realtimeaudio::spectrogramFormatFromInt;
+using realtimeaudio::WavFile;
+using realtimeaudio::WavStatus;
+using realtimeaudio::wavStatusMessage;
+using realtimeaudio::windowTypeFromInt;
+
+static void throwJava(JNIEnv *env, const char *type, const std::string &msg) {
+  jclass cls = env->FindClass(type);
+  if (cls != nullptr)
+    env->ThrowNew(cls, msg.c_str());
+}
+
+// Reads a WAV file and computes its whole spectrogram on worker threads.
+// Blocks for the duration, so call it off the JS and UI threads. `meta`
+// receives [frames, bins, hopSize, sampleRate]; returns the row-major matrix
+// or null with a pending IOException / IllegalArgumentException.
+extern "C" JNIEXPORT jbyteArray JNICALL
+Java_com_realtimeaudio_RealtimeAudioAnalyzerModule_nativeComputeSpectrogram(
+    JNIEnv *env, jobject thiz, jstring path, jint fftSize, jint hopSize,
+    jint window, jint backend, jint layout, jint bands, jint format,
+    jfloat minDb, jfloat maxDb, jint threads, jintArray meta) {
+  if (path == nullptr || env->GetArrayLength(meta) < 4) {
+    throwJava(env, "java/lang/IllegalArgumentException", "invalid arguments");
+    return nullptr;
+  }
+
+  const char *chars = env->GetStringUTFChars(path, nullptr);
+  if (chars == nullptr)
+    return nullptr; // OutOfMemoryError pending
+  const std::string file(chars);
+  env->ReleaseStringUTFChars(path, chars);
+
+  WavFile wav;
+  const WavStatus status = readWav(file.c_str(), &wav);
+  if (status != WavStatus::Ok) {
+    throwJava(env, "java/io/IOException",
+              file + ": " + wavStatusMessage(status));
+    return nullptr;
+  }
+
+  SpectrogramOptions options;
+  options.fftSize = fftSize;
+  options.hopSize = hopSize;
+  options.window = windowTypeFromInt(window);
+  options.backend = fftBackendFromInt(backend);
+  options.layout = bandLayoutFromInt(layout);
+  options.bands = bands;
+  options.format = spectrogramFormatFromInt(format);
+  options.minDb = minDb;
+  options.maxDb = maxDb;
+  options.threads = threads;
+
+  Spectrogram result;
+  if (!computeSpectrogram(wav.buffer(), (float)wav.sampleRate, options,
+                          &result) ||
+      result.data.size() > (size_t)INT_MAX) {
+    throwJava(env, "java/lang/IllegalArgumentException",
+              "could not compute a spectrogram with fftSize " +
+                  std::to_string(fftSize) + " for " + file);
+    return nullptr;
+  }
+  // The decoded samples are not needed for the copy below
+  wav.data = {};
+
+  jbyteArray out = env->NewByteArray((jsize)result.data.size());
+  if (out == nullptr)
+    return nullptr; // OutOfMemoryError pending
+  env->SetByteArrayRegion(out, 0, (jsize)result.data.size(),
+                          reinterpret_cast<const jbyte *>(result.data.data()));
+  const jint info[4] = {result.frames, result.bins, result.hopSize,
+                        wav.sampleRate};
+  env->SetIntArrayRegion(meta, 0, 4, info);
+  return out;
+}
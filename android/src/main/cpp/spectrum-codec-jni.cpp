@@ -0,0 +1,83 @@
+#include "analyzer.h"
+#include "spectrum_codec.h"
+
+#include <jni.h>
+#include <new>
+
+using realtimeaudio::Analyzer;
+using realtimeaudio::SpectrumEncoder;
+using realtimeaudio::SpectrumEncoding;
+
+// One encoder per stream of a delivered frame: stream 0 is the main
+// spectrum, 1 + c the spectrum of channel c
+static constexpr int kStreams = 1 + Analyzer::kMaxChannels;
+
+struct FrameEncoders {
+  SpectrumEncoder streams[kStreams];
+};
+
+// Owned by the delivery thread of one session; freed by
+// nativeReleaseSpectrumEncoder(). Returns 0 for the float format, an empty
+// dB range or out of memory.
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_realtimeaudio_AudioEngine_nativeCreateSpectrumEncoder(
+    JNIEnv *env, jobject thiz, jint format, jfloat minDb, jfloat maxDb,
+    jboolean delta, jint keyframeInterval, jint capacity) {
+  SpectrumEncoding encoding;
+  encoding.format = realtimeaudio::spectrumFormatFromInt(format);
+  encoding.minDb = minDb;
+  encoding.maxDb = maxDb;
+  encoding.delta = delta == JNI_TRUE;
+  encoding.keyframeInterval = keyframeInterval;
+
+  auto *encoders = new (std::nothrow) FrameEncoders();
+  if (encoders == nullptr)
+    return 0;
+  for (SpectrumEncoder &encoder : encoders->streams) {
+    if (!encoder.configure(encoding, capacity)) {
+      delete encoders;
+      return 0;
+    }
+  }
+  return reinterpret_cast<jlong>(encoders);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_realtimeaudio_AudioEngine_nativeReleaseSpectrumEncoder(JNIEnv *env,
+                                                                jobject thiz,
+                                                                jlong handle) {
+  delete reinterpret_cast<FrameEncoders *>(handle);
+}
+
+// Encodes `count` values of `values` starting at `offset` into `out` (see
+// cpp/spectrum_codec.h for the layout). Returns the bytes written, 0 for an
+// empty frame, or -1 on a bad stream or a too short `out`.
+extern "C" JNIEXPORT jint JNICALL
+Java_com_realtimeaudio_AudioEngine_nativeEncodeSpectrum(
+    JNIEnv *env, jobject thiz, jlong handle, jint stream, jfloatArray values,
+    jint offset, jint count, jbyteArray out) {
+  auto *encoders = reinterpret_cast<FrameEncoders *>(handle);
+  if (encoders == nullptr || stream < 0 || stream >= kStreams || offset < 0 ||
+      count < 0 || offset + count > env->GetArrayLength(values))
+    return -1;
+  if (count == 0)
+    return 0;
+
+  const jsize outCapacity = env->GetArrayLength(out);
+  auto *src =
+      static_cast<const float *>(env->GetPrimitiveArrayCritical(values, nullptr));
+  if (src == nullptr)
+    return -1;
+  auto *dst = static_cast<uint8_t *>(env->GetPrimitiveArrayCritical(out, nullptr));
+  if (dst == nullptr) {
+    env->ReleasePrimitiveArrayCritical(values, const_cast<float *>(src),
+                                       JNI_ABORT);
+    return -1;
+  }
+  const int bytes = encoders->streams[stream].encode(src + offset, count, dst,
+                                                     (int)outCapacity);
+  env->ReleasePrimitiveArrayCritical(out, dst, bytes > 0 ? 0 : JNI_ABORT);
+  env->ReleasePrimitiveArrayCritical(values, const_cast<float *>(src),
+                                     JNI_ABORT);
+  return bytes;
+}
@@ -0,0 +1,142 @@
+#include "analyzer.h"
+#include "frame_queue.h"
+#include "subscriber_graph.h"
+
+#include <algorithm>
+#include <jni.h>
+#include <new>
+
+using realtimeaudio::Analyzer;
+using realtimeaudio::FrameQueue;
+using realtimeaudio::SubscriberConfig;
+using realtimeaudio::SubscriberGraph;
+
+static inline SubscriberGraph *graphFromHandle(jlong handle) {
+  return reinterpret_cast<SubscriberGraph *>(handle);
+}
+
+// --- Subscriber graph (owned by AudioEngine, kept across sessions) ---
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_realtimeaudio_AudioEngine_nativeCreateSubscriberGraph(JNIEnv *env,
+                                                               jobject thiz) {
+  return reinterpret_cast<jlong>(new (std::nothrow) SubscriberGraph());
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_realtimeaudio_AudioEngine_nativeReleaseSubscriberGraph(JNIEnv *env,
+                                                                jobject thiz,
+                                                                jlong handle) {
+  delete graphFromHandle(handle);
+}
+
+// Adds subscriber `id` or replaces its config; false when the graph is full.
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_realtimeaudio_AudioEngine_nativeSetSubscriber(
+    JNIEnv *env, jobject thiz, jlong handle, jint id, jfloat rateHz,
+    jboolean spectrum, jint layout, jint bands, jint features,
+    jboolean meters) {
+  SubscriberGraph *graph = graphFromHandle(handle);
+  if (graph == nullptr)
+    return JNI_FALSE;
+  SubscriberConfig config;
+  config.rateHz = rateHz;
+  config.spectrum = spectrum == JNI_TRUE;
+  config.layout = realtimeaudio::bandLayoutFromInt(layout);
+  config.bands = bands;
+  config.features = (uint32_t)features;
+  config.meters = meters == JNI_TRUE;
+  return graph->set((int32_t)id, config) ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_realtimeaudio_AudioEngine_nativeRemoveSubscriber(JNIEnv *env,
+                                                          jobject thiz,
+                                                          jlong handle,
+                                                          jint id) {
+  SubscriberGraph *graph = graphFromHandle(handle);
+  return graph != nullptr && graph->remove((int32_t)id) ? JNI_TRUE : JNI_FALSE;
+}
+
+// Geometry of the session's spectrum, so band tables are built here and
+// not on the capture thread.
+extern "C" JNIEXPORT void JNICALL
+Java_com_realtimeaudio_AudioEngine_nativeSubscriberSpectrum(
+    JNIEnv *env, jobject thiz, jlong handle, jint fftSize, jint sampleRate) {
+  if (SubscriberGraph *graph = graphFromHandle(handle))
+    graph->setSpectrum(fftSize, (float)sampleRate);
+}
+
+// FEATURE_* bits some subscriber wants
+extern "C" JNIEXPORT jint JNICALL
+Java_com_realtimeaudio_AudioEngine_nativeSubscriberFeatures(JNIEnv *env,
+                                                            jobject thiz,
+                                                            jlong handle) {
+  SubscriberGraph *graph = graphFromHandle(handle);
+  return graph != nullptr ? (jint)graph->featureMask() : 0;
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_realtimeaudio_AudioEngine_nativeSubscriberMeters(JNIEnv *env,
+                                                          jobject thiz,
+                                                          jlong handle) {
+  SubscriberGraph *graph = graphFromHandle(handle);
+  return graph != nullptr && graph->wantsMeters() ? JNI_TRUE : JNI_FALSE;
+}
+
+// The analyzer's frames fan out to the graph's subscribers from now on (the
+// AAudio callback reads it back); 0 detaches it. The graph must outlive the
+// analyzer's session.
+extern "C" JNIEXPORT void JNICALL
+Java_com_realtimeaudio_AudioEngine_nativeSetSubscribers(JNIEnv *env,
+                                                        jobject thiz,
+                                                        jlong analyzerHandle,
+                                                        jlong graphHandle) {
+  if (Analyzer *analyzer = reinterpret_cast<Analyzer *>(analyzerHandle))
+    analyzer->setSubscribers(graphFromHandle(graphHandle));
+}
+
+// Capture thread: SubscriberGraph::poll() bits for `nowNs` (System.nanoTime)
+extern "C" JNIEXPORT jint JNICALL
+Java_com_realtimeaudio_AudioEngine_nativePollSubscribers(JNIEnv *env,
+                                                         jobject thiz,
+                                                         jlong handle,
+                                                         jlong nowNs) {
+  SubscriberGraph *graph = graphFromHandle(handle);
+  return graph != nullptr ? (jint)graph->poll((int64_t)nowNs) : 0;
+}
+
+// Capture thread: pushes a frame for every due subscriber. Magnitudes come
+// from `data` when given (array path), otherwise from the analyzer's
+// registered direct output; `count` 0 pushes levels only. Returns the
+// frames pushed.
+extern "C" JNIEXPORT jint JNICALL
+Java_com_realtimeaudio_AudioEngine_pushSubscriberFrames(
+    JNIEnv *env, jobject thiz, jlong graphHandle, jlong queueHandle,
+    jlong analyzerHandle, jfloatArray data, jint count, jfloat rms,
+    jfloat peak, jdouble timestampMs, jint bufferSize, jlong nowNs) {
+  SubscriberGraph *graph = graphFromHandle(graphHandle);
+  FrameQueue *queue = reinterpret_cast<FrameQueue *>(queueHandle);
+  Analyzer *analyzer = reinterpret_cast<Analyzer *>(analyzerHandle);
+  if (graph == nullptr || queue == nullptr || analyzer == nullptr)
+    return 0;
+  const uint32_t frames = (uint32_t)std::max<jint>(bufferSize, 0);
+
+  if (data != nullptr && count > 0) {
+    count = std::min(count, env->GetArrayLength(data));
+    auto *src =
+        static_cast<const float *>(env->GetPrimitiveArrayCritical(data, nullptr));
+    if (src == nullptr)
+      return 0;
+    const int pushed = graph->publish(*queue, *analyzer, src, count, rms, peak,
+                                      timestampMs, frames, (int64_t)nowNs);
+    env->ReleasePrimitiveArrayCritical(data, const_cast<float *>(src), JNI_ABORT);
+    return pushed;
+  }
+
+  const float *src = count > 0 ? analyzer->registeredOutput() : nullptr;
+  if (src != nullptr)
+    count = std::min(count, (jint)analyzer->registeredOutputCapacity());
+  return graph->publish(*queue, *analyzer, src, src != nullptr ? count : 0,
+                        rms, peak, timestampMs, frames, (int64_t)nowNs);
+}
@@ -110,19 +110,23 @@ class AudioAnalyzerDemoActivity : AppCompatActivity() {
     
     private fun setupAudioEngine() {
         audioEngine = AudioEngine { data ->
+            // The frame is recycled once this returns; copy what the UI needs
+            val sampleRate = data.sampleRate
+            val rms = data.rms
+            val peak = data.peak
             runOnUiThread {
-                updateAudioData(data)
+                updateAudioData(sampleRate, rms, peak)
             }
         }
     }
     
-    private fun updateAudioData(data: AudioEngine.AudioData) {
-        sampleRateText.text = "Sample Rate: ${data.sampleRate} Hz"
-        rmsText.text = "RMS: ${String.format("%.3f", data.rms)}"
-        peakText.text = "Peak: ${String.format("%.3f", data.peak)}"
+    private fun updateAudioData(sampleRate: Int, rms: Double, peak: Double) {
+        sampleRateText.text = "Sample Rate: $sampleRate Hz"
+        rmsText.text = "RMS: ${String.format("%.3f", rms)}"
+        peakText.text = "Peak: ${String.format("%.3f", peak)}"
         
         // Update progress bar (0-100 scale)
-        val rmsPercent = (data.rms * 100).toInt().coerceIn(0, 100)
+        val rmsPercent = (rms * 100).toInt().coerceIn(0, 100)
         levelProgressBar.progress = rmsPercent
     }
     
@@ -3,40 +3,250 @@ package com.realtimeaudio
 import android.media.AudioFormat
 import android.media.AudioRecord
 import android.media.MediaRecorder
+import android.os.Process
+import android.os.Trace
 import android.util.Log
-import kotlin.math.sqrt
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import java.nio.FloatBuffer
+import java.util.concurrent.ConcurrentHashMap
+import java.util.concurrent.locks.LockSupport
 
-class AudioEngine(private val onDataCallback: (AudioData) -> Unit) {
+/**
+ * @param onVoiceActivity called on the delivery thread whenever the voice
+ *   activity gate opens or closes (see [VoiceActivitySettings]), also with
+ *   shared frames, which otherwise bypass the callbacks
+ */
+class AudioEngine(
+    private val onDataCallback: (AudioData) -> Unit,
+    private val onVoiceActivity: (VoiceActivity) -> Unit = {}
+) {
 
     private var audioRecord: AudioRecord? = null
-    private var isRunning = false
+    @Volatile private var isRunning = false
     private var processingThread: Thread? = null
+    // Runs onDataCallback so slow consumers never stall AudioRecord.read
+    private var deliveryThread: Thread? = null
 
     // DSP Configuration
     private var bufferSize = 1024
     private var sampleRate = 48000  // Prefer 48kHz
     private var callbackRateHz = 30
     private var emitFft = true
-    private var smoothingEnabled = true
-    private var smoothingFactor = 0.5f
-    private var fftSize = 1024
-    private var downsampleBins = -1
-
-    // State for Smoothing
-    private var smoothRms = 0.0f
-    private var smoothPeak = 0.0f
-
-    data class AudioData(
-        val timestamp: Double,
-        val rms: Double,
-        val peak: Double,
-        val fft: FloatArray?,
-        val sampleRate: Int,
-        val bufferSize: Int
+    // Written by setSmoothing(), applied natively by the processing thread
+    @Volatile private var smoothingEnabled = true
+    @Volatile private var smoothingFactor = 0.5f
+    // Read by the processing thread, written by setFftConfig()
+    @Volatile private var fftSize = 1024
+    @Volatile private var hopSize = 0 // 0 = one STFT frame per read
+    @Volatile private var downsampleBins = -1 // output bands, <= 0 = raw bins
+    @Volatile private var bandLayout = BAND_LAYOUT_LINEAR
+    private var fftBackend = FFT_BACKEND_AUTO
+    private var windowType = WINDOW_HANN
+    private var featureMask = 0 // FEATURE_* bits computed natively per frame
+    // What the session computes: the above plus what subscribers asked for
+    // when it started
+    private var sessionFeatures = 0
+    private var sessionMeters = false
+    private var channelMode = CHANNEL_MODE_MONO
+    private var meterSettings: MeterSettings? = null // null = meters off
+    private var voiceSettings: VoiceActivitySettings? = null // null = gate off
+    // Compact spectra in delivered frames (null = float arrays)
+    private var spectrumEncoding: SpectrumEncoding? = null
+    // Systrace sections around each stage (see getPerformanceStats)
+    private var traceStages = false
+    private var cpuAffinity = AFFINITY_ANY
+
+    /**
+     * One delivered frame. Frames are allocated once per capture session and
+     * refilled in place for every delivery, so the steady state allocates
+     * nothing: a frame is only valid until [onDataCallback] returns, and a
+     * consumer that keeps values (or hands them to another thread) copies
+     * them first.
+     */
+    class AudioData internal constructor(
+        capacity: Int, channelCapacity: Int, encodedCapacity: Int
+    ) {
+        var timestamp = 0.0
+        var rms = 0.0
+        var peak = 0.0
+        // Band-mapped spectrum: the first [bins] values of [fft]; 0 when the
+        // frame ships none
+        val fft = FloatArray(capacity)
+        var bins = 0
+        // [fft] encoded per [SpectrumEncoding] when one is set
+        val encoded = EncodedSpectrum(encodedCapacity)
+        var sampleRate = 0
+        var bufferSize = 0
+        var fftSize = 0
+        var droppedFrames = 0L // frames lost to queue overruns so far
+        // Id of the [Subscription] the frame is for; -1 for the main stream
+        var subscriber = -1
+        // Meaningful when features.mask != 0
+        val features = SpectralFeatures()
+        // Meaningful when meters.enabled
+        val meters = LevelMeters()
+        // Meaningful when voice.enabled
+        val voice = VoiceActivity()
+        // Left / right (or mid / side) in the stereo channel modes: the
+        // first [channelCount] entries are valid
+        val channels = Array(2) {
+            ChannelData(channelCapacity, if (channelCapacity > 0) encodedCapacity else 0)
+        }
+        var channelCount = 0
+    }
+
+    /** Levels (unsmoothed) and spectrum of one channel of a stereo frame. */
+    class ChannelData internal constructor(capacity: Int, encodedCapacity: Int) {
+        var rms = 0.0
+        var peak = 0.0
+        // The first [bins] values of [fft]
+        val fft = FloatArray(capacity)
+        var bins = 0
+        val encoded = EncodedSpectrum(encodedCapacity)
+    }
+
+    /**
+     * A spectrum as quantized dB codes (cpp/spectrum_codec.h): the first
+     * [size] bytes of [bytes], a flag byte (keyframe or delta) and the
+     * codes; 0 when the frame ships no spectrum.
+     */
+    class EncodedSpectrum internal constructor(capacity: Int) {
+        val bytes = ByteArray(capacity)
+        var size = 0
+    }
+
+    /** Per-frame spectral features; only the bits in [mask] are meaningful. */
+    class SpectralFeatures {
+        var mask = 0
+        var centroid = 0.0
+        var flux = 0.0
+        var rolloff = 0.0
+        var flatness = 0.0
+        var onset = false
+        var pitch = 0.0 // Hz, 0 when unpitched
+        var pitchConfidence = 0.0
+    }
+
+    /**
+     * Native meter ballistics, in milliseconds: sliding RMS window, RMS
+     * attack / release time constants (release also drives the peak) and
+     * the peak hold window.
+     */
+    data class MeterSettings(
+        val windowMs: Float = 300f,
+        val attackMs: Float = 10f,
+        val releaseMs: Float = 300f,
+        val holdMs: Float = 1500f
+    )
+
+    /**
+     * Native voice activity gate: it opens once the read level has stayed
+     * above max([thresholdDb], noise floor + [noiseMarginDb]) for
+     * [attackMs] and closes after [releaseMs] below [hysteresisDb] under
+     * that (levels in dBFS, times in ms). While it is closed the FFT and
+     * feature stages are skipped and frames drop to [silentRateHz], 0
+     * sending only the transitions.
+     */
+    data class VoiceActivitySettings(
+        val thresholdDb: Float = -50f,
+        val hysteresisDb: Float = 6f,
+        val noiseMarginDb: Float = 10f,
+        val attackMs: Float = 30f,
+        val releaseMs: Float = 500f,
+        val silentRateHz: Int = 0
+    )
+
+    /** Voice activity gate after the frame's read. */
+    class VoiceActivity {
+        var enabled = false
+        var active = false
+        var changed = false // this frame opened or closed the gate
+        var timestamp = 0.0
+        var levelDb = 0.0
+        var noiseFloorDb = 0.0
+    }
+
+    /**
+     * Compact spectrum payloads: SPECTRUM_FORMAT_UINT8 / _UINT16 codes over
+     * [minDb, maxDb], optionally delta-coded against the previous frame with
+     * a keyframe at least every [keyframeInterval] frames.
+     */
+    data class SpectrumEncoding(
+        val format: Int = SPECTRUM_FORMAT_UINT8,
+        val minDb: Float = -100f,
+        val maxDb: Float = 0f,
+        val delta: Boolean = false,
+        val keyframeInterval: Int = 30
+    )
+
+    /**
+     * One consumer's share of the session (see [addSubscriber]): [bands]
+     * bands in [layout] (<= 0 raw bins) at [rateHz], the [features] bits and
+     * the meters. Frames carry the downmix spectrum as floats and the
+     * levels; channel spectra, encoding and the voice gate stay with the
+     * main stream.
+     */
+    data class Subscription(
+        val rateHz: Int = 30,
+        val spectrum: Boolean = true,
+        val bands: Int = 0,
+        val layout: Int = BAND_LAYOUT_LINEAR,
+        val features: Int = 0,
+        val meters: Boolean = false
     )
 
+    /** Read-size independent meters of the newest read (linear, LUFS). */
+    class LevelMeters {
+        var enabled = false
+        var rms = 0.0
+        var peak = 0.0
+        var peakHold = 0.0
+        var momentaryLufs = 0.0
+        var shortTermLufs = 0.0
+    }
+
     private var libraryLoaded = false
 
+    // Opaque pointer to this engine's native Analyzer (0 = not created)
+    private var nativeHandle = 0L
+    // Serializes control-thread plan preparation against the analyzer's release
+    private val analyzerLock = Any()
+
+    // Direct buffers registered with the native analyzer (zero-copy path).
+    // Held here so they stay reachable while native code points into them.
+    private var directPcm: ByteBuffer? = null
+    private var directOutput: FloatBuffer? = null
+    private var directStats: FloatBuffer? = null
+
+    // Native FrameStore handle owned by the module (0 = events only). When
+    // set and shared delivery is on, frames are published to JS memory
+    // instead of going through onDataCallback.
+    @Volatile private var frameStoreHandle = 0L
+    @Volatile private var sharedFrames = false
+
+    // Native SpectrogramHistory handle owned by the module (0 = none). Read
+    // when a session creates its analyzer, which then appends every
+    // delivered frame to it.
+    @Volatile private var historyHandle = 0L
+
+    // Native SPSC FrameQueue between the capture and delivery threads
+    private var frameQueue = 0L
+    private val queueStats = LongArray(3) // [pushed, delivered, dropped]
+
+    // Native AAudio capture (0 = AudioRecord path). When set, analysis runs
+    // in the AAudio callback and there is no processing thread.
+    private var captureHandle = 0L
+
+    // Native PerfStats shared by every session of this engine (0 = none).
+    // Reset on start and kept after stop, so the last session stays readable.
+    private var perfHandle = 0L
+
+    // Native SubscriberGraph, kept across sessions like perfHandle (0 =
+    // none), and the configs it holds, read by the delivery thread
+    private var subscriberGraph = 0L
+    private val subscriptions = ConcurrentHashMap<Int, Subscription>()
+
     init {
         try {
             System.loadLibrary("realtimeaudioanalyzer")
@@ -46,17 +256,171 @@ class AudioEngine(private val onDataCallback: (AudioData) -> Unit) {
             Log.e(TAG, "Failed to load C++ library", e)
             libraryLoaded = false
         }
+        if (libraryLoaded) {
+            perfHandle = nativeCreatePerfStats()
+            subscriberGraph = nativeCreateSubscriberGraph()
+        }
     }
 
     // JNI Methods
-    private external fun computeFft(input: FloatArray, output: FloatArray, nfft: Int)
-    private external fun cleanupFft()
+    private external fun nativeCreate(nfft: Int, backend: Int, window: Int, channelMode: Int): Long
+    private external fun cleanupFft(handle: Long)
+    // Builds the plan for a new size on the calling thread (see setFftConfig)
+    private external fun nativePreparePlan(handle: Long, nfft: Int): Boolean
+    private external fun processPcm(
+        handle: Long, pcm: ShortArray, count: Int, output: FloatArray,
+        stats: FloatArray, nfft: Int, hopSize: Int, withFft: Boolean
+    ): Int
+    private external fun nativeSetBuffers(
+        handle: Long, pcm: ByteBuffer, output: ByteBuffer, stats: ByteBuffer
+    ): Boolean
+    private external fun processPcmDirect(
+        handle: Long, count: Int, nfft: Int, hopSize: Int, withFft: Boolean
+    ): Int
+    // Spectral features (FEATURE_* bits) computed on every frame
+    private external fun nativeSetFeatures(handle: Long, mask: Int, sampleRate: Int)
+    // Sliding RMS, peak hold and LUFS over every read; allocates, so only
+    // before capture starts
+    private external fun nativeSetMeters(
+        handle: Long, enabled: Boolean, windowMs: Float, attackMs: Float,
+        releaseMs: Float, holdMs: Float, sampleRate: Int
+    )
+    // Voice activity gate over every read; before capture starts
+    private external fun nativeSetVoiceActivity(
+        handle: Long, enabled: Boolean, thresholdDb: Float, hysteresisDb: Float,
+        noiseMarginDb: Float, attackMs: Float, releaseMs: Float, sampleRate: Int
+    )
+    // VAD_* bits of the gate after the latest read
+    private external fun nativeVoiceActivity(handle: Long): Int
+    // Level smoothing applied natively to the returned stats
+    private external fun nativeSetSmoothing(handle: Long, enabled: Boolean, factor: Float)
+    // Band mapping applied natively when frames are published or queued
+    private external fun nativeSetBands(handle: Long, layout: Int, bands: Int, sampleRate: Int)
+    // data == null publishes the analyzer's registered direct output
+    private external fun publishFrame(
+        storeHandle: Long, analyzerHandle: Long, data: FloatArray?, count: Int,
+        rms: Float, peak: Float, timestampMs: Double
+    )
+    private external fun nativeCreateFrameQueue(slots: Int, capacity: Int): Long
+    private external fun nativeReleaseFrameQueue(handle: Long)
+    // Never blocks; drops the oldest queued frame when full
+    private external fun pushFrame(
+        queueHandle: Long, analyzerHandle: Long, data: FloatArray?, count: Int,
+        rms: Float, peak: Float, timestampMs: Double, bufferSize: Int, fftSize: Int
+    )
+    // Returns bins, or -1 when empty; meta = [timestamp, rms, peak, bufferSize,
+    // fftSize, centroid, flux, rolloff, flatness, onset, pitch, pitchConfidence,
+    // channels, channelBins, rms0, peak0, rms1, peak1, meterRms, meterPeak,
+    // peakHold, momentaryLufs, shortTermLufs, voiceActive, voiceChanged,
+    // levelDb, noiseFloorDb]. Channel spectra follow the bins in `out`.
+    private external fun popFrame(
+        queueHandle: Long, perfHandle: Long, out: FloatArray, meta: DoubleArray
+    ): Int
+    private external fun nativeQueueStats(queueHandle: Long, out: LongArray)
+    private external fun nativeCaptureSupported(): Boolean
+    // storeHandle != 0 publishes shared frames instead of queueing them
+    private external fun nativeStartCapture(
+        analyzerHandle: Long, queueHandle: Long, storeHandle: Long,
+        sampleRate: Int, bufferSize: Int, fftSize: Int, hopSize: Int,
+        downsampleBins: Int, bandLayout: Int, callbackRateHz: Int, silentRateHz: Int,
+        emitFft: Boolean,
+        features: Int, smoothingEnabled: Boolean, smoothingFactor: Float,
+        cpuAffinity: Int
+    ): Long
+    private external fun nativeStopCapture(handle: Long)
+    private external fun nativeCaptureSampleRate(handle: Long): Int
+    private external fun nativeCaptureSetFftConfig(
+        handle: Long, fftSize: Int, downsampleBins: Int, hopSize: Int, bandLayout: Int
+    )
+    private external fun nativeCaptureSetSmoothing(handle: Long, enabled: Boolean, factor: Float)
+    private external fun nativeCreateSpectrumEncoder(
+        format: Int, minDb: Float, maxDb: Float, delta: Boolean,
+        keyframeInterval: Int, capacity: Int
+    ): Long
+    private external fun nativeReleaseSpectrumEncoder(handle: Long)
+    // Stream 0 is the main spectrum, 1 + c channel c; returns the bytes written
+    private external fun nativeEncodeSpectrum(
+        handle: Long, stream: Int, values: FloatArray, offset: Int, count: Int, out: ByteArray
+    ): Int
+    private external fun nativeCreatePerfStats(): Long
+    private external fun nativeReleasePerfStats(handle: Long)
+    // The analyzer times its analyze / fft / features stages into perfHandle
+    private external fun nativeSetPerfStats(analyzerHandle: Long, perfHandle: Long)
+    private external fun nativePerfReset(handle: Long, tracing: Boolean)
+    // Appends the analyzer's delivered frames to historyHandle (0 = none)
+    private external fun nativeSetHistory(analyzerHandle: Long, historyHandle: Long)
+    private external fun nativePerfRecord(handle: Long, stage: Int, durationNs: Long)
+    private external fun nativeCreateSubscriberGraph(): Long
+    private external fun nativeReleaseSubscriberGraph(handle: Long)
+    private external fun nativeSetSubscriber(
+        handle: Long, id: Int, rateHz: Float, spectrum: Boolean, layout: Int,
+        bands: Int, features: Int, meters: Boolean
+    ): Boolean
+    private external fun nativeRemoveSubscriber(handle: Long, id: Int): Boolean
+    private external fun nativeSubscriberSpectrum(handle: Long, fftSize: Int, sampleRate: Int)
+    private external fun nativeSubscriberFeatures(handle: Long): Int
+    private external fun nativeSubscriberMeters(handle: Long): Boolean
+    private external fun nativeSetSubscribers(analyzerHandle: Long, graphHandle: Long)
+    private external fun nativePollSubscribers(handle: Long, nowNs: Long): Int
+    private external fun pushSubscriberFrames(
+        graphHandle: Long, queueHandle: Long, analyzerHandle: Long,
+        data: FloatArray?, count: Int, rms: Float, peak: Float,
+        timestamp: Double, bufferSize: Int, nowNs: Long
+    ): Int
+    private external fun nativePerfCountRead(handle: Long, emitted: Boolean, overrun: Boolean)
+    // Pins the calling (capture) thread per AFFINITY_* and records its
+    // scheduling in perfHandle; true when pinned
+    private external fun nativeTuneAudioThread(perfHandle: Long, affinity: Int): Boolean
+    // See PERF_* for the layout of `out`
+    private external fun nativePerfSnapshot(handle: Long, out: DoubleArray): Boolean
 
+    /**
+     * @param bufferSize samples per AudioRecord read (capture latency)
+     * @param fftSize STFT frame length, independent of [bufferSize]
+     * @param hopSize samples between STFT frames; 0 takes one frame per read
+     * @param sharedFrames publish frames to the JSI frame buffer (see
+     *   [setFrameStore]) instead of [onDataCallback]
+     * @param bandLayout how spectra are aggregated into `downsampleBins`
+     *   bands (BAND_LAYOUT_*), see [setFftConfig]
+     * @param nativeCapture capture with AAudio and analyze in its callback;
+     *   falls back to AudioRecord where AAudio is unavailable (API < 26)
+     * @param windowType analysis window (WINDOW_*)
+     * @param features spectral features (FEATURE_* bits) to compute per
+     *   frame; they still run when [emitFft] is false
+     * @param channelMode CHANNEL_MODE_*; the stereo modes capture two
+     *   channels and add per-channel levels and spectra to every frame
+     * @param meters sliding-window RMS, peak hold and LUFS meters computed
+     *   over every read with these ballistics; null leaves them off
+     * @param voiceActivity gate the analysis on voice activity with these
+     *   settings; null analyzes every frame
+     * @param spectrumEncoding ship spectra as quantized dB codes in
+     *   [AudioData.encoded] instead of [AudioData.fft]; null keeps floats
+     * @param traceStages wrap each pipeline stage in a systrace section
+     *   ("rta:read", "rta:analyze", ...) for Perfetto; stage timings are
+     *   collected either way, see [getPerformanceStats]
+     * @param cpuAffinity AFFINITY_*: core class the capture thread (or the
+     *   AAudio callback thread) is pinned to; it always gets audio-class
+     *   scheduling
+     */
     fun start(
         bufferSize: Int,
         sampleRate: Int,
         callbackRateHz: Int,
-        emitFft: Boolean
+        emitFft: Boolean,
+        fftSize: Int = bufferSize,
+        hopSize: Int = 0,
+        fftBackend: Int = FFT_BACKEND_AUTO,
+        sharedFrames: Boolean = false,
+        nativeCapture: Boolean = false,
+        bandLayout: Int = BAND_LAYOUT_LINEAR,
+        windowType: Int = WINDOW_HANN,
+        features: Int = 0,
+        channelMode: Int = CHANNEL_MODE_MONO,
+        traceStages: Boolean = false,
+        meters: MeterSettings? = null,
+        spectrumEncoding: SpectrumEncoding? = null,
+        voiceActivity: VoiceActivitySettings? = null,
+        cpuAffinity: Int = AFFINITY_ANY
     ) {
         if (isRunning) {
             Log.w(TAG, "Audio engine already running")
@@ -69,15 +433,37 @@ class AudioEngine(private val onDataCallback: (AudioData) -> Unit) {
 
         this.bufferSize = bufferSize
         this.sampleRate = sampleRate
-        this.callbackRateHz = callbackRateHz
+        this.callbackRateHz = callbackRateHz.coerceIn(MIN_CALLBACK_RATE_HZ, MAX_CALLBACK_RATE_HZ)
         this.emitFft = emitFft
-        this.fftSize = bufferSize // Default FFT size to buffer size
+        this.fftBackend = fftBackend
+        this.windowType = windowType
+        this.featureMask = features
+        this.channelMode = channelMode
+        this.traceStages = traceStages
+        this.cpuAffinity = cpuAffinity
+        this.meterSettings = meters
+        this.voiceSettings = voiceActivity
+        this.spectrumEncoding = spectrumEncoding?.takeIf { it.format != SPECTRUM_FORMAT_FLOAT }
+        this.sharedFrames = sharedFrames
+        this.bandLayout = bandLayout
+        this.fftSize = if (fftSize > 0) fftSize else bufferSize
+        this.hopSize = hopSize.coerceIn(0, this.fftSize)
+        this.sessionFeatures = features or nativeSubscriberFeatures(subscriberGraph)
+        this.sessionMeters = meters != null || nativeSubscriberMeters(subscriberGraph)
+        nativePerfReset(perfHandle, traceStages)
+
+        if (nativeCapture) {
+            if (startNativeCapture()) return
+            Log.w(TAG, "AAudio capture unavailable, falling back to AudioRecord")
+        }
 
         // Ensure safe buffer size with fallback sample rate logic
+        val channelConfig =
+            if (inputChannels() > 1) AudioFormat.CHANNEL_IN_STEREO else AudioFormat.CHANNEL_IN_MONO
         var actualSampleRate = sampleRate
         var minBufferSize = AudioRecord.getMinBufferSize(
             actualSampleRate,
-            AudioFormat.CHANNEL_IN_MONO,
+            channelConfig,
             AudioFormat.ENCODING_PCM_16BIT
         )
         
@@ -87,7 +473,7 @@ class AudioEngine(private val onDataCallback: (AudioData) -> Unit) {
             actualSampleRate = 44100
             minBufferSize = AudioRecord.getMinBufferSize(
                 actualSampleRate,
-                AudioFormat.CHANNEL_IN_MONO,
+                channelConfig,
                 AudioFormat.ENCODING_PCM_16BIT
             )
         }
@@ -101,13 +487,13 @@ class AudioEngine(private val onDataCallback: (AudioData) -> Unit) {
         Log.i(TAG, "Using sample rate: ${actualSampleRate}Hz, min buffer size: ${minBufferSize}")
 
         // We might need a larger internal buffer than the requested processing bufferSize
-        val recordBufferSize = kotlin.math.max(minBufferSize, bufferSize * 2)
+        val recordBufferSize = kotlin.math.max(minBufferSize, bufferSize * 2 * inputChannels())
 
         try {
             audioRecord = AudioRecord(
                 MediaRecorder.AudioSource.VOICE_RECOGNITION, // Tuned for voice/audio analysis
                 actualSampleRate,
-                AudioFormat.CHANNEL_IN_MONO,
+                channelConfig,
                 AudioFormat.ENCODING_PCM_16BIT,
                 recordBufferSize
             )
@@ -119,18 +505,128 @@ class AudioEngine(private val onDataCallback: (AudioData) -> Unit) {
             throw Exception("AudioRecord initialization failed")
         }
 
+        // Each engine owns its own native analyzer so plans stay warm
+        nativeHandle = nativeCreate(this.fftSize, fftBackend, windowType, channelMode)
+        if (nativeHandle == 0L) {
+            audioRecord?.release()
+            audioRecord = null
+            throw Exception("Failed to create native analyzer")
+        }
+        nativeSetFeatures(nativeHandle, sessionFeatures, actualSampleRate)
+        applyMeters(actualSampleRate)
+        applyVoiceActivity(actualSampleRate)
+        nativeSetPerfStats(nativeHandle, perfHandle)
+        nativeSetHistory(nativeHandle, historyHandle)
+        nativeSubscriberSpectrum(subscriberGraph, this.fftSize, actualSampleRate)
+        nativeSetSubscribers(nativeHandle, subscriberGraph)
+
+        frameQueue = nativeCreateFrameQueue(queueSlots(), frameCapacity())
+        if (frameQueue == 0L) {
+            cleanupFft(nativeHandle)
+            nativeHandle = 0L
+            audioRecord?.release()
+            audioRecord = null
+            throw Exception("Failed to create frame queue")
+        }
+
         isRunning = true
         audioRecord?.startRecording()
 
-        processingThread = Thread {
+        startDeliveryThread(DELIVERY_IDLE_NS)
+
+        processingThread = Thread({
+            tuneCaptureThread()
             processAudio()
-        }
-        processingThread?.priority = Thread.MAX_PRIORITY
+        }, "RealtimeAudioCapture")
         processingThread?.start()
     }
 
+    /**
+     * Opens the AAudio stream. The analyzer and queue are created here as on
+     * the AudioRecord path, but the AAudio callback drives them instead of a
+     * Kotlin thread. Returns false (with nothing left running) on failure.
+     */
+    private fun startNativeCapture(): Boolean {
+        if (!nativeCaptureSupported()) return false
+
+        nativeHandle = nativeCreate(fftSize, fftBackend, windowType, channelMode)
+        if (nativeHandle == 0L) return false
+        // Resized natively once the stream's actual rate is known
+        applyMeters(sampleRate)
+        applyVoiceActivity(sampleRate)
+        nativeSetPerfStats(nativeHandle, perfHandle)
+        nativeSetHistory(nativeHandle, historyHandle)
+        // The band tables are rebuilt natively for the stream's actual rate
+        nativeSubscriberSpectrum(subscriberGraph, fftSize, sampleRate)
+        nativeSetSubscribers(nativeHandle, subscriberGraph)
+        frameQueue = nativeCreateFrameQueue(queueSlots(), frameCapacity())
+        if (frameQueue == 0L) {
+            stop()
+            return false
+        }
+
+        isRunning = true
+        // Native code cannot unpark the delivery thread, so it polls a few
+        // times per emission interval
+        startDeliveryThread(1_000_000_000L / callbackRateHz / 4)
+
+        val store = if (sharedFrames) frameStoreHandle else 0L
+        captureHandle = nativeStartCapture(
+            nativeHandle, frameQueue, store, sampleRate, bufferSize, fftSize,
+            hopSize, downsampleBins, bandLayout, callbackRateHz,
+            voiceSettings?.silentRateHz ?: 0, emitFft,
+            sessionFeatures, smoothingEnabled, smoothingFactor, cpuAffinity
+        )
+        if (captureHandle == 0L) {
+            stop()
+            return false
+        }
+        sampleRate = nativeCaptureSampleRate(captureHandle)
+        Log.i(TAG, "AAudio capture at ${sampleRate}Hz")
+        return true
+    }
+
+    // Subscribers that want meters get the default ballistics
+    private fun applyMeters(rate: Int) {
+        if (!sessionMeters) return
+        val m = meterSettings ?: MeterSettings()
+        nativeSetMeters(
+            nativeHandle, true, m.windowMs, m.attackMs, m.releaseMs, m.holdMs, rate
+        )
+    }
+
+    private fun applyVoiceActivity(rate: Int) {
+        val v = voiceSettings ?: return
+        nativeSetVoiceActivity(
+            nativeHandle, true, v.thresholdDb, v.hysteresisDb, v.noiseMarginDb,
+            v.attackMs, v.releaseMs, rate
+        )
+    }
+
+    // Thread.MAX_PRIORITY only maps to a foreground nice level and leaves
+    // the thread free to migrate; reads need audio-class scheduling
+    private fun tuneCaptureThread() {
+        try {
+            Process.setThreadPriority(Process.THREAD_PRIORITY_URGENT_AUDIO)
+        } catch (e: Exception) {
+            Log.w(TAG, "Could not raise the capture thread priority", e)
+        }
+        if (libraryLoaded) nativeTuneAudioThread(perfHandle, cpuAffinity)
+    }
+
+    private fun startDeliveryThread(idleNs: Long) {
+        deliveryThread = Thread({ deliverFrames(idleNs) }, "RealtimeAudioDelivery")
+        deliveryThread?.start()
+    }
+
     fun stop() {
         isRunning = false
+
+        // No AAudio callbacks run once this returns
+        if (captureHandle != 0L) {
+            nativeStopCapture(captureHandle)
+            captureHandle = 0L
+        }
         
         // Wait for processing thread to finish
         try {
@@ -145,6 +641,26 @@ class AudioEngine(private val onDataCallback: (AudioData) -> Unit) {
         }
         processingThread = null
 
+        // The capture thread has exited: wake the delivery thread so it sees
+        // isRunning == false, then free the queue once nobody touches it
+        deliveryThread?.let { thread ->
+            LockSupport.unpark(thread)
+            try {
+                thread.join(1000)
+            } catch (e: InterruptedException) {
+                Thread.currentThread().interrupt()
+            }
+        }
+        deliveryThread = null
+        if (frameQueue != 0L) {
+            nativeQueueStats(frameQueue, queueStats)
+            if (queueStats[2] > 0) {
+                Log.w(TAG, "Dropped ${queueStats[2]} of ${queueStats[0]} frames (consumer too slow)")
+            }
+            nativeReleaseFrameQueue(frameQueue)
+            frameQueue = 0L
+        }
+
         // Stop and release AudioRecord
         try {
             audioRecord?.stop()
@@ -155,11 +671,17 @@ class AudioEngine(private val onDataCallback: (AudioData) -> Unit) {
         audioRecord = null
         
         // Cleanup native resources
-        try {
-            cleanupFft()
-        } catch (e: Exception) {
-            Log.w(TAG, "Error cleaning up FFT", e)
+        synchronized(analyzerLock) {
+            try {
+                if (nativeHandle != 0L) cleanupFft(nativeHandle)
+            } catch (e: Exception) {
+                Log.w(TAG, "Error cleaning up FFT", e)
+            }
+            nativeHandle = 0L
         }
+        directPcm = null
+        directOutput = null
+        directStats = null
         
         Log.i(TAG, "Audio engine stopped")
     }
@@ -168,29 +690,209 @@ class AudioEngine(private val onDataCallback: (AudioData) -> Unit) {
         return isRunning
     }
 
+    /**
+     * Stage timings and pipeline counters of the current (or last) session
+     * into [out] (at least PERF_SNAPSHOT_SIZE values, see PERF_*). Returns
+     * false when the native library is unavailable.
+     */
+    fun getPerformanceStats(out: DoubleArray): Boolean =
+        perfHandle != 0L && nativePerfSnapshot(perfHandle, out)
+
+    /** Stops capture and frees the native stats; the engine is unusable after. */
+    fun release() {
+        stop()
+        if (perfHandle != 0L) {
+            nativeReleasePerfStats(perfHandle)
+            perfHandle = 0L
+        }
+        if (subscriberGraph != 0L) {
+            nativeReleaseSubscriberGraph(subscriberGraph)
+            subscriberGraph = 0L
+        }
+        subscriptions.clear()
+    }
+
+    /**
+     * Adds subscriber [id] (or replaces its subscription). Its frames reach
+     * [onDataCallback] with [AudioData.subscriber] set, on their own
+     * schedule, computed from the session's one transform; they are
+     * delivered with shared frames too. The spectrum and rate apply at
+     * once, features and meters the session does not compute yet from the
+     * next start(). False when MAX_SUBSCRIBERS others exist.
+     */
+    fun addSubscriber(id: Int, subscription: Subscription): Boolean {
+        if (!libraryLoaded) return false
+        val rate = subscription.rateHz.coerceIn(MIN_CALLBACK_RATE_HZ, MAX_CALLBACK_RATE_HZ)
+        val sub = subscription.copy(rateHz = rate)
+        // Published before the native side can emit frames for it
+        val previous = subscriptions.put(id, sub)
+        val ok = nativeSetSubscriber(
+            subscriberGraph, id, rate.toFloat(), sub.spectrum, sub.layout,
+            sub.bands, sub.features, sub.meters
+        )
+        if (!ok) {
+            if (previous != null) subscriptions[id] = previous else subscriptions.remove(id)
+        }
+        return ok
+    }
+
+    /** Drops subscriber [id]; false when there is none. */
+    fun removeSubscriber(id: Int): Boolean {
+        if (!libraryLoaded) return false
+        val removed = nativeRemoveSubscriber(subscriberGraph, id)
+        subscriptions.remove(id)
+        return removed
+    }
+
+    /** Window of the current (or last) session, as a JS name. */
+    fun windowFunctionName(): String = windowName(windowType)
+
+    /** Capture thread affinity of the current (or last) session, as a JS name. */
+    fun cpuAffinityName(): String = affinityName(cpuAffinity)
+
+    /** Channel mode of the current (or last) session, as a JS name. */
+    fun channelModeName(): String = channelModeName(channelMode)
+
+    /** Spectral features of the current (or last) session, as JS names. */
+    fun featureNames(): List<String> = featureNames(featureMask)
+
+    /** Voice activity gate of the current (or last) session, null when off. */
+    fun voiceActivitySettings(): VoiceActivitySettings? = voiceSettings
+
+    /** Spectrum encoding of the current (or last) session, null for floats. */
+    fun spectrumEncoding(): SpectrumEncoding? = spectrumEncoding
+
     fun setSmoothing(enabled: Boolean, factor: Float) {
         this.smoothingEnabled = enabled
         this.smoothingFactor = factor.coerceIn(0.0f, 1.0f)
+        if (captureHandle != 0L) {
+            nativeCaptureSetSmoothing(captureHandle, enabled, smoothingFactor)
+        }
+    }
+
+    /** Native FrameStore to publish into when started with sharedFrames. */
+    fun setFrameStore(handle: Long) {
+        frameStoreHandle = handle
+    }
+
+    /**
+     * Native SpectrogramHistory the next session records into (0 = none).
+     * Takes effect on start(); the handle must stay valid until stop().
+     */
+    fun setSpectrogramHistory(handle: Long) {
+        historyHandle = handle
     }
 
-    fun setFftConfig(size: Int, bins: Int) {
+    /** [bins] output bands in [layout]; <= 0 ships the raw spectrum. */
+    fun setFftConfig(size: Int, bins: Int, hop: Int = hopSize, layout: Int = bandLayout) {
+        synchronized(analyzerLock) {
+            // Build the new plan here, off the capture thread, before the
+            // processing path can see the new size. The AAudio capture
+            // prepares it itself in nativeCaptureSetFftConfig().
+            if (nativeHandle != 0L && captureHandle == 0L && size != fftSize &&
+                !nativePreparePlan(nativeHandle, size)
+            ) {
+                Log.w(TAG, "Could not prepare a plan for fftSize $size")
+            }
+        }
         this.fftSize = size
+        this.hopSize = hop.coerceIn(0, size)
+        this.bandLayout = layout
         this.downsampleBins = bins
+        nativeSubscriberSpectrum(subscriberGraph, size, sampleRate)
+        if (captureHandle != 0L) {
+            nativeCaptureSetFftConfig(captureHandle, size, bins, this.hopSize, bandLayout)
+        }
+    }
+
+    /**
+     * Allocates native-order direct buffers and hands their addresses to the
+     * analyzer once: AudioRecord reads PCM16 straight into `pcm`, native code
+     * writes magnitudes into `output` and [rms, peak] into `stats`.
+     * Returns false (and keeps the array path) if the native side rejects them.
+     */
+    private fun registerDirectBuffers(pcmSamples: Int, outputFloats: Int): Boolean {
+        val pcm = ByteBuffer.allocateDirect(pcmSamples * 2).order(ByteOrder.nativeOrder())
+        val output = ByteBuffer.allocateDirect(outputFloats * 4).order(ByteOrder.nativeOrder())
+        val stats = ByteBuffer.allocateDirect(2 * 4).order(ByteOrder.nativeOrder())
+
+        val ok = try {
+            nativeSetBuffers(nativeHandle, pcm, output, stats)
+        } catch (e: UnsatisfiedLinkError) {
+            false
+        }
+        if (!ok) {
+            Log.w(TAG, "Direct buffers unavailable, using array path")
+            return false
+        }
+
+        directPcm = pcm
+        directOutput = output.asFloatBuffer()
+        directStats = stats.asFloatBuffer()
+        return true
     }
 
+    // Samples per frame captured for the channel mode
+    private fun inputChannels(): Int = if (channelMode == CHANNEL_MODE_MONO) 1 else 2
+
+    // Main frames plus one per subscriber that may come due with them
+    private fun queueSlots(): Int = FRAME_QUEUE_SLOTS + MAX_SUBSCRIBERS
+
+    // Floats per queued frame: the bins plus, in stereo modes, two channel spectra
+    private fun frameCapacity(): Int = MAX_FRAME_BINS * (1 + if (inputChannels() > 1) 2 else 0)
+
     private fun processAudio() {
-        val readBuffer = ShortArray(bufferSize)
-        val floatBuffer = FloatArray(bufferSize) // For processing
+        // bufferSize counts frames; stereo reads are interleaved
+        val channels = inputChannels()
+        val readSamples = bufferSize * channels
+        val readBuffer = ShortArray(readSamples)
+        val statsArray = FloatArray(2) // [rms, peak] for the array path
         
-        // Output buffers to reuse
-        var fftOutput = FloatArray(fftSize / 2 + 1) // reused
+        // Output buffers to reuse, sized for the largest FFT so a live size
+        // change never allocates on this thread
+        val fftOutput = FloatArray(MAX_FRAME_BINS + 1)
+        var lastBins = 0 // bins of the newest STFT frame in fftOutput
+        var lastFrameFftSize = fftSize
+        // Band config last handed to the analyzer (changed by setFftConfig)
+        var appliedBands = Int.MIN_VALUE
+        var appliedLayout = -1
+        var appliedSmoothing = false
+        var appliedFactor = Float.NaN
+
+        // PCM is bounded by the read size, the spectrum by the largest FFT
+        val useDirect = registerDirectBuffers(readSamples, MAX_FRAME_BINS + 1)
         
-        var lastCallbackTime = 0L
-        val updateIntervalMs = 1000 / callbackRateHz
+        val tracing = traceStages
+
+        // Emission schedule on the monotonic clock. Advancing by whole
+        // intervals keeps the average rate at callbackRateHz even though
+        // reads only land on buffer boundaries.
+        val updateIntervalNs = 1_000_000_000L / callbackRateHz
+        var nextCallbackNs = 0L
+        // Voice activity gate, closed until the first read opens it
+        val voiceGate = voiceSettings != null
+        val silentRateHz = voiceSettings?.silentRateHz ?: 0
+        val silentIntervalNs = if (silentRateHz > 0) 1_000_000_000L / silentRateHz else 0L
+        var voiceOpen = !voiceGate
 
         while (isRunning) {
             val record = audioRecord ?: break
-            val readCount = record.read(readBuffer, 0, bufferSize)
+
+            // setFftConfig() prepares the plan before publishing the size,
+            // so the native side only swaps it in
+            val currentFftSize = if (fftSize > 0) fftSize else bufferSize
+            if (tracing) Trace.beginSection("rta:read")
+            val readStartNs = System.nanoTime()
+            val readCount = if (useDirect) {
+                // Bytes -> samples; errors are negative and pass through unchanged
+                val bytes = record.read(directPcm!!, readSamples * 2)
+                if (bytes > 0) bytes / 2 else bytes
+            } else {
+                record.read(readBuffer, 0, readSamples)
+            }
+            val readEndNs = System.nanoTime()
+            if (tracing) Trace.endSection()
+            nativePerfRecord(perfHandle, PERF_STAGE_READ, readEndNs - readStartNs)
 
             if (readCount < 0) {
                 // Error reading audio
@@ -211,125 +913,434 @@ class AudioEngine(private val onDataCallback: (AudioData) -> Unit) {
             }
 
             if (readCount > 0) {
-                // Convert to float [-1.0, 1.0] and compute inline stats
-                var sumSq = 0.0f
-                var peak = 0.0f
-                
-                for (i in 0 until readCount) {
-                    val sampleVal = readBuffer[i] / 32768.0f
-                    floatBuffer[i] = sampleVal
-                    
-                    val absVal = kotlin.math.abs(sampleVal)
-                    if (absVal > peak) peak = absVal
-                    sumSq += sampleVal * sampleVal
-                }
+                // Pipeline: conversion, RMS/peak and smoothing run on every
+                // read; the FFT and the bin downsampling only run when a
+                // consumer is due to receive this frame
+                val nowNs = System.nanoTime()
+                // A closed voice gate drops the rate to silentRateHz (none at 0)
+                val gated = !voiceOpen
+                val scheduled = nowNs >= nextCallbackNs && (!gated || silentIntervalNs > 0)
+                // Subscribers run on their own schedules, off the same transform
+                val wanted = nativePollSubscribers(subscriberGraph, nowNs)
 
-                // RMS
-                var rms = sqrt(sumSq / readCount)
-
-                // Smoothing
-                if (smoothingEnabled) {
-                    smoothRms = lerp(smoothRms, rms, smoothingFactor)
-                    smoothPeak = lerp(smoothPeak, peak, smoothingFactor)
-                    rms = smoothRms
-                    peak = smoothPeak
-                } else {
-                    smoothRms = rms
-                    smoothPeak = peak
+                // The native ring keeps fftSize samples of history, so the
+                // transform no longer depends on how much a single read returned
+                val currentHopSize = hopSize
+                if (currentFftSize != lastFrameFftSize) {
+                    // Native history restarts; don't re-send the old frame
+                    lastBins = 0
+                    lastFrameFftSize = currentFftSize
                 }
+                // Features need the magnitudes even when the spectrum is not
+                // shipped. While gated they are requested on every read: the
+                // analyzer skips the transform until the gate opens, then
+                // takes that frame at once.
+                val withFft = ((scheduled || gated) && (emitFft || featureMask != 0)) ||
+                    (wanted and SUBSCRIBERS_SPECTRAL) != 0
 
-                val now = System.currentTimeMillis()
-                if (now - lastCallbackTime >= updateIntervalMs) {
-                    var fftData: FloatArray? = null
-                    
-                    if (emitFft) {
-                        // Ensure output buffer helps
-                        // We are passing floatBuffer (size bufferSize).
-                        // If fftSize != bufferSize, we have a mismatch.
-                        // For simplicity in this engine, we assume fftSize = bufferSize or 
-                        // we pad/truncate. The requirement said "FFT size configurable (default = buffer size)".
-                        // If configured differently, we'd need to handle buffering.
-                        // For this implementation, let's use the current buffer data.
-                        
-                        val currentFftSize = if (fftSize > 0) fftSize else bufferSize
-                        
-                        // We need to resize output if needed (rarely happens after init)
-                        val neededSize = currentFftSize / 2 // approx
-                        if (fftOutput.size < neededSize) { // Simple check
-                             fftOutput = FloatArray(neededSize + 10) 
-                        }
+                val smoothing = smoothingEnabled
+                val factor = smoothingFactor
+                if (smoothing != appliedSmoothing || factor != appliedFactor) {
+                    nativeSetSmoothing(nativeHandle, smoothing, factor)
+                    appliedSmoothing = smoothing
+                    appliedFactor = factor
+                }
 
-                        // Call JNI
-                        // If bufferSize < fftSize, we should pad. If bufferSize > fftSize, truncate.
-                        // We pass the floatBuffer. JNI will read up to nfft.
-                        // If nfft > buffer, JNI might crash if we don't handle it.
-                        // Let's safe guard:
-                        val safeFftSize = kotlin.math.min(currentFftSize, readCount)
-                        
-                        try {
-                            computeFft(floatBuffer, fftOutput, safeFftSize)
-                        } catch (e: UnsatisfiedLinkError) {
-                            Log.e(TAG, "JNI method not found - library may not be loaded", e)
-                            break
-                        } catch (e: Exception) {
-                            Log.e(TAG, "Error computing FFT", e)
-                            // Continue without FFT data
-                            fftData = null
-                        }
-                        
-                        // Downsampling
-                        if (downsampleBins > 0 && downsampleBins < neededSize) {
-                           fftData = resampleFft(fftOutput, safeFftSize / 2, downsampleBins)
-                        } else {
-                           // Copy just the valid part
-                           fftData = fftOutput.copyOfRange(0, safeFftSize / 2)
+                // One native pass: int16 -> float into the STFT history,
+                // smoothed RMS/peak and (when due and a hop has elapsed) the
+                // magnitudes
+                var bins = 0
+                var rms = 0.0f
+                var peak = 0.0f
+                try {
+                    if (useDirect) {
+                        val directStatsOut = directStats!!
+                        val directOut = directOutput!!
+                        bins = processPcmDirect(
+                            nativeHandle, readCount, currentFftSize, currentHopSize, withFft
+                        )
+                        rms = directStatsOut.get(0)
+                        peak = directStatsOut.get(1)
+                        if (bins > 0) {
+                            directOut.position(0)
+                            directOut.get(fftOutput, 0, kotlin.math.min(bins, fftOutput.size))
                         }
+                    } else {
+                        bins = processPcm(
+                            nativeHandle, readBuffer, readCount, fftOutput,
+                            statsArray, currentFftSize, currentHopSize, withFft
+                        )
+                        rms = statsArray[0]
+                        peak = statsArray[1]
                     }
+                } catch (e: UnsatisfiedLinkError) {
+                    Log.e(TAG, "JNI method not found - library may not be loaded", e)
+                    break
+                }
+
+                if (bins > 0) lastBins = bins
+
+                var voiceChanged = false
+                if (voiceGate) {
+                    val voice = nativeVoiceActivity(nativeHandle)
+                    voiceOpen = (voice and VAD_ACTIVE) != 0
+                    voiceChanged = (voice and VAD_CHANGED) != 0
+                }
+                // Transitions go out at once, whatever the schedule; there is
+                // no spectrum to ship while gated
+                val due = scheduled || voiceChanged
+                val shipFft = withFft && emitFft && voiceOpen
+
+                val bands = downsampleBins
+                val layout = bandLayout
+                if (bands != appliedBands || layout != appliedLayout) {
+                    nativeSetBands(nativeHandle, layout, bands, sampleRate)
+                    appliedBands = bands
+                    appliedLayout = layout
+                }
 
-                    val data = AudioData(
-                        timestamp = now.toDouble(),
-                        rms = rms.toDouble(),
-                        peak = peak.toDouble(),
-                        fft = fftData,
-                        sampleRate = sampleRate,
-                        bufferSize = readCount
+                // Native code band-maps the bins while copying them out, so
+                // no spectrum-sized array is allocated per frame
+                val store = frameStoreHandle
+                val source = if (useDirect) null else fftOutput
+                if (due && sharedFrames && store != 0L) {
+                    // Zero-serialization path: one copy into native memory
+                    // that JS reads directly
+                    val timestamp = System.currentTimeMillis().toDouble()
+                    val count = if (shipFft) lastBins else 0
+                    publishFrame(store, nativeHandle, source, count, rms, peak, timestamp)
+                    if (voiceChanged) {
+                        // The shared frame has no room for the gate: queue the
+                        // transition alone so the delivery thread reports it
+                        pushFrame(
+                            frameQueue, nativeHandle, null, 0, rms, peak,
+                            timestamp, readCount / channels, currentFftSize
+                        )
+                        deliveryThread?.let { LockSupport.unpark(it) }
+                    }
+                } else if (due) {
+                    // Hand the frame to the delivery thread, which builds the
+                    // event. Between hops the most recent STFT frame is re-sent.
+                    val timestamp = System.currentTimeMillis().toDouble()
+                    val count = if (shipFft) lastBins else 0
+                    pushFrame(
+                        frameQueue, nativeHandle, source, count, rms, peak,
+                        timestamp, readCount / channels, currentFftSize
+                    )
+                    deliveryThread?.let { LockSupport.unpark(it) }
+                }
+                if ((wanted and SUBSCRIBERS_DUE) != 0) {
+                    val spectral = (wanted and SUBSCRIBERS_SPECTRAL) != 0 && voiceOpen
+                    pushSubscriberFrames(
+                        subscriberGraph, frameQueue, nativeHandle, source,
+                        if (spectral) lastBins else 0, rms, peak,
+                        System.currentTimeMillis().toDouble(), readCount / channels, nowNs
                     )
-                    
-                    onDataCallback(data)
-                    lastCallbackTime = now
+                    deliveryThread?.let { LockSupport.unpark(it) }
+                }
+
+                if (due) {
+                    val intervalNs = if (voiceOpen) updateIntervalNs else silentIntervalNs
+                    nextCallbackNs += intervalNs
+                    if (voiceChanged || nextCallbackNs <= nowNs) {
+                        // A transition, or fell behind (first frame or a
+                        // stall): resync
+                        nextCallbackNs = nowNs + intervalNs
+                    }
                 }
+
+                // Processing slower than the audio it carried means the
+                // AudioRecord buffer is filling up: an overrun in the making
+                val audioNs = readCount / channels * 1_000_000_000L / sampleRate
+                nativePerfCountRead(perfHandle, due, System.nanoTime() - readEndNs > audioNs)
             }
         }
     }
 
-    private fun lerp(start: Float, stop: Float, amount: Float): Float {
-        return start + (stop - start) * amount
-    }
-    
-    // Simple bin averaging for downsampling
-    private fun resampleFft(src: FloatArray, srcLen: Int, destLen: Int): FloatArray {
-         val dest = FloatArray(destLen)
-         val bucketSize = srcLen.toFloat() / destLen.toFloat()
-         
-         for (i in 0 until destLen) {
-             val startIndex = (i * bucketSize).toInt()
-             val endIndex = ((i + 1) * bucketSize).toInt().coerceAtMost(srcLen)
-             
-             if (startIndex >= endIndex) {
-                 if (startIndex < srcLen) dest[i] = src[startIndex]
-                 continue
-             }
-             
-             var sum = 0.0f
-             for (j in startIndex until endIndex) {
-                 sum += src[j]
-             }
-             dest[i] = sum / (endIndex - startIndex)
-         }
-         return dest
+    /**
+     * Delivery thread: drains the frame queue into [onDataCallback], parking
+     * while it is empty. The AudioRecord thread unparks it after every push;
+     * [idleNs] bounds the wait otherwise.
+     */
+    private fun deliverFrames(idleNs: Long) {
+        val bins = FloatArray(frameCapacity())
+        val meta = DoubleArray(POP_META_VALUES)
+        // Encoder state lives with this thread for the session
+        val encoding = spectrumEncoding
+        val encoder = encoding?.let {
+            nativeCreateSpectrumEncoder(
+                it.format, it.minDb, it.maxDb, it.delta, it.keyframeInterval, MAX_FRAME_BINS
+            )
+        } ?: 0L
+        if (encoding != null && encoder == 0L) {
+            Log.w(TAG, "Spectrum encoding unavailable, sending float spectra")
+        }
+        // Refilled for every delivery (see AudioData)
+        val frame = AudioData(
+            MAX_FRAME_BINS, if (inputChannels() > 1) MAX_FRAME_BINS else 0,
+            if (encoder != 0L) 1 + MAX_FRAME_BINS * 2 else 0
+        )
+
+        val tracing = traceStages
+
+        while (isRunning) {
+            val count = popFrame(frameQueue, perfHandle, bins, meta)
+            if (count < 0) {
+                LockSupport.parkNanos(this, idleNs)
+                continue
+            }
+
+            // Already band-mapped natively; copy just the valid part
+            System.arraycopy(bins, 0, frame.fft, 0, count)
+            frame.bins = count
+            frame.subscriber = meta[27].toInt()
+            // Frames for a subscriber removed since they were queued are dropped
+            val subscription = if (frame.subscriber >= 0) subscriptions[frame.subscriber] else null
+            if (frame.subscriber >= 0 && subscription == null) continue
+            val channelBins = meta[13].toInt()
+            frame.channelCount = meta[12].toInt()
+            for (c in 0 until frame.channelCount) {
+                val channel = frame.channels[c]
+                channel.rms = meta[14 + 2 * c]
+                channel.peak = meta[15 + 2 * c]
+                System.arraycopy(bins, count + c * channelBins, channel.fft, 0, channelBins)
+                channel.bins = channelBins
+            }
+            frame.encoded.size = 0
+            if (encoder != 0L && subscription == null) {
+                frame.encoded.size =
+                    nativeEncodeSpectrum(encoder, 0, bins, 0, count, frame.encoded.bytes).coerceAtLeast(0)
+                for (c in 0 until frame.channelCount) {
+                    val channel = frame.channels[c]
+                    channel.encoded.size = nativeEncodeSpectrum(
+                        encoder, 1 + c, bins, count + c * channelBins, channelBins, channel.encoded.bytes
+                    ).coerceAtLeast(0)
+                }
+            }
+
+            nativeQueueStats(frameQueue, queueStats)
+            frame.timestamp = meta[0]
+            frame.sampleRate = sampleRate
+            frame.rms = meta[1]
+            frame.peak = meta[2]
+            frame.bufferSize = meta[3].toInt()
+            frame.fftSize = meta[4].toInt()
+            frame.droppedFrames = queueStats[2]
+            frame.features.apply {
+                mask = subscription?.let { it.features and sessionFeatures } ?: featureMask
+                centroid = meta[5]
+                flux = meta[6]
+                rolloff = meta[7]
+                flatness = meta[8]
+                onset = meta[9] != 0.0
+                pitch = meta[10]
+                pitchConfidence = meta[11]
+            }
+            frame.meters.apply {
+                enabled = subscription?.let { it.meters && sessionMeters } ?: (meterSettings != null)
+                rms = meta[18]
+                peak = meta[19]
+                peakHold = meta[20]
+                momentaryLufs = meta[21]
+                shortTermLufs = meta[22]
+            }
+            frame.voice.apply {
+                enabled = voiceSettings != null && subscription == null
+                active = meta[23] != 0.0
+                changed = meta[24] != 0.0
+                timestamp = meta[0]
+                levelDb = meta[25]
+                noiseFloorDb = meta[26]
+            }
+
+            // Includes the module's event map building and emit
+            if (tracing) Trace.beginSection("rta:deliver")
+            val deliverStartNs = System.nanoTime()
+            try {
+                if (frame.voice.enabled && frame.voice.changed) onVoiceActivity(frame.voice)
+                // Sessions publishing to a store only queue gate transitions
+                // (and subscriber frames)
+                if (!sharedFrames || frameStoreHandle == 0L || subscription != null) {
+                    onDataCallback(frame)
+                }
+            } catch (e: Exception) {
+                Log.e(TAG, "Frame consumer failed", e)
+            }
+            nativePerfRecord(perfHandle, PERF_STAGE_DELIVER, System.nanoTime() - deliverStartNs)
+            if (tracing) Trace.endSection()
+        }
+        if (encoder != 0L) nativeReleaseSpectrumEncoder(encoder)
     }
 
     companion object {
         const val TAG = "AudioEngine"
+
+        // Accepted callbackRateHz range (matches the iOS validation)
+        const val MIN_CALLBACK_RATE_HZ = 1
+        const val MAX_CALLBACK_RATE_HZ = 120
+
+        // Capture -> delivery queue: slots of up to MAX_FRAME_BINS floats
+        // (fftSize 16384 / 2), three times that with the stereo channel
+        // spectra. The session's eight slots cover ~65 ms of backlog at
+        // 120 Hz; queueSlots() adds one per subscriber (MAX_SUBSCRIBERS)
+        // that may come due with a main frame.
+        const val FRAME_QUEUE_SLOTS = 8
+        const val MAX_FRAME_BINS = 8192
+        // Values popFrame() writes into its meta array
+        private const val POP_META_VALUES = 28
+
+        // Subscriptions per engine (SubscriberGraph::kMaxSubscribers)
+        const val MAX_SUBSCRIBERS = 8
+        // nativePollSubscribers() bits: a subscriber is due / needs the spectrum
+        private const val SUBSCRIBERS_DUE = 1
+        private const val SUBSCRIBERS_SPECTRAL = 2
+        // Fallback wake-up in case an unpark is missed
+        const val DELIVERY_IDLE_NS = 100_000_000L
+
+        // nativeVoiceActivity() bits: the gate is open / the read switched it
+        const val VAD_ACTIVE = 1
+        const val VAD_CHANGED = 2
+
+        // Native FFT implementations (values match FftBackendType in C++)
+        const val FFT_BACKEND_AUTO = 0
+        const val FFT_BACKEND_KISS = 1
+        const val FFT_BACKEND_REAL = 2
+        // Apple only; resolves like auto on Android
+        const val FFT_BACKEND_ACCELERATE = 3
+        // Fixed-point KissFFT; PCM16 is analyzed without float conversion
+        const val FFT_BACKEND_KISS_Q15 = 4
+        const val FFT_BACKEND_KISS_Q31 = 5
+
+        fun fftBackendFromName(name: String?): Int = when (name) {
+            "kissfft" -> FFT_BACKEND_KISS
+            "realfft" -> FFT_BACKEND_REAL
+            "accelerate" -> FFT_BACKEND_ACCELERATE
+            "kissfft-q15" -> FFT_BACKEND_KISS_Q15
+            "kissfft-q31" -> FFT_BACKEND_KISS_Q31
+            else -> FFT_BACKEND_AUTO
+        }
+
+        // Analysis windows (values match WindowType in C++)
+        const val WINDOW_HANN = 0
+        const val WINDOW_HAMMING = 1
+        const val WINDOW_BLACKMAN = 2
+        const val WINDOW_RECTANGULAR = 3
+        const val WINDOW_BLACKMAN_HARRIS = 4
+        const val WINDOW_FLAT_TOP = 5
+
+        private val WINDOW_NAMES = arrayOf(
+            "hanning", "hamming", "blackman", "rectangular", "blackmanharris", "flattop"
+        )
+
+        fun windowFromName(name: String?): Int =
+            WINDOW_NAMES.indexOf(name).takeIf { it >= 0 } ?: WINDOW_HANN
+
+        fun windowName(type: Int): String = WINDOW_NAMES.getOrElse(type) { WINDOW_NAMES[WINDOW_HANN] }
+
+        // Spectral features (bit values match FeatureFlags in C++)
+        const val FEATURE_CENTROID = 1 shl 0
+        const val FEATURE_FLUX = 1 shl 1
+        const val FEATURE_ROLLOFF = 1 shl 2
+        const val FEATURE_FLATNESS = 1 shl 3
+        const val FEATURE_ONSET = 1 shl 4
+        const val FEATURE_PITCH = 1 shl 5
+
+        private val FEATURE_NAMES = arrayOf(
+            "centroid", "flux", "rolloff", "flatness", "onset", "pitch"
+        )
+
+        /** Bit mask for JS feature names; unknown names are ignored. */
+        fun featureMaskFromNames(names: List<String?>): Int =
+            names.fold(0) { mask, name ->
+                val bit = FEATURE_NAMES.indexOf(name)
+                if (bit >= 0) mask or (1 shl bit) else mask
+            }
+
+        fun featureNames(mask: Int): List<String> =
+            FEATURE_NAMES.filterIndexed { bit, _ -> (mask and (1 shl bit)) != 0 }
+
+        // Input channel modes (values match ChannelMode in C++)
+        const val CHANNEL_MODE_MONO = 0
+        const val CHANNEL_MODE_STEREO = 1
+        const val CHANNEL_MODE_MIDSIDE = 2
+
+        private val CHANNEL_MODE_NAMES = arrayOf("mono", "stereo", "midside")
+
+        fun channelModeFromName(name: String?): Int =
+            CHANNEL_MODE_NAMES.indexOf(name).takeIf { it >= 0 } ?: CHANNEL_MODE_MONO
+
+        fun channelModeName(mode: Int): String =
+            CHANNEL_MODE_NAMES.getOrElse(mode) { CHANNEL_MODE_NAMES[CHANNEL_MODE_MONO] }
+
+        // Event spectrum formats (values match SpectrumFormat in C++)
+        const val SPECTRUM_FORMAT_FLOAT = 0
+        const val SPECTRUM_FORMAT_UINT8 = 1
+        const val SPECTRUM_FORMAT_UINT16 = 2
+
+        private val SPECTRUM_FORMAT_NAMES = arrayOf("float", "uint8", "uint16")
+
+        fun spectrumFormatFromName(name: String?): Int =
+            SPECTRUM_FORMAT_NAMES.indexOf(name).takeIf { it >= 0 } ?: SPECTRUM_FORMAT_FLOAT
+
+        fun spectrumFormatName(format: Int): String =
+            SPECTRUM_FORMAT_NAMES.getOrElse(format) { SPECTRUM_FORMAT_NAMES[SPECTRUM_FORMAT_FLOAT] }
+
+        // Output band layouts (values match BandLayout in C++)
+        const val BAND_LAYOUT_LINEAR = 0
+        const val BAND_LAYOUT_LOG = 1
+        const val BAND_LAYOUT_MEL = 2
+        const val BAND_LAYOUT_OCTAVE = 3
+
+        fun bandLayoutFromName(name: String?): Int = when (name) {
+            "log" -> BAND_LAYOUT_LOG
+            "mel" -> BAND_LAYOUT_MEL
+            "octave" -> BAND_LAYOUT_OCTAVE
+            else -> BAND_LAYOUT_LINEAR
+        }
+
+        // Pipeline stages (values match PerfStage in C++)
+        const val PERF_STAGE_READ = 0
+        const val PERF_STAGE_ANALYZE = 1
+        const val PERF_STAGE_FFT = 2
+        const val PERF_STAGE_FEATURES = 3
+        const val PERF_STAGE_PUBLISH = 4
+        const val PERF_STAGE_QUEUE = 5
+        const val PERF_STAGE_DELIVER = 6
+
+        // JS names, in PERF_STAGE_* order
+        val PERF_STAGE_NAMES = arrayOf(
+            "read", "analyze", "fft", "features", "publish", "queue", "deliver"
+        )
+
+        // getPerformanceStats() layout: PERF_HEADER_VALUES counters
+        // [elapsedMs, reads, rateLimited, overruns, queueDepth, maxQueueDepth,
+        // queueDropped], then per stage [count, meanUs, p50Us, p95Us, p99Us,
+        // maxUs] and PERF_HISTOGRAM_BUCKETS counts, bucket i holding
+        // [2^i, 2^(i+1)) us (bucket 0 from 0, the last open-ended)
+        const val PERF_HEADER_VALUES = 7
+        const val PERF_HISTOGRAM_BUCKETS = 16
+        const val PERF_STAGE_VALUES = 6 + PERF_HISTOGRAM_BUCKETS
+        // ... then PERF_THREAD_VALUES for the capture thread: [tuned,
+        // realtime, nice, pinned, cpu, coreClass, migrations] and the reads
+        // per core class, in CORE_CLASS_NAMES order
+        const val PERF_THREAD_VALUES = 7 + 4
+        const val PERF_THREAD_OFFSET = PERF_HEADER_VALUES + 7 * PERF_STAGE_VALUES
+        const val PERF_SNAPSHOT_SIZE = PERF_THREAD_OFFSET + PERF_THREAD_VALUES
+
+        // Capture thread core placement (values match CoreAffinity in C++)
+        const val AFFINITY_ANY = 0
+        const val AFFINITY_LITTLE = 1
+        const val AFFINITY_BIG = 2
+
+        private val AFFINITY_NAMES = arrayOf("any", "little", "big")
+
+        fun affinityFromName(name: String?): Int =
+            AFFINITY_NAMES.indexOf(name).takeIf { it >= 0 } ?: AFFINITY_ANY
+
+        fun affinityName(affinity: Int): String =
+            AFFINITY_NAMES.getOrElse(affinity) { AFFINITY_NAMES[AFFINITY_ANY] }
+
+        // Core classes (values match CoreClass in C++)
+        val CORE_CLASS_NAMES = arrayOf("unknown", "little", "mid", "big")
     }
 }
@@ -1,8 +1,11 @@
 package com.realtimeaudio
 
+import android.util.Base64
+import android.util.Log
 import com.facebook.react.bridge.Arguments
 import com.facebook.react.bridge.Promise
 import com.facebook.react.bridge.ReactApplicationContext
+import com.facebook.react.bridge.ReactMethod
 import com.facebook.react.bridge.ReadableMap
 import com.facebook.react.bridge.WritableMap
 import com.facebook.react.modules.core.DeviceEventManagerModule
@@ -21,20 +24,185 @@ class RealtimeAudioAnalyzerModule(
 
   companion object {
     const val NAME = "RealtimeAudioAnalyzer"
+
+    // Floats per frame slot: the largest spectrum (fftSize 16384 / 2)
+    const val FRAME_BUFFER_CAPACITY = 8192
+
+    // computeSpectrogram value encodings (SpectrogramFormat in cpp/spectrogram.h)
+    const val SPECTROGRAM_FORMAT_UINT8 = 0
+    const val SPECTROGRAM_FORMAT_FLOAT16 = 1
+
+    // installSpectrogramHistory() defaults and limits
+    const val HISTORY_DEFAULT_FRAMES = 512
+    const val HISTORY_MAX_FRAMES = 8192
+    const val HISTORY_DEFAULT_BINS = 2048
+
+    // Upper bound for the meter times; the RMS window is allocated natively
+    const val MAX_METER_MS = 10_000f
+
+    // Upper bound for the voice activity gate's attack and release times
+    const val MAX_VAD_MS = 10_000f
   }
 
-  private val engine = AudioEngine { data -> sendEvent(data) }
+  private val engine = AudioEngine(
+    onDataCallback = { data -> sendEvent(data) },
+    onVoiceActivity = { voice -> sendVoiceActivity(voice) }
+  )
+
+  // Native FrameStore backing the JS frame ArrayBuffer (0 = not installed)
+  private var frameStoreHandle = 0L
+
+  private external fun nativeInstallFrameBuffer(jsRuntime: Long, existing: Long, capacity: Int): Long
+  private external fun nativeReleaseFrameBuffer(handle: Long)
+
+  // Native SpectrogramHistory backing the JS history ArrayBuffer (0 = none)
+  private var historyHandle = 0L
+
+  private external fun nativeInstallSpectrogramHistory(
+    jsRuntime: Long, frames: Int, maxBins: Int, format: Int, minDb: Float, maxDb: Float
+  ): Long
+  private external fun nativeReleaseSpectrogramHistory(handle: Long)
+  // Blocking; meta receives [frames, bins, hopSize, sampleRate]
+  private external fun nativeComputeSpectrogram(
+    path: String, fftSize: Int, hopSize: Int, window: Int, backend: Int,
+    layout: Int, bands: Int, format: Int, minDb: Float, maxDb: Float,
+    threads: Int, meta: IntArray
+  ): ByteArray?
 
   override fun getName(): String = NAME
 
   override fun startAnalysis(config: ReadableMap, promise: Promise) {
     try {
-      val bufferSize = if (config.hasKey("fftSize")) config.getInt("fftSize") else 1024
+      val fftSize = if (config.hasKey("fftSize")) config.getInt("fftSize") else 1024
+      // Read size defaults to the FFT size; a smaller read with a hop gives
+      // an overlapping STFT at lower latency
+      val bufferSize = if (config.hasKey("bufferSize")) config.getInt("bufferSize") else fftSize
+      val hopSize = if (config.hasKey("hopSize")) config.getInt("hopSize") else 0
       val sampleRate = if (config.hasKey("sampleRate")) config.getInt("sampleRate") else 44100
-      val callbackRateHz = 30
-      val emitFft = true
+      val callbackRateHz =
+        if (config.hasKey("callbackRateHz")) config.getDouble("callbackRateHz").toInt() else 30
+      val emitFft = if (config.hasKey("emitFft")) config.getBoolean("emitFft") else true
+      if (callbackRateHz !in AudioEngine.MIN_CALLBACK_RATE_HZ..AudioEngine.MAX_CALLBACK_RATE_HZ) {
+        promise.reject(
+          "E_INVALID_CONFIG",
+          "callbackRateHz must be between ${AudioEngine.MIN_CALLBACK_RATE_HZ} and " +
+            "${AudioEngine.MAX_CALLBACK_RATE_HZ}, got: $callbackRateHz"
+        )
+        return
+      }
+      val fftBackend = AudioEngine.fftBackendFromName(
+        if (config.hasKey("fftBackend")) config.getString("fftBackend") else null
+      )
+      val windowType = AudioEngine.windowFromName(
+        if (config.hasKey("windowFunction")) config.getString("windowFunction") else null
+      )
+      // Per-frame scalars computed natively; with emitFft false they replace
+      // the spectrum on the bridge
+      val features = if (config.hasKey("features")) {
+        val names = config.getArray("features")
+        AudioEngine.featureMaskFromNames(
+          (0 until (names?.size() ?: 0)).map { names?.getString(it) }
+        )
+      } else 0
+      val channelMode = AudioEngine.channelModeFromName(
+        if (config.hasKey("channelMode")) config.getString("channelMode") else null
+      )
+
+      // 'jsi' needs installFrameBuffer() first; otherwise fall back to events
+      val wantsShared = config.hasKey("frameDelivery") && config.getString("frameDelivery") == "jsi"
+      if (wantsShared && frameStoreHandle == 0L) {
+        Log.w(NAME, "frameDelivery 'jsi' requested before installFrameBuffer(); using events")
+      }
+
+      // Read-size independent meters; each time falls back to its default
+      val meters = if (config.hasKey("meters") && config.getBoolean("meters")) {
+        fun ms(key: String, default: Float) =
+          if (config.hasKey(key)) config.getDouble(key).toFloat().coerceIn(0f, MAX_METER_MS) else default
+        val defaults = AudioEngine.MeterSettings()
+        AudioEngine.MeterSettings(
+          windowMs = ms("meterWindowMs", defaults.windowMs).coerceAtLeast(1f),
+          attackMs = ms("meterAttackMs", defaults.attackMs),
+          releaseMs = ms("meterReleaseMs", defaults.releaseMs),
+          holdMs = ms("peakHoldMs", defaults.holdMs)
+        )
+      } else null
+
+      // Voice activity gate; each setting falls back to its default
+      val voiceActivity = if (config.hasKey("voiceActivity") && config.getBoolean("voiceActivity")) {
+        fun value(key: String, default: Float) =
+          if (config.hasKey(key)) config.getDouble(key).toFloat() else default
+        val defaults = AudioEngine.VoiceActivitySettings()
+        AudioEngine.VoiceActivitySettings(
+          thresholdDb = value("vadThresholdDb", defaults.thresholdDb),
+          hysteresisDb = value("vadHysteresisDb", defaults.hysteresisDb).coerceAtLeast(0f),
+          noiseMarginDb = value("vadNoiseMarginDb", defaults.noiseMarginDb).coerceAtLeast(0f),
+          attackMs = value("vadAttackMs", defaults.attackMs).coerceIn(0f, MAX_VAD_MS),
+          releaseMs = value("vadReleaseMs", defaults.releaseMs).coerceIn(0f, MAX_VAD_MS),
+          silentRateHz = if (config.hasKey("vadSilentRateHz")) {
+            config.getInt("vadSilentRateHz").coerceIn(0, callbackRateHz)
+          } else defaults.silentRateHz
+        )
+      } else null
+
+      // Compact spectra: dB codes instead of float arrays in events
+      val spectrumFormat = AudioEngine.spectrumFormatFromName(
+        if (config.hasKey("spectrumFormat")) config.getString("spectrumFormat") else null
+      )
+      val spectrumEncoding = if (spectrumFormat != AudioEngine.SPECTRUM_FORMAT_FLOAT) {
+        val defaults = AudioEngine.SpectrumEncoding()
+        val encoding = AudioEngine.SpectrumEncoding(
+          format = spectrumFormat,
+          minDb = if (config.hasKey("spectrumMinDb")) config.getDouble("spectrumMinDb").toFloat() else defaults.minDb,
+          maxDb = if (config.hasKey("spectrumMaxDb")) config.getDouble("spectrumMaxDb").toFloat() else defaults.maxDb,
+          delta = config.hasKey("spectrumDelta") && config.getBoolean("spectrumDelta"),
+          keyframeInterval = if (config.hasKey("keyframeInterval")) {
+            config.getInt("keyframeInterval").coerceAtLeast(0)
+          } else defaults.keyframeInterval
+        )
+        if (!(encoding.maxDb > encoding.minDb)) {
+          promise.reject(
+            "E_INVALID_CONFIG",
+            "spectrumMaxDb must be above spectrumMinDb, got: ${encoding.minDb}..${encoding.maxDb}"
+          )
+          return
+        }
+        encoding
+      } else null
+
+      // Systrace sections around each pipeline stage
+      val traceStages = config.hasKey("traceStages") && config.getBoolean("traceStages")
+
+      // Core class the capture thread is pinned to ('any' leaves it free)
+      val cpuAffinity = AudioEngine.affinityFromName(
+        if (config.hasKey("cpuAffinity")) config.getString("cpuAffinity") else null
+      )
+
+      // 'aaudio' runs capture and analysis natively (API 26+)
+      val nativeCapture = config.hasKey("captureBackend") && config.getString("captureBackend") == "aaudio"
+
+      // Output bands: downsampleBins bands laid out per bandLayout
+      val bandLayout = AudioEngine.bandLayoutFromName(
+        if (config.hasKey("bandLayout")) config.getString("bandLayout") else null
+      )
+      if (config.hasKey("downsampleBins")) {
+        engine.setFftConfig(fftSize, config.getInt("downsampleBins"), hopSize, bandLayout)
+      }
 
-      engine.start(bufferSize, sampleRate, callbackRateHz, emitFft)
+      engine.start(
+        bufferSize, sampleRate, callbackRateHz, emitFft,
+        fftSize = fftSize, hopSize = hopSize, fftBackend = fftBackend,
+        sharedFrames = wantsShared && frameStoreHandle != 0L,
+        nativeCapture = nativeCapture,
+        bandLayout = bandLayout,
+        windowType = windowType,
+        features = features,
+        channelMode = channelMode,
+        traceStages = traceStages,
+        meters = meters,
+        spectrumEncoding = spectrumEncoding,
+        voiceActivity = voiceActivity,
+        cpuAffinity = cpuAffinity
+      )
       promise.resolve(null)
     } catch (e: SecurityException) {
       promise.reject("E_PERMISSION_DENIED", "Microphone permission denied: ${e.message}", e)
@@ -43,6 +211,82 @@ class RealtimeAudioAnalyzerModule(
     }
   }
 
+  /**
+   * Installs the shared frame ArrayBuffer into the JS runtime. Synchronous so
+   * it runs on the JS thread, which is required to touch the jsi::Runtime.
+   */
+  @ReactMethod(isBlockingSynchronousMethod = true)
+  override fun installFrameBuffer(): Boolean {
+    val jsRuntime = reactApplicationContext.javaScriptContextHolder?.get() ?: 0L
+    if (jsRuntime == 0L) return false
+    return try {
+      frameStoreHandle = nativeInstallFrameBuffer(jsRuntime, frameStoreHandle, FRAME_BUFFER_CAPACITY)
+      engine.setFrameStore(frameStoreHandle)
+      frameStoreHandle != 0L
+    } catch (e: UnsatisfiedLinkError) {
+      Log.e(NAME, "Native library not loaded, frame buffer unavailable", e)
+      false
+    }
+  }
+
+  /**
+   * Allocates the native spectrogram history and installs it into the JS
+   * runtime; sessions started afterwards record every delivered frame into
+   * it. Replaces a previous history, so it is refused while analysis runs.
+   */
+  @ReactMethod(isBlockingSynchronousMethod = true)
+  override fun installSpectrogramHistory(options: ReadableMap): Boolean {
+    if (engine.isRecording()) {
+      Log.w(NAME, "installSpectrogramHistory() must be called before startAnalysis()")
+      return false
+    }
+    val jsRuntime = reactApplicationContext.javaScriptContextHolder?.get() ?: 0L
+    if (jsRuntime == 0L) return false
+
+    val frames = if (options.hasKey("frames")) options.getInt("frames") else HISTORY_DEFAULT_FRAMES
+    val maxBins = if (options.hasKey("maxBins")) options.getInt("maxBins") else HISTORY_DEFAULT_BINS
+    val format = when (if (options.hasKey("format")) options.getString("format") else null) {
+      "float16" -> SPECTROGRAM_FORMAT_FLOAT16
+      else -> SPECTROGRAM_FORMAT_UINT8
+    }
+    val minDb = if (options.hasKey("minDb")) options.getDouble("minDb").toFloat() else -100f
+    val maxDb = if (options.hasKey("maxDb")) options.getDouble("maxDb").toFloat() else 0f
+    if (frames !in 1..HISTORY_MAX_FRAMES || maxBins !in 1..FRAME_BUFFER_CAPACITY || !(maxDb > minDb)) {
+      Log.w(NAME, "Invalid spectrogram history options: $frames frames, $maxBins bins, $minDb..$maxDb dB")
+      return false
+    }
+
+    return try {
+      val handle = nativeInstallSpectrogramHistory(jsRuntime, frames, maxBins, format, minDb, maxDb)
+      if (handle != 0L) {
+        engine.setSpectrogramHistory(handle)
+        if (historyHandle != 0L) nativeReleaseSpectrogramHistory(historyHandle)
+        historyHandle = handle
+      }
+      handle != 0L
+    } catch (e: UnsatisfiedLinkError) {
+      Log.e(NAME, "Native library not loaded, spectrogram history unavailable", e)
+      false
+    }
+  }
+
+  override fun invalidate() {
+    // Stop publishing before the store handle goes away; JS may still hold
+    // the ArrayBuffer, which keeps its own reference to the memory
+    engine.release()
+    engine.setFrameStore(0L)
+    engine.setSpectrogramHistory(0L)
+    if (frameStoreHandle != 0L) {
+      nativeReleaseFrameBuffer(frameStoreHandle)
+      frameStoreHandle = 0L
+    }
+    if (historyHandle != 0L) {
+      nativeReleaseSpectrogramHistory(historyHandle)
+      historyHandle = 0L
+    }
+    super.invalidate()
+  }
+
   override fun stopAnalysis(promise: Promise) {
     engine.stop()
     promise.resolve(null)
@@ -56,12 +300,73 @@ class RealtimeAudioAnalyzerModule(
     val config = Arguments.createMap().apply {
       putInt("fftSize", 1024)
       putInt("sampleRate", 44100)
-      putString("windowFunction", "hanning")
+      putString("windowFunction", engine.windowFunctionName())
+      putString("channelMode", engine.channelModeName())
+      putArray("features", Arguments.createArray().apply {
+        engine.featureNames().forEach { pushString(it) }
+      })
+      putString(
+        "spectrumFormat",
+        AudioEngine.spectrumFormatName(engine.spectrumEncoding()?.format ?: AudioEngine.SPECTRUM_FORMAT_FLOAT)
+      )
+      putBoolean("voiceActivity", engine.voiceActivitySettings() != null)
+      putString("cpuAffinity", engine.cpuAffinityName())
       putDouble("smoothing", 0.8)
     }
     promise.resolve(config)
   }
 
+  /**
+   * Stage timing histograms and pipeline counters of the current (or last)
+   * session; see PerformanceStats in NativeRealtimeAudioAnalyzer.ts.
+   */
+  override fun getPerformanceStats(promise: Promise) {
+    val values = DoubleArray(AudioEngine.PERF_SNAPSHOT_SIZE)
+    if (!engine.getPerformanceStats(values)) {
+      promise.reject("E_UNAVAILABLE", "Native library not loaded")
+      return
+    }
+    val stages = Arguments.createMap()
+    AudioEngine.PERF_STAGE_NAMES.forEachIndexed { stage, name ->
+      val base = AudioEngine.PERF_HEADER_VALUES + stage * AudioEngine.PERF_STAGE_VALUES
+      stages.putMap(name, Arguments.createMap().apply {
+        putDouble("count", values[base])
+        putDouble("meanUs", values[base + 1])
+        putDouble("p50Us", values[base + 2])
+        putDouble("p95Us", values[base + 3])
+        putDouble("p99Us", values[base + 4])
+        putDouble("maxUs", values[base + 5])
+        putArray("histogram", Arguments.createArray().apply {
+          for (b in 0 until AudioEngine.PERF_HISTOGRAM_BUCKETS) pushDouble(values[base + 6 + b])
+        })
+      })
+    }
+    promise.resolve(Arguments.createMap().apply {
+      putDouble("elapsedMs", values[0])
+      putDouble("reads", values[1])
+      putDouble("rateLimitedFrames", values[2])
+      putDouble("readOverruns", values[3])
+      putDouble("queueDepth", values[4])
+      putDouble("maxQueueDepth", values[5])
+      putDouble("queueDroppedFrames", values[6])
+      putMap("stages", stages)
+      val t = AudioEngine.PERF_THREAD_OFFSET
+      if (values[t] != 0.0) {
+        putMap("thread", Arguments.createMap().apply {
+          putBoolean("realtime", values[t + 1] != 0.0)
+          putInt("nice", values[t + 2].toInt())
+          putBoolean("pinned", values[t + 3] != 0.0)
+          putInt("cpu", values[t + 4].toInt())
+          putString("coreClass", AudioEngine.CORE_CLASS_NAMES.getOrElse(values[t + 5].toInt()) { "unknown" })
+          putDouble("migrations", values[t + 6])
+          putMap("coreReads", Arguments.createMap().apply {
+            AudioEngine.CORE_CLASS_NAMES.forEachIndexed { c, name -> putDouble(name, values[t + 7 + c]) }
+          })
+        })
+      }
+    })
+  }
+
   // Legacy aliases (if in your TS Spec)
   override fun start(options: ReadableMap, promise: Promise) =
     startAnalysis(options, promise)
@@ -82,12 +387,121 @@ class RealtimeAudioAnalyzerModule(
     promise.resolve(null)
   }
 
+  /**
+   * Adds (or replaces) subscriber `id`, served from the session's shared
+   * FFT with its own bands, rate and products. Resolves false when
+   * AudioEngine.MAX_SUBSCRIBERS others exist.
+   */
+  override fun addAnalysisSubscriber(id: Double, options: ReadableMap, promise: Promise) {
+    val rateHz =
+      if (options.hasKey("callbackRateHz")) options.getDouble("callbackRateHz").toInt() else 30
+    if (rateHz !in AudioEngine.MIN_CALLBACK_RATE_HZ..AudioEngine.MAX_CALLBACK_RATE_HZ) {
+      promise.reject(
+        "E_INVALID_CONFIG",
+        "callbackRateHz must be between ${AudioEngine.MIN_CALLBACK_RATE_HZ} and " +
+          "${AudioEngine.MAX_CALLBACK_RATE_HZ}, got: $rateHz"
+      )
+      return
+    }
+    val features = if (options.hasKey("features")) {
+      val names = options.getArray("features")
+      AudioEngine.featureMaskFromNames(
+        (0 until (names?.size() ?: 0)).map { names?.getString(it) }
+      )
+    } else 0
+    val subscription = AudioEngine.Subscription(
+      rateHz = rateHz,
+      spectrum = !options.hasKey("emitFft") || options.getBoolean("emitFft"),
+      bands = if (options.hasKey("downsampleBins")) options.getInt("downsampleBins") else 0,
+      layout = AudioEngine.bandLayoutFromName(
+        if (options.hasKey("bandLayout")) options.getString("bandLayout") else null
+      ),
+      features = features,
+      meters = options.hasKey("meters") && options.getBoolean("meters")
+    )
+    promise.resolve(engine.addSubscriber(id.toInt(), subscription))
+  }
+
+  override fun removeAnalysisSubscriber(id: Double, promise: Promise) {
+    promise.resolve(engine.removeSubscriber(id.toInt()))
+  }
+
+  /**
+   * Computes the spectrogram of a WAV file in one native call, on a worker
+   * thread of its own so neither the JS thread nor capture is blocked. The
+   * matrix is returned base64-encoded rather than as events.
+   */
+  override fun computeSpectrogram(path: String, options: ReadableMap, promise: Promise) {
+    val file = path.removePrefix("file://")
+    val fftSize = if (options.hasKey("fftSize")) options.getInt("fftSize") else 1024
+    val hopSize = if (options.hasKey("hopSize")) options.getInt("hopSize") else fftSize / 2
+    val bands = if (options.hasKey("downsampleBins")) options.getInt("downsampleBins") else 0
+    val format = when (if (options.hasKey("format")) options.getString("format") else null) {
+      "float16" -> SPECTROGRAM_FORMAT_FLOAT16
+      else -> SPECTROGRAM_FORMAT_UINT8
+    }
+    val minDb = if (options.hasKey("minDb")) options.getDouble("minDb") else -100.0
+    val maxDb = if (options.hasKey("maxDb")) options.getDouble("maxDb") else 0.0
+    val threads = if (options.hasKey("threads")) options.getInt("threads") else 0
+    val window = AudioEngine.windowFromName(
+      if (options.hasKey("windowFunction")) options.getString("windowFunction") else null
+    )
+    val backend = AudioEngine.fftBackendFromName(
+      if (options.hasKey("fftBackend")) options.getString("fftBackend") else null
+    )
+    val layout = AudioEngine.bandLayoutFromName(
+      if (options.hasKey("bandLayout")) options.getString("bandLayout") else null
+    )
+
+    Thread({
+      try {
+        val meta = IntArray(4)
+        val data = nativeComputeSpectrogram(
+          file, fftSize, hopSize, window, backend, layout, bands, format,
+          minDb.toFloat(), maxDb.toFloat(), threads, meta
+        ) ?: throw IllegalStateException("Spectrogram computation failed")
+        promise.resolve(Arguments.createMap().apply {
+          putInt("frames", meta[0])
+          putInt("bins", meta[1])
+          putInt("hopSize", meta[2])
+          putInt("sampleRate", meta[3])
+          putInt("fftSize", fftSize)
+          putString("format", if (format == SPECTROGRAM_FORMAT_FLOAT16) "float16" else "uint8")
+          putDouble("minDb", minDb)
+          putDouble("maxDb", maxDb)
+          putString("data", Base64.encodeToString(data, Base64.NO_WRAP))
+        })
+      } catch (e: java.io.IOException) {
+        promise.reject("E_FILE_READ_FAILED", e.message ?: "Could not read $file", e)
+      } catch (e: Throwable) {
+        promise.reject("E_SPECTROGRAM_FAILED", e.message ?: "Unknown error occurred", e)
+      }
+    }, "RealtimeAudioSpectrogram").start()
+  }
+
   override fun addListener(eventName: String) { /* required by RN */ }
   override fun removeListeners(count: Double) { /* required by RN */ }
 
   private fun sendEvent(data: AudioEngine.AudioData) {
     // Use the supported API; hasActiveCatalystInstance is deprecated
     if (!reactApplicationContext.hasActiveReactInstance()) return
+    if (data.subscriber >= 0) {
+      sendSubscriberEvent(data)
+      return
+    }
+
+    val encoding = engine.spectrumEncoding()
+    // {format, bins, minDb, maxDb, data}; decoded by SpectrumDecoder in JS
+    fun spectrumMap(
+      encoding: AudioEngine.SpectrumEncoding, encoded: AudioEngine.EncodedSpectrum, bins: Int
+    ): WritableMap =
+      Arguments.createMap().apply {
+        putString("format", AudioEngine.spectrumFormatName(encoding.format))
+        putInt("bins", bins)
+        putDouble("minDb", encoding.minDb.toDouble())
+        putDouble("maxDb", encoding.maxDb.toDouble())
+        putString("data", Base64.encodeToString(encoded.bytes, 0, encoded.size, Base64.NO_WRAP))
+      }
 
     fun params(): WritableMap =
       Arguments.createMap().apply {
@@ -95,16 +509,112 @@ class RealtimeAudioAnalyzerModule(
         putDouble("volume", data.rms)
         putDouble("peak", data.peak)
         putInt("sampleRate", data.sampleRate)
-        putInt("fftSize", data.bufferSize)
+        putInt("fftSize", data.fftSize)
+        putInt("bufferSize", data.bufferSize)
+        putDouble("droppedFrames", data.droppedFrames.toDouble())
 
         val freq = Arguments.createArray()
-        data.fft?.forEach { freq.pushDouble(it.toDouble()) }
+        if (encoding == null) {
+          for (i in 0 until data.bins) freq.pushDouble(data.fft[i].toDouble())
+        } else if (data.encoded.size > 0) {
+          putMap("spectrum", spectrumMap(encoding, data.encoded, data.bins))
+        }
         putArray("frequencyData", freq)
         putArray("timeData", Arguments.createArray())
+
+        if (data.features.mask != 0) putMap("features", featuresMap(data.features))
+        if (data.meters.enabled) putMap("meters", metersMap(data.meters))
+
+        val v = data.voice
+        if (v.enabled) {
+          putMap("voiceActivity", voiceActivityMap(v))
+        }
+
+        if (data.channelCount > 0) {
+          putArray("channels", Arguments.createArray().apply {
+            for (c in 0 until data.channelCount) {
+              val channel = data.channels[c]
+              pushMap(Arguments.createMap().apply {
+                putDouble("volume", channel.rms)
+                putDouble("peak", channel.peak)
+                val bins = Arguments.createArray()
+                if (encoding == null) {
+                  for (i in 0 until channel.bins) bins.pushDouble(channel.fft[i].toDouble())
+                } else if (channel.encoded.size > 0) {
+                  putMap("spectrum", spectrumMap(encoding, channel.encoded, channel.bins))
+                }
+                putArray("frequencyData", bins)
+              })
+            }
+          })
+        }
       }
 
     reactApplicationContext
       .getJSModule(DeviceEventManagerModule.RCTDeviceEventEmitter::class.java)
       .emit("RealtimeAudioAnalyzer:onData", params())
   }
-}
\ No newline at end of file
+
+  // Subscriber frames: float spectra in the subscriber's bands, levels and
+  // its features and meters; the rest stays with onData
+  private fun sendSubscriberEvent(data: AudioEngine.AudioData) {
+    val params = Arguments.createMap().apply {
+      putInt("subscriberId", data.subscriber)
+      putDouble("timestamp", data.timestamp)
+      putDouble("volume", data.rms)
+      putDouble("peak", data.peak)
+      putInt("sampleRate", data.sampleRate)
+      putInt("fftSize", data.fftSize)
+      putInt("bufferSize", data.bufferSize)
+      putDouble("droppedFrames", data.droppedFrames.toDouble())
+      putArray("frequencyData", Arguments.createArray().apply {
+        for (i in 0 until data.bins) pushDouble(data.fft[i].toDouble())
+      })
+      if (data.features.mask != 0) putMap("features", featuresMap(data.features))
+      if (data.meters.enabled) putMap("meters", metersMap(data.meters))
+    }
+    reactApplicationContext
+      .getJSModule(DeviceEventManagerModule.RCTDeviceEventEmitter::class.java)
+      .emit("RealtimeAudioAnalyzer:onSubscriberData", params)
+  }
+
+  // The features in the frame's mask
+  private fun featuresMap(f: AudioEngine.SpectralFeatures): WritableMap =
+    Arguments.createMap().apply {
+      if ((f.mask and AudioEngine.FEATURE_CENTROID) != 0) putDouble("centroid", f.centroid)
+      if ((f.mask and AudioEngine.FEATURE_FLUX) != 0) putDouble("flux", f.flux)
+      if ((f.mask and AudioEngine.FEATURE_ROLLOFF) != 0) putDouble("rolloff", f.rolloff)
+      if ((f.mask and AudioEngine.FEATURE_FLATNESS) != 0) putDouble("flatness", f.flatness)
+      if ((f.mask and AudioEngine.FEATURE_ONSET) != 0) putBoolean("onset", f.onset)
+      if ((f.mask and AudioEngine.FEATURE_PITCH) != 0) {
+        putDouble("pitch", f.pitch)
+        putDouble("pitchConfidence", f.pitchConfidence)
+      }
+    }
+
+  private fun metersMap(m: AudioEngine.LevelMeters): WritableMap =
+    Arguments.createMap().apply {
+      putDouble("rms", m.rms)
+      putDouble("peak", m.peak)
+      putDouble("peakHold", m.peakHold)
+      putDouble("momentaryLufs", m.momentaryLufs)
+      putDouble("shortTermLufs", m.shortTermLufs)
+    }
+
+  // {active, levelDb, noiseFloorDb}, also the body of onVoiceActivity events
+  private fun voiceActivityMap(voice: AudioEngine.VoiceActivity): WritableMap =
+    Arguments.createMap().apply {
+      putBoolean("active", voice.active)
+      putDouble("levelDb", voice.levelDb)
+      putDouble("noiseFloorDb", voice.noiseFloorDb)
+    }
+
+  private fun sendVoiceActivity(voice: AudioEngine.VoiceActivity) {
+    if (!reactApplicationContext.hasActiveReactInstance()) return
+
+    val params = voiceActivityMap(voice).apply { putDouble("timestamp", voice.timestamp) }
+    reactApplicationContext
+      .getJSModule(DeviceEventManagerModule.RCTDeviceEventEmitter::class.java)
+      .emit("RealtimeAudioAnalyzer:onVoiceActivity", params)
+  }
+}
@@ -0,0 +1,45 @@
+#include "accelerate_fft.h"
+
+#if defined(__APPLE__)
+
+namespace realtimeaudio {
+
+bool AccelerateFft::supports(int nfft) {
+  return nfft >= 16 && (nfft & (nfft - 1)) == 0;
+}
+
+AccelerateFft::AccelerateFft(int nfft) : nfft_(nfft) {
+  if (!supports(nfft))
+    return;
+  while ((1 << log2n_) < nfft)
+    ++log2n_;
+  setup_ = vDSP_create_fftsetup(log2n_, kFFTRadix2);
+}
+
+AccelerateFft::~AccelerateFft() {
+  if (setup_)
+    vDSP_destroy_fftsetup(setup_);
+}
+
+void AccelerateFft::forward(const float *input, float *re, float *im) {
+  const vDSP_Length half = (vDSP_Length)(nfft_ / 2);
+
+  // Even samples -> re, odd -> im, then transform in place
+  DSPSplitComplex split = {re, im};
+  vDSP_ctoz(reinterpret_cast<const DSPComplex *>(input), 2, &split, 1, half);
+  vDSP_fft_zrip(setup_, &split, 1, log2n_, kFFTDirection_Forward);
+
+  // zrip output is 2x the DFT sums
+  const float scale = 0.5f;
+  vDSP_vsmul(re, 1, &scale, re, 1, half);
+  vDSP_vsmul(im, 1, &scale, im, 1, half);
+
+  // imagp[0] holds the Nyquist term; bin 0 is the (real) DC term
+  re[half] = im[0];
+  im[half] = 0.0f;
+  im[0] = 0.0f;
+}
+
+} // namespace realtimeaudio
+
+#endif // __APPLE__
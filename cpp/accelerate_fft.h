@@ -0,0 +1,43 @@
+#ifndef REALTIMEAUDIO_ACCELERATE_FFT_H
+#define REALTIMEAUDIO_ACCELERATE_FFT_H
+
+#if defined(__APPLE__)
+
+#include "fft_backend.h"
+#include <Accelerate/Accelerate.h>
+
+namespace realtimeaudio {
+
+// vDSP real FFT (vDSP_fft_zrip) for power-of-two sizes, the Auto choice on
+// Apple platforms. vDSP packs the input as N/2 complex points and returns
+// twice the DFT with the Nyquist term in imagp[0]; forward() rescales and
+// unpacks that into the common FftBackend layout, so frames match the other
+// backends.
+class AccelerateFft : public FftBackend {
+public:
+  explicit AccelerateFft(int nfft);
+  ~AccelerateFft() override;
+
+  AccelerateFft(const AccelerateFft &) = delete;
+  AccelerateFft &operator=(const AccelerateFft &) = delete;
+
+  static bool supports(int nfft);
+  bool isValid() const { return setup_ != nullptr; }
+
+  int size() const override { return nfft_; }
+  FftBackendType type() const override { return FftBackendType::Accelerate; }
+  const char *name() const override { return "accelerate"; }
+
+  void forward(const float *input, float *re, float *im) override;
+
+private:
+  int nfft_;
+  vDSP_Length log2n_ = 0;
+  FFTSetup setup_ = nullptr;
+};
+
+} // namespace realtimeaudio
+
+#endif // __APPLE__
+
+#endif // REALTIMEAUDIO_ACCELERATE_FFT_H
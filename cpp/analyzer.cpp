@@ -0,0 +1,571 @@
+#include "analyzer.h"
+#include "fixed_fft.h"
+#include "simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace realtimeaudio {
+
+ChannelMode channelModeFromInt(int value) {
+  switch (value) {
+  case (int)ChannelMode::Stereo:
+    return ChannelMode::Stereo;
+  case (int)ChannelMode::MidSide:
+    return ChannelMode::MidSide;
+  default:
+    return ChannelMode::Mono;
+  }
+}
+
+Analyzer::Analyzer(int nfft, FftBackendType backend, WindowType window,
+                   ChannelMode channels)
+    : backend_type_(backend), window_type_(window), channel_mode_(channels) {
+  configure(nfft);
+}
+
+Analyzer::~Analyzer() {
+  release();
+  delete prepared_.exchange(nullptr);
+  delete retired_.exchange(nullptr);
+}
+
+void Analyzer::release() {
+  fft_.reset();
+  fixed_ = nullptr;
+  window_.reset();
+  nfft_ = 0;
+}
+
+std::unique_ptr<Analyzer::Plan>
+Analyzer::buildPlan(int nfft, FftBackendType backend, WindowType window,
+                    ChannelMode mode) {
+  std::unique_ptr<Plan> plan(new (std::nothrow) Plan());
+  if (plan == nullptr)
+    return nullptr;
+  plan->fft = createFftBackend(backend, nfft);
+  plan->window = windowTable(window, nfft);
+  if (plan->fft == nullptr || plan->window == nullptr) {
+    // FFT allocation failed (e.g. odd size)
+    return nullptr;
+  }
+  plan->nfft = nfft;
+  plan->mode = mode;
+  plan->in.resize(nfft);
+  plan->re.resize(nfft / 2 + 1); // Real FFT output size
+  plan->im.resize(nfft / 2 + 1);
+  plan->ring.reset(nfft);
+  if (plan->fft->asFixedPoint() != nullptr)
+    plan->pcm_ring.reset(nfft);
+  if (mode != ChannelMode::Mono) {
+    plan->ring1.reset(nfft);
+    plan->re1.resize(nfft / 2 + 1);
+    plan->im1.resize(nfft / 2 + 1);
+    plan->channel_out.resize((size_t)kMaxChannels * (nfft / 2));
+  }
+  return plan;
+}
+
+void Analyzer::install(Plan &plan) {
+  std::swap(fft_, plan.fft);
+  std::swap(window_, plan.window);
+  std::swap(fft_in_, plan.in);
+  std::swap(fft_re_, plan.re);
+  std::swap(fft_im_, plan.im);
+  std::swap(ring_, plan.ring);
+  std::swap(pcm_ring_, plan.pcm_ring);
+  std::swap(ring1_, plan.ring1);
+  std::swap(fft_re1_, plan.re1);
+  std::swap(fft_im1_, plan.im1);
+  std::swap(channel_out_, plan.channel_out);
+  std::swap(mapper_, plan.mapper);
+  std::swap(pitch_, plan.pitch);
+  std::swap(mode_, plan.mode);
+  std::swap(nfft_, plan.nfft);
+  fixed_ = fft_ ? fft_->asFixedPoint() : nullptr;
+  pending_ = 0;
+  channel_bins_ = 0;
+}
+
+std::unique_ptr<Analyzer::Plan> Analyzer::takePrepared(int nfft) {
+  std::unique_ptr<Plan> plan(prepared_.exchange(nullptr));
+  if (plan != nullptr &&
+      (plan->nfft != nfft ||
+       (pitch_enabled_.load() && plan->pitch.fft == nullptr))) {
+    // Stale (built for another size, or before pitch was enabled)
+    retire(std::move(plan));
+  }
+  return plan;
+}
+
+void Analyzer::prepareBands(Plan &plan) const {
+  const int bands = bands_.load();
+  if (bands > 0)
+    plan.mapper.configure(band_layout_.load(), plan.nfft / 2, bands, plan.nfft,
+                          band_sample_rate_.load());
+}
+
+void Analyzer::retire(std::unique_ptr<Plan> plan) {
+  // Hand the memory back so a control thread frees it. If the slot is
+  // still occupied the older plan is freed here (rare).
+  delete retired_.exchange(plan.release());
+}
+
+bool Analyzer::preparePlan(int nfft) {
+  delete retired_.exchange(nullptr);
+  if (nfft <= 0)
+    return false;
+  std::unique_ptr<Plan> plan = buildPlan(
+      nfft, backend_type_, window_type_, channel_mode_);
+  if (plan == nullptr)
+    return false;
+  // Rebuilding the band table is the other allocation a resize needs; if
+  // the settings change before the swap, mapBands() rebuilds it
+  prepareBands(*plan);
+  if (pitch_enabled_.load() && !buildPitch(plan->pitch, nfft))
+    return false;
+  delete prepared_.exchange(plan.release());
+  return true;
+}
+
+bool Analyzer::configure(int nfft) {
+  if (nfft <= 0)
+    return false;
+  if (fft_ != nullptr && nfft_ == nfft)
+    return true;
+
+  std::unique_ptr<Plan> plan = takePrepared(nfft);
+  if (plan == nullptr) {
+    // Nothing prepared: build it here
+    plan = buildPlan(nfft, backend_type_, window_type_,
+                     channel_mode_);
+    if (plan == nullptr) {
+      release();
+      return false;
+    }
+    // Without it pitch reads 0 until the next plan
+    if (pitch_enabled_.load())
+      buildPitch(plan->pitch, nfft);
+  }
+  install(*plan);
+  retire(std::move(plan));
+  return true;
+}
+
+bool Analyzer::buildPitch(PitchPlan &pitch, int nfft) {
+  // Float transform whatever the frame's backend
+  pitch.fft = createFftBackend(FftBackendType::Auto, 2 * nfft);
+  if (pitch.fft == nullptr)
+    return false;
+  pitch.padded.assign(2 * (size_t)nfft, 0.0f);
+  pitch.re.assign((size_t)nfft + 1, 0.0f);
+  pitch.im.assign((size_t)nfft + 1, 0.0f);
+  return true;
+}
+
+void Analyzer::setHopSize(int hopSize) { hop_ = std::max(hopSize, 0); }
+
+namespace {
+
+// Sample-type dispatch for the shared ingest path
+inline void analyze(const int16_t *pcm, int count, float *frame,
+                    FrameStats *stats) {
+  convertPcm16(pcm, count, frame, nullptr, nullptr, 0, stats);
+}
+
+inline void analyze(const float *samples, int count, float *frame,
+                    FrameStats *stats) {
+  analyzeFloat(samples, count, frame, stats);
+}
+
+inline void analyze(const int16_t *pcm, int count, int16_t *frame,
+                    FrameStats *stats) {
+  analyzePcm16(pcm, count, frame, stats);
+}
+
+// Stereo sources for ingestStereo(), split from frame `offset` on
+struct StereoPlanes {
+  const float *left;
+  const float *right;
+};
+
+inline void split(const int16_t *pcm, int offset, int frames, bool midSide,
+                  float *a, float *b, FrameStats *levels, FrameStats *mix) {
+  splitStereoPcm16(pcm + 2 * offset, frames, midSide, a, b, levels, mix);
+}
+
+inline void split(const float *samples, int offset, int frames, bool midSide,
+                  float *a, float *b, FrameStats *levels, FrameStats *mix) {
+  splitStereoFloat(samples + 2 * offset, frames, midSide, a, b, levels, mix);
+}
+
+inline void split(const StereoPlanes &planes, int offset, int frames,
+                  bool midSide, float *a, float *b, FrameStats *levels,
+                  FrameStats *mix) {
+  splitStereoPlanar(planes.left + offset, planes.right + offset, frames,
+                    midSide, a, b, levels, mix);
+}
+
+inline void meter(LevelMeter &m, const StereoPlanes &planes, int frames) {
+  m.processPlanar(planes.left, planes.right, frames);
+}
+
+} // namespace
+
+template <typename Sample, typename Ring>
+void Analyzer::ingest(Ring &ring, const Sample *samples, int count,
+                      FrameStats *stats) {
+  const int capacity = ring.capacity();
+  if (count > capacity) {
+    // Only the newest `capacity` samples are kept, but stats cover the read
+    analyze(samples, count, (typename Ring::value_type *)nullptr, stats);
+    samples += count - capacity;
+    count = capacity;
+    stats = nullptr;
+  }
+  analyze(samples, count, ring.writeSpan(count), stats);
+  ring.commit(count);
+  pending_ = std::min(pending_ + count, std::max(hop_, capacity));
+}
+
+template <typename Input>
+void Analyzer::ingestStereo(const Input &input, int frames,
+                            FrameStats *stats) {
+  // Mono keeps only the downmix, which is the mid channel
+  const bool mono = mode_ == ChannelMode::Mono;
+  const bool midSide = mono || mode_ == ChannelMode::MidSide;
+  const int capacity = ring_.capacity();
+  FrameStats *levels = channel_levels_;
+  int offset = 0;
+  if (frames > capacity) {
+    split(input, 0, frames, midSide, nullptr, nullptr, levels, stats);
+    offset = frames - capacity;
+    frames = capacity;
+    levels = nullptr;
+    stats = nullptr;
+  }
+  split(input, offset, frames, midSide, ring_.writeSpan(frames),
+        mono ? nullptr : ring1_.writeSpan(frames), levels, stats);
+  ring_.commit(frames);
+  if (!mono)
+    ring1_.commit(frames);
+  pending_ = std::min(pending_ + frames, std::max(hop_, capacity));
+}
+
+int Analyzer::transform(float *output, int maxBins) {
+  // Perform FFT on the already windowed input
+  fft_->forward(fft_in_.data(), fft_re_.data(), fft_im_.data());
+  return spectrumMagnitudes(output, maxBins);
+}
+
+int Analyzer::spectrumMagnitudes(const float *re, const float *im,
+                                 float *output, int maxBins) const {
+  // Compute Magnitude (and normalize)
+  // We only output the first nfft/2 bins (Nyquist excluded).
+  // Backends are unnormalized (forward transform sums), so divide by N/2,
+  // and by the window's coherent gain so levels do not depend on the window.
+  int bins = std::min(maxBins, nfft_ / 2);
+  float scale = 1.0f / ((float)(nfft_ / 2) * window_->coherentGain);
+  complexMagnitudes(re, im, bins, scale, output);
+  return bins;
+}
+
+int Analyzer::transformStereo(float *output, int maxBins) {
+  const int half = nfft_ / 2;
+  float *left = channel_out_.data();
+  float *right = left + half;
+
+  // Channel 1 first: the downmix is built in channel 0's spectrum
+  applyWindow(ring1_.latest(nfft_), window_->values.data(), fft_in_.data(),
+              nfft_);
+  fft_->forward(fft_in_.data(), fft_re1_.data(), fft_im1_.data());
+  applyWindow(ring_.latest(nfft_), window_->values.data(), fft_in_.data(),
+              nfft_);
+  fft_->forward(fft_in_.data(), fft_re_.data(), fft_im_.data());
+
+  const int bins = spectrumMagnitudes(left, maxBins);
+  spectrumMagnitudes(fft_re1_.data(), fft_im1_.data(), right, bins);
+  channel_bins_ = bins;
+
+  if (mode_ == ChannelMode::MidSide) {
+    // Channel 0 already is the downmix
+    std::copy(left, left + bins, output);
+    return bins;
+  }
+
+  // The transform is linear, so the downmix spectrum is the mean of the
+  // channel spectra (Nyquist included, which pitch detection reads)
+  using namespace simd;
+  float *re = fft_re_.data();
+  float *im = fft_im_.data();
+  const float *re1 = fft_re1_.data();
+  const float *im1 = fft_im1_.data();
+  const v4f vhalf = splat(0.5f);
+  int i = 0;
+  for (; i + kWidth <= half + 1; i += kWidth) {
+    store(re + i, mul(add(load(re + i), load(re1 + i)), vhalf));
+    store(im + i, mul(add(load(im + i), load(im1 + i)), vhalf));
+  }
+  for (; i <= half; ++i) {
+    re[i] = (re[i] + re1[i]) * 0.5f;
+    im[i] = (im[i] + im1[i]) * 0.5f;
+  }
+  return spectrumMagnitudes(output, maxBins);
+}
+
+const float *Analyzer::channelSpectrum(int channel) const {
+  if (mode_ == ChannelMode::Mono || channel < 0 || channel >= kMaxChannels ||
+      channel_out_.empty())
+    return nullptr;
+  return channel_out_.data() + (size_t)channel * (nfft_ / 2);
+}
+
+int Analyzer::computeMagnitudes(const float *input, float *output,
+                                int maxBins) {
+  if (fft_ == nullptr)
+    return 0;
+
+  applyWindow(input, window_->values.data(), fft_in_.data(), nfft_);
+  return transform(output, maxBins);
+}
+
+template <typename Sample>
+int Analyzer::process(const Sample *samples, int count, int nfft,
+                      float *magnitudes, int maxBins, FrameStats *stats) {
+  PerfScope scope(perf_, PerfStage::Analyze);
+  // Every sample, before the history can drop any of an oversized read
+  meter_.process(samples, count / inputChannels(), inputChannels());
+  if (nfft <= 0 || !configure(nfft)) {
+    if (channelMode() != ChannelMode::Mono)
+      split(samples, 0, count / kMaxChannels, true, nullptr, nullptr,
+            channel_levels_, stats);
+    else
+      analyze(samples, count, (float *)nullptr, stats);
+    return 0;
+  }
+
+  // Always ingest so the history stays continuous between frames. Mono
+  // PCM16 stays integer up to the transform on fixed-point backends.
+  bool fixed = false;
+  if constexpr (std::is_same<Sample, int16_t>::value) {
+    fixed = fixed_ != nullptr && mode_ == ChannelMode::Mono;
+    if (fixed)
+      ingest(pcm_ring_, samples, count, stats);
+  }
+  if (!fixed) {
+    if (mode_ != ChannelMode::Mono)
+      ingestStereo(samples, count / kMaxChannels, stats);
+    else
+      ingest(ring_, samples, count, stats);
+  }
+  vad_.update(stats ? stats->rms : 0.0f, count / inputChannels());
+  return takeFrame(magnitudes, maxBins, fixed);
+}
+
+template <typename Input>
+int Analyzer::processStereo(const Input &input, int frames, int nfft,
+                            float *magnitudes, int maxBins,
+                            FrameStats *stats) {
+  PerfScope scope(perf_, PerfStage::Analyze);
+  meter(meter_, input, std::max(frames, 0));
+  if (nfft <= 0 || !configure(nfft)) {
+    split(input, 0, std::max(frames, 0), true, nullptr, nullptr,
+          channel_levels_, stats);
+    return 0;
+  }
+  ingestStereo(input, std::max(frames, 0), stats);
+  vad_.update(stats ? stats->rms : 0.0f, frames);
+  return takeFrame(magnitudes, maxBins, false);
+}
+
+int Analyzer::takeFrame(float *magnitudes, int maxBins, bool fixed) {
+  frame_features_.onset = false;
+  // A closed gate leaves the due frame pending for when it opens
+  if (magnitudes == nullptr || !frameDue() || gated())
+    return 0;
+
+  pending_ = 0;
+  const bool pitch =
+      (feature_mask_ & kFeaturePitch) != 0 && pitch_.fft != nullptr;
+  if (pitch && pitch_detector_.needsWindow(*window_)) {
+    // Once per plan or window change
+    pitch_detector_.prepareWindow(*window_, *pitch_.fft, pitch_.padded.data(),
+                                  pitch_.re.data(), pitch_.im.data());
+  }
+  const int64_t fftStart = perf_ ? perf_->begin(PerfStage::Fft) : 0;
+  int bins = 0;
+  if (fixed) {
+    fixed_->forwardPcm16(pcm_ring_.latest(nfft_), window_->valuesQ15.data(),
+                         fft_re_.data(), fft_im_.data());
+    bins = spectrumMagnitudes(magnitudes, maxBins);
+  } else if (mode_ != ChannelMode::Mono) {
+    bins = transformStereo(magnitudes, maxBins);
+  } else {
+    applyWindow(ring_.latest(nfft_), window_->values.data(), fft_in_.data(),
+                nfft_);
+    bins = transform(magnitudes, maxBins);
+  }
+  if (perf_ != nullptr)
+    perf_->end(PerfStage::Fft, fftStart);
+  if (feature_mask_ != 0) {
+    PerfScope scope(perf_, PerfStage::Features);
+    features_.compute(magnitudes, bins, nfft_, &frame_features_);
+    if (pitch) {
+      pitchFrame(fixed);
+      pitch_detector_.detect(*pitch_.fft, pitch_.padded.data(),
+                             pitch_.re.data(), pitch_.im.data(),
+                             &frame_features_.pitch,
+                             &frame_features_.pitchConfidence);
+    }
+  }
+  return bins;
+}
+
+void Analyzer::pitchFrame(bool fixed) {
+  float *out = pitch_.padded.data();
+  const float *window = window_->values.data();
+  if (fixed) {
+    const int16_t *pcm = pcm_ring_.latest(nfft_);
+    for (int i = 0; i < nfft_; ++i)
+      out[i] = (float)pcm[i] * (1.0f / 32768.0f) * window[i];
+  } else if (mode_ == ChannelMode::Stereo) {
+    // fft_in_ holds channel 0 only; the downmix is the channels' mean
+    const float *left = ring_.latest(nfft_);
+    const float *right = ring1_.latest(nfft_);
+    for (int i = 0; i < nfft_; ++i)
+      out[i] = 0.5f * (left[i] + right[i]);
+    applyWindow(out, window, out, nfft_);
+  } else {
+    // Mono, or MidSide whose channel 0 is the downmix
+    std::copy(fft_in_.begin(), fft_in_.begin() + nfft_, out);
+  }
+}
+
+int Analyzer::processPcm16(const int16_t *pcm, int count, int nfft,
+                           float *magnitudes, int maxBins, FrameStats *stats) {
+  return process(pcm, count, nfft, magnitudes, maxBins, stats);
+}
+
+int Analyzer::processFloat(const float *samples, int count, int nfft,
+                           float *magnitudes, int maxBins, FrameStats *stats) {
+  return process(samples, count, nfft, magnitudes, maxBins, stats);
+}
+
+int Analyzer::processPlanar(const float *left, const float *right, int frames,
+                            int nfft, float *magnitudes, int maxBins,
+                            FrameStats *stats) {
+  return processStereo(StereoPlanes{left, right}, frames, nfft, magnitudes,
+                       maxBins, stats);
+}
+
+void Analyzer::setSmoothing(bool enabled, float factor) {
+  smoothing_enabled_ = enabled;
+  smoothing_factor_ = std::max(0.0f, std::min(factor, 1.0f));
+}
+
+void Analyzer::smoothLevels(FrameStats *stats) {
+  if (!smoothing_enabled_) {
+    smooth_rms_ = stats->rms;
+    smooth_peak_ = stats->peak;
+    return;
+  }
+  smooth_rms_ += (stats->rms - smooth_rms_) * smoothing_factor_;
+  smooth_peak_ += (stats->peak - smooth_peak_) * smoothing_factor_;
+  stats->rms = smooth_rms_;
+  stats->peak = smooth_peak_;
+}
+
+void Analyzer::setFeatures(uint32_t mask, float sampleRate) {
+  feature_mask_ = mask & kFeatureAll;
+  features_.configure(feature_mask_, sampleRate);
+  const bool pitch = (feature_mask_ & kFeaturePitch) != 0;
+  pitch_enabled_.store(pitch);
+  if (pitch) {
+    pitch_detector_.configure(sampleRate);
+    if (nfft_ > 0 && pitch_.fft == nullptr)
+      buildPitch(pitch_, nfft_);
+  }
+  frame_features_ = SpectralFeatures();
+}
+
+void Analyzer::setMeters(bool enabled, const MeterSettings &settings,
+                         float sampleRate) {
+  if (enabled)
+    meter_.configure(settings, sampleRate);
+  else
+    meter_.disable();
+}
+
+void Analyzer::setVoiceActivity(bool enabled,
+                                const VoiceActivitySettings &settings,
+                                float sampleRate) {
+  if (enabled)
+    vad_.configure(settings, sampleRate);
+  else
+    vad_.disable();
+}
+
+void Analyzer::setBuffers(const int16_t *pcm, int pcmCapacity, float *output,
+                          int outputCapacity, float *stats) {
+  pcm_buf_ = pcm;
+  pcm_capacity_ = pcm ? pcmCapacity : 0;
+  out_buf_ = output;
+  out_capacity_ = output ? outputCapacity : 0;
+  stats_buf_ = stats;
+}
+
+void Analyzer::setBands(BandLayout layout, int bands, float sampleRate) {
+  band_layout_.store(layout);
+  bands_.store(bands);
+  band_sample_rate_.store(sampleRate);
+}
+
+int Analyzer::mapBands(const float *spectrum, int bins, float *out,
+                       int maxOut) {
+  const BandLayout layout = band_layout_.load();
+  const int requested = bands_.load();
+  const bool passThrough =
+      requested <= 0 || nfft_ <= 0 ||
+      (layout == BandLayout::Linear && requested >= nfft_ / 2);
+  if (passThrough) {
+    const int count = std::max(0, std::min(bins, maxOut));
+    std::copy(spectrum, spectrum + count, out);
+    return count;
+  }
+
+  const int bands =
+      mapper_.configure(layout, bins, requested, nfft_, band_sample_rate_.load());
+  if (bands <= 0 || bands > maxOut)
+    return 0;
+  mapper_.apply(spectrum, out);
+  return bands;
+}
+
+int Analyzer::mapChannelBands(float *out, int maxOut) {
+  if (channelSpectrum(0) == nullptr || channel_bins_ <= 0)
+    return 0;
+  const int room = maxOut / kMaxChannels;
+  const int count = mapBands(channelSpectrum(0), channel_bins_, out, room);
+  if (count > 0)
+    mapBands(channelSpectrum(1), channel_bins_, out + count, room);
+  return count;
+}
+
+int Analyzer::processRegistered(int count, int nfft, bool withFft) {
+  if (!hasBuffers() || count <= 0 || count > pcm_capacity_)
+    return 0;
+
+  FrameStats stats;
+  int bins = processPcm16(pcm_buf_, count, nfft, withFft ? out_buf_ : nullptr,
+                          out_capacity_, &stats);
+  smoothLevels(&stats);
+  stats_buf_[0] = stats.rms;
+  stats_buf_[1] = stats.peak;
+  return bins;
+}
+
+} // namespace realtimeaudio
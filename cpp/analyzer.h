@@ -0,0 +1,371 @@
+#ifndef REALTIMEAUDIO_ANALYZER_H
+#define REALTIMEAUDIO_ANALYZER_H
+
+#include "band_mapper.h"
+#include "fft_backend.h"
+#include "level_meter.h"
+#include "pcm_kernel.h"
+#include "perf_stats.h"
+#include "pitch_detector.h"
+#include "sample_ring.h"
+#include "spectral_features.h"
+#include "voice_activity.h"
+#include "window.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace realtimeaudio {
+
+class SpectrogramHistory;
+class SubscriberGraph;
+
+// Input channel layout. Values are shared with AudioEngine.CHANNEL_MODE_*,
+// RTAAnalyzer and the JS names 'mono' | 'stereo' | 'midside'.
+enum class ChannelMode : int {
+  Mono = 0,    // one channel; planar stereo input is downmixed
+  Stereo = 1,  // left and right spectra next to the downmix
+  MidSide = 2, // mid (L + R) / 2 and side (L - R) / 2 spectra
+};
+
+ChannelMode channelModeFromInt(int value);
+
+// Per-engine analysis state, shared by the Android (JNI / AAudio) and iOS
+// (RTAAnalyzer) front ends so both produce the same frames: window, FFT,
+// magnitudes normalized by nfft / 2 and the window's coherent gain, band
+// mapping and level smoothing. On the fixed-point backends (KissQ15 /
+// KissQ31) PCM16 input is analyzed in integer arithmetic up to the
+// magnitudes, see fixed_fft.h. Each
+// engine owns exactly one Analyzer, so plans, windows and scratch buffers are
+// never shared between engines and stay warm across calls.
+//
+// PCM reads are appended to an `nfft`-sample history ring and frames are
+// taken every `hopSize` samples (STFT), so the transform size is independent
+// of the capture read size: e.g. a 4096-point FFT with 75% overlap (hop 1024)
+// fed by 256-sample reads.
+//
+// In the stereo channel modes each channel has its own history and both are
+// transformed with the one plan per frame; the main outputs describe the
+// downmix, whose spectrum is derived from the two channel spectra rather
+// than transformed again.
+//
+// An Analyzer is not thread-safe: it must only be driven from the thread that
+// processes audio for its engine. The one exception is preparePlan(), which
+// control threads use to build the plan for a new size ahead of time so the
+// audio thread only swaps pointers when the size changes.
+class Analyzer {
+public:
+  explicit Analyzer(int nfft, FftBackendType backend = FftBackendType::Auto,
+                    WindowType window = WindowType::Hann,
+                    ChannelMode channels = ChannelMode::Mono);
+  ~Analyzer();
+
+  Analyzer(const Analyzer &) = delete;
+  Analyzer &operator=(const Analyzer &) = delete;
+
+  // Rebuilds the plan, window and history only when the size actually
+  // changes, adopting a matching prepared plan instead of allocating when
+  // there is one. Returns false if the plan could not be allocated.
+  bool configure(int nfft);
+
+  // Builds the FFT plan, window, scratch buffers and history for `nfft` on
+  // the calling thread and publishes it for the next configure(nfft) on the
+  // processing thread. Callable from any thread; a newer call replaces a
+  // plan that was not adopted yet. Returns false if allocation failed.
+  bool preparePlan(int nfft);
+
+  // Samples between STFT frames; 0 takes a frame after every read.
+  void setHopSize(int hopSize);
+  int hopSize() const { return hop_; }
+
+  // The FFT implementation, window and channel layout are fixed for the
+  // Analyzer's lifetime (engines create a new one on start()), so only the
+  // size changes while audio runs, through preparePlan() / configure().
+  FftBackendType backend() const { return backend_type_; }
+  // Name of the active plan's implementation ("none" before configure()).
+  const char *backendName() const { return fft_ ? fft_->name() : "none"; }
+
+  // Window tables come from the process-wide cache, so a plan only
+  // recomputes coefficients the first time a (type, size) pair is used.
+  WindowType window() const { return window_type_; }
+
+  // Input channel layout. In Stereo and MidSide modes processPcm16() and
+  // processFloat() take interleaved stereo (`count` samples, count / 2
+  // frames), levels, magnitudes and features describe the downmix, and each
+  // channel gets its own spectrum and levels (see channelSpectrum()).
+  ChannelMode channelMode() const { return channel_mode_; }
+  // Samples per input frame of processPcm16() / processFloat()
+  int inputChannels() const {
+    return channelMode() == ChannelMode::Mono ? 1 : kMaxChannels;
+  }
+  static constexpr int kMaxChannels = 2;
+
+  bool isValid() const { return fft_ != nullptr; }
+  int size() const { return nfft_; }
+
+  // Windows `nfft` samples of `input`, runs the real FFT and writes up to
+  // `maxBins` normalized magnitudes into `output`: a bin-centred sine of
+  // amplitude A reads A for every window type.
+  // Returns the number of bins written.
+  int computeMagnitudes(const float *input, float *output, int maxBins);
+
+  // Converts `count` PCM16 samples in one SIMD pass into the history ring,
+  // filling `stats`. When `magnitudes` is non-null and a hop has elapsed
+  // since the last frame, the latest `nfft` samples are windowed and up to
+  // `maxBins` magnitudes produced. Returns the number of bins written (0 when
+  // no frame was taken).
+  int processPcm16(const int16_t *pcm, int count, int nfft, float *magnitudes,
+                   int maxBins, FrameStats *stats);
+
+  // processPcm16() for float samples in [-1.0, 1.0].
+  int processFloat(const float *samples, int count, int nfft,
+                   float *magnitudes, int maxBins, FrameStats *stats);
+
+  // processFloat() for planar stereo (e.g. AVAudioPCMBuffer channels): reads
+  // `frames` samples from each of `left` and `right`. In Mono mode the two
+  // are downmixed into the history in the same pass.
+  int processPlanar(const float *left, const float *right, int frames,
+                    int nfft, float *magnitudes, int maxBins,
+                    FrameStats *stats);
+
+  // Channel 0 / 1 (left / right, or mid / side) of the newest frame:
+  // channelBins() magnitudes, normalized like the main output. nullptr in
+  // Mono mode. Valid until the next frame is taken.
+  const float *channelSpectrum(int channel) const;
+  int channelBins() const { return channel_bins_; }
+  // Unsmoothed levels of channel 0 / 1 over the last read
+  const FrameStats &channelLevels(int channel) const {
+    return channel_levels_[channel & 1];
+  }
+
+  // One-pole smoothing of read levels: level += (raw - level) * factor.
+  void setSmoothing(bool enabled, float factor);
+  // Replaces `stats` with the smoothed levels (tracks them when disabled).
+  void smoothLevels(FrameStats *stats);
+
+  // Registers caller-owned memory (e.g. direct ByteBuffers) once, so the
+  // per-frame path needs no array marshalling: PCM16 input, magnitude output
+  // and a two-float [rms, peak] stats block. The memory must outlive the
+  // Analyzer or be replaced by another call.
+  void setBuffers(const int16_t *pcm, int pcmCapacity, float *output,
+                  int outputCapacity, float *stats);
+  bool hasBuffers() const {
+    return pcm_buf_ != nullptr && out_buf_ != nullptr && stats_buf_ != nullptr;
+  }
+  const float *registeredOutput() const { return out_buf_; }
+  int registeredOutputCapacity() const { return out_capacity_; }
+
+  // Band aggregation for emitted spectra. `bands` <= 0 disables it; Linear
+  // with `bands` >= the bin count is a pass-through.
+  void setBands(BandLayout layout, int bands, float sampleRate);
+  bool hasBands() const { return bands_.load() > 0; }
+
+  // Maps `bins` magnitudes of the current size into `out` (room for
+  // `maxOut`), or copies them when no band layout applies. The weight table
+  // is rebuilt only when the layout, bin count or FFT size changes. Returns
+  // the number of floats written.
+  int mapBands(const float *spectrum, int bins, float *out, int maxOut);
+
+  // mapBands() of both channel spectra of the newest frame, packed one
+  // after the other into `out` (room for `maxOut` floats in total). Returns
+  // the floats written per channel; 0 in Mono mode or before a frame.
+  int mapChannelBands(float *out, int maxOut);
+
+  // Spectral features computed on every frame taken from now on, from the
+  // magnitudes before band mapping. `mask` is a set of FeatureFlags; 0
+  // disables the stage. kFeaturePitch adds a pitch estimate from the same
+  // frame for two transforms of twice its size (see PitchDetector).
+  void setFeatures(uint32_t mask, float sampleRate);
+  uint32_t featureMask() const { return feature_mask_; }
+  // Features of the newest frame. `onset` is only set right after the
+  // process call that took that frame, so re-sending it never repeats one.
+  const SpectralFeatures &features() const { return frame_features_; }
+
+  // Sliding-window RMS, peak hold and LUFS meters over every sample of every
+  // process call from now on, independent of the read size (see
+  // LevelMeter); `enabled` false stops them. Allocates the windows, so call
+  // it before processing starts.
+  void setMeters(bool enabled, const MeterSettings &settings,
+                 float sampleRate);
+  bool metersEnabled() const { return meter_.enabled(); }
+  const MeterSettings &meterSettings() const { return meter_.settings(); }
+  // Readings after the latest process call (zeros while disabled)
+  const MeterLevels &meters() const { return meter_.levels(); }
+
+  // Voice activity gate over the level of every process call from now on
+  // (see VoiceActivityDetector); `enabled` false ungates. While the gate is
+  // closed no frames are taken, so the FFT, feature and pitch stages are
+  // skipped and process calls return 0, but the history keeps filling: the
+  // call that opens the gate takes a frame at once.
+  void setVoiceActivity(bool enabled, const VoiceActivitySettings &settings,
+                        float sampleRate);
+  bool voiceActivityEnabled() const { return vad_.enabled(); }
+  const VoiceActivitySettings &voiceActivitySettings() const {
+    return vad_.settings();
+  }
+  // Gate state after the latest process call (closed while disabled)
+  const VoiceActivity &voiceActivity() const { return vad_.state(); }
+  // True while the gate holds the analysis stages back
+  bool gated() const { return vad_.enabled() && !vad_.state().active; }
+
+  // Times every process call (PerfStage::Analyze) and, within it, the FFT
+  // and feature stages of each frame into `stats` (not owned; nullptr, the
+  // default, disables timing). Set it before processing starts.
+  void setPerfStats(PerfStats *stats) { perf_ = stats; }
+  PerfStats *perfStats() const { return perf_; }
+
+  // History the publishing code appends each delivered frame to (not owned;
+  // nullptr, the default, keeps none). Set it before processing starts.
+  void setHistory(SpectrogramHistory *history) { history_ = history; }
+  SpectrogramHistory *history() const { return history_; }
+
+  // Consumers the capture paths fan each frame out to besides the main
+  // stream (not owned; nullptr, the default, has none). Set it before
+  // processing starts.
+  void setSubscribers(SubscriberGraph *graph) { subscribers_ = graph; }
+  SubscriberGraph *subscribers() const { return subscribers_; }
+
+  // processPcm16() on the registered buffers, with smoothed levels in the
+  // stats block. Returns the number of bins written (0 when `withFft` is
+  // false, no frame was due, or on failure).
+  int processRegistered(int count, int nfft, bool withFft);
+
+private:
+  // Zero-padded transform of twice the frame size for PitchDetector, and
+  // its buffers; only built while pitch is enabled
+  struct PitchPlan {
+    std::unique_ptr<FftBackend> fft;
+    std::vector<float> padded, re, im;
+  };
+
+  // Everything that depends on the transform size, built as a unit so a
+  // size change is a swap rather than a series of reallocations.
+  struct Plan {
+    int nfft = 0;
+    ChannelMode mode = ChannelMode::Mono;
+    std::unique_ptr<FftBackend> fft;
+    std::shared_ptr<const WindowTable> window;
+    std::vector<float> in, re, im;
+    SampleRing ring;
+    Pcm16Ring pcm_ring; // fixed-point backends only
+    // Second channel and the per-channel spectra (stereo modes only)
+    SampleRing ring1;
+    std::vector<float> re1, im1, channel_out;
+    // Band table for nfft / 2 bins, when built by preparePlan()
+    BandMapper mapper;
+    PitchPlan pitch;
+  };
+
+  static std::unique_ptr<Plan> buildPlan(int nfft, FftBackendType backend,
+                                         WindowType window, ChannelMode mode);
+  // Swaps `plan` into the live state; `plan` is left holding the old one.
+  void install(Plan &plan);
+  // Takes the prepared plan if it matches `nfft` and the current settings.
+  std::unique_ptr<Plan> takePrepared(int nfft);
+  void retire(std::unique_ptr<Plan> plan);
+  // Builds `plan`'s band table for the current band settings
+  void prepareBands(Plan &plan) const;
+  // Builds the pitch transform for frames of `nfft`; false on failure
+  static bool buildPitch(PitchPlan &pitch, int nfft);
+  // Windowed downmix of the frame just transformed, into pitch_.padded
+  void pitchFrame(bool fixed);
+
+  void release();
+  template <typename Sample>
+  int process(const Sample *samples, int count, int nfft, float *magnitudes,
+              int maxBins, FrameStats *stats);
+  template <typename Input>
+  int processStereo(const Input &input, int frames, int nfft,
+                    float *magnitudes, int maxBins, FrameStats *stats);
+  template <typename Sample, typename Ring>
+  void ingest(Ring &ring, const Sample *samples, int count, FrameStats *stats);
+  template <typename Input>
+  void ingestStereo(const Input &input, int frames, FrameStats *stats);
+  // Takes the due frame, if any, from the ingested history
+  int takeFrame(float *magnitudes, int maxBins, bool fixed);
+  bool frameDue() const { return hop_ > 0 ? pending_ >= hop_ : pending_ > 0; }
+  // Forward FFT of fft_in_, then spectrumMagnitudes()
+  int transform(float *output, int maxBins);
+  // Normalized magnitudes of fft_re_ / fft_im_
+  int spectrumMagnitudes(float *output, int maxBins) {
+    return spectrumMagnitudes(fft_re_.data(), fft_im_.data(), output, maxBins);
+  }
+  int spectrumMagnitudes(const float *re, const float *im, float *output,
+                         int maxBins) const;
+  // Both channel spectra, then the downmix into `output`
+  int transformStereo(float *output, int maxBins);
+
+  // Fixed at construction, so preparePlan() can read them from a control
+  // thread
+  const FftBackendType backend_type_;
+  const WindowType window_type_;
+  const ChannelMode channel_mode_;
+
+  // Handoff slots: control thread -> audio thread (prepared) and back
+  // (retired, freed by the next preparePlan() or the destructor)
+  std::atomic<Plan *> prepared_{nullptr};
+  std::atomic<Plan *> retired_{nullptr};
+
+  std::unique_ptr<FftBackend> fft_;
+  FixedPointFft *fixed_ = nullptr; // fft_, when it takes PCM16 directly
+  int nfft_ = 0;
+  std::shared_ptr<const WindowTable> window_;
+  std::vector<float> fft_in_; // To hold windowed input
+  std::vector<float> fft_re_, fft_im_; // Split spectrum, nfft / 2 + 1 bins
+
+  // STFT input history (PCM16 reads on fixed-point backends use pcm_ring_)
+  SampleRing ring_;
+  Pcm16Ring pcm_ring_;
+  int hop_ = 0;
+  int pending_ = 0; // samples ingested since the last frame
+
+  // Stereo modes: channel 1 history and spectrum (channel 0 uses ring_ and
+  // fft_re_ / fft_im_), and both channels' magnitudes
+  ChannelMode mode_ = ChannelMode::Mono; // of the installed plan
+  SampleRing ring1_;
+  std::vector<float> fft_re1_, fft_im1_;
+  std::vector<float> channel_out_;
+  int channel_bins_ = 0;
+  FrameStats channel_levels_[kMaxChannels];
+
+  // Registered I/O (not owned)
+  const int16_t *pcm_buf_ = nullptr;
+  int pcm_capacity_ = 0;
+  float *out_buf_ = nullptr;
+  int out_capacity_ = 0;
+  float *stats_buf_ = nullptr;
+
+  // Output band mapping. The settings are atomic so preparePlan() can
+  // build the table for a new size off the audio thread.
+  BandMapper mapper_;
+  std::atomic<BandLayout> band_layout_{BandLayout::Linear};
+  std::atomic<int> bands_{0};
+  std::atomic<float> band_sample_rate_{48000.0f};
+
+  // Spectral feature stage
+  uint32_t feature_mask_ = 0;
+  FeatureExtractor features_;
+  PitchDetector pitch_detector_;
+  PitchPlan pitch_;
+  // Atomic so preparePlan() builds the pitch transform when it is needed
+  std::atomic<bool> pitch_enabled_{false};
+  SpectralFeatures frame_features_;
+
+  LevelMeter meter_;
+  VoiceActivityDetector vad_;
+
+  // Level smoothing
+  bool smoothing_enabled_ = true;
+  float smoothing_factor_ = 0.5f;
+  float smooth_rms_ = 0.0f;
+  float smooth_peak_ = 0.0f;
+
+  PerfStats *perf_ = nullptr;
+  SpectrogramHistory *history_ = nullptr;
+  SubscriberGraph *subscribers_ = nullptr;
+};
+
+} // namespace realtimeaudio
+
+#endif // REALTIMEAUDIO_ANALYZER_H
@@ -0,0 +1,171 @@
+#include "band_mapper.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace realtimeaudio {
+
+namespace {
+
+double hzToMel(double hz) { return 2595.0 * std::log10(1.0 + hz / 700.0); }
+double melToHz(double mel) { return 700.0 * (std::pow(10.0, mel / 2595.0) - 1.0); }
+
+} // namespace
+
+BandLayout bandLayoutFromInt(int value) {
+  switch (value) {
+  case (int)BandLayout::Log:
+    return BandLayout::Log;
+  case (int)BandLayout::Mel:
+    return BandLayout::Mel;
+  case (int)BandLayout::ThirdOctave:
+    return BandLayout::ThirdOctave;
+  default:
+    return BandLayout::Linear;
+  }
+}
+
+void BandMapper::reset() {
+  bands_.clear();
+  weights_.clear();
+}
+
+int BandMapper::configure(BandLayout layout, int bins, int bands, int fftSize,
+                          float sampleRate) {
+  if (layout == layout_ && bins == bins_ && bands == requested_ &&
+      fftSize == fft_size_ && sampleRate == sample_rate_)
+    return this->bands();
+
+  layout_ = layout;
+  bins_ = bins;
+  requested_ = bands;
+  fft_size_ = fftSize;
+  sample_rate_ = sampleRate;
+  reset();
+  if (bins <= 0 || fftSize <= 0 || sampleRate <= 0.0f)
+    return 0;
+  if (layout != BandLayout::ThirdOctave && bands <= 0)
+    return 0;
+
+  const double binHz = (double)sampleRate / fftSize;
+  const double lo = kMinFrequency;
+  const double hi =
+      std::min<double>(kMaxFrequency, std::min(sampleRate * 0.5, binHz * (bins - 1)));
+  bands_.reserve(layout == BandLayout::ThirdOctave ? 32 : bands);
+
+  switch (layout) {
+  case BandLayout::Linear: {
+    // Same buckets as the old Kotlin/Swift resamplers
+    const float bucket = (float)bins / (float)bands;
+    for (int i = 0; i < bands; ++i) {
+      int start = (int)(i * bucket);
+      int end = std::min((int)((i + 1) * bucket), bins);
+      if (start >= end) {
+        const float one = 1.0f;
+        addBand(std::min(start, bins - 1), &one, 1);
+        continue;
+      }
+      std::vector<float> w(end - start, 1.0f / (end - start));
+      addBand(start, w.data(), end - start);
+    }
+    break;
+  }
+  case BandLayout::Log: {
+    const double ratio = hi / lo;
+    for (int i = 0; i < bands; ++i)
+      addRange(lo * std::pow(ratio, (double)i / bands),
+               lo * std::pow(ratio, (double)(i + 1) / bands), binHz);
+    break;
+  }
+  case BandLayout::Mel: {
+    const double melLo = hzToMel(lo), melHi = hzToMel(hi);
+    const double step = (melHi - melLo) / (bands + 1);
+    for (int i = 0; i < bands; ++i)
+      addTriangle(melToHz(melLo + i * step), melToHz(melLo + (i + 1) * step),
+                  melToHz(melLo + (i + 2) * step), binHz);
+    break;
+  }
+  case BandLayout::ThirdOctave: {
+    // Base-2 centers 1 kHz * 2^(n/3), edges a sixth of an octave either side
+    const int first = (int)std::ceil(3.0 * std::log2(lo / 1000.0));
+    const int last = (int)std::floor(3.0 * std::log2(hi / 1000.0));
+    for (int n = first; n <= last; ++n) {
+      const double center = 1000.0 * std::pow(2.0, n / 3.0);
+      addRange(center * std::pow(2.0, -1.0 / 6.0),
+               std::min(hi, center * std::pow(2.0, 1.0 / 6.0)), binHz);
+    }
+    break;
+  }
+  }
+  return this->bands();
+}
+
+void BandMapper::addBand(int start, const float *weights, int count) {
+  Band band;
+  band.start = start;
+  band.count = count;
+  band.offset = (int)weights_.size();
+  weights_.insert(weights_.end(), weights, weights + count);
+  bands_.push_back(band);
+}
+
+void BandMapper::addRange(double lo, double hi, double binHz) {
+  const int start = std::max(0, (int)std::ceil(lo / binHz));
+  const int end = std::min(bins_, (int)std::ceil(hi / binHz));
+  if (start >= end) {
+    addInterpolated(std::sqrt(lo * hi), binHz);
+    return;
+  }
+  std::vector<float> w(end - start, 1.0f / (end - start));
+  addBand(start, w.data(), end - start);
+}
+
+void BandMapper::addTriangle(double lo, double center, double hi,
+                             double binHz) {
+  const int start = std::max(0, (int)std::ceil(lo / binHz));
+  const int end = std::min(bins_, (int)std::ceil(hi / binHz));
+  std::vector<float> w;
+  double sum = 0.0;
+  for (int k = start; k < end; ++k) {
+    const double hz = k * binHz;
+    const double v = hz <= center ? (hz - lo) / (center - lo)
+                                  : (hi - hz) / (hi - center);
+    w.push_back((float)std::max(0.0, v));
+    sum += w.back();
+  }
+  if (sum <= 0.0) {
+    addInterpolated(center, binHz);
+    return;
+  }
+  for (float &v : w)
+    v = (float)(v / sum);
+  addBand(start, w.data(), (int)w.size());
+}
+
+void BandMapper::addInterpolated(double hz, double binHz) {
+  const double pos = std::min(hz / binHz, (double)(bins_ - 1));
+  const int k = std::min((int)pos, std::max(bins_ - 2, 0));
+  if (bins_ < 2) {
+    const float one = 1.0f;
+    addBand(0, &one, 1);
+    return;
+  }
+  const float frac = (float)(pos - k);
+  const float w[2] = {1.0f - frac, frac};
+  addBand(k, w, 2);
+}
+
+void BandMapper::apply(const float *spectrum, float *out) const {
+  const float *weights = weights_.data();
+  for (size_t i = 0; i < bands_.size(); ++i) {
+    const Band &band = bands_[i];
+    const float *x = spectrum + band.start;
+    const float *w = weights + band.offset;
+    float sum = 0.0f;
+    for (int j = 0; j < band.count; ++j)
+      sum += x[j] * w[j];
+    out[i] = sum;
+  }
+}
+
+} // namespace realtimeaudio
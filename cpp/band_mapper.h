@@ -0,0 +1,75 @@
+#ifndef REALTIMEAUDIO_BAND_MAPPER_H
+#define REALTIMEAUDIO_BAND_MAPPER_H
+
+#include <vector>
+
+namespace realtimeaudio {
+
+// Values are shared with AudioEngine.BAND_LAYOUT_* and the JS names
+// 'linear' | 'log' | 'mel' | 'octave'.
+enum class BandLayout : int {
+  Linear = 0,      // equal-width buckets over all bins (legacy downsampling)
+  Log = 1,         // log-spaced band edges
+  Mel = 2,         // triangular mel filters (HTK mel scale)
+  ThirdOctave = 3, // ANSI 1/3-octave bands; the band count follows the range
+};
+
+BandLayout bandLayoutFromInt(int value);
+
+// Aggregates a magnitude spectrum into perceptual bands through a sparse
+// weight table: every band is a contiguous run of bins with one weight per
+// bin, built once per configuration so apply() is a single multiply-add pass
+// with no allocation. Weights of each band sum to one, so band values stay on
+// the same scale as the input magnitudes.
+//
+// Bands too narrow to contain a bin (low frequencies at small FFT sizes)
+// interpolate between the two bins around their center instead of coming
+// out empty.
+class BandMapper {
+public:
+  // Lowest band edge for the log/mel/octave layouts; the highest is
+  // min(kMaxFrequency, Nyquist).
+  static constexpr float kMinFrequency = 20.0f;
+  static constexpr float kMaxFrequency = 20000.0f;
+
+  // Rebuilds the table only when a parameter changes. `bins` spectrum bins
+  // are spaced sampleRate / fftSize apart starting at DC. `bands` is ignored
+  // for ThirdOctave. Returns the resulting band count (0 if invalid).
+  int configure(BandLayout layout, int bins, int bands, int fftSize,
+                float sampleRate);
+
+  int bands() const { return (int)bands_.size(); }
+  int inputBins() const { return bins_; }
+
+  // Writes bands() values into `out`; `spectrum` must hold inputBins().
+  void apply(const float *spectrum, float *out) const;
+
+private:
+  struct Band {
+    int start;  // first bin
+    int count;  // bins in the run
+    int offset; // into weights_
+  };
+
+  void reset();
+  // Rectangular average of bins whose frequency lies in [lo, hi)
+  void addRange(double lo, double hi, double binHz);
+  // Triangle rising lo -> center, falling center -> hi
+  void addTriangle(double lo, double center, double hi, double binHz);
+  // Two-bin linear interpolation at `hz`
+  void addInterpolated(double hz, double binHz);
+  void addBand(int start, const float *weights, int count);
+
+  std::vector<Band> bands_;
+  std::vector<float> weights_;
+
+  BandLayout layout_ = BandLayout::Linear;
+  int bins_ = 0;
+  int requested_ = 0;
+  int fft_size_ = 0;
+  float sample_rate_ = 0.0f;
+};
+
+} // namespace realtimeaudio
+
+#endif // REALTIMEAUDIO_BAND_MAPPER_H
@@ -0,0 +1,429 @@
+// Per-stage micro-benchmark of the analysis hot path (host or device shell).
+//
+//   cmake -S android -B build-bench -DRTA_BUILD_BENCHMARKS=ON
+//   cmake --build build-bench
+//   ./build-bench/rta_analysis_bench          # KISS_FFT_SIMD + NEON/SSE
+//   ./build-bench/rta_analysis_bench_scalar   # same source, scalar fallback
+//
+// Times each stage of a frame on its own, for every FFT size and backend:
+//
+//   pcm16     convertPcm16(): conversion, stats and windowing in one pass
+//   window    applyWindow() on float input (AVAudioEngine path)
+//   fft       FftBackend::forward(); the fixed-point backends go through
+//             their float entry point (block floating point), and the
+//             sizes with compile-time kernels also time the generic RealFft
+//   magnitude complexMagnitudes() over nfft / 2 bins
+//   bands     BandMapper::apply() per layout (64 bands, 1/3 octave fixed)
+//   features  FeatureExtractor::compute() with every spectral feature
+//   pitch     PitchDetector::detect() on its 2 * nfft plan, including
+//             copying the windowed frame in
+//   meter     LevelMeter::process() on the PCM16 read (RMS, peak hold, LUFS)
+//   frame     full Analyzer::processPcm16(); for the fixed-point backends
+//             this is their integer PCM16 path
+//
+// Reports ns/frame and cycles/sample (cycles per input sample of the nfft
+// frame). Cycles come from the hardware counter (perf_event_open) where
+// the kernel allows it, else the x86 TSC, else --ghz=<clock>; compare the
+// "cycles" header between runs before comparing the column.
+//
+// Options: --csv, --quick (shorter timing loops), --sizes=256,1024,...
+// and --stage=<name> to run one stage.
+
+#include "analyzer.h"
+#include "band_mapper.h"
+#include "fft_backend.h"
+#include "pcm_kernel.h"
+#include "pitch_detector.h"
+#include "real_fft.h"
+#include "sized_fft.h"
+#include "spectral_features.h"
+#include "window.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#ifndef RTA_BENCH_VARIANT
+#define RTA_BENCH_VARIANT "simd"
+#endif
+
+using namespace realtimeaudio;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr float kSampleRate = 48000.0f;
+constexpr int kBands = 64;
+
+// Cycle source, chosen once: the CPU cycle counter of this thread, the TSC
+// (constant rate, so it scales with the nominal clock rather than the
+// current one) or nothing.
+class CycleCounter {
+public:
+  CycleCounter() {
+#if defined(__linux__)
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CPU_CYCLES;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd_ = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    if (fd_ >= 0) {
+      source_ = "perf";
+      return;
+    }
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+    source_ = "tsc";
+#endif
+  }
+
+  ~CycleCounter() {
+#if defined(__linux__)
+    if (fd_ >= 0)
+      close(fd_);
+#endif
+  }
+
+  CycleCounter(const CycleCounter &) = delete;
+  CycleCounter &operator=(const CycleCounter &) = delete;
+
+  bool available() const { return source_ != nullptr; }
+  const char *source() const { return source_ ? source_ : "none"; }
+
+  uint64_t now() const {
+#if defined(__linux__)
+    if (fd_ >= 0) {
+      uint64_t value = 0;
+      if (read(fd_, &value, sizeof(value)) == (ssize_t)sizeof(value))
+        return value;
+      return 0;
+    }
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+  }
+
+private:
+  int fd_ = -1;
+  const char *source_ = nullptr;
+};
+
+struct Options {
+  bool csv = false;
+  double minSeconds = 0.25;
+  double ghz = 0.0; // fallback when no counter is available
+  std::vector<int> sizes = {256, 512, 1024, 2048, 4096, 8192};
+  const char *stage = nullptr;
+};
+
+struct Timing {
+  double ns;     // per call
+  double cycles; // per call, < 0 when unknown
+};
+
+class Bench {
+public:
+  explicit Bench(const Options &options) : options_(options) {}
+
+  const CycleCounter &counter() const { return counter_; }
+
+  bool enabled(const char *stage) const {
+    return options_.stage == nullptr || std::strcmp(options_.stage, stage) == 0;
+  }
+
+  // Runs `fn` until at least minSeconds elapsed; returns cost per call.
+  template <typename Fn> Timing time(Fn &&fn) const {
+    for (int i = 0; i < 64; ++i)
+      fn(); // warm caches and plans
+
+    long iterations = 0;
+    const uint64_t startCycles = counter_.now();
+    const auto start = Clock::now();
+    double elapsed = 0.0;
+    do {
+      for (int i = 0; i < 256; ++i)
+        fn();
+      iterations += 256;
+      elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (elapsed < options_.minSeconds);
+    const uint64_t cycles = counter_.now() - startCycles;
+
+    Timing t;
+    t.ns = elapsed * 1e9 / (double)iterations;
+    if (counter_.available())
+      t.cycles = (double)cycles / (double)iterations;
+    else
+      t.cycles = options_.ghz > 0.0 ? t.ns * options_.ghz : -1.0;
+    return t;
+  }
+
+  void report(const char *stage, int nfft, const char *variant,
+              const Timing &t) const {
+    const double perSample = t.cycles >= 0.0 ? t.cycles / nfft : -1.0;
+    if (options_.csv) {
+      printf("%s,%s,%d,%s,%.1f,", RTA_BENCH_VARIANT, stage, nfft, variant,
+             t.ns);
+      if (perSample >= 0.0)
+        printf("%.3f\n", perSample);
+      else
+        printf("\n");
+      return;
+    }
+    printf("%-9s %6d %-13s %12.0f ", stage, nfft, variant, t.ns);
+    if (perSample >= 0.0)
+      printf("%14.3f\n", perSample);
+    else
+      printf("%14s\n", "n/a");
+  }
+
+private:
+  Options options_;
+  CycleCounter counter_;
+};
+
+const char *layoutName(BandLayout layout) {
+  switch (layout) {
+  case BandLayout::Linear:
+    return "linear";
+  case BandLayout::Log:
+    return "log";
+  case BandLayout::Mel:
+    return "mel";
+  case BandLayout::ThirdOctave:
+    return "third-octave";
+  }
+  return "?";
+}
+
+volatile float g_sink; // keeps results observable
+
+void runSize(const Bench &bench, int nfft) {
+  const FftBackendType backends[] = {
+    FftBackendType::Kiss, FftBackendType::Real,
+    FftBackendType::KissQ15, FftBackendType::KissQ31,
+#if defined(__APPLE__)
+    FftBackendType::Accelerate,
+#endif
+  };
+  const int bins = nfft / 2;
+
+  // A two-tone signal with some noise so every stage sees a realistic frame
+  std::vector<float> input(nfft), windowed(nfft), frame(nfft);
+  std::vector<int16_t> pcm(nfft);
+  srand(1);
+  for (int i = 0; i < nfft; ++i) {
+    input[i] = 0.5f * sinf(0.05f * i) + 0.25f * sinf(0.31f * i) +
+               0.01f * ((float)(rand() % 2001) / 1000.0f - 1.0f);
+    pcm[i] = (int16_t)(input[i] * 32767.0f);
+  }
+  std::shared_ptr<const WindowTable> window =
+      windowTable(WindowType::Hann, nfft);
+  applyWindow(input.data(), window->values.data(), windowed.data(), nfft);
+  const float scale = 1.0f / ((float)bins * window->coherentGain);
+
+  if (bench.enabled("pcm16")) {
+    bench.report("pcm16", nfft, "-", bench.time([&] {
+      FrameStats stats;
+      convertPcm16(pcm.data(), nfft, frame.data(), window->values.data(),
+                   windowed.data(), nfft, &stats);
+      g_sink = windowed[1] + stats.rms;
+    }));
+  }
+
+  if (bench.enabled("window")) {
+    bench.report("window", nfft, "hann", bench.time([&] {
+      applyWindow(input.data(), window->values.data(), windowed.data(), nfft);
+      g_sink = windowed[1];
+    }));
+  }
+
+  // Reference spectrum for the stages after the FFT
+  std::vector<float> re(bins + 1), im(bins + 1), spectrum(bins);
+  {
+    std::unique_ptr<FftBackend> fft = createFftBackend(FftBackendType::Real,
+                                                       nfft);
+    fft->forward(windowed.data(), re.data(), im.data());
+    complexMagnitudes(re.data(), im.data(), bins, scale, spectrum.data());
+  }
+
+  if (bench.enabled("fft")) {
+    std::vector<float> outRe(bins + 1), outIm(bins + 1);
+    for (FftBackendType type : backends) {
+      std::unique_ptr<FftBackend> fft = createFftBackend(type, nfft);
+      if (!fft)
+        continue;
+      bench.report("fft", nfft, fft->name(), bench.time([&] {
+        fft->forward(windowed.data(), outRe.data(), outIm.data());
+        g_sink = outRe[1];
+      }));
+    }
+    // The generic plan the compile-time kernels replace at this size
+    if (sizedRealFftSupports(nfft)) {
+      RealFft generic(nfft);
+      bench.report("fft", nfft, "realfft", bench.time([&] {
+        generic.forward(windowed.data(), outRe.data(), outIm.data());
+        g_sink = outRe[1];
+      }));
+    }
+  }
+
+  if (bench.enabled("magnitude")) {
+    std::vector<float> out(bins);
+    bench.report("magnitude", nfft, "-", bench.time([&] {
+      complexMagnitudes(re.data(), im.data(), bins, scale, out.data());
+      g_sink = out[1];
+    }));
+  }
+
+  if (bench.enabled("bands")) {
+    const BandLayout layouts[] = {BandLayout::Linear, BandLayout::Log,
+                                  BandLayout::Mel, BandLayout::ThirdOctave};
+    std::vector<float> out(bins);
+    for (BandLayout layout : layouts) {
+      BandMapper mapper;
+      if (mapper.configure(layout, bins, kBands, nfft, kSampleRate) <= 0)
+        continue;
+      bench.report("bands", nfft, layoutName(layout), bench.time([&] {
+        mapper.apply(spectrum.data(), out.data());
+        g_sink = out[0];
+      }));
+    }
+  }
+
+  if (bench.enabled("features")) {
+    FeatureExtractor extractor;
+    extractor.configure(kFeatureSpectral, kSampleRate);
+    bench.report("features", nfft, "spectral", bench.time([&] {
+      SpectralFeatures features;
+      extractor.compute(spectrum.data(), bins, nfft, &features);
+      g_sink = features.centroid;
+    }));
+  }
+
+  if (bench.enabled("pitch") && nfft <= PitchDetector::kMaxSize) {
+    // The detector's zero-padded plan, as built by the Analyzer
+    std::unique_ptr<FftBackend> fft = createFftBackend(FftBackendType::Real,
+                                                       2 * nfft);
+    std::vector<float> padded(2 * nfft), workRe(nfft + 1), workIm(nfft + 1);
+    PitchDetector detector;
+    detector.configure(kSampleRate);
+    detector.prepareWindow(*window, *fft, padded.data(), workRe.data(),
+                           workIm.data());
+    bench.report("pitch", nfft, fft->name(), bench.time([&] {
+      // detect() consumes the frame
+      std::memcpy(padded.data(), windowed.data(), nfft * sizeof(float));
+      float frequency = 0.0f, confidence = 0.0f;
+      detector.detect(*fft, padded.data(), workRe.data(), workIm.data(),
+                      &frequency, &confidence);
+      g_sink = frequency;
+    }));
+  }
+
+  if (bench.enabled("meter")) {
+    LevelMeter meter;
+    meter.configure(MeterSettings(), kSampleRate);
+    bench.report("meter", nfft, "pcm16", bench.time([&] {
+      meter.process(pcm.data(), nfft, 1);
+      g_sink = meter.levels().rms;
+    }));
+  }
+
+  if (bench.enabled("frame")) {
+    std::vector<float> mags(bins);
+    for (FftBackendType type : backends) {
+      Analyzer analyzer(nfft, type);
+      if (!analyzer.isValid())
+        continue;
+      bench.report("frame", nfft, analyzer.backendName(), bench.time([&] {
+        FrameStats stats;
+        analyzer.processPcm16(pcm.data(), nfft, nfft, mags.data(),
+                              (int)mags.size(), &stats);
+        g_sink = mags[1] + stats.rms;
+      }));
+    }
+  }
+}
+
+bool parseSizes(const char *list, std::vector<int> *sizes) {
+  sizes->clear();
+  while (*list) {
+    char *end = nullptr;
+    const long value = strtol(list, &end, 10);
+    if (end == list || value < 16 || (value & (value - 1)) != 0)
+      return false;
+    sizes->push_back((int)value);
+    list = *end == ',' ? end + 1 : end;
+    if (*end != ',' && *end != '\0')
+      return false;
+  }
+  return !sizes->empty();
+}
+
+int usage(const char *argv0) {
+  fprintf(stderr,
+          "usage: %s [--csv] [--quick] [--sizes=256,1024,...] "
+          "[--stage=pcm16|window|fft|magnitude|bands|features|pitch|meter|"
+          "frame] "
+          "[--ghz=<clock>]\n",
+          argv0);
+  return EXIT_FAILURE;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    const char *arg = argv[i];
+    if (std::strcmp(arg, "--csv") == 0)
+      options.csv = true;
+    else if (std::strcmp(arg, "--quick") == 0)
+      options.minSeconds = 0.02;
+    else if (std::strncmp(arg, "--sizes=", 8) == 0) {
+      if (!parseSizes(arg + 8, &options.sizes))
+        return usage(argv[0]);
+    } else if (std::strncmp(arg, "--stage=", 8) == 0)
+      options.stage = arg + 8;
+    else if (std::strncmp(arg, "--ghz=", 6) == 0)
+      options.ghz = atof(arg + 6);
+    else
+      return usage(argv[0]);
+  }
+
+  Bench bench(options);
+  if (options.csv) {
+    printf("variant,stage,nfft,detail,ns_per_frame,cycles_per_sample\n");
+  } else {
+    printf("variant: %s, cycles: %s\n", RTA_BENCH_VARIANT,
+           bench.counter().available()
+               ? bench.counter().source()
+               : (options.ghz > 0.0 ? "estimated from --ghz" : "none"));
+    printf("%-9s %6s %-13s %12s %14s\n", "stage", "nfft", "detail",
+           "ns/frame", "cycles/sample");
+  }
+
+  for (int nfft : options.sizes)
+    runSize(bench, nfft);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,123 @@
+#include "fft_backend.h"
+#include "fixed_fft.h"
+#include "kiss_fft/kiss_fftr.h"
+#include "real_fft.h"
+#include "sized_fft.h"
+
+#if defined(__APPLE__)
+#include "accelerate_fft.h"
+#endif
+
+#include <new>
+#include <vector>
+
+namespace realtimeaudio {
+
+namespace {
+
+// KissFFT kiss_fftr adapter. This copy of kiss_fftr packs the Nyquist term
+// into freqdata[0].i (vDSP style), so it is unpacked into bin nfft / 2 here.
+class KissFftBackend : public FftBackend {
+public:
+  explicit KissFftBackend(int nfft) : nfft_(nfft) {
+    cfg_ = kiss_fftr_alloc(nfft, 0, nullptr, nullptr);
+    out_.resize(nfft / 2 + 1);
+  }
+  ~KissFftBackend() override {
+    if (cfg_)
+      kiss_fftr_free(cfg_);
+  }
+
+  bool isValid() const { return cfg_ != nullptr; }
+
+  int size() const override { return nfft_; }
+  FftBackendType type() const override { return FftBackendType::Kiss; }
+  const char *name() const override { return "kissfft"; }
+
+  void forward(const float *input, float *re, float *im) override {
+    kiss_fftr(cfg_, input, out_.data());
+
+    const int half = nfft_ / 2;
+    re[0] = out_[0].r;
+    im[0] = 0.0f;
+    for (int k = 1; k < half; ++k) {
+      re[k] = out_[k].r;
+      im[k] = out_[k].i;
+    }
+    re[half] = out_[0].i;
+    im[half] = 0.0f;
+  }
+
+private:
+  int nfft_;
+  kiss_fftr_cfg cfg_ = nullptr;
+  std::vector<kiss_fft_cpx> out_;
+};
+
+std::unique_ptr<FftBackend> createKiss(int nfft) {
+  if (nfft <= 0 || (nfft & 1))
+    return nullptr;
+  std::unique_ptr<KissFftBackend> kiss(new (std::nothrow) KissFftBackend(nfft));
+  if (!kiss || !kiss->isValid())
+    return nullptr;
+  return kiss;
+}
+
+std::unique_ptr<FftBackend> createReal(int nfft) {
+  if (sizedRealFftSupports(nfft)) {
+    if (std::unique_ptr<FftBackend> sized = createSizedRealFft(nfft))
+      return sized;
+  }
+  if (RealFft::supports(nfft))
+    return std::unique_ptr<FftBackend>(new (std::nothrow) RealFft(nfft));
+  return createKiss(nfft);
+}
+
+std::unique_ptr<FftBackend> createAccelerate(int nfft) {
+#if defined(__APPLE__)
+  if (AccelerateFft::supports(nfft)) {
+    std::unique_ptr<AccelerateFft> vdsp(new (std::nothrow) AccelerateFft(nfft));
+    if (vdsp && vdsp->isValid())
+      return vdsp;
+  }
+#endif
+  return createReal(nfft);
+}
+
+} // namespace
+
+std::unique_ptr<FftBackend> createFftBackend(FftBackendType type, int nfft) {
+  switch (type) {
+  case FftBackendType::Kiss:
+    return createKiss(nfft);
+  case FftBackendType::Real:
+    return createReal(nfft);
+  case FftBackendType::Auto:
+  case FftBackendType::Accelerate:
+    return createAccelerate(nfft);
+  case FftBackendType::KissQ15:
+    return createKissQ15(nfft);
+  case FftBackendType::KissQ31:
+    return createKissQ31(nfft);
+  }
+  return nullptr;
+}
+
+FftBackendType fftBackendFromInt(int value) {
+  switch (value) {
+  case (int)FftBackendType::Kiss:
+    return FftBackendType::Kiss;
+  case (int)FftBackendType::Real:
+    return FftBackendType::Real;
+  case (int)FftBackendType::Accelerate:
+    return FftBackendType::Accelerate;
+  case (int)FftBackendType::KissQ15:
+    return FftBackendType::KissQ15;
+  case (int)FftBackendType::KissQ31:
+    return FftBackendType::KissQ31;
+  default:
+    return FftBackendType::Auto;
+  }
+}
+
+} // namespace realtimeaudio
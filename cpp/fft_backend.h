@@ -0,0 +1,53 @@
+#ifndef REALTIMEAUDIO_FFT_BACKEND_H
+#define REALTIMEAUDIO_FFT_BACKEND_H
+
+#include <memory>
+
+namespace realtimeaudio {
+
+// Values are shared with AudioEngine.FFT_BACKEND_* on the Kotlin side and
+// RTAAnalyzer on iOS.
+enum class FftBackendType : int {
+  Auto = 0,       // Accelerate on Apple, else RealFft, for powers of two;
+                  // KissFFT otherwise
+  Kiss = 1,       // KissFFT kiss_fftr (any even size)
+  Real = 2,       // SIMD split-format real FFT (powers of two >= 32;
+                  // compile-time kernels for 256 to 2048)
+  Accelerate = 3, // vDSP real FFT (Apple only, powers of two >= 16)
+  KissQ15 = 4,    // KissFFT in Q15 fixed point (any even size)
+  KissQ31 = 5,    // KissFFT in Q31 fixed point (any even size)
+};
+
+class FixedPointFft;
+
+// A forward real-input FFT plan of a fixed size. Implementations own all of
+// their scratch memory so forward() never allocates.
+//
+// Output is split complex: `re` and `im` each receive size() / 2 + 1
+// unnormalized bins (bin 0 = DC, bin size() / 2 = Nyquist, both with a zero
+// imaginary part), i.e. exactly the DFT sums.
+class FftBackend {
+public:
+  virtual ~FftBackend() = default;
+
+  virtual int size() const = 0;
+  virtual FftBackendType type() const = 0;
+  virtual const char *name() const = 0;
+
+  virtual void forward(const float *input, float *re, float *im) = 0;
+
+  // Non-null for fixed-point backends, which also take PCM16 directly.
+  virtual FixedPointFft *asFixedPoint() { return nullptr; }
+};
+
+// Returns nullptr if no backend supports `nfft` (e.g. odd sizes). Explicitly
+// requesting Real or Accelerate for a size (or platform) it cannot handle
+// falls back to the Auto choice.
+std::unique_ptr<FftBackend> createFftBackend(FftBackendType type, int nfft);
+
+// Maps a Kotlin/Swift backend id to the enum (unknown ids map to Auto).
+FftBackendType fftBackendFromInt(int value);
+
+} // namespace realtimeaudio
+
+#endif // REALTIMEAUDIO_FFT_BACKEND_H
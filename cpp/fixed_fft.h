@@ -0,0 +1,43 @@
+#ifndef REALTIMEAUDIO_FIXED_FFT_H
+#define REALTIMEAUDIO_FIXED_FFT_H
+
+#include "fft_backend.h"
+#include <cstdint>
+#include <memory>
+
+namespace realtimeaudio {
+
+// Fixed-point backends: the bundled KissFFT built a second and third time
+// with FIXED_POINT 16 / 32 under the kiss_q15_ / kiss_q31_ prefixes
+// (kiss_fft_fixed/). For devices without a fast FPU the PCM16 path never
+// touches floats until the magnitudes: samples stay int16 in the history,
+// are windowed in integer arithmetic and transformed in Q15 or Q31.
+//
+// Q15 has 16-bit butterflies, but KissFFT divides by the radix at every
+// stage to stay in range, so its noise floor sits around -75 dBFS (nfft
+// 2048): fine for level meters and spectrum displays, too coarse for pitch.
+// Q31 uses 64-bit products and stays below -100 dBFS. Whether either beats
+// the float backends depends on the core: measure with rta_analysis_bench on
+// the target device (on x86 hosts float is faster).
+class FixedPointFft : public FftBackend {
+public:
+  FixedPointFft *asFixedPoint() override { return this; }
+
+  // Windows size() PCM16 samples by the Q15 `window` and transforms them.
+  // `re` / `im` receive the same unnormalized bins forward() produces for
+  // the windowed samples as floats in [-1.0, 1.0).
+  virtual void forwardPcm16(const int16_t *pcm, const int16_t *window,
+                            float *re, float *im) = 0;
+
+  // forward() of float input scales each frame to the fixed-point range
+  // (block floating point) and the bins back, so any caller of FftBackend
+  // keeps working.
+};
+
+// nullptr for odd sizes or allocation failure.
+std::unique_ptr<FftBackend> createKissQ15(int nfft);
+std::unique_ptr<FftBackend> createKissQ31(int nfft);
+
+} // namespace realtimeaudio
+
+#endif // REALTIMEAUDIO_FIXED_FFT_H
@@ -0,0 +1,115 @@
+// KissFFT fixed-point adapter, compiled once per precision. The including
+// file first includes kiss_fft_fixed/kiss_fft_q15.h or kiss_fft_q31.h, whose
+// macros map the kiss_* names used here onto that build, and defines
+// RTA_FIXED_FFT_TYPE / RTA_FIXED_FFT_NAME. No include guard on purpose.
+
+#include "fixed_fft.h"
+
+#include <algorithm>
+#include <cmath>
+#include <new>
+#include <vector>
+
+namespace realtimeaudio {
+
+namespace {
+
+#if FIXED_POINT == 32
+constexpr int kFracBits = 31;
+constexpr float kSampleMax = 2147483647.0f;
+
+// Q15 sample * Q15 window = Q30, promoted to Q31
+inline kiss_fft_scalar windowSample(int16_t pcm, int16_t window) {
+  return (kiss_fft_scalar)((int32_t)pcm * window) * 2;
+}
+#else
+constexpr int kFracBits = 15;
+constexpr float kSampleMax = 32767.0f;
+
+// Q15 * Q15, rounded back to Q15
+inline kiss_fft_scalar windowSample(int16_t pcm, int16_t window) {
+  return (kiss_fft_scalar)(((int32_t)pcm * window + (1 << 14)) >> 15);
+}
+#endif
+
+// Headroom for block floating point so rounding never overflows
+constexpr float kBlockFullScale = kSampleMax * 0.99f;
+
+// This copy of kiss_fftr packs the Nyquist term into freqdata[0].i (vDSP
+// style). Fixed-point KissFFT also divides by the radix at every stage,
+// i.e. returns the DFT / nfft, which `scale` undoes.
+class KissFixedFft final : public FixedPointFft {
+public:
+  explicit KissFixedFft(int nfft) : nfft_(nfft) {
+    cfg_ = kiss_fftr_alloc(nfft, 0, nullptr, nullptr);
+    in_.resize(nfft);
+    out_.resize(nfft / 2 + 1);
+  }
+  ~KissFixedFft() override {
+    if (cfg_)
+      kiss_fftr_free(cfg_);
+  }
+
+  bool isValid() const { return cfg_ != nullptr; }
+
+  int size() const override { return nfft_; }
+  FftBackendType type() const override { return RTA_FIXED_FFT_TYPE; }
+  const char *name() const override { return RTA_FIXED_FFT_NAME; }
+
+  void forwardPcm16(const int16_t *pcm, const int16_t *window, float *re,
+                    float *im) override {
+    kiss_fft_scalar *in = in_.data();
+    for (int i = 0; i < nfft_; ++i)
+      in[i] = windowSample(pcm[i], window[i]);
+    run((float)nfft_ / (float)(1LL << kFracBits), re, im);
+  }
+
+  void forward(const float *input, float *re, float *im) override {
+    float peak = 0.0f;
+    for (int i = 0; i < nfft_; ++i)
+      peak = std::max(peak, std::fabs(input[i]));
+    if (!(peak > 0.0f)) {
+      std::fill(re, re + nfft_ / 2 + 1, 0.0f);
+      std::fill(im, im + nfft_ / 2 + 1, 0.0f);
+      return;
+    }
+    const float gain = kBlockFullScale / peak;
+    kiss_fft_scalar *in = in_.data();
+    for (int i = 0; i < nfft_; ++i)
+      in[i] = (kiss_fft_scalar)std::lrint(input[i] * gain);
+    run((float)nfft_ / gain, re, im);
+  }
+
+private:
+  void run(float scale, float *re, float *im) {
+    kiss_fftr(cfg_, in_.data(), out_.data());
+
+    const int half = nfft_ / 2;
+    re[0] = (float)out_[0].r * scale;
+    im[0] = 0.0f;
+    for (int k = 1; k < half; ++k) {
+      re[k] = (float)out_[k].r * scale;
+      im[k] = (float)out_[k].i * scale;
+    }
+    re[half] = (float)out_[0].i * scale;
+    im[half] = 0.0f;
+  }
+
+  int nfft_;
+  kiss_fftr_cfg cfg_ = nullptr;
+  std::vector<kiss_fft_scalar> in_;
+  std::vector<kiss_fft_cpx> out_;
+};
+
+std::unique_ptr<FftBackend> createKissFixed(int nfft) {
+  if (nfft <= 0 || (nfft & 1))
+    return nullptr;
+  std::unique_ptr<KissFixedFft> fft(new (std::nothrow) KissFixedFft(nfft));
+  if (!fft || !fft->isValid())
+    return nullptr;
+  return fft;
+}
+
+} // namespace
+
+} // namespace realtimeaudio
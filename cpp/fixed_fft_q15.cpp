@@ -0,0 +1,13 @@
+#include "kiss_fft_fixed/kiss_fft_q15.h"
+
+#define RTA_FIXED_FFT_TYPE FftBackendType::KissQ15
+#define RTA_FIXED_FFT_NAME "kissfft-q15"
+#include "fixed_fft_impl.h"
+
+namespace realtimeaudio {
+
+std::unique_ptr<FftBackend> createKissQ15(int nfft) {
+  return createKissFixed(nfft);
+}
+
+} // namespace realtimeaudio
@@ -0,0 +1,42 @@
+#include "frame_bindings.h"
+
+namespace realtimeaudio {
+
+namespace jsi = facebook::jsi;
+
+namespace {
+
+// Zero-copy jsi::MutableBuffer over a FrameStore or SpectrogramHistory
+template <typename Memory> class SharedBuffer : public jsi::MutableBuffer {
+public:
+  explicit SharedBuffer(std::shared_ptr<Memory> memory)
+      : memory_(std::move(memory)) {}
+
+  size_t size() const override { return memory_->size(); }
+  uint8_t *data() override { return memory_->data(); }
+
+private:
+  std::shared_ptr<Memory> memory_;
+};
+
+template <typename Memory>
+void installBuffer(jsi::Runtime &runtime, const char *name,
+                   std::shared_ptr<Memory> memory) {
+  auto buffer = std::make_shared<SharedBuffer<Memory>>(std::move(memory));
+  jsi::ArrayBuffer arrayBuffer(runtime, std::move(buffer));
+  runtime.global().setProperty(runtime, name, std::move(arrayBuffer));
+}
+
+} // namespace
+
+void installFrameBindings(jsi::Runtime &runtime,
+                          std::shared_ptr<FrameStore> store) {
+  installBuffer(runtime, kFrameBufferGlobal, std::move(store));
+}
+
+void installHistoryBindings(jsi::Runtime &runtime,
+                            std::shared_ptr<SpectrogramHistory> history) {
+  installBuffer(runtime, kHistoryBufferGlobal, std::move(history));
+}
+
+} // namespace realtimeaudio
@@ -0,0 +1,33 @@
+#ifndef REALTIMEAUDIO_FRAME_BINDINGS_H
+#define REALTIMEAUDIO_FRAME_BINDINGS_H
+
+#include "frame_store.h"
+#include "spectrogram_history.h"
+
+#include <jsi/jsi.h>
+#include <memory>
+
+namespace realtimeaudio {
+
+// Global the frame ArrayBuffer is installed under (see src/frameBuffer.ts).
+constexpr const char *kFrameBufferGlobal = "__RealtimeAudioAnalyzerFrameBuffer";
+
+// Exposes `store` to JS as an ArrayBuffer backed by the store's own memory.
+// The buffer holds a reference, so the memory outlives the native module if
+// JS keeps the buffer. Must be called on the JS thread.
+void installFrameBindings(facebook::jsi::Runtime &runtime,
+                          std::shared_ptr<FrameStore> store);
+
+// Global the spectrogram history is installed under (see
+// src/spectrogramHistory.ts).
+constexpr const char *kHistoryBufferGlobal =
+    "__RealtimeAudioAnalyzerHistoryBuffer";
+
+// Same as installFrameBindings() for a SpectrogramHistory; replaces any
+// previously installed history buffer.
+void installHistoryBindings(facebook::jsi::Runtime &runtime,
+                            std::shared_ptr<SpectrogramHistory> history);
+
+} // namespace realtimeaudio
+
+#endif // REALTIMEAUDIO_FRAME_BINDINGS_H
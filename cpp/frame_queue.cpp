@@ -0,0 +1,117 @@
+#include "frame_queue.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace realtimeaudio {
+
+FrameQueue::FrameQueue(uint32_t slots, uint32_t capacity)
+    : slots_(std::max<uint32_t>(slots, 2)), capacity_(capacity) {
+  storage_.assign((size_t)slots_ * capacity_, 0.0f);
+  ring_.reset(new Slot[slots_]);
+  for (uint32_t i = 0; i < slots_; ++i)
+    ring_[i].data = storage_.data() + (size_t)i * capacity_;
+}
+
+void FrameQueue::clampTo(FrameInfo &info, uint32_t capacity) {
+  info.bins = std::min(info.bins, capacity);
+  info.channels = std::min<uint32_t>(info.channels, 2);
+  if (info.channels > 0)
+    info.channelBins = std::min(info.channelBins,
+                                (capacity - info.bins) / info.channels);
+  else
+    info.channelBins = 0;
+}
+
+float *FrameQueue::beginPush() {
+  const uint64_t head = head_.load(std::memory_order_relaxed);
+  uint64_t tail = tail_.load(std::memory_order_acquire);
+  // Full: drop the oldest frame. A failed CAS means the consumer just took
+  // it, which frees the slot just as well.
+  while (head - tail >= slots_) {
+    if (tail_.compare_exchange_weak(tail, tail + 1, std::memory_order_acq_rel,
+                                    std::memory_order_acquire)) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      break;
+    }
+  }
+  // Mark the slot as being written before any of it changes, so a consumer
+  // still copying the dropped frame sees the sequence move
+  Slot &slot = slotAt(head);
+  slot.sequence.store(sequenceOf(head) - 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  return slot.data;
+}
+
+void FrameQueue::endPush(const FrameInfo &info) {
+  const uint64_t head = head_.load(std::memory_order_relaxed);
+  Slot &slot = slotAt(head);
+  slot.info = info;
+  clampTo(slot.info, capacity_);
+  slot.sequence.store(sequenceOf(head), std::memory_order_release);
+  head_.store(head + 1, std::memory_order_release);
+  pushed_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FrameQueue::push(const FrameInfo &info, const float *bins) {
+  float *dst = beginPush();
+  const uint32_t count = bins ? std::min(info.bins, capacity_) : 0;
+  if (count > 0)
+    std::memcpy(dst, bins, count * sizeof(float));
+  FrameInfo copy = info;
+  copy.bins = count;
+  copy.channels = 0;
+  endPush(copy);
+}
+
+bool FrameQueue::pop(FrameInfo &info, float *out, uint32_t outCapacity) {
+  uint64_t tail = tail_.load(std::memory_order_acquire);
+  for (;;) {
+    const uint64_t head = head_.load(std::memory_order_acquire);
+    if (tail >= head)
+      return false;
+
+    const Slot &slot = slotAt(tail);
+    const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence != sequenceOf(tail)) {
+      // Already being rewritten: the frame was dropped, try the next one
+      tail = tail_.load(std::memory_order_acquire);
+      continue;
+    }
+    // The counts may be torn if the frame is rewritten meanwhile; clamping
+    // them again keeps every read inside the slot until the check below
+    FrameInfo stored = slot.info;
+    clampTo(stored, capacity_);
+    info = stored;
+    clampTo(info, outCapacity);
+    // Main bins, then the channel spectra packed right after them
+    if (info.bins > 0)
+      std::memcpy(out, slot.data, info.bins * sizeof(float));
+    for (uint32_t c = 0; c < info.channels && info.channelBins > 0; ++c)
+      std::memcpy(out + info.bins + c * info.channelBins,
+                  slot.data + stored.bins + c * stored.channelBins,
+                  info.channelBins * sizeof(float));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+      tail = tail_.load(std::memory_order_acquire);
+      continue;
+    }
+
+    // Keep the copy only if the producer did not drop this frame meanwhile;
+    // on failure `tail` is reloaded and the next oldest frame is tried
+    if (tail_.compare_exchange_strong(tail, tail + 1,
+                                      std::memory_order_acq_rel,
+                                      std::memory_order_acquire)) {
+      popped_.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+}
+
+uint32_t FrameQueue::size() const {
+  const uint64_t tail = tail_.load(std::memory_order_acquire);
+  const uint64_t head = head_.load(std::memory_order_acquire);
+  return head > tail ? (uint32_t)(head - tail) : 0;
+}
+
+} // namespace realtimeaudio
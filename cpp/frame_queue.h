@@ -0,0 +1,110 @@
+#ifndef REALTIMEAUDIO_FRAME_QUEUE_H
+#define REALTIMEAUDIO_FRAME_QUEUE_H
+
+#include "level_meter.h"
+#include "pcm_kernel.h"
+#include "spectral_features.h"
+#include "voice_activity.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace realtimeaudio {
+
+// Per-frame values carried alongside the spectrum.
+struct FrameInfo {
+  double timestampMs = 0.0;
+  float rms = 0.0f;
+  float peak = 0.0f;
+  uint32_t bins = 0;       // valid floats in the frame's data
+  uint32_t bufferSize = 0; // samples in the read that produced the frame
+  uint32_t fftSize = 0;
+  int64_t pushedNs = 0; // PerfStats::nowNs() at push, for the queue wait
+  SpectralFeatures features; // enabled features of the frame, else zeros
+  MeterLevels meters; // when the analyzer's meters are enabled
+  VoiceActivity voice; // when the analyzer's gate is enabled
+  // Stereo channel modes: `channels` spectra of `channelBins` floats each
+  // follow the frame's `bins` in its data, plus per-channel levels
+  uint32_t channels = 0;
+  uint32_t channelBins = 0;
+  FrameStats channelLevels[2];
+  // SubscriberGraph frames: the subscriber's id; -1 for the main stream
+  int32_t subscriber = -1;
+
+  uint32_t floats() const { return bins + channels * channelBins; }
+};
+
+// Fixed-size single-producer/single-consumer ring of analysis frames.
+//
+// The producer (capture thread) never waits: when the ring is full it drops
+// the oldest queued frame and counts an overrun. Dropping moves the read
+// index, so both sides advance it with a CAS. A dropped slot can be
+// rewritten while the consumer copies it, so every slot also carries a
+// sequence (a seqlock, as in FrameStore): the consumer copies a frame out,
+// bounded by the slot's capacity whatever the counts read, and keeps the
+// copy only if the sequence was unchanged around it and its CAS wins. A
+// frame overwritten mid-copy is discarded rather than delivered torn. All
+// storage is allocated up front.
+class FrameQueue {
+public:
+  FrameQueue(uint32_t slots, uint32_t capacity);
+
+  FrameQueue(const FrameQueue &) = delete;
+  FrameQueue &operator=(const FrameQueue &) = delete;
+
+  uint32_t slots() const { return slots_; }
+  uint32_t capacity() const { return capacity_; }
+
+  // Producer. beginPush() returns `capacity()` writable floats for the next
+  // frame (making room first if needed); endPush() makes it visible, with
+  // `info.bins` and `info.channelBins` clamped to fit.
+  float *beginPush();
+  void endPush(const FrameInfo &info);
+
+  // beginPush() + copy of `info.bins` floats (clamped) + endPush().
+  void push(const FrameInfo &info, const float *bins);
+
+  // Consumer. Copies the oldest frame's data into `out` (up to
+  // `outCapacity` floats, with the counts in `info` clamped to match).
+  // False when empty.
+  bool pop(FrameInfo &info, float *out, uint32_t outCapacity);
+
+  // Frames currently queued (approximate while the producer runs).
+  uint32_t size() const;
+
+  // Counters since construction
+  uint64_t pushed() const { return pushed_.load(std::memory_order_relaxed); }
+  uint64_t popped() const { return popped_.load(std::memory_order_relaxed); }
+  uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+  struct Slot {
+    // 2 * (index + 1) once frame `index` is complete, odd while written
+    std::atomic<uint64_t> sequence{0};
+    FrameInfo info;
+    float *data = nullptr;
+  };
+
+  Slot &slotAt(uint64_t index) { return ring_[index % slots_]; }
+  static uint64_t sequenceOf(uint64_t index) { return 2 * (index + 1); }
+  // Clamps the counts of `info` so its data fits in `capacity` floats
+  static void clampTo(FrameInfo &info, uint32_t capacity);
+
+  uint32_t slots_;
+  uint32_t capacity_;
+  std::unique_ptr<Slot[]> ring_; // atomics, so not a vector
+  std::vector<float> storage_;
+
+  // Monotonic indices; head is written only by the producer
+  std::atomic<uint64_t> head_{0};
+  std::atomic<uint64_t> tail_{0};
+
+  std::atomic<uint64_t> pushed_{0};
+  std::atomic<uint64_t> popped_{0};
+  std::atomic<uint64_t> dropped_{0};
+};
+
+} // namespace realtimeaudio
+
+#endif // REALTIMEAUDIO_FRAME_QUEUE_H
@@ -0,0 +1,66 @@
+#include "frame_store.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace realtimeaudio {
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "JS reads the sequence words as plain u32");
+
+FrameStore::FrameStore(uint32_t capacity)
+    : capacity_((capacity + 1) & ~1u), // even, so slots stay 8-byte aligned
+      slot_stride_(sizeof(SlotHeader) + capacity_ * sizeof(float)),
+      memory_(sizeof(Header) + kSlots * slot_stride_, 0) {
+  Header *h = new (memory_.data()) Header;
+  h->sequence.store(0, std::memory_order_relaxed);
+  h->slot.store(0, std::memory_order_relaxed);
+  h->slotCount = kSlots;
+  h->capacity = capacity_;
+  for (uint32_t i = 0; i < kSlots; ++i) {
+    SlotHeader *s = new (slot(i)) SlotHeader;
+    s->sequence.store(0, std::memory_order_relaxed);
+    s->bins = 0;
+    s->rms = 0.0f;
+    s->peak = 0.0f;
+    s->timestamp = 0.0;
+  }
+}
+
+float *FrameStore::beginFrame() {
+  // Never the published slot, so a reader of the current frame is untouched
+  writing_ = (header()->slot.load(std::memory_order_relaxed) + 1) % kSlots;
+  SlotHeader *s = slot(writing_);
+  s->sequence.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  return reinterpret_cast<float *>(s + 1);
+}
+
+void FrameStore::endFrame(uint32_t bins, float rms, float peak,
+                          double timestampMs) {
+  SlotHeader *s = slot(writing_);
+  s->bins = std::min(bins, capacity_);
+  s->rms = rms;
+  s->peak = peak;
+  s->timestamp = timestampMs;
+
+  const uint32_t seq = next_sequence_;
+  next_sequence_ = (seq == UINT32_MAX) ? 1 : seq + 1; // 0 stays "none"
+
+  s->sequence.store(seq, std::memory_order_release);
+  Header *h = header();
+  h->slot.store(writing_, std::memory_order_relaxed);
+  h->sequence.store(seq, std::memory_order_release);
+}
+
+void FrameStore::publish(const float *bins, uint32_t count, float rms,
+                         float peak, double timestampMs) {
+  float *dst = beginFrame();
+  count = std::min(count, capacity_);
+  if (bins != nullptr && count > 0)
+    memcpy(dst, bins, sizeof(float) * count);
+  endFrame(bins != nullptr ? count : 0, rms, peak, timestampMs);
+}
+
+} // namespace realtimeaudio
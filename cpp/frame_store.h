@@ -0,0 +1,93 @@
+#ifndef REALTIMEAUDIO_FRAME_STORE_H
+#define REALTIMEAUDIO_FRAME_STORE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace realtimeaudio {
+
+// Double-buffered analysis frames in one flat block of memory that is exposed
+// to JS as an ArrayBuffer, so spectra reach JS without any serialization.
+//
+// Layout (native endianness, mirrored by src/frameBuffer.ts):
+//
+//   header   u32 sequence     last published frame (0 = none yet)
+//            u32 slot         slot holding `sequence`
+//            u32 slotCount    kSlots
+//            u32 capacity     floats per slot
+//   slot[i]  u32 sequence     frame in this slot, 0 while being written
+//            u32 bins         valid floats in `data`
+//            f32 rms, f32 peak
+//            f64 timestamp    milliseconds since the epoch
+//            f32 data[capacity]
+//
+// A single writer (the analysis thread) fills the slot that is not
+// published, then publishes it by bumping the sequence. Readers take
+// (sequence, slot), read the slot and accept it only if the slot's sequence
+// still matches, i.e. a seqlock with two slots so the writer never blocks.
+class FrameStore {
+public:
+  static constexpr uint32_t kSlots = 2;
+
+  explicit FrameStore(uint32_t capacity);
+
+  FrameStore(const FrameStore &) = delete;
+  FrameStore &operator=(const FrameStore &) = delete;
+
+  uint32_t capacity() const { return capacity_; }
+  uint32_t sequence() const {
+    return header()->sequence.load(std::memory_order_acquire);
+  }
+
+  uint8_t *data() { return memory_.data(); }
+  size_t size() const { return memory_.size(); }
+
+  // Two-phase write so producers can fill the slot in place (e.g. straight
+  // from a JNI array). beginFrame() returns `capacity()` writable floats.
+  float *beginFrame();
+  void endFrame(uint32_t bins, float rms, float peak, double timestampMs);
+
+  // beginFrame() + copy of `count` bins (clamped to capacity) + endFrame().
+  void publish(const float *bins, uint32_t count, float rms, float peak,
+               double timestampMs);
+
+private:
+  struct Header {
+    std::atomic<uint32_t> sequence;
+    std::atomic<uint32_t> slot;
+    uint32_t slotCount;
+    uint32_t capacity;
+  };
+  struct SlotHeader {
+    std::atomic<uint32_t> sequence;
+    uint32_t bins;
+    float rms;
+    float peak;
+    double timestamp;
+  };
+  static_assert(sizeof(Header) == 16, "header layout is shared with JS");
+  static_assert(sizeof(SlotHeader) == 24, "slot layout is shared with JS");
+
+  Header *header() { return reinterpret_cast<Header *>(memory_.data()); }
+  const Header *header() const {
+    return reinterpret_cast<const Header *>(memory_.data());
+  }
+  SlotHeader *slot(uint32_t index) {
+    return reinterpret_cast<SlotHeader *>(memory_.data() + sizeof(Header) +
+                                          index * slot_stride_);
+  }
+
+  uint32_t capacity_;
+  size_t slot_stride_;
+  std::vector<uint8_t> memory_; // 8-byte aligned via operator new
+
+  // Writer-side state
+  uint32_t next_sequence_ = 1;
+  uint32_t writing_ = 0;
+};
+
+} // namespace realtimeaudio
+
+#endif // REALTIMEAUDIO_FRAME_STORE_H
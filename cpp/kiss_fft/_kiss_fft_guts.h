@@ -4,6 +4,20 @@
 #define MIN(n, m) ((n) < (m) ? (n) : (m))
 #define MAX(n, m) ((n) > (m) ? (n) : (m))
 
+/*
+  KISS_FFT_SIMD (set per ABI by android/CMakeLists.txt and by the podspec)
+  enables a NEON / SSE2
+  radix-4 butterfly for float builds. Unlike USE_SIMD, which batches four
+  independent transforms into one __m128 scalar, it vectorizes a single
+  transform across four consecutive butterflies, using per-stage twiddle
+  tables in split (re[], im[]) layout. Stages it cannot handle (m % 4 != 0)
+  and targets without NEON/SSE2 keep the scalar butterfly.
+ */
+#if defined(KISS_FFT_SIMD) && !defined(FIXED_POINT) && !defined(USE_SIMD) &&  \
+    (defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(__SSE2__))
+#define KISS_FFT_VECTOR_BFLY4 1
+#endif
+
 /*
   Explanation of macros dealing with complex math:
 
@@ -170,6 +184,12 @@ struct kiss_fft_state {
   int nfft;
   int inverse;
   int factors[2 * 32];
+#ifdef KISS_FFT_VECTOR_BFLY4
+  /* Per-stage split twiddles (tw1, tw2, tw3 as re[m], im[m] pairs), indexed
+     by stage depth; NULL for stages handled by the scalar butterfly. The
+     tables live in the same allocation, after the twiddles. */
+  const float *stage_twiddles[32];
+#endif
   kiss_fft_cpx twiddles[1];
 };
 
@@ -76,6 +76,120 @@ static void kf_bfly4(kiss_fft_cpx *Fout, const size_t fstride,
   } while (--k);
 }
 
+#ifdef KISS_FFT_VECTOR_BFLY4
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+typedef float32x4_t kf_v4;
+#define V4_LOAD(p) vld1q_f32(p)
+#define V4_ADD(a, b) vaddq_f32(a, b)
+#define V4_SUB(a, b) vsubq_f32(a, b)
+#define V4_MUL(a, b) vmulq_f32(a, b)
+/* Deinterleave / interleave four kiss_fft_cpx */
+#define V4_LOAD_CPX(p, re, im)                                                 \
+  do {                                                                         \
+    float32x4x2_t v_ = vld2q_f32((const float *)(p));                          \
+    (re) = v_.val[0];                                                          \
+    (im) = v_.val[1];                                                          \
+  } while (0)
+#define V4_STORE_CPX(p, re, im)                                                \
+  do {                                                                         \
+    float32x4x2_t v_;                                                          \
+    v_.val[0] = (re);                                                          \
+    v_.val[1] = (im);                                                          \
+    vst2q_f32((float *)(p), v_);                                               \
+  } while (0)
+#else
+#include <emmintrin.h>
+typedef __m128 kf_v4;
+#define V4_LOAD(p) _mm_loadu_ps(p)
+#define V4_ADD(a, b) _mm_add_ps(a, b)
+#define V4_SUB(a, b) _mm_sub_ps(a, b)
+#define V4_MUL(a, b) _mm_mul_ps(a, b)
+#define V4_LOAD_CPX(p, re, im)                                                 \
+  do {                                                                         \
+    __m128 lo_ = _mm_loadu_ps((const float *)(p));                             \
+    __m128 hi_ = _mm_loadu_ps((const float *)(p) + 4);                         \
+    (re) = _mm_shuffle_ps(lo_, hi_, _MM_SHUFFLE(2, 0, 2, 0));                  \
+    (im) = _mm_shuffle_ps(lo_, hi_, _MM_SHUFFLE(3, 1, 3, 1));                  \
+  } while (0)
+#define V4_STORE_CPX(p, re, im)                                                \
+  do {                                                                         \
+    _mm_storeu_ps((float *)(p), _mm_unpacklo_ps(re, im));                      \
+    _mm_storeu_ps((float *)(p) + 4, _mm_unpackhi_ps(re, im));                  \
+  } while (0)
+#endif
+
+/* Same math as kf_bfly4, four butterflies at a time (requires m % 4 == 0) */
+static void kf_bfly4_vec(kiss_fft_cpx *Fout, const kiss_fft_cfg st,
+                         const size_t m, const float *tw)
+{
+  const float *tw1r = tw, *tw1i = tw + m;
+  const float *tw2r = tw + 2 * m, *tw2i = tw + 3 * m;
+  const float *tw3r = tw + 4 * m, *tw3i = tw + 5 * m;
+  size_t k;
+
+  for (k = 0; k < m; k += 4)
+  {
+    kf_v4 ar, ai, br, bi, cr, ci, dr, di, tr, ti;
+    kf_v4 s0r, s0i, s1r, s1i, s2r, s2i, s3r, s3i, s4r, s4i, s5r, s5i;
+
+    V4_LOAD_CPX(Fout + k, ar, ai);
+    V4_LOAD_CPX(Fout + k + m, br, bi);
+    V4_LOAD_CPX(Fout + k + 2 * m, cr, ci);
+    V4_LOAD_CPX(Fout + k + 3 * m, dr, di);
+
+    tr = V4_LOAD(tw1r + k);
+    ti = V4_LOAD(tw1i + k);
+    s0r = V4_SUB(V4_MUL(br, tr), V4_MUL(bi, ti));
+    s0i = V4_ADD(V4_MUL(br, ti), V4_MUL(bi, tr));
+    tr = V4_LOAD(tw2r + k);
+    ti = V4_LOAD(tw2i + k);
+    s1r = V4_SUB(V4_MUL(cr, tr), V4_MUL(ci, ti));
+    s1i = V4_ADD(V4_MUL(cr, ti), V4_MUL(ci, tr));
+    tr = V4_LOAD(tw3r + k);
+    ti = V4_LOAD(tw3i + k);
+    s2r = V4_SUB(V4_MUL(dr, tr), V4_MUL(di, ti));
+    s2i = V4_ADD(V4_MUL(dr, ti), V4_MUL(di, tr));
+
+    s5r = V4_SUB(ar, s1r);
+    s5i = V4_SUB(ai, s1i);
+    ar = V4_ADD(ar, s1r);
+    ai = V4_ADD(ai, s1i);
+    s3r = V4_ADD(s0r, s2r);
+    s3i = V4_ADD(s0i, s2i);
+    s4r = V4_SUB(s0r, s2r);
+    s4i = V4_SUB(s0i, s2i);
+
+    V4_STORE_CPX(Fout + k + 2 * m, V4_SUB(ar, s3r), V4_SUB(ai, s3i));
+    V4_STORE_CPX(Fout + k, V4_ADD(ar, s3r), V4_ADD(ai, s3i));
+
+    if (st->inverse)
+    {
+      V4_STORE_CPX(Fout + k + m, V4_SUB(s5r, s4i), V4_ADD(s5i, s4r));
+      V4_STORE_CPX(Fout + k + 3 * m, V4_ADD(s5r, s4i), V4_SUB(s5i, s4r));
+    }
+    else
+    {
+      V4_STORE_CPX(Fout + k + m, V4_ADD(s5r, s4i), V4_SUB(s5i, s4r));
+      V4_STORE_CPX(Fout + k + 3 * m, V4_SUB(s5r, s4i), V4_ADD(s5i, s4r));
+    }
+  }
+}
+
+#define KF_BFLY4(Fout, fstride, st, m, stage)                                  \
+  do {                                                                         \
+    if ((st)->stage_twiddles[stage])                                           \
+      kf_bfly4_vec(Fout, st, m, (st)->stage_twiddles[stage]);                  \
+    else                                                                       \
+      kf_bfly4(Fout, fstride, st, m);                                          \
+  } while (0)
+
+#else
+#define KF_BFLY4(Fout, fstride, st, m, stage)                                  \
+  ((void)(stage), kf_bfly4(Fout, fstride, st, m))
+#endif /* KISS_FFT_VECTOR_BFLY4 */
+
 static void kf_bfly3(kiss_fft_cpx *Fout, const size_t fstride,
                      const kiss_fft_cfg st, size_t m)
 {
@@ -195,6 +309,7 @@ static void kf_work(kiss_fft_cpx *Fout, const kiss_fft_cpx *f,
                     const kiss_fft_cfg st)
 {
   kiss_fft_cpx *Fout_beg = Fout;
+  const int stage = (int)(factors - st->factors) / 2;
   const int p = *factors++; /* the radix  */
   const int m = *factors++; /* stage's fft nfft/p */
   const kiss_fft_cpx *Fout_end = Fout + p * m;
@@ -222,7 +337,7 @@ static void kf_work(kiss_fft_cpx *Fout, const kiss_fft_cpx *f,
       kf_bfly3(Fout, fstride, st, m);
       break;
     case 4:
-      kf_bfly4(Fout, fstride, st, m);
+      KF_BFLY4(Fout, fstride, st, m, stage);
       break;
     case 5:
       kf_bfly5(Fout, fstride, st, m);
@@ -267,7 +382,7 @@ static void kf_work(kiss_fft_cpx *Fout, const kiss_fft_cpx *f,
     kf_bfly3(Fout, fstride, st, m);
     break;
   case 4:
-    kf_bfly4(Fout, fstride, st, m);
+    KF_BFLY4(Fout, fstride, st, m, stage);
     break;
   case 5:
     kf_bfly5(Fout, fstride, st, m);
@@ -327,6 +442,22 @@ kiss_fft_cfg kiss_fft_alloc(int nfft, int inverse_fft, void *mem,
   kiss_fft_cfg st = NULL;
   size_t memneeded = sizeof(struct kiss_fft_state) +
                      sizeof(kiss_fft_cpx) * (nfft - 1); /* twiddle factors*/
+#ifdef KISS_FFT_VECTOR_BFLY4
+  int facbuf[2 * 32];
+  int s;
+  size_t stagefloats = 0;
+
+  /* Room for the split twiddle tables of every vectorizable radix-4 stage */
+  kf_factor(nfft, facbuf);
+  for (s = 0;; ++s)
+  {
+    if (facbuf[2 * s] == 4 && facbuf[2 * s + 1] % 4 == 0)
+      stagefloats += 6 * (size_t)facbuf[2 * s + 1];
+    if (facbuf[2 * s + 1] == 1)
+      break;
+  }
+  memneeded += sizeof(float) * stagefloats;
+#endif
 
   if (lenmem == NULL)
   {
@@ -355,6 +486,40 @@ kiss_fft_cfg kiss_fft_alloc(int nfft, int inverse_fft, void *mem,
     }
 
     kf_factor(nfft, st->factors);
+
+#ifdef KISS_FFT_VECTOR_BFLY4
+    {
+      float *table = (float *)(st->twiddles + nfft);
+      size_t fstride = 1;
+
+      for (s = 0; s < 32; ++s)
+        st->stage_twiddles[s] = NULL;
+
+      for (s = 0;; ++s)
+      {
+        const int p = st->factors[2 * s];
+        const size_t m = (size_t)st->factors[2 * s + 1];
+        if (p == 4 && m % 4 == 0)
+        {
+          size_t k;
+          for (k = 0; k < m; ++k)
+          {
+            table[k] = st->twiddles[k * fstride].r;
+            table[m + k] = st->twiddles[k * fstride].i;
+            table[2 * m + k] = st->twiddles[2 * k * fstride].r;
+            table[3 * m + k] = st->twiddles[2 * k * fstride].i;
+            table[4 * m + k] = st->twiddles[3 * k * fstride].r;
+            table[5 * m + k] = st->twiddles[3 * k * fstride].i;
+          }
+          st->stage_twiddles[s] = table;
+          table += 6 * m;
+        }
+        fstride *= p;
+        if (m == 1)
+          break;
+      }
+    }
+#endif
   }
   return st;
 }
@@ -0,0 +1,5 @@
+/* KissFFT sources compiled as Q15 under the kiss_q15_ prefix */
+#include "kiss_fft_q15.h"
+
+#include "../kiss_fft/kiss_fft.c"
+#include "../kiss_fft/kiss_fftr.c"
@@ -0,0 +1,29 @@
+#ifndef KISS_FFT_Q15_H
+#define KISS_FFT_Q15_H
+
+/*
+ Q15 build of the bundled KissFFT. Every public symbol and type is renamed
+ to a kiss_q15_ prefix so the fixed-point copy links next to the float one;
+ a translation unit includes either this header or kiss_fft/kiss_fftr.h,
+ never both.
+ */
+
+#define FIXED_POINT 16
+
+#define kiss_fft_state kiss_q15_fft_state
+#define kiss_fft_cfg kiss_q15_fft_cfg
+#define kiss_fft_cpx kiss_q15_fft_cpx
+#define kiss_fft_alloc kiss_q15_fft_alloc
+#define kiss_fft kiss_q15_fft
+#define kiss_fft_stride kiss_q15_fft_stride
+#define kiss_fft_cleanup kiss_q15_fft_cleanup
+#define kiss_fft_next_fast_size kiss_q15_fft_next_fast_size
+#define kiss_fftr_state kiss_q15_fftr_state
+#define kiss_fftr_cfg kiss_q15_fftr_cfg
+#define kiss_fftr_alloc kiss_q15_fftr_alloc
+#define kiss_fftr kiss_q15_fftr
+#define kiss_fftri kiss_q15_fftri
+
+#include "../kiss_fft/kiss_fftr.h"
+
+#endif
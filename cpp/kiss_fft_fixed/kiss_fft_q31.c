@@ -0,0 +1,5 @@
+/* KissFFT sources compiled as Q31 under the kiss_q31_ prefix */
+#include "kiss_fft_q31.h"
+
+#include "../kiss_fft/kiss_fft.c"
+#include "../kiss_fft/kiss_fftr.c"
@@ -0,0 +1,246 @@
+#include "level_meter.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace realtimeaudio {
+
+namespace {
+
+constexpr float kPcm16Scale = 1.0f / 32768.0f;
+
+// Loudness of a K-weighted mean square (BS.1770: -0.691 + 10 log10)
+float lufs(double meanSquare) {
+  if (!(meanSquare > 0.0))
+    return kSilenceLufs;
+  return std::max(kSilenceLufs,
+                  (float)(-0.691 + 10.0 * std::log10(meanSquare)));
+}
+
+} // namespace
+
+void LevelMeter::configure(const MeterSettings &settings, float sampleRate) {
+  if (!(sampleRate > 0.0f)) {
+    disable();
+    return;
+  }
+  settings_.windowMs = std::max(settings.windowMs, 0.0f);
+  settings_.attackMs = std::max(settings.attackMs, 0.0f);
+  settings_.releaseMs = std::max(settings.releaseMs, 0.0f);
+  settings_.holdMs = std::max(settings.holdMs, 0.0f);
+  sample_rate_ = sampleRate;
+
+  const double perMs = sampleRate / 1000.0;
+  squares_.assign((size_t)std::max(1L, std::lround(settings_.windowMs * perMs)),
+                  0.0f);
+  hold_window_ = std::max(
+      1, (int)std::ceil(settings_.holdMs * perMs / (double)kHoldChunk));
+  hold_values_.assign((size_t)hold_window_ + 1, 0.0f);
+  hold_chunks_.assign((size_t)hold_window_ + 1, 0);
+  block_size_ = std::max(1, (int)std::lround(sampleRate / 10.0));
+
+  // K-weighting for this rate (BS.1770 pre-filter, bilinear design): a
+  // +4 dB high shelf around 1.7 kHz, then a 38 Hz high-pass
+  const double pi = 3.14159265358979323846;
+  Biquad shelf;
+  {
+    const double f0 = 1681.974450955533;
+    const double gainDb = 3.999843853973347;
+    const double q = 0.7071752369554196;
+    const double k = std::tan(pi * f0 / sampleRate);
+    const double vh = std::pow(10.0, gainDb / 20.0);
+    const double vb = std::pow(vh, 0.4996667741545416);
+    const double a0 = 1.0 + k / q + k * k;
+    shelf.b0 = (vh + vb * k / q + k * k) / a0;
+    shelf.b1 = 2.0 * (k * k - vh) / a0;
+    shelf.b2 = (vh - vb * k / q + k * k) / a0;
+    shelf.a1 = 2.0 * (k * k - 1.0) / a0;
+    shelf.a2 = (1.0 - k / q + k * k) / a0;
+  }
+  Biquad highpass;
+  {
+    const double f0 = 38.13547087602444;
+    const double q = 0.5003270373238773;
+    const double k = std::tan(pi * f0 / sampleRate);
+    const double a0 = 1.0 + k / q + k * k;
+    highpass.b0 = 1.0;
+    highpass.b1 = -2.0;
+    highpass.b2 = 1.0;
+    highpass.a1 = 2.0 * (k * k - 1.0) / a0;
+    highpass.a2 = (1.0 - k / q + k * k) / a0;
+  }
+  for (int c = 0; c < kMaxChannels; ++c) {
+    shelf_[c] = shelf;
+    highpass_[c] = highpass;
+  }
+  reset();
+}
+
+void LevelMeter::disable() {
+  sample_rate_ = 0.0f;
+  std::vector<float>().swap(squares_);
+  std::vector<float>().swap(hold_values_);
+  std::vector<int64_t>().swap(hold_chunks_);
+  levels_ = MeterLevels();
+}
+
+void LevelMeter::reset() {
+  levels_ = MeterLevels();
+  std::fill(squares_.begin(), squares_.end(), 0.0f);
+  square_pos_ = 0;
+  square_sum_ = 0.0;
+  hold_head_ = 0;
+  hold_count_ = 0;
+  chunk_index_ = 0;
+  chunk_max_ = 0.0f;
+  chunk_fill_ = 0;
+  for (int c = 0; c < kMaxChannels; ++c) {
+    shelf_[c].z1 = shelf_[c].z2 = 0.0;
+    highpass_[c].z1 = highpass_[c].z2 = 0.0;
+  }
+  std::fill(blocks_, blocks_ + kShortTermBlocks, 0.0);
+  block_pos_ = 0;
+  blocks_filled_ = 0;
+  block_fill_ = 0;
+  block_sum_ = 0.0;
+}
+
+template <int Channels, typename Sample>
+void LevelMeter::run(const Sample &sample, int frames) {
+  const int window = (int)squares_.size();
+  float readPeak = 0.0f;
+  for (int i = 0; i < frames; ++i) {
+    float mix;
+    double power;
+    if (Channels == 1) {
+      mix = sample(i, 0);
+      const double k = highpass_[0].process(shelf_[0].process(mix));
+      power = k * k;
+    } else {
+      const float left = sample(i, 0);
+      const float right = sample(i, 1);
+      mix = 0.5f * (left + right);
+      const double kl = highpass_[0].process(shelf_[0].process(left));
+      const double kr = highpass_[1].process(shelf_[1].process(right));
+      power = kl * kl + kr * kr;
+    }
+
+    // Sliding RMS: add the new square, drop the one leaving the window
+    const float square = mix * mix;
+    square_sum_ += (double)square - (double)squares_[square_pos_];
+    squares_[square_pos_] = square;
+    if (++square_pos_ == window) {
+      // Re-sum once per window so rounding error cannot build up
+      square_pos_ = 0;
+      double sum = 0.0;
+      for (float v : squares_)
+        sum += v;
+      square_sum_ = sum;
+    }
+
+    const float magnitude = std::fabs(mix);
+    readPeak = std::max(readPeak, magnitude);
+    chunk_max_ = std::max(chunk_max_, magnitude);
+    if (++chunk_fill_ == kHoldChunk)
+      pushHoldChunk();
+
+    block_sum_ += power;
+    if (++block_fill_ == block_size_)
+      pushBlock();
+  }
+  finishRead(frames, readPeak);
+}
+
+void LevelMeter::process(const int16_t *pcm, int frames, int channels) {
+  if (!enabled() || pcm == nullptr || frames <= 0)
+    return;
+  if (channels > 1)
+    run<2>([pcm](int i, int c) { return pcm[2 * i + c] * kPcm16Scale; },
+           frames);
+  else
+    run<1>([pcm](int i, int) { return pcm[i] * kPcm16Scale; }, frames);
+}
+
+void LevelMeter::process(const float *samples, int frames, int channels) {
+  if (!enabled() || samples == nullptr || frames <= 0)
+    return;
+  if (channels > 1)
+    run<2>([samples](int i, int c) { return samples[2 * i + c]; }, frames);
+  else
+    run<1>([samples](int i, int) { return samples[i]; }, frames);
+}
+
+void LevelMeter::processPlanar(const float *left, const float *right,
+                               int frames) {
+  if (!enabled() || left == nullptr || right == nullptr || frames <= 0)
+    return;
+  run<2>([left, right](int i, int c) { return c == 0 ? left[i] : right[i]; },
+         frames);
+}
+
+void LevelMeter::pushHoldChunk() {
+  const float value = chunk_max_;
+  chunk_max_ = 0.0f;
+  chunk_fill_ = 0;
+
+  // Smaller maxima queued earlier can never be the hold value again
+  const int capacity = (int)hold_values_.size();
+  while (hold_count_ > 0) {
+    const int back = (hold_head_ + hold_count_ - 1) % capacity;
+    if (hold_values_[back] > value)
+      break;
+    --hold_count_;
+  }
+  const int slot = (hold_head_ + hold_count_) % capacity;
+  hold_values_[slot] = value;
+  hold_chunks_[slot] = chunk_index_++;
+  ++hold_count_;
+
+  // Expire the front once it leaves the window
+  while (hold_count_ > 0 &&
+         hold_chunks_[hold_head_] < chunk_index_ - hold_window_) {
+    hold_head_ = (hold_head_ + 1) % capacity;
+    --hold_count_;
+  }
+}
+
+void LevelMeter::pushBlock() {
+  blocks_[block_pos_] = block_sum_;
+  block_pos_ = (block_pos_ + 1) % kShortTermBlocks;
+  blocks_filled_ = std::min(blocks_filled_ + 1, kShortTermBlocks);
+  block_sum_ = 0.0;
+  block_fill_ = 0;
+
+  // Until the windows fill up, the blocks seen so far are averaged
+  auto meanSquare = [this](int blocks) {
+    const int n = std::min(blocks, blocks_filled_);
+    double sum = 0.0;
+    for (int b = 1; b <= n; ++b)
+      sum += blocks_[(block_pos_ - b + kShortTermBlocks) % kShortTermBlocks];
+    return sum / ((double)n * block_size_);
+  };
+  levels_.momentaryLufs = lufs(meanSquare(kMomentaryBlocks));
+  levels_.shortTermLufs = lufs(meanSquare(kShortTermBlocks));
+}
+
+void LevelMeter::finishRead(int frames, float peak) {
+  const double seconds = (double)frames / sample_rate_;
+  const float target =
+      std::sqrt((float)(std::max(square_sum_, 0.0) / (double)squares_.size()));
+  const float tauMs =
+      target > levels_.rms ? settings_.attackMs : settings_.releaseMs;
+  const float follow =
+      tauMs > 0.0f ? (float)(1.0 - std::exp(-seconds * 1000.0 / tauMs)) : 1.0f;
+  levels_.rms += (target - levels_.rms) * follow;
+
+  const float decay =
+      settings_.releaseMs > 0.0f
+          ? (float)std::exp(-seconds * 1000.0 / settings_.releaseMs)
+          : 0.0f;
+  levels_.peak = std::max(peak, levels_.peak * decay);
+
+  const float held = hold_count_ > 0 ? hold_values_[hold_head_] : 0.0f;
+  levels_.peakHold = std::max(held, chunk_max_);
+}
+
+} // namespace realtimeaudio
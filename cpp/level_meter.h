@@ -0,0 +1,122 @@
+#ifndef REALTIMEAUDIO_LEVEL_METER_H
+#define REALTIMEAUDIO_LEVEL_METER_H
+
+#include <cstdint>
+#include <vector>
+
+namespace realtimeaudio {
+
+// Loudness reported for silence (and before the first 100 ms block)
+constexpr float kSilenceLufs = -120.0f;
+
+// Meter ballistics, in milliseconds
+struct MeterSettings {
+  float windowMs = 300.0f;  // sliding RMS window
+  float attackMs = 10.0f;   // RMS rise time constant, 0 = instant
+  float releaseMs = 300.0f; // RMS and peak fall time constant, 0 = instant
+  float holdMs = 1500.0f;   // peak hold window
+};
+
+// Readings after the latest read; levels are linear full scale.
+struct MeterLevels {
+  float rms = 0.0f;      // sliding-window RMS through attack / release
+  float peak = 0.0f;     // sample peak: instant attack, released
+  float peakHold = 0.0f; // highest sample over the hold window
+  float momentaryLufs = kSilenceLufs; // EBU R128, 400 ms K-weighted
+  float shortTermLufs = kSilenceLufs; // EBU R128, 3 s K-weighted
+};
+
+// Level meters that do not depend on the read size. Every sample goes
+// through, each costing O(1):
+//  - a running sum of squares over a ring of the last `windowMs`
+//  - a monotonic deque of 64-sample maxima for the peak hold
+//  - two K-weighting biquads per channel (ITU-R BS.1770), accumulated into
+//    100 ms blocks for the momentary (4 blocks) and short-term (30 blocks)
+//    loudness
+// Attack / release are applied per read with the read's duration, so the
+// ballistics are the same for 128- and 4096-sample reads.
+//
+// RMS and peaks describe the downmix (L + R) / 2, like the analyzer's main
+// levels. Loudness sums the K-weighted channel powers (both weighted 1.0). A
+// mono input is metered as one channel.
+//
+// Not thread-safe; owned by one Analyzer.
+class LevelMeter {
+public:
+  static constexpr int kMaxChannels = 2;
+  static constexpr int kHoldChunk = 64; // peak hold resolution, samples
+
+  // Sizes the windows for `sampleRate` and clears all state. Allocates, so
+  // call it before processing starts.
+  void configure(const MeterSettings &settings, float sampleRate);
+  // Stops metering and frees the windows.
+  void disable();
+  bool enabled() const { return sample_rate_ > 0.0f; }
+  const MeterSettings &settings() const { return settings_; }
+
+  // Clears the levels and history, keeping the configuration.
+  void reset();
+
+  // One read of `frames` frames; `channels` is 1 or 2 (interleaved).
+  void process(const int16_t *pcm, int frames, int channels);
+  void process(const float *samples, int frames, int channels);
+  void processPlanar(const float *left, const float *right, int frames);
+
+  const MeterLevels &levels() const { return levels_; }
+
+private:
+  // Transposed direct form II
+  struct Biquad {
+    double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+    double z1 = 0.0, z2 = 0.0;
+
+    double process(double x) {
+      const double y = b0 * x + z1;
+      z1 = b1 * x - a1 * y + z2;
+      z2 = b2 * x - a2 * y;
+      return y;
+    }
+  };
+
+  template <int Channels, typename Sample>
+  void run(const Sample &sample, int frames);
+  void pushHoldChunk();
+  void pushBlock();
+  // Applies the ballistics for a read of `frames` with sample peak `peak`
+  void finishRead(int frames, float peak);
+
+  MeterSettings settings_;
+  float sample_rate_ = 0.0f;
+  MeterLevels levels_;
+
+  // Sliding RMS: squared downmix samples and their sum
+  std::vector<float> squares_;
+  int square_pos_ = 0;
+  double square_sum_ = 0.0;
+
+  // Peak hold: decreasing chunk maxima, oldest first, in a ring
+  std::vector<float> hold_values_;
+  std::vector<int64_t> hold_chunks_; // chunk index of each value
+  int hold_head_ = 0;
+  int hold_count_ = 0;
+  int hold_window_ = 1; // chunks
+  int64_t chunk_index_ = 0;
+  float chunk_max_ = 0.0f;
+  int chunk_fill_ = 0;
+
+  // Loudness: K-weighting per channel and 100 ms block energies
+  Biquad shelf_[kMaxChannels];
+  Biquad highpass_[kMaxChannels];
+  static constexpr int kShortTermBlocks = 30;
+  static constexpr int kMomentaryBlocks = 4;
+  double blocks_[kShortTermBlocks] = {};
+  int block_pos_ = 0;
+  int blocks_filled_ = 0;
+  int block_size_ = 1;
+  int block_fill_ = 0;
+  double block_sum_ = 0.0;
+};
+
+} // namespace realtimeaudio
+
+#endif // REALTIMEAUDIO_LEVEL_METER_H
@@ -0,0 +1,325 @@
+#include "pcm_kernel.h"
+#include "simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace realtimeaudio {
+
+namespace {
+
+constexpr float kPcm16Scale = 1.0f / 32768.0f;
+
+// Processes samples [begin, end). Templated so the optional outputs cost no
+// branches inside the vector loop.
+template <bool kFrame, bool kWindow>
+void convertRange(const int16_t *pcm, int begin, int end, float *frame,
+                  const float *window, float *windowed, simd::v4f &sumSq,
+                  simd::v4f &peak, float &sumSqTail, float &peakTail) {
+  const simd::v4f scale = simd::splat(kPcm16Scale);
+  int i = begin;
+
+  for (; i + 8 <= end; i += 8) {
+    simd::v4f lo, hi;
+    simd::loadPcm16(pcm + i, lo, hi);
+    lo = simd::mul(lo, scale);
+    hi = simd::mul(hi, scale);
+
+    sumSq = simd::madd(sumSq, lo, lo);
+    sumSq = simd::madd(sumSq, hi, hi);
+    peak = simd::max(peak, simd::max(simd::abs(lo), simd::abs(hi)));
+
+    if (kFrame) {
+      simd::store(frame + i, lo);
+      simd::store(frame + i + 4, hi);
+    }
+    if (kWindow) {
+      simd::store(windowed + i, simd::mul(lo, simd::load(window + i)));
+      simd::store(windowed + i + 4, simd::mul(hi, simd::load(window + i + 4)));
+    }
+  }
+
+  for (; i < end; ++i) {
+    float x = pcm[i] * kPcm16Scale;
+    sumSqTail += x * x;
+    peakTail = std::max(peakTail, std::fabs(x));
+    if (kFrame)
+      frame[i] = x;
+    if (kWindow)
+      windowed[i] = x * window[i];
+  }
+}
+
+template <bool kFrame>
+void convertRangeDispatch(bool withWindow, const int16_t *pcm, int begin,
+                          int end, float *frame, const float *window,
+                          float *windowed, simd::v4f &sumSq, simd::v4f &peak,
+                          float &sumSqTail, float &peakTail) {
+  if (withWindow)
+    convertRange<kFrame, true>(pcm, begin, end, frame, window, windowed, sumSq,
+                               peak, sumSqTail, peakTail);
+  else
+    convertRange<kFrame, false>(pcm, begin, end, frame, window, windowed,
+                                sumSq, peak, sumSqTail, peakTail);
+}
+
+// RMS / peak accumulator for one channel of the stereo split
+struct Levels {
+  simd::v4f sumSq = simd::splat(0.0f);
+  simd::v4f peak = simd::splat(0.0f);
+  float sumSqTail = 0.0f;
+  float peakTail = 0.0f;
+
+  void add(simd::v4f x) {
+    sumSq = simd::madd(sumSq, x, x);
+    peak = simd::max(peak, simd::abs(x));
+  }
+  void add(float x) {
+    sumSqTail += x * x;
+    peakTail = std::max(peakTail, std::fabs(x));
+  }
+  void finish(int count, FrameStats *stats) const {
+    float total = simd::hsum(sumSq) + sumSqTail;
+    stats->rms = count > 0 ? sqrtf(total / (float)count) : 0.0f;
+    stats->peak = std::max(simd::hmax(peak), peakTail);
+  }
+};
+
+// Frame loaders: four frames as two vectors, or one frame as two floats
+struct InterleavedPcm16 {
+  const int16_t *pcm;
+  void load(int i, simd::v4f &l, simd::v4f &r) const {
+    simd::v4f lo, hi;
+    simd::loadPcm16(pcm + 2 * i, lo, hi);
+    simd::unzip(lo, hi, l, r);
+    const simd::v4f scale = simd::splat(kPcm16Scale);
+    l = simd::mul(l, scale);
+    r = simd::mul(r, scale);
+  }
+  void load(int i, float &l, float &r) const {
+    l = pcm[2 * i] * kPcm16Scale;
+    r = pcm[2 * i + 1] * kPcm16Scale;
+  }
+};
+
+struct InterleavedFloat {
+  const float *input;
+  void load(int i, simd::v4f &l, simd::v4f &r) const {
+    simd::loadDeinterleave(input + 2 * i, l, r);
+  }
+  void load(int i, float &l, float &r) const {
+    l = input[2 * i];
+    r = input[2 * i + 1];
+  }
+};
+
+struct PlanarFloat {
+  const float *left;
+  const float *right;
+  void load(int i, simd::v4f &l, simd::v4f &r) const {
+    l = simd::load(left + i);
+    r = simd::load(right + i);
+  }
+  void load(int i, float &l, float &r) const {
+    l = left[i];
+    r = right[i];
+  }
+};
+
+template <bool kMidSide, bool kA, bool kB, typename Frames>
+void splitRange(const Frames &in, int frames, float *a, float *b,
+                FrameStats *stats, FrameStats *mix) {
+  const simd::v4f half = simd::splat(0.5f);
+  Levels la, lb, lm;
+  int i = 0;
+  for (; i + simd::kWidth <= frames; i += simd::kWidth) {
+    simd::v4f l, r;
+    in.load(i, l, r);
+    const simd::v4f m = simd::mul(simd::add(l, r), half);
+    const simd::v4f x = kMidSide ? m : l;
+    const simd::v4f y = kMidSide ? simd::mul(simd::sub(l, r), half) : r;
+    la.add(x);
+    lb.add(y);
+    if (!kMidSide)
+      lm.add(m);
+    if (kA)
+      simd::store(a + i, x);
+    if (kB)
+      simd::store(b + i, y);
+  }
+  for (; i < frames; ++i) {
+    float l, r;
+    in.load(i, l, r);
+    const float m = (l + r) * 0.5f;
+    const float x = kMidSide ? m : l;
+    const float y = kMidSide ? (l - r) * 0.5f : r;
+    la.add(x);
+    lb.add(y);
+    if (!kMidSide)
+      lm.add(m);
+    if (kA)
+      a[i] = x;
+    if (kB)
+      b[i] = y;
+  }
+
+  if (stats != nullptr) {
+    la.finish(frames, &stats[0]);
+    lb.finish(frames, &stats[1]);
+  }
+  if (mix != nullptr)
+    (kMidSide ? la : lm).finish(frames, mix);
+}
+
+template <bool kMidSide, typename Frames>
+void splitOutputs(const Frames &in, int frames, float *a, float *b,
+                  FrameStats *stats, FrameStats *mix) {
+  if (a != nullptr && b != nullptr)
+    splitRange<kMidSide, true, true>(in, frames, a, b, stats, mix);
+  else if (a != nullptr)
+    splitRange<kMidSide, true, false>(in, frames, a, b, stats, mix);
+  else if (b != nullptr)
+    splitRange<kMidSide, false, true>(in, frames, a, b, stats, mix);
+  else
+    splitRange<kMidSide, false, false>(in, frames, a, b, stats, mix);
+}
+
+template <typename Frames>
+void splitStereo(const Frames &in, int frames, bool midSide, float *a,
+                 float *b, FrameStats *stats, FrameStats *mix) {
+  frames = std::max(frames, 0);
+  if (midSide)
+    splitOutputs<true>(in, frames, a, b, stats, mix);
+  else
+    splitOutputs<false>(in, frames, a, b, stats, mix);
+}
+
+} // namespace
+
+void convertPcm16(const int16_t *pcm, int count, float *frame,
+                  const float *window, float *windowed, int nfft,
+                  FrameStats *stats) {
+  simd::v4f sumSq = simd::splat(0.0f);
+  simd::v4f peak = simd::splat(0.0f);
+  float sumSqTail = 0.0f;
+  float peakTail = 0.0f;
+
+  const bool withWindow = windowed != nullptr && window != nullptr && nfft > 0;
+  // Windowed segment first, then the (rare) remainder beyond nfft
+  const int split = withWindow ? std::min(count, nfft) : 0;
+
+  if (frame != nullptr) {
+    convertRangeDispatch<true>(withWindow, pcm, 0, split, frame, window,
+                               windowed, sumSq, peak, sumSqTail, peakTail);
+    convertRange<true, false>(pcm, split, count, frame, nullptr, nullptr,
+                              sumSq, peak, sumSqTail, peakTail);
+  } else {
+    convertRangeDispatch<false>(withWindow, pcm, 0, split, nullptr, window,
+                                windowed, sumSq, peak, sumSqTail, peakTail);
+    convertRange<false, false>(pcm, split, count, nullptr, nullptr, nullptr,
+                               sumSq, peak, sumSqTail, peakTail);
+  }
+
+  // Zero pad short reads up to the transform size
+  if (withWindow && count < nfft)
+    memset(windowed + count, 0, sizeof(float) * (nfft - count));
+
+  if (stats != nullptr) {
+    float total = simd::hsum(sumSq) + sumSqTail;
+    stats->rms = count > 0 ? sqrtf(total / (float)count) : 0.0f;
+    stats->peak = std::max(simd::hmax(peak), peakTail);
+  }
+}
+
+void analyzeFloat(const float *input, int count, float *frame,
+                  FrameStats *stats) {
+  simd::v4f sumSq = simd::splat(0.0f);
+  simd::v4f peak = simd::splat(0.0f);
+  float sumSqTail = 0.0f;
+  float peakTail = 0.0f;
+
+  int i = 0;
+  for (; i + simd::kWidth <= count; i += simd::kWidth) {
+    simd::v4f x = simd::load(input + i);
+    sumSq = simd::madd(sumSq, x, x);
+    peak = simd::max(peak, simd::abs(x));
+    if (frame != nullptr)
+      simd::store(frame + i, x);
+  }
+  for (; i < count; ++i) {
+    float x = input[i];
+    sumSqTail += x * x;
+    peakTail = std::max(peakTail, std::fabs(x));
+    if (frame != nullptr)
+      frame[i] = x;
+  }
+
+  if (stats != nullptr) {
+    float total = simd::hsum(sumSq) + sumSqTail;
+    stats->rms = count > 0 ? sqrtf(total / (float)count) : 0.0f;
+    stats->peak = std::max(simd::hmax(peak), peakTail);
+  }
+}
+
+void analyzePcm16(const int16_t *pcm, int count, int16_t *frame,
+                  FrameStats *stats) {
+  if (frame != nullptr)
+    memcpy(frame, pcm, sizeof(int16_t) * (size_t)std::max(count, 0));
+  if (stats == nullptr)
+    return;
+
+  // Squares are at most 2^30, so only a 64-bit sum is safe for long reads.
+  // Plain loop: compilers vectorize it with widening multiply-accumulates.
+  int64_t sumSq = 0;
+  int32_t peak = 0;
+  for (int i = 0; i < count; ++i) {
+    const int32_t x = pcm[i];
+    sumSq += x * x;
+    peak = std::max(peak, x < 0 ? -x : x);
+  }
+  stats->rms = count > 0 ? sqrtf((float)((double)sumSq / count)) * kPcm16Scale
+                         : 0.0f;
+  stats->peak = (float)peak * kPcm16Scale;
+}
+
+void splitStereoPcm16(const int16_t *pcm, int frames, bool midSide, float *a,
+                      float *b, FrameStats *stats, FrameStats *mix) {
+  splitStereo(InterleavedPcm16{pcm}, frames, midSide, a, b, stats, mix);
+}
+
+void splitStereoFloat(const float *input, int frames, bool midSide, float *a,
+                      float *b, FrameStats *stats, FrameStats *mix) {
+  splitStereo(InterleavedFloat{input}, frames, midSide, a, b, stats, mix);
+}
+
+void splitStereoPlanar(const float *left, const float *right, int frames,
+                       bool midSide, float *a, float *b, FrameStats *stats,
+                       FrameStats *mix) {
+  splitStereo(PlanarFloat{left, right}, frames, midSide, a, b, stats, mix);
+}
+
+void applyWindow(const float *input, const float *window, float *output,
+                 int n) {
+  int i = 0;
+  for (; i + simd::kWidth <= n; i += simd::kWidth)
+    simd::store(output + i,
+                simd::mul(simd::load(input + i), simd::load(window + i)));
+  for (; i < n; ++i)
+    output[i] = input[i] * window[i];
+}
+
+void complexMagnitudes(const float *re, const float *im, int bins, float scale,
+                       float *output) {
+  using namespace simd;
+  const v4f vscale = splat(scale);
+  int i = 0;
+  for (; i + kWidth <= bins; i += kWidth) {
+    v4f r = load(re + i), m = load(im + i);
+    store(output + i, mul(simd::sqrt(madd(mul(r, r), m, m)), vscale));
+  }
+  for (; i < bins; ++i)
+    output[i] = sqrtf(re[i] * re[i] + im[i] * im[i]) * scale;
+}
+
+} // namespace realtimeaudio
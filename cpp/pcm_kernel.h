@@ -0,0 +1,59 @@
+#ifndef REALTIMEAUDIO_PCM_KERNEL_H
+#define REALTIMEAUDIO_PCM_KERNEL_H
+
+#include <cstdint>
+
+namespace realtimeaudio {
+
+// Per-read level statistics, linear full scale (0.0 - 1.0).
+struct FrameStats {
+  float rms = 0.0f;
+  float peak = 0.0f;
+};
+
+// Single vectorized pass over `count` PCM16 samples:
+//  - converts to float [-1.0, 1.0) into `frame` (optional, may be null)
+//  - accumulates RMS and peak into `stats`
+//  - writes `sample * window[i]` for the first `nfft` samples into
+//    `windowed` (optional), zero-padding when `count < nfft`
+void convertPcm16(const int16_t *pcm, int count, float *frame,
+                  const float *window, float *windowed, int nfft,
+                  FrameStats *stats);
+
+// Float counterpart of convertPcm16() for hosts that capture float samples
+// (AVAudioEngine): copies `count` samples into `frame` (optional) and
+// accumulates RMS and peak into `stats`.
+void analyzeFloat(const float *input, int count, float *frame,
+                  FrameStats *stats);
+
+// Integer counterpart of convertPcm16() for the fixed-point path: copies
+// `count` samples into `frame` (optional) and accumulates RMS and peak with
+// integer arithmetic, converting only the two results to float.
+void analyzePcm16(const int16_t *pcm, int count, int16_t *frame,
+                  FrameStats *stats);
+
+// Splits `frames` stereo frames into two float channels in one SIMD pass:
+// (left, right), or with `midSide` (mid, side) = ((L + R) / 2, (L - R) / 2).
+// `a` and `b` are optional outputs. `stats` (optional, two entries) receives
+// the levels of both channels and `mix` (optional) those of the downmix
+// (L + R) / 2, which is also the mid channel. Inputs are interleaved PCM16,
+// interleaved float or planar float.
+void splitStereoPcm16(const int16_t *pcm, int frames, bool midSide, float *a,
+                      float *b, FrameStats *stats, FrameStats *mix);
+void splitStereoFloat(const float *input, int frames, bool midSide, float *a,
+                      float *b, FrameStats *stats, FrameStats *mix);
+void splitStereoPlanar(const float *left, const float *right, int frames,
+                       bool midSide, float *a, float *b, FrameStats *stats,
+                       FrameStats *mix);
+
+// output[i] = input[i] * window[i] for `n` samples.
+void applyWindow(const float *input, const float *window, float *output,
+                 int n);
+
+// output[i] = |re[i] + i * im[i]| * scale for `bins` split-complex bins.
+void complexMagnitudes(const float *re, const float *im, int bins, float scale,
+                       float *output);
+
+} // namespace realtimeaudio
+
+#endif // REALTIMEAUDIO_PCM_KERNEL_H
@@ -0,0 +1,294 @@
+#include "perf_stats.h"
+
+#include <algorithm>
+#include <chrono>
+
+#if defined(__ANDROID__)
+#include <dlfcn.h>
+#elif defined(__APPLE__)
+#include <os/signpost.h>
+#endif
+
+namespace realtimeaudio {
+
+namespace {
+
+#if defined(__ANDROID__)
+// ATrace entry points resolved at runtime (libandroid.so has them from
+// API 23), like AAudio in aaudio_capture.cpp
+struct ATraceApi {
+  bool (*isEnabled)() = nullptr;
+  void (*beginSection)(const char *) = nullptr;
+  void (*endSection)() = nullptr;
+
+  ATraceApi() {
+    void *lib = dlopen("libandroid.so", RTLD_NOW);
+    if (lib == nullptr)
+      return;
+    isEnabled = reinterpret_cast<bool (*)()>(dlsym(lib, "ATrace_isEnabled"));
+    beginSection = reinterpret_cast<void (*)(const char *)>(
+        dlsym(lib, "ATrace_beginSection"));
+    endSection = reinterpret_cast<void (*)()>(dlsym(lib, "ATrace_endSection"));
+    if (isEnabled == nullptr || beginSection == nullptr ||
+        endSection == nullptr) {
+      isEnabled = nullptr;
+    }
+  }
+};
+
+const ATraceApi &atrace() {
+  static const ATraceApi instance;
+  return instance;
+}
+
+// Section names as they appear in Perfetto / systrace
+const char *const kTraceNames[kPerfStageCount] = {
+    "rta:read",    "rta:analyze", "rta:fft",    "rta:features",
+    "rta:publish", "rta:queue",   "rta:deliver"};
+
+void traceBegin(PerfStage stage) {
+  const ATraceApi &api = atrace();
+  if (api.isEnabled != nullptr && api.isEnabled())
+    api.beginSection(kTraceNames[(int)stage]);
+}
+
+void traceEnd(PerfStage) {
+  // Sections nest per thread, so this closes the innermost one
+  const ATraceApi &api = atrace();
+  if (api.isEnabled != nullptr && api.isEnabled())
+    api.endSection();
+}
+#elif defined(__APPLE__)
+os_log_t traceLog() {
+  static os_log_t log =
+      os_log_create("com.realtimeaudio", OS_LOG_CATEGORY_POINTS_OF_INTEREST);
+  return log;
+}
+
+// os_signpost names must be string literals, hence one case per stage
+#define RTA_SIGNPOST(kind, stage)                                              \
+  do {                                                                         \
+    os_log_t log = traceLog();                                                 \
+    if (!os_signpost_enabled(log))                                             \
+      break;                                                                   \
+    switch (stage) {                                                           \
+    case PerfStage::Read:                                                      \
+      os_signpost_interval_##kind(log, OS_SIGNPOST_ID_EXCLUSIVE, "read");      \
+      break;                                                                   \
+    case PerfStage::Analyze:                                                   \
+      os_signpost_interval_##kind(log, OS_SIGNPOST_ID_EXCLUSIVE, "analyze");   \
+      break;                                                                   \
+    case PerfStage::Fft:                                                       \
+      os_signpost_interval_##kind(log, OS_SIGNPOST_ID_EXCLUSIVE, "fft");       \
+      break;                                                                   \
+    case PerfStage::Features:                                                  \
+      os_signpost_interval_##kind(log, OS_SIGNPOST_ID_EXCLUSIVE, "features");  \
+      break;                                                                   \
+    case PerfStage::Publish:                                                   \
+      os_signpost_interval_##kind(log, OS_SIGNPOST_ID_EXCLUSIVE, "publish");   \
+      break;                                                                   \
+    case PerfStage::Queue:                                                     \
+      os_signpost_interval_##kind(log, OS_SIGNPOST_ID_EXCLUSIVE, "queue");     \
+      break;                                                                   \
+    case PerfStage::Deliver:                                                   \
+      os_signpost_interval_##kind(log, OS_SIGNPOST_ID_EXCLUSIVE, "deliver");   \
+      break;                                                                   \
+    }                                                                          \
+  } while (0)
+
+void traceBegin(PerfStage stage) { RTA_SIGNPOST(begin, stage); }
+void traceEnd(PerfStage stage) { RTA_SIGNPOST(end, stage); }
+
+#undef RTA_SIGNPOST
+#else
+void traceBegin(PerfStage) {}
+void traceEnd(PerfStage) {}
+#endif
+
+int bucketFor(int64_t durationNs) {
+  const uint64_t us = durationNs > 0 ? (uint64_t)durationNs / 1000 : 0;
+  int bucket = 0;
+  for (uint64_t v = us >> 1; v != 0 && bucket < kPerfBuckets - 1; v >>= 1)
+    ++bucket;
+  return bucket;
+}
+
+double bucketLowerUs(int bucket) {
+  return bucket == 0 ? 0.0 : (double)(1u << bucket);
+}
+
+// Linear interpolation inside the bucket holding the `fraction` quantile
+double percentileUs(const PerfStageStats &s, double fraction) {
+  if (s.count == 0)
+    return 0.0;
+  const double target = fraction * (double)s.count;
+  double seen = 0.0;
+  for (int i = 0; i < kPerfBuckets; ++i) {
+    const double inBucket = (double)s.histogram[i];
+    if (inBucket == 0.0 || seen + inBucket < target) {
+      seen += inBucket;
+      continue;
+    }
+    const double lo = bucketLowerUs(i);
+    const double hi =
+        i == kPerfBuckets - 1 ? std::max(lo, s.maxUs) : bucketLowerUs(i + 1);
+    const double value = lo + (hi - lo) * (target - seen) / inBucket;
+    return std::min(value, s.maxUs);
+  }
+  return s.maxUs;
+}
+
+} // namespace
+
+const char *perfStageName(PerfStage stage) {
+  switch (stage) {
+  case PerfStage::Read:
+    return "read";
+  case PerfStage::Analyze:
+    return "analyze";
+  case PerfStage::Fft:
+    return "fft";
+  case PerfStage::Features:
+    return "features";
+  case PerfStage::Publish:
+    return "publish";
+  case PerfStage::Queue:
+    return "queue";
+  case PerfStage::Deliver:
+    return "deliver";
+  }
+  return "unknown";
+}
+
+PerfStats::PerfStats() { reset(); }
+
+int64_t PerfStats::nowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+int64_t PerfStats::begin(PerfStage stage) const {
+  if (tracing())
+    traceBegin(stage);
+  return nowNs();
+}
+
+void PerfStats::end(PerfStage stage, int64_t startNs) {
+  record(stage, nowNs() - startNs);
+  if (tracing())
+    traceEnd(stage);
+}
+
+void PerfStats::record(PerfStage stage, int64_t durationNs) {
+  const int index = (int)stage;
+  if (index < 0 || index >= kPerfStageCount)
+    return;
+  durationNs = std::max<int64_t>(durationNs, 0);
+  Stage &s = stages_[index];
+  s.count.fetch_add(1, std::memory_order_relaxed);
+  s.totalNs.fetch_add((uint64_t)durationNs, std::memory_order_relaxed);
+  s.buckets[bucketFor(durationNs)].fetch_add(1, std::memory_order_relaxed);
+  int64_t max = s.maxNs.load(std::memory_order_relaxed);
+  while (durationNs > max &&
+         !s.maxNs.compare_exchange_weak(max, durationNs,
+                                        std::memory_order_relaxed)) {
+  }
+}
+
+void PerfStats::observeQueue(uint32_t depth, uint64_t dropped) {
+  queue_depth_.store(depth, std::memory_order_relaxed);
+  queue_dropped_.store(dropped, std::memory_order_relaxed);
+  uint32_t max = max_queue_depth_.load(std::memory_order_relaxed);
+  while (depth > max &&
+         !max_queue_depth_.compare_exchange_weak(max, depth,
+                                                 std::memory_order_relaxed)) {
+  }
+}
+
+void PerfStats::setThread(bool realtime, int nice, bool pinned) {
+  thread_realtime_.store(realtime, std::memory_order_relaxed);
+  thread_nice_.store(nice, std::memory_order_relaxed);
+  thread_pinned_.store(pinned, std::memory_order_relaxed);
+  thread_tuned_.store(true, std::memory_order_relaxed);
+}
+
+void PerfStats::countCore(int cpu, int coreClass) {
+  if (cpu < 0)
+    return;
+  coreClass = coreClass >= 0 && coreClass < kPerfCoreClasses ? coreClass : 0;
+  core_reads_[coreClass].fetch_add(1, std::memory_order_relaxed);
+  core_class_.store(coreClass, std::memory_order_relaxed);
+  // Only the capture thread counts cores, so exchange() sees its last read
+  const int previous = cpu_.exchange(cpu, std::memory_order_relaxed);
+  if (previous >= 0 && previous != cpu)
+    migrations_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void PerfStats::reset() {
+  for (Stage &s : stages_) {
+    s.count.store(0, std::memory_order_relaxed);
+    s.totalNs.store(0, std::memory_order_relaxed);
+    s.maxNs.store(0, std::memory_order_relaxed);
+    for (std::atomic<uint64_t> &bucket : s.buckets)
+      bucket.store(0, std::memory_order_relaxed);
+  }
+  reads_.store(0, std::memory_order_relaxed);
+  rate_limited_.store(0, std::memory_order_relaxed);
+  overruns_.store(0, std::memory_order_relaxed);
+  queue_depth_.store(0, std::memory_order_relaxed);
+  max_queue_depth_.store(0, std::memory_order_relaxed);
+  queue_dropped_.store(0, std::memory_order_relaxed);
+  thread_tuned_.store(false, std::memory_order_relaxed);
+  thread_realtime_.store(false, std::memory_order_relaxed);
+  thread_nice_.store(0, std::memory_order_relaxed);
+  thread_pinned_.store(false, std::memory_order_relaxed);
+  cpu_.store(-1, std::memory_order_relaxed);
+  core_class_.store(0, std::memory_order_relaxed);
+  migrations_.store(0, std::memory_order_relaxed);
+  for (std::atomic<uint64_t> &reads : core_reads_)
+    reads.store(0, std::memory_order_relaxed);
+  start_ns_.store(nowNs(), std::memory_order_relaxed);
+}
+
+void PerfStats::snapshot(PerfSnapshot *out) const {
+  for (int i = 0; i < kPerfStageCount; ++i) {
+    const Stage &s = stages_[i];
+    PerfStageStats &o = out->stages[i];
+    // Buckets first, so the count never exceeds what they hold
+    uint64_t inBuckets = 0;
+    for (int b = 0; b < kPerfBuckets; ++b) {
+      o.histogram[b] = s.buckets[b].load(std::memory_order_relaxed);
+      inBuckets += o.histogram[b];
+    }
+    o.count = inBuckets;
+    const uint64_t count = s.count.load(std::memory_order_relaxed);
+    const uint64_t totalNs = s.totalNs.load(std::memory_order_relaxed);
+    o.meanUs = count > 0 ? (double)totalNs / (double)count / 1000.0 : 0.0;
+    o.maxUs = (double)s.maxNs.load(std::memory_order_relaxed) / 1000.0;
+    o.p50Us = percentileUs(o, 0.50);
+    o.p95Us = percentileUs(o, 0.95);
+    o.p99Us = percentileUs(o, 0.99);
+  }
+  out->elapsedMs =
+      (double)(nowNs() - start_ns_.load(std::memory_order_relaxed)) / 1e6;
+  out->reads = reads_.load(std::memory_order_relaxed);
+  out->rateLimited = rate_limited_.load(std::memory_order_relaxed);
+  out->overruns = overruns_.load(std::memory_order_relaxed);
+  out->queueDepth = queue_depth_.load(std::memory_order_relaxed);
+  out->maxQueueDepth = max_queue_depth_.load(std::memory_order_relaxed);
+  out->queueDropped = queue_dropped_.load(std::memory_order_relaxed);
+
+  PerfThreadStats &t = out->thread;
+  t.tuned = thread_tuned_.load(std::memory_order_relaxed);
+  t.realtime = thread_realtime_.load(std::memory_order_relaxed);
+  t.nice = thread_nice_.load(std::memory_order_relaxed);
+  t.pinned = thread_pinned_.load(std::memory_order_relaxed);
+  t.cpu = cpu_.load(std::memory_order_relaxed);
+  t.coreClass = core_class_.load(std::memory_order_relaxed);
+  t.migrations = migrations_.load(std::memory_order_relaxed);
+  for (int c = 0; c < kPerfCoreClasses; ++c)
+    t.coreReads[c] = core_reads_[c].load(std::memory_order_relaxed);
+}
+
+} // namespace realtimeaudio
@@ -0,0 +1,172 @@
+#ifndef REALTIMEAUDIO_PERF_STATS_H
+#define REALTIMEAUDIO_PERF_STATS_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace realtimeaudio {
+
+// Pipeline stages timed by PerfStats. Values are shared with
+// AudioEngine.PERF_STAGE_*, RTAPerfStats and the JS stage names.
+enum class PerfStage : int {
+  Read = 0,     // waiting for the capture read (AudioRecord.read)
+  Analyze = 1,  // one Analyzer::process call: ingest, levels, any frame
+  Fft = 2,      // window, transform and magnitudes of a frame (in Analyze)
+  Features = 3, // spectral features and pitch of a frame (in Analyze)
+  Publish = 4,  // band mapping into the queue slot or shared frame
+  Queue = 5,    // time a frame waited between push and pop
+  Deliver = 6,  // building and emitting the event (sendEvent)
+};
+
+constexpr int kPerfStageCount = 7;
+// Histogram bucket i counts durations in [2^i, 2^(i+1)) us; bucket 0 starts
+// at 0 and the last one is open-ended (>= 32.8 ms)
+constexpr int kPerfBuckets = 16;
+// Core classes reads are counted by: unknown, little, mid, big (values of
+// CoreClass in android/src/main/cpp/audio_thread.h)
+constexpr int kPerfCoreClasses = 4;
+
+// JS name of `stage`: "read", "analyze", "fft", ...
+const char *perfStageName(PerfStage stage);
+
+struct PerfStageStats {
+  uint64_t count = 0;
+  double meanUs = 0.0;
+  // Percentiles interpolated within their histogram bucket
+  double p50Us = 0.0;
+  double p95Us = 0.0;
+  double p99Us = 0.0;
+  double maxUs = 0.0;
+  uint64_t histogram[kPerfBuckets] = {};
+};
+
+// Where the capture thread ran; left at the defaults by platforms that
+// don't sample it (iOS)
+struct PerfThreadStats {
+  bool tuned = false;    // setThread() was called this session
+  bool realtime = false; // SCHED_FIFO / SCHED_RR
+  int32_t nice = 0;
+  bool pinned = false; // restricted to a core class
+  int32_t cpu = -1;    // core of the latest read
+  int32_t coreClass = 0;
+  uint64_t migrations = 0; // reads on another core than the read before
+  uint64_t coreReads[kPerfCoreClasses] = {};
+};
+
+struct PerfSnapshot {
+  PerfStageStats stages[kPerfStageCount];
+  double elapsedMs = 0.0;     // since construction or reset()
+  uint64_t reads = 0;         // capture reads (buffers) analyzed
+  uint64_t rateLimited = 0;   // reads analyzed but not emitted
+  uint64_t overruns = 0;      // capture overruns, see countOverruns()
+  uint32_t queueDepth = 0;    // frames queued at the last push
+  uint32_t maxQueueDepth = 0;
+  uint64_t queueDropped = 0;  // frames the queue dropped (consumer too slow)
+  PerfThreadStats thread;
+};
+
+// Always-on counters for the realtime pipeline: a fixed log2 histogram per
+// stage plus read, rate limiter, overrun and queue counters. Every update
+// is a few relaxed atomic adds, so the capture, delivery and JS threads may
+// record and read concurrently without locks or allocation; a snapshot
+// taken mid-update can be off by the frame in flight.
+//
+// With tracing enabled, begin() / end() also emit systrace sections
+// (Android, ATrace) or os_signpost intervals (Apple) named after the stage,
+// for Perfetto / Instruments. Tracing off costs one relaxed load.
+class PerfStats {
+public:
+  PerfStats();
+
+  PerfStats(const PerfStats &) = delete;
+  PerfStats &operator=(const PerfStats &) = delete;
+
+  // Monotonic clock shared by every stage (CLOCK_MONOTONIC on Android, so
+  // it matches System.nanoTime()).
+  static int64_t nowNs();
+
+  // Opens a trace section when tracing and returns the start time for
+  // end(), which records the duration and closes the section.
+  int64_t begin(PerfStage stage) const;
+  void end(PerfStage stage, int64_t startNs);
+
+  void record(PerfStage stage, int64_t durationNs);
+
+  void countRead(bool emitted) {
+    reads_.fetch_add(1, std::memory_order_relaxed);
+    if (!emitted)
+      rate_limited_.fetch_add(1, std::memory_order_relaxed);
+  }
+  // A read that took longer to process than the audio it carried, or xruns
+  // reported by the platform stream
+  void countOverruns(uint64_t count) {
+    overruns_.fetch_add(count, std::memory_order_relaxed);
+  }
+  // Queue size after a push and the queue's drop counter
+  void observeQueue(uint32_t depth, uint64_t dropped);
+  // Scheduling the capture thread ended up with, and the core (and its
+  // class) one read ran on
+  void setThread(bool realtime, int nice, bool pinned);
+  void countCore(int cpu, int coreClass);
+
+  // Applies to begin() / end() calls from now on; toggling it mid-stage can
+  // leave that one section unbalanced.
+  void setTracing(bool enabled) {
+    tracing_.store(enabled, std::memory_order_relaxed);
+  }
+  bool tracing() const { return tracing_.load(std::memory_order_relaxed); }
+
+  // Zeroes every counter (new capture session); tracing is kept.
+  void reset();
+  void snapshot(PerfSnapshot *out) const;
+
+private:
+  struct Stage {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> totalNs{0};
+    std::atomic<int64_t> maxNs{0};
+    std::atomic<uint64_t> buckets[kPerfBuckets];
+  };
+
+  Stage stages_[kPerfStageCount];
+  std::atomic<int64_t> start_ns_{0};
+  std::atomic<uint64_t> reads_{0};
+  std::atomic<uint64_t> rate_limited_{0};
+  std::atomic<uint64_t> overruns_{0};
+  std::atomic<uint32_t> queue_depth_{0};
+  std::atomic<uint32_t> max_queue_depth_{0};
+  std::atomic<uint64_t> queue_dropped_{0};
+  std::atomic<bool> thread_tuned_{false};
+  std::atomic<bool> thread_realtime_{false};
+  std::atomic<int32_t> thread_nice_{0};
+  std::atomic<bool> thread_pinned_{false};
+  std::atomic<int32_t> cpu_{-1};
+  std::atomic<int32_t> core_class_{0};
+  std::atomic<uint64_t> migrations_{0};
+  std::atomic<uint64_t> core_reads_[kPerfCoreClasses];
+  std::atomic<bool> tracing_{false};
+};
+
+// Times the enclosing scope as `stage`; a null `stats` makes it a no-op.
+class PerfScope {
+public:
+  PerfScope(PerfStats *stats, PerfStage stage)
+      : stats_(stats), stage_(stage),
+        start_ns_(stats != nullptr ? stats->begin(stage) : 0) {}
+  ~PerfScope() {
+    if (stats_ != nullptr)
+      stats_->end(stage_, start_ns_);
+  }
+
+  PerfScope(const PerfScope &) = delete;
+  PerfScope &operator=(const PerfScope &) = delete;
+
+private:
+  PerfStats *stats_;
+  PerfStage stage_;
+  int64_t start_ns_;
+};
+
+} // namespace realtimeaudio
+
+#endif // REALTIMEAUDIO_PERF_STATS_H
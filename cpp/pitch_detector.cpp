@@ -0,0 +1,121 @@
+#include "pitch_detector.h"
+#include <algorithm>
+#include <cmath>
+
+namespace realtimeaudio {
+
+namespace {
+
+// Below this lag-0 energy (relative to the window's) the frame is silence
+constexpr float kSilence = 1e-10f;
+// Window autocorrelation values below this are too small to divide by
+constexpr float kMinWindowAcf = 1e-3f;
+
+} // namespace
+
+void PitchDetector::configure(float sampleRate) {
+  sample_rate_ = sampleRate > 0.0f ? sampleRate : 48000.0f;
+  window_acf_.resize(kMaxSize / 2 + 1);
+  window_ = nullptr;
+}
+
+void PitchDetector::autocorrelate(FftBackend &fft, float *padded, float *re,
+                                  float *im) {
+  const int size = fft.size();
+  const int n = size / 2;
+  std::fill(padded + n, padded + size, 0.0f);
+  fft.forward(padded, re, im);
+  // |X|^2 extended to its even, full-length form
+  for (int j = 0; j <= n; ++j)
+    padded[j] = re[j] * re[j] + im[j] * im[j];
+  for (int j = 1; j < n; ++j)
+    padded[size - j] = padded[j];
+  // Forward on a real even sequence == size * inverse; the imaginary part
+  // is 0
+  fft.forward(padded, re, im);
+}
+
+void PitchDetector::prepareWindow(const WindowTable &window, FftBackend &fft,
+                                  float *padded, float *re, float *im) {
+  const int n = fft.size() / 2;
+  if (window.size() != n || n / 2 + 1 > (int)window_acf_.size())
+    return;
+  std::copy(window.values.begin(), window.values.end(), padded);
+  autocorrelate(fft, padded, re, im);
+  const float norm = re[0] > 0.0f ? 1.0f / re[0] : 0.0f;
+  for (int k = 0; k <= n / 2; ++k)
+    window_acf_[k] = re[k] * norm;
+  window_ = &window;
+}
+
+void PitchDetector::detect(FftBackend &fft, float *padded, float *re,
+                           float *im, float *frequency,
+                           float *confidence) const {
+  *frequency = 0.0f;
+  *confidence = 0.0f;
+  const int n = fft.size() / 2;
+  if (window_ == nullptr || window_->size() != n)
+    return;
+
+  autocorrelate(fft, padded, re, im);
+  if (re[0] <= kSilence * (float)fft.size())
+    return;
+
+  // Normalized, window-corrected autocorrelation r(k), 1 at lag 0
+  const int minLag =
+      std::max(2, (int)std::floor(sample_rate_ / kMaxFrequency));
+  const int maxLag = std::min(n / 2 - 1,
+                              (int)std::ceil(sample_rate_ / kMinFrequency));
+  if (maxLag <= minLag)
+    return;
+  const float norm = 1.0f / re[0];
+  float *r = padded; // free again; holds r(0..maxLag + 1)
+  for (int k = 0; k <= maxLag + 1; ++k) {
+    const float w = window_acf_[k];
+    r[k] = w > kMinWindowAcf ? re[k] * norm / w : 0.0f;
+  }
+
+  // Key maxima: the highest value of each positive lobe after r first
+  // drops below zero
+  int k = 1;
+  while (k <= maxLag && r[k] > 0.0f)
+    ++k;
+  float highest = 0.0f;
+  for (int i = k; i <= maxLag; ++i)
+    highest = std::max(highest, r[i]);
+  if (highest <= 0.0f)
+    return;
+
+  const float threshold = kPeakThreshold * highest;
+  int best = -1;
+  while (k <= maxLag && best < 0) {
+    while (k <= maxLag && r[k] <= 0.0f)
+      ++k;
+    int peak = k;
+    while (k <= maxLag && r[k] > 0.0f) {
+      if (r[k] > r[peak])
+        peak = k;
+      ++k;
+    }
+    if (peak <= maxLag && peak >= minLag && r[peak] >= threshold)
+      best = peak;
+  }
+  if (best < 0)
+    return;
+
+  // Parabolic refinement around the picked lag
+  float lag = (float)best;
+  float value = r[best];
+  const float a = r[best - 1], b = r[best], c = r[best + 1];
+  const float denom = a - 2.0f * b + c;
+  if (denom < 0.0f) {
+    const float delta = 0.5f * (a - c) / denom;
+    lag += delta;
+    value = b - 0.25f * (a - c) * delta;
+  }
+
+  *frequency = sample_rate_ / lag;
+  *confidence = std::max(0.0f, std::min(value, 1.0f));
+}
+
+} // namespace realtimeaudio
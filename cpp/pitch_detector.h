@@ -0,0 +1,75 @@
+#ifndef REALTIMEAUDIO_PITCH_DETECTOR_H
+#define REALTIMEAUDIO_PITCH_DETECTOR_H
+
+#include "fft_backend.h"
+#include "window.h"
+#include <vector>
+
+namespace realtimeaudio {
+
+// Fundamental-frequency estimator for the frames the Analyzer already
+// windows. The autocorrelation comes from the frame's power spectrum
+// (Wiener-Khinchin): the frame is zero-padded to twice its length, so the
+// autocorrelation is linear rather than circular (lag k does not alias
+// with lag N - k), and the power spectrum is real and even, so the forward
+// real-FFT plan of the padded size doubles as its inverse. The estimate
+// costs two transforms of 2N, not an O(N^2) lag loop.
+//
+// The frame is windowed, so its autocorrelation is divided by the window's
+// (Boersma's correction, as in Praat) to undo the taper's bias towards short
+// lags. Peaks are then picked McLeod-style (MPM): the first positive lobe
+// maximum within kPeakThreshold of the highest one wins, refined by
+// parabolic interpolation.
+//
+// Lags are searched up to N / 2, so the lowest detectable pitch is
+// 2 * sampleRate / N (e.g. 47 Hz for a 2048-point frame at 48 kHz). Below
+// about three periods per frame the window leaves little to correlate:
+// sines stay within 5 cents down to that limit, harmonic-rich tones only
+// from about 2.2 periods (55 Hz here); above it estimates are within a
+// fraction of a cent (cpp/tests/pitch_detector_test.cpp).
+class PitchDetector {
+public:
+  static constexpr float kMinFrequency = 30.0f;
+  static constexpr float kMaxFrequency = 4000.0f;
+  static constexpr float kPeakThreshold = 0.9f;
+  // Largest transform supported (window autocorrelation storage)
+  static constexpr int kMaxSize = 16384;
+
+  // Reserves the window autocorrelation for kMaxSize, so call it off the
+  // audio path or once per session.
+  void configure(float sampleRate);
+
+  // True until prepareWindow() ran for `window`.
+  bool needsWindow(const WindowTable &window) const {
+    return &window != window_;
+  }
+
+  // In the following `fft` is the padded plan, twice the frame size N;
+  // `padded` has room for fft.size() floats and `re` / `im` for N + 1.
+
+  // Autocorrelation of `window` (N values). Runs two transforms, once per
+  // plan or window change.
+  void prepareWindow(const WindowTable &window, FftBackend &fft, float *padded,
+                     float *re, float *im);
+
+  // `padded` holds the windowed frame in its first N floats; the rest is
+  // zeroed here and all three buffers are overwritten. Writes the pitch in
+  // Hz and a 0..1 confidence (normalized autocorrelation at the picked
+  // lag), both 0 when no periodicity was found. Allocation free.
+  void detect(FftBackend &fft, float *padded, float *re, float *im,
+              float *frequency, float *confidence) const;
+
+private:
+  // Zero-pads the N-sample frame in `padded` and leaves its linear
+  // autocorrelation, lags 0..N, in re
+  static void autocorrelate(FftBackend &fft, float *padded, float *re,
+                            float *im);
+
+  float sample_rate_ = 48000.0f;
+  const WindowTable *window_ = nullptr;
+  std::vector<float> window_acf_; // normalized, lags 0..N/2
+};
+
+} // namespace realtimeaudio
+
+#endif // REALTIMEAUDIO_PITCH_DETECTOR_H
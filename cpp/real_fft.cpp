@@ -0,0 +1,204 @@
+#include "real_fft.h"
+#include "simd.h"
+
+#include <cmath>
+#include <utility>
+
+namespace realtimeaudio {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+inline bool isPowerOfTwo(int n) { return n > 0 && (n & (n - 1)) == 0; }
+
+} // namespace
+
+bool RealFft::supports(int nfft) {
+  return nfft >= kMinSize && isPowerOfTwo(nfft);
+}
+
+RealFft::RealFft(int nfft) : nfft_(nfft), half_(nfft / 2) {
+  const int M = half_;
+
+  // Stockham stages: n halves while the span s doubles, n * s == M.
+  for (int n = M, s = 1; n > 1; n >>= 1, s <<= 1) {
+    const int m = n / 2;
+    Stage stage;
+    stage.span = s;
+    stage.twiddles = m;
+    stage.offset = tw_re_.size();
+
+    // Span 2 reads two butterflies per twiddle, so store each one twice to
+    // keep its loads contiguous; all other stages use one entry per twiddle.
+    const int repeat = (s == 2) ? 2 : 1;
+    for (int p = 0; p < m; ++p) {
+      double phase = -2.0 * kPi * p / n;
+      for (int r = 0; r < repeat; ++r) {
+        tw_re_.push_back((float)cos(phase));
+        tw_im_.push_back((float)sin(phase));
+      }
+    }
+    stages_.push_back(stage);
+  }
+
+  // Untangling twiddles exp(-i*pi*(k/M + 1/2)), k in [0, M/2]
+  post_re_.resize(M / 2 + 1);
+  post_im_.resize(M / 2 + 1);
+  for (int k = 0; k <= M / 2; ++k) {
+    double phase = -kPi * ((double)k / M + 0.5);
+    post_re_[k] = (float)cos(phase);
+    post_im_[k] = (float)sin(phase);
+  }
+
+  a_re_.resize(M);
+  a_im_.resize(M);
+  b_re_.resize(M);
+  b_im_.resize(M);
+}
+
+void RealFft::runStage(const Stage &stage, const float *sr, const float *si,
+                       float *dr, float *di) const {
+  using namespace simd;
+
+  const int s = stage.span;
+  const int m = stage.twiddles;
+  const int half = half_ / 2; // s * m: distance between butterfly inputs
+  const float *wr = tw_re_.data() + stage.offset;
+  const float *wi = tw_im_.data() + stage.offset;
+
+  if (s == 1) {
+    // Outputs 2p and 2p + 1 are adjacent: interleave sum and difference
+    for (int p = 0; p < m; p += 4) {
+      v4f ar = load(sr + p), ai = load(si + p);
+      v4f br = load(sr + p + half), bi = load(si + p + half);
+      v4f xr = sub(ar, br), xi = sub(ai, bi);
+      v4f tr = load(wr + p), ti = load(wi + p);
+      v4f yr = sub(mul(xr, tr), mul(xi, ti));
+      v4f yi = add(mul(xr, ti), mul(xi, tr));
+
+      v4f lo, hi;
+      zip(add(ar, br), yr, lo, hi);
+      store(dr + 2 * p, lo);
+      store(dr + 2 * p + 4, hi);
+      zip(add(ai, bi), yi, lo, hi);
+      store(di + 2 * p, lo);
+      store(di + 2 * p + 4, hi);
+    }
+  } else if (s == 2) {
+    // Pairs of outputs are adjacent: interleave two lanes at a time
+    for (int j = 0; j < half; j += 4) {
+      v4f ar = load(sr + j), ai = load(si + j);
+      v4f br = load(sr + j + half), bi = load(si + j + half);
+      v4f xr = sub(ar, br), xi = sub(ai, bi);
+      v4f tr = load(wr + j), ti = load(wi + j);
+      v4f yr = sub(mul(xr, tr), mul(xi, ti));
+      v4f yi = add(mul(xr, ti), mul(xi, tr));
+
+      v4f lo, hi;
+      zipPairs(add(ar, br), yr, lo, hi);
+      store(dr + 2 * j, lo);
+      store(dr + 2 * j + 4, hi);
+      zipPairs(add(ai, bi), yi, lo, hi);
+      store(di + 2 * j, lo);
+      store(di + 2 * j + 4, hi);
+    }
+  } else {
+    // Contiguous runs of s samples share one twiddle
+    for (int p = 0; p < m; ++p) {
+      const v4f tr = splat(wr[p]), ti = splat(wi[p]);
+      const float *ar0 = sr + s * p, *ai0 = si + s * p;
+      float *d0r = dr + 2 * s * p, *d0i = di + 2 * s * p;
+      float *d1r = d0r + s, *d1i = d0i + s;
+
+      for (int q = 0; q < s; q += 4) {
+        v4f ar = load(ar0 + q), ai = load(ai0 + q);
+        v4f br = load(ar0 + q + half), bi = load(ai0 + q + half);
+        v4f xr = sub(ar, br), xi = sub(ai, bi);
+
+        store(d0r + q, add(ar, br));
+        store(d0i + q, add(ai, bi));
+        store(d1r + q, sub(mul(xr, tr), mul(xi, ti)));
+        store(d1i + q, add(mul(xr, ti), mul(xi, tr)));
+      }
+    }
+  }
+}
+
+void RealFft::pack(const float *input, int half, float *zr, float *zi) {
+  using namespace simd;
+
+  for (int n = 0; n < half; n += 4) {
+    v4f even, odd;
+    loadDeinterleave(input + 2 * n, even, odd);
+    store(zr + n, even);
+    store(zi + n, odd);
+  }
+}
+
+void RealFft::untangle(const float *zr, const float *zi, const float *postRe,
+                       const float *postIm, int half, float *re, float *im) {
+  using namespace simd;
+
+  // X[k] = F1 + F2 * W^k, X[M-k] = conj(F1 - F2 * W^k), where
+  // F1 = (Z[k] + conj(Z[M-k])) / 2 and F2 = (Z[k] - conj(Z[M-k])) / 2
+  const int M = half;
+  re[0] = zr[0] + zi[0];
+  im[0] = 0.0f;
+  re[M] = zr[0] - zi[0];
+  im[M] = 0.0f;
+
+  const v4f halfv = splat(0.5f);
+  int k = 1;
+  for (; k + 3 < M / 2; k += 4) {
+    // Mirrored bins M-k-3 .. M-k, reversed so lane i pairs with k + i
+    v4f ar = load(zr + k), ai = load(zi + k);
+    v4f br = reverse(load(zr + M - k - 3));
+    v4f bi = sub(splat(0.0f), reverse(load(zi + M - k - 3)));
+
+    v4f f1r = mul(add(ar, br), halfv), f1i = mul(add(ai, bi), halfv);
+    v4f f2r = mul(sub(ar, br), halfv), f2i = mul(sub(ai, bi), halfv);
+    v4f wr = load(postRe + k), wi = load(postIm + k);
+    v4f tr = sub(mul(f2r, wr), mul(f2i, wi));
+    v4f ti = add(mul(f2r, wi), mul(f2i, wr));
+
+    store(re + k, add(f1r, tr));
+    store(im + k, add(f1i, ti));
+    store(re + M - k - 3, reverse(sub(f1r, tr)));
+    store(im + M - k - 3, reverse(sub(ti, f1i)));
+  }
+  for (; k < M / 2; ++k) {
+    float ar = zr[k], ai = zi[k];
+    float br = zr[M - k], bi = -zi[M - k];
+    float f1r = 0.5f * (ar + br), f1i = 0.5f * (ai + bi);
+    float f2r = 0.5f * (ar - br), f2i = 0.5f * (ai - bi);
+    float tr = f2r * postRe[k] - f2i * postIm[k];
+    float ti = f2r * postIm[k] + f2i * postRe[k];
+    re[k] = f1r + tr;
+    im[k] = f1i + ti;
+    re[M - k] = f1r - tr;
+    im[M - k] = ti - f1i;
+  }
+  // Middle bin pairs with itself
+  re[M / 2] = zr[M / 2];
+  im[M / 2] = -zi[M / 2];
+}
+
+void RealFft::forward(const float *input, float *re, float *im) {
+  // 1. Pack x[2n] + i*x[2n+1] as an M-point complex signal
+  float *sr = a_re_.data(), *si = a_im_.data();
+  float *dr = b_re_.data(), *di = b_im_.data();
+  pack(input, half_, sr, si);
+
+  // 2. Complex FFT, ping-ponging between the two buffers
+  for (const Stage &stage : stages_) {
+    runStage(stage, sr, si, dr, di);
+    std::swap(sr, dr);
+    std::swap(si, di);
+  }
+
+  // 3. Untangle the packed spectrum into the M + 1 real-input bins
+  untangle(sr, si, post_re_.data(), post_im_.data(), half_, re, im);
+}
+
+} // namespace realtimeaudio
@@ -0,0 +1,60 @@
+#ifndef REALTIMEAUDIO_REAL_FFT_H
+#define REALTIMEAUDIO_REAL_FFT_H
+
+#include "fft_backend.h"
+#include <vector>
+
+namespace realtimeaudio {
+
+// Split-format real FFT for power-of-two sizes (PFFFT-style data layout).
+//
+// The N real samples are packed as an N/2-point complex signal (even samples
+// in re[], odd in im[]), transformed with a radix-2 Stockham autosort FFT
+// (no bit reversal pass) whose stages are vectorized four butterflies at a
+// time, and untangled into the N/2 + 1 real-input bins. All twiddles are
+// precomputed per stage in the layout each stage reads contiguously.
+class RealFft : public FftBackend {
+public:
+  explicit RealFft(int nfft);
+
+  // Smallest supported size; below this the vector stages do not fill.
+  static constexpr int kMinSize = 32;
+  static bool supports(int nfft);
+
+  int size() const override { return nfft_; }
+  FftBackendType type() const override { return FftBackendType::Real; }
+  const char *name() const override { return "realfft"; }
+
+  void forward(const float *input, float *re, float *im) override;
+
+  // The steps around the complex FFT, shared with the fixed-size kernels
+  // (sized_fft.h). pack() splits `half` * 2 real samples into even (zr) and
+  // odd (zi) samples; untangle() turns the transformed packed signal into
+  // the half + 1 real-input bins, given the twiddles exp(-i*pi*(k/half +
+  // 1/2)) for k in [0, half / 2]. `half` is a power of two >= 16.
+  static void pack(const float *input, int half, float *zr, float *zi);
+  static void untangle(const float *zr, const float *zi, const float *postRe,
+                       const float *postIm, int half, float *re, float *im);
+
+private:
+  struct Stage {
+    int span;      // s: distance between the two inputs of a butterfly group
+    int twiddles;  // m: distinct twiddles in this stage
+    size_t offset; // into tw_re_/tw_im_
+  };
+
+  // One Stockham pass from (sr, si) into (dr, di).
+  void runStage(const Stage &stage, const float *sr, const float *si,
+                float *dr, float *di) const;
+
+  int nfft_;
+  int half_; // M = nfft / 2 complex points
+  std::vector<Stage> stages_;
+  std::vector<float> tw_re_, tw_im_;     // per-stage twiddles
+  std::vector<float> post_re_, post_im_; // real untangling twiddles
+  std::vector<float> a_re_, a_im_, b_re_, b_im_; // ping-pong buffers
+};
+
+} // namespace realtimeaudio
+
+#endif // REALTIMEAUDIO_REAL_FFT_H
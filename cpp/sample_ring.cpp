@@ -0,0 +1,33 @@
+#include "sample_ring.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace realtimeaudio {
+
+template <typename T> void BasicSampleRing<T>::reset(int capacity) {
+  capacity_ = std::max(capacity, 0);
+  data_.assign(2 * (size_t)capacity_, T());
+  write_ = 0;
+}
+
+template <typename T> void BasicSampleRing<T>::commit(int count) {
+  if (capacity_ == 0 || count <= 0)
+    return;
+  count = std::min(count, capacity_);
+
+  // Samples that landed in the first copy are mirrored forward, any that ran
+  // into the second copy are mirrored back to the start.
+  T *data = data_.data();
+  const int first = std::min(count, capacity_ - write_);
+  memcpy(data + write_ + capacity_, data + write_, sizeof(T) * first);
+  if (count > first)
+    memcpy(data, data + capacity_, sizeof(T) * (count - first));
+
+  write_ = (write_ + count) % capacity_;
+}
+
+template class BasicSampleRing<float>;
+template class BasicSampleRing<int16_t>;
+
+} // namespace realtimeaudio
@@ -0,0 +1,53 @@
+#ifndef REALTIMEAUDIO_SAMPLE_RING_H
+#define REALTIMEAUDIO_SAMPLE_RING_H
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace realtimeaudio {
+
+// Mirrored ring buffer for the STFT input history. Every sample is stored
+// twice, `capacity` apart, so the most recent N <= capacity samples are
+// always one contiguous span that can be windowed directly, and a writer
+// can convert straight into the ring without a wrap-around split.
+//
+// Not thread-safe; owned by one Analyzer.
+template <typename T> class BasicSampleRing {
+public:
+  using value_type = T;
+
+  // Resizes to `capacity` samples of silence.
+  void reset(int capacity);
+  int capacity() const { return capacity_; }
+
+  // Returns room for `count` (<= capacity) contiguous samples at the write
+  // position. Fill it, then call commit(count).
+  T *writeSpan(int count) {
+    assert(count <= capacity_);
+    (void)count;
+    return data_.data() + write_;
+  }
+  void commit(int count);
+
+  // Oldest-to-newest view of the last `n` (<= capacity) samples.
+  const T *latest(int n) const {
+    return data_.data() + write_ + capacity_ - n;
+  }
+
+private:
+  std::vector<T> data_; // 2 * capacity_
+  int capacity_ = 0;
+  int write_ = 0; // next write position, [0, capacity_)
+};
+
+// Float history, and the PCM16 one of the fixed-point path
+using SampleRing = BasicSampleRing<float>;
+using Pcm16Ring = BasicSampleRing<int16_t>;
+
+extern template class BasicSampleRing<float>;
+extern template class BasicSampleRing<int16_t>;
+
+} // namespace realtimeaudio
+
+#endif // REALTIMEAUDIO_SAMPLE_RING_H
@@ -0,0 +1,251 @@
+#ifndef REALTIMEAUDIO_SIMD_H
+#define REALTIMEAUDIO_SIMD_H
+
+// Minimal 4-lane float vector used by the hot-path kernels.
+//
+// NEON is used on arm64-v8a / armeabi-v7a (the NDK enables it by default),
+// SSE2 on x86 / x86_64 emulators, and a plain scalar struct everywhere else
+// (or when RTA_FORCE_SCALAR is defined, see RTA_ENABLE_SIMD in CMake), so
+// every kernel has exactly one implementation written against this API.
+
+#include <cmath>
+#include <cstdint>
+
+#if defined(RTA_FORCE_SCALAR)
+#define RTA_SIMD_SCALAR 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define RTA_SIMD_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define RTA_SIMD_SSE2 1
+#else
+#define RTA_SIMD_SCALAR 1
+#endif
+
+namespace realtimeaudio {
+namespace simd {
+
+constexpr int kWidth = 4;
+
+#if defined(RTA_SIMD_NEON)
+
+typedef float32x4_t v4f;
+
+inline v4f load(const float *p) { return vld1q_f32(p); }
+inline void store(float *p, v4f v) { vst1q_f32(p, v); }
+inline v4f splat(float x) { return vdupq_n_f32(x); }
+inline v4f add(v4f a, v4f b) { return vaddq_f32(a, b); }
+inline v4f sub(v4f a, v4f b) { return vsubq_f32(a, b); }
+inline v4f mul(v4f a, v4f b) { return vmulq_f32(a, b); }
+inline v4f madd(v4f acc, v4f a, v4f b) { return vmlaq_f32(acc, a, b); }
+inline v4f max(v4f a, v4f b) { return vmaxq_f32(a, b); }
+inline v4f abs(v4f a) { return vabsq_f32(a); }
+
+inline float hsum(v4f v) {
+  float32x2_t s = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+  return vget_lane_f32(vpadd_f32(s, s), 0);
+}
+
+inline float hmax(v4f v) {
+  float32x2_t m = vmax_f32(vget_low_f32(v), vget_high_f32(v));
+  return vget_lane_f32(vpmax_f32(m, m), 0);
+}
+
+inline v4f sqrt(v4f a) {
+#if defined(__aarch64__)
+  return vsqrtq_f32(a);
+#else
+  // ARMv7 NEON has no vector square root
+  float t[4];
+  vst1q_f32(t, a);
+  for (int i = 0; i < 4; ++i)
+    t[i] = sqrtf(t[i]);
+  return vld1q_f32(t);
+#endif
+}
+
+// (a0, a1, a2, a3) -> (a3, a2, a1, a0)
+inline v4f reverse(v4f a) {
+  float32x4_t r = vrev64q_f32(a);
+  return vcombine_f32(vget_high_f32(r), vget_low_f32(r));
+}
+
+// lo = (a0, b0, a1, b1), hi = (a2, b2, a3, b3)
+inline void zip(v4f a, v4f b, v4f &lo, v4f &hi) {
+  float32x4x2_t z = vzipq_f32(a, b);
+  lo = z.val[0];
+  hi = z.val[1];
+}
+
+// lo = (a0, a1, b0, b1), hi = (a2, a3, b2, b3)
+inline void zipPairs(v4f a, v4f b, v4f &lo, v4f &hi) {
+  lo = vcombine_f32(vget_low_f32(a), vget_low_f32(b));
+  hi = vcombine_f32(vget_high_f32(a), vget_high_f32(b));
+}
+
+// Loads 8 floats and splits them into even and odd lanes.
+inline void loadDeinterleave(const float *p, v4f &even, v4f &odd) {
+  float32x4x2_t v = vld2q_f32(p);
+  even = v.val[0];
+  odd = v.val[1];
+}
+
+// even = (a0, a2, b0, b2), odd = (a1, a3, b1, b3)
+inline void unzip(v4f a, v4f b, v4f &even, v4f &odd) {
+  float32x4x2_t v = vuzpq_f32(a, b);
+  even = v.val[0];
+  odd = v.val[1];
+}
+
+// Sign-extends 8 int16 samples into two float vectors.
+inline void loadPcm16(const int16_t *p, v4f &lo, v4f &hi) {
+  int16x8_t s = vld1q_s16(p);
+  lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(s)));
+  hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(s)));
+}
+
+#elif defined(RTA_SIMD_SSE2)
+
+typedef __m128 v4f;
+
+inline v4f load(const float *p) { return _mm_loadu_ps(p); }
+inline void store(float *p, v4f v) { _mm_storeu_ps(p, v); }
+inline v4f splat(float x) { return _mm_set1_ps(x); }
+inline v4f add(v4f a, v4f b) { return _mm_add_ps(a, b); }
+inline v4f sub(v4f a, v4f b) { return _mm_sub_ps(a, b); }
+inline v4f mul(v4f a, v4f b) { return _mm_mul_ps(a, b); }
+inline v4f madd(v4f acc, v4f a, v4f b) {
+  return _mm_add_ps(acc, _mm_mul_ps(a, b));
+}
+inline v4f max(v4f a, v4f b) { return _mm_max_ps(a, b); }
+inline v4f abs(v4f a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+
+inline float hsum(v4f v) {
+  __m128 s = _mm_add_ps(v, _mm_movehl_ps(v, v));
+  s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+  return _mm_cvtss_f32(s);
+}
+
+inline float hmax(v4f v) {
+  __m128 m = _mm_max_ps(v, _mm_movehl_ps(v, v));
+  m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+  return _mm_cvtss_f32(m);
+}
+
+inline v4f sqrt(v4f a) { return _mm_sqrt_ps(a); }
+
+inline v4f reverse(v4f a) {
+  return _mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+inline void zip(v4f a, v4f b, v4f &lo, v4f &hi) {
+  lo = _mm_unpacklo_ps(a, b);
+  hi = _mm_unpackhi_ps(a, b);
+}
+
+inline void zipPairs(v4f a, v4f b, v4f &lo, v4f &hi) {
+  lo = _mm_movelh_ps(a, b);
+  hi = _mm_movehl_ps(b, a);
+}
+
+inline void loadDeinterleave(const float *p, v4f &even, v4f &odd) {
+  __m128 lo = _mm_loadu_ps(p);
+  __m128 hi = _mm_loadu_ps(p + 4);
+  even = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+  odd = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+inline void unzip(v4f a, v4f b, v4f &even, v4f &odd) {
+  even = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+  odd = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+inline void loadPcm16(const int16_t *p, v4f &lo, v4f &hi) {
+  __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+  // Duplicate each lane into the upper half, then arithmetic-shift it down
+  lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16));
+  hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16));
+}
+
+#else
+
+struct v4f {
+  float v[4];
+};
+
+inline v4f load(const float *p) { return {{p[0], p[1], p[2], p[3]}}; }
+inline void store(float *p, v4f a) {
+  for (int i = 0; i < 4; ++i)
+    p[i] = a.v[i];
+}
+inline v4f splat(float x) { return {{x, x, x, x}}; }
+
+#define RTA_SIMD_SCALAR_OP(name, expr)                                         \
+  inline v4f name(v4f a, v4f b) {                                              \
+    v4f r;                                                                     \
+    for (int i = 0; i < 4; ++i)                                                \
+      r.v[i] = (expr);                                                         \
+    return r;                                                                  \
+  }
+RTA_SIMD_SCALAR_OP(add, a.v[i] + b.v[i])
+RTA_SIMD_SCALAR_OP(sub, a.v[i] - b.v[i])
+RTA_SIMD_SCALAR_OP(mul, a.v[i] * b.v[i])
+RTA_SIMD_SCALAR_OP(max, a.v[i] > b.v[i] ? a.v[i] : b.v[i])
+#undef RTA_SIMD_SCALAR_OP
+
+inline v4f madd(v4f acc, v4f a, v4f b) { return add(acc, mul(a, b)); }
+inline v4f abs(v4f a) {
+  for (int i = 0; i < 4; ++i)
+    a.v[i] = std::fabs(a.v[i]);
+  return a;
+}
+inline float hsum(v4f a) { return (a.v[0] + a.v[1]) + (a.v[2] + a.v[3]); }
+inline float hmax(v4f a) {
+  float m = a.v[0];
+  for (int i = 1; i < 4; ++i)
+    m = a.v[i] > m ? a.v[i] : m;
+  return m;
+}
+
+inline v4f sqrt(v4f a) {
+  for (int i = 0; i < 4; ++i)
+    a.v[i] = sqrtf(a.v[i]);
+  return a;
+}
+
+inline v4f reverse(v4f a) { return {{a.v[3], a.v[2], a.v[1], a.v[0]}}; }
+
+inline void zip(v4f a, v4f b, v4f &lo, v4f &hi) {
+  lo = {{a.v[0], b.v[0], a.v[1], b.v[1]}};
+  hi = {{a.v[2], b.v[2], a.v[3], b.v[3]}};
+}
+
+inline void zipPairs(v4f a, v4f b, v4f &lo, v4f &hi) {
+  lo = {{a.v[0], a.v[1], b.v[0], b.v[1]}};
+  hi = {{a.v[2], a.v[3], b.v[2], b.v[3]}};
+}
+
+inline void loadDeinterleave(const float *p, v4f &even, v4f &odd) {
+  even = {{p[0], p[2], p[4], p[6]}};
+  odd = {{p[1], p[3], p[5], p[7]}};
+}
+
+inline void unzip(v4f a, v4f b, v4f &even, v4f &odd) {
+  even = {{a.v[0], a.v[2], b.v[0], b.v[2]}};
+  odd = {{a.v[1], a.v[3], b.v[1], b.v[3]}};
+}
+
+inline void loadPcm16(const int16_t *p, v4f &lo, v4f &hi) {
+  for (int i = 0; i < 4; ++i) {
+    lo.v[i] = (float)p[i];
+    hi.v[i] = (float)p[i + 4];
+  }
+}
+
+#endif
+
+} // namespace simd
+} // namespace realtimeaudio
+
+#endif // REALTIMEAUDIO_SIMD_H
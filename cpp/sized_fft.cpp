@@ -0,0 +1,293 @@
+#include "sized_fft.h"
+#include "real_fft.h"
+#include "simd.h"
+
+#include <array>
+#include <new>
+
+namespace realtimeaudio {
+
+namespace {
+
+#define KERNEL_INLINE __attribute__((always_inline)) inline
+
+// --- Compile-time twiddles ---
+
+constexpr double kHalfPi = 1.57079632679489661923;
+
+// Taylor series on [0, pi/2]; the last terms are below 1e-20
+constexpr double taylorSin(double x) {
+  double term = x, sum = x;
+  for (int k = 1; k < 14; ++k) {
+    term *= -x * x / ((2.0 * k) * (2.0 * k + 1.0));
+    sum += term;
+  }
+  return sum;
+}
+
+constexpr double taylorCos(double x) {
+  double term = 1.0, sum = 1.0;
+  for (int k = 1; k < 14; ++k) {
+    term *= -x * x / ((2.0 * k - 1.0) * (2.0 * k));
+    sum += term;
+  }
+  return sum;
+}
+
+struct Root {
+  double re, im;
+};
+
+// exp(-2*pi*i * k / n), reduced to a quadrant in exact integer arithmetic
+constexpr Root unitRoot(int k, int n) {
+  const long r = 4L * (k % n);
+  const long quadrant = r / n;
+  const double x = kHalfPi * (double)(r - quadrant * n) / n;
+  const double c = taylorCos(x), s = taylorSin(x);
+  switch (quadrant) {
+  case 0:
+    return {c, -s};
+  case 1:
+    return {-s, -c};
+  case 2:
+    return {-c, s};
+  default:
+    return {s, c};
+  }
+}
+
+// Twiddles of the radix-4 passes over n = M, M / 4, ... >= 4 points
+constexpr int twiddleCount(int M) {
+  int count = 0;
+  for (int n = M; n >= 4; n /= 4)
+    count += 3 * (n / 4);
+  return count;
+}
+
+// Start of the pass over n points: w^p, w^2p, w^3p for p < n / 4, in
+// that order, with w = exp(-2*pi*i / n)
+constexpr int twiddleOffset(int M, int n) {
+  int offset = 0;
+  for (int len = M; len > n; len /= 4)
+    offset += 3 * (len / 4);
+  return offset;
+}
+
+// Tables of one size; M = nfft / 2 complex points
+template <int M> struct Twiddles {
+  float passRe[twiddleCount(M)] = {};
+  float passIm[twiddleCount(M)] = {};
+  // exp(-i*pi*(k/M + 1/2)) for k in [0, M/2], see RealFft::untangle()
+  float postRe[M / 2 + 1] = {};
+  float postIm[M / 2 + 1] = {};
+};
+
+template <int M> constexpr Twiddles<M> makeTwiddles() {
+  Twiddles<M> t;
+  for (int n = M; n >= 4; n /= 4) {
+    const int m = n / 4;
+    const int offset = twiddleOffset(M, n);
+    for (int j = 1; j <= 3; ++j) {
+      for (int p = 0; p < m; ++p) {
+        const Root w = unitRoot(j * p, n);
+        t.passRe[offset + (j - 1) * m + p] = (float)w.re;
+        t.passIm[offset + (j - 1) * m + p] = (float)w.im;
+      }
+    }
+  }
+  for (int k = 0; k <= M / 2; ++k) {
+    const Root w = unitRoot(k + M / 2, 2 * M);
+    t.postRe[k] = (float)w.re;
+    t.postIm[k] = (float)w.im;
+  }
+  return t;
+}
+
+template <int M> struct TwiddleTable {
+  static constexpr Twiddles<M> kValues = makeTwiddles<M>();
+};
+
+// --- Kernels ---
+
+template <int N> class SizedRealFft final : public FftBackend {
+public:
+  static constexpr int M = N / 2;
+  static_assert(M >= 128 && (M & (M - 1)) == 0, "kernels need M >= 128");
+
+  int size() const override { return N; }
+  FftBackendType type() const override { return FftBackendType::Real; }
+  const char *name() const override { return "realfft-r4"; }
+
+  void forward(const float *input, float *re, float *im) override {
+    RealFft::pack(input, M, a_re_.data(), a_im_.data());
+    const float *zr = nullptr, *zi = nullptr;
+    passes<M, 1>(a_re_.data(), a_im_.data(), b_re_.data(), b_im_.data(), &zr,
+                 &zi);
+    const Twiddles<M> &t = TwiddleTable<M>::kValues;
+    RealFft::untangle(zr, zi, t.postRe, t.postIm, M, re, im);
+  }
+
+private:
+  // Radix-4 passes while four or more points remain, then a radix-2 pass
+  // for odd powers of two. Ping-pongs between (xr, xi) and (yr, yi); the
+  // buffer holding the result is known at compile time.
+  template <int n, int s>
+  static void passes(float *xr, float *xi, float *yr, float *yi,
+                     const float **zr, const float **zi) {
+    if constexpr (n == 1) {
+      *zr = xr;
+      *zi = xi;
+    } else if constexpr (n == 2) {
+      radix2<s>(xr, xi, yr, yi);
+      *zr = yr;
+      *zi = yi;
+    } else {
+      radix4<n, s>(xr, xi, yr, yi);
+      passes<n / 4, 4 * s>(yr, yi, xr, xi, zr, zi);
+    }
+  }
+
+  // One Stockham radix-4 pass over n-point sub-transforms at span s:
+  // inputs x[q + s*(p + r*n/4)], outputs y[q + s*(4p + r)]
+  template <int n, int s>
+  static void radix4(const float *sr, const float *si, float *dr, float *di) {
+    using namespace simd;
+
+    constexpr int m = n / 4;
+    constexpr int quarter = s * m; // M / 4: distance between the inputs
+    const Twiddles<M> &t = TwiddleTable<M>::kValues;
+    constexpr int offset = twiddleOffset(M, n);
+    const float *w1r = t.passRe + offset, *w1i = t.passIm + offset;
+    const float *w2r = w1r + m, *w2i = w1i + m;
+    const float *w3r = w2r + m, *w3i = w2i + m;
+
+    if constexpr (s == 1) {
+      // Four butterflies per step, one per lane; their outputs are
+      // adjacent, so the 4 x 4 result is transposed on the way out
+      for (int p = 0; p < m; p += 4) {
+        v4f yr[4], yi[4];
+        butterfly(load(sr + p), load(si + p), load(sr + p + quarter),
+                  load(si + p + quarter), load(sr + p + 2 * quarter),
+                  load(si + p + 2 * quarter), load(sr + p + 3 * quarter),
+                  load(si + p + 3 * quarter), load(w1r + p), load(w1i + p),
+                  load(w2r + p), load(w2i + p), load(w3r + p), load(w3i + p),
+                  yr, yi);
+        storeTransposed(dr + 4 * p, yr);
+        storeTransposed(di + 4 * p, yi);
+      }
+    } else {
+      // Contiguous runs of s samples share their twiddles
+      for (int p = 0; p < m; ++p) {
+        const v4f t1r = splat(w1r[p]), t1i = splat(w1i[p]);
+        const v4f t2r = splat(w2r[p]), t2i = splat(w2i[p]);
+        const v4f t3r = splat(w3r[p]), t3i = splat(w3i[p]);
+        const float *xr = sr + s * p, *xi = si + s * p;
+        float *outr = dr + 4 * s * p, *outi = di + 4 * s * p;
+
+        for (int q = 0; q < s; q += 4) {
+          v4f yr[4], yi[4];
+          butterfly(load(xr + q), load(xi + q), load(xr + q + quarter),
+                    load(xi + q + quarter), load(xr + q + 2 * quarter),
+                    load(xi + q + 2 * quarter), load(xr + q + 3 * quarter),
+                    load(xi + q + 3 * quarter), t1r, t1i, t2r, t2i, t3r, t3i,
+                    yr, yi);
+          for (int r = 0; r < 4; ++r) {
+            store(outr + q + r * s, yr[r]);
+            store(outi + q + r * s, yi[r]);
+          }
+        }
+      }
+    }
+  }
+
+  // Last pass of odd powers of two: two points, no twiddles
+  template <int s>
+  static void radix2(const float *sr, const float *si, float *dr, float *di) {
+    using namespace simd;
+
+    for (int q = 0; q < s; q += 4) {
+      v4f ar = load(sr + q), ai = load(si + q);
+      v4f br = load(sr + q + s), bi = load(si + q + s);
+      store(dr + q, add(ar, br));
+      store(di + q, add(ai, bi));
+      store(dr + q + s, sub(ar, br));
+      store(di + q + s, sub(ai, bi));
+    }
+  }
+
+  // 4-point DFT of (a, b, c, d), outputs 1 to 3 rotated by w1 to w3.
+  // Forced inline: with the scalar v4f fallback the compiler otherwise
+  // keeps the call and the kernels run 4-5x slower than RealFft.
+  KERNEL_INLINE static void
+  butterfly(simd::v4f ar, simd::v4f ai, simd::v4f br, simd::v4f bi,
+            simd::v4f cr, simd::v4f ci, simd::v4f dr, simd::v4f di,
+            simd::v4f w1r, simd::v4f w1i, simd::v4f w2r, simd::v4f w2i,
+            simd::v4f w3r, simd::v4f w3i, simd::v4f *yr, simd::v4f *yi) {
+    using namespace simd;
+
+    const v4f apcr = add(ar, cr), apci = add(ai, ci);
+    const v4f amcr = sub(ar, cr), amci = sub(ai, ci);
+    const v4f bpdr = add(br, dr), bpdi = add(bi, di);
+    const v4f bmdr = sub(br, dr), bmdi = sub(bi, di);
+
+    // amc -/+ i * bmd
+    const v4f x1r = add(amcr, bmdi), x1i = sub(amci, bmdr);
+    const v4f x2r = sub(apcr, bpdr), x2i = sub(apci, bpdi);
+    const v4f x3r = sub(amcr, bmdi), x3i = add(amci, bmdr);
+
+    yr[0] = add(apcr, bpdr);
+    yi[0] = add(apci, bpdi);
+    yr[1] = sub(mul(x1r, w1r), mul(x1i, w1i));
+    yi[1] = add(mul(x1r, w1i), mul(x1i, w1r));
+    yr[2] = sub(mul(x2r, w2r), mul(x2i, w2i));
+    yi[2] = add(mul(x2r, w2i), mul(x2i, w2r));
+    yr[3] = sub(mul(x3r, w3r), mul(x3i, w3i));
+    yi[3] = add(mul(x3r, w3i), mul(x3i, w3r));
+  }
+
+  // out[4 * lane + r] = y[r][lane]
+  KERNEL_INLINE static void storeTransposed(float *out, const simd::v4f *y) {
+    using namespace simd;
+
+    v4f lo02, hi02, lo13, hi13, lo, hi;
+    zip(y[0], y[2], lo02, hi02);
+    zip(y[1], y[3], lo13, hi13);
+    zip(lo02, lo13, lo, hi);
+    store(out, lo);
+    store(out + 4, hi);
+    zip(hi02, hi13, lo, hi);
+    store(out + 8, lo);
+    store(out + 12, hi);
+  }
+
+  std::array<float, M> a_re_{}, a_im_{}, b_re_{}, b_im_{};
+};
+
+template <int N> std::unique_ptr<FftBackend> createSized() {
+  return std::unique_ptr<FftBackend>(new (std::nothrow) SizedRealFft<N>());
+}
+
+#undef KERNEL_INLINE
+
+} // namespace
+
+bool sizedRealFftSupports(int nfft) {
+  return nfft == 256 || nfft == 512 || nfft == 1024 || nfft == 2048;
+}
+
+std::unique_ptr<FftBackend> createSizedRealFft(int nfft) {
+  switch (nfft) {
+  case 256:
+    return createSized<256>();
+  case 512:
+    return createSized<512>();
+  case 1024:
+    return createSized<1024>();
+  case 2048:
+    return createSized<2048>();
+  default:
+    return nullptr;
+  }
+}
+
+} // namespace realtimeaudio
@@ -0,0 +1,28 @@
+#ifndef REALTIMEAUDIO_SIZED_FFT_H
+#define REALTIMEAUDIO_SIZED_FFT_H
+
+#include "fft_backend.h"
+#include <memory>
+
+namespace realtimeaudio {
+
+// Real FFT kernels specialized at compile time for the sizes the app uses
+// (256, 512, 1024 and 2048). Same data layout and output as RealFft, but:
+//
+//   - the complex FFT runs radix-4 Stockham passes (plus one radix-2 pass
+//     for 256 and 1024), half as many passes over memory as radix-2;
+//   - every pass is its own instantiation, so spans, trip counts and table
+//     offsets are constants and the pass sequence is unrolled;
+//   - twiddles are constexpr tables in read-only data, shared by all plans
+//     of a size and never computed at runtime.
+//
+// Selected by createFftBackend() for FftBackendType::Real and Auto (off
+// Apple); other sizes keep the generic RealFft plan.
+bool sizedRealFftSupports(int nfft);
+
+// nullptr for an unsupported size or out of memory.
+std::unique_ptr<FftBackend> createSizedRealFft(int nfft);
+
+} // namespace realtimeaudio
+
+#endif // REALTIMEAUDIO_SIZED_FFT_H
@@ -0,0 +1,106 @@
+#include "spectral_features.h"
+#include <algorithm>
+#include <cmath>
+
+namespace realtimeaudio {
+
+namespace {
+
+// Keeps log() finite on silent bins and the ratios defined on silence
+constexpr float kEpsilon = 1e-12f;
+// Weight of the newest frame in the onset statistics
+constexpr float kOnsetAlpha = 0.1f;
+
+} // namespace
+
+void FeatureExtractor::configure(uint32_t mask, float sampleRate) {
+  mask_ = mask & kFeatureSpectral;
+  sample_rate_ = sampleRate > 0.0f ? sampleRate : 48000.0f;
+  // Onsets are picked on the flux, so they need its history too
+  if ((mask_ & (kFeatureFlux | kFeatureOnset)) != 0)
+    previous_.resize(kMaxBins);
+  reset();
+}
+
+void FeatureExtractor::reset() {
+  previous_bins_ = 0;
+  flux_mean_ = 0.0f;
+  flux_var_ = 0.0f;
+  frames_since_onset_ = kOnsetRefractory;
+}
+
+void FeatureExtractor::compute(const float *spectrum, int bins, int fftSize,
+                               SpectralFeatures *out) {
+  *out = SpectralFeatures();
+  if (mask_ == 0 || bins <= 0 || fftSize <= 0)
+    return;
+
+  const float binHz = sample_rate_ / (float)fftSize;
+
+  // One pass for the sums every feature but the rolloff needs
+  double sum = 0.0, weighted = 0.0, power = 0.0, logPower = 0.0;
+  const bool flatness = (mask_ & kFeatureFlatness) != 0;
+  for (int i = 0; i < bins; ++i) {
+    const float m = spectrum[i];
+    sum += m;
+    weighted += (double)i * m;
+    const float p = m * m;
+    power += p;
+    if (flatness)
+      logPower += std::log(p + kEpsilon);
+  }
+
+  if ((mask_ & kFeatureCentroid) != 0 && sum > kEpsilon)
+    out->centroid = (float)(weighted / sum) * binHz;
+
+  if (flatness && power > kEpsilon) {
+    const double geometric = std::exp(logPower / bins);
+    out->flatness = (float)std::min(1.0, geometric / (power / bins));
+  }
+
+  if ((mask_ & kFeatureRolloff) != 0 && power > kEpsilon) {
+    const double target = power * kRolloffFraction;
+    double cumulative = 0.0;
+    int i = 0;
+    for (; i < bins - 1; ++i) {
+      cumulative += spectrum[i] * spectrum[i];
+      if (cumulative >= target)
+        break;
+    }
+    out->rolloff = (float)i * binHz;
+  }
+
+  if ((mask_ & (kFeatureFlux | kFeatureOnset)) == 0 || bins > kMaxBins)
+    return;
+
+  // A size change restarts the history: no flux for the first frame
+  float flux = 0.0f;
+  const bool hasPrevious = previous_bins_ == bins;
+  if (hasPrevious) {
+    double rise = 0.0;
+    for (int i = 0; i < bins; ++i)
+      rise += std::max(0.0f, spectrum[i] - previous_[i]);
+    flux = (float)(rise / bins);
+  }
+  std::copy(spectrum, spectrum + bins, previous_.begin());
+  previous_bins_ = bins;
+
+  if ((mask_ & kFeatureFlux) != 0)
+    out->flux = flux;
+
+  if ((mask_ & kFeatureOnset) != 0 && hasPrevious) {
+    ++frames_since_onset_;
+    const float threshold =
+        flux_mean_ + kOnsetSensitivity * std::sqrt(flux_var_);
+    if (flux > threshold && flux > kOnsetMinFlux &&
+        frames_since_onset_ >= kOnsetRefractory) {
+      out->onset = true;
+      frames_since_onset_ = 0;
+    }
+    const float delta = flux - flux_mean_;
+    flux_mean_ += kOnsetAlpha * delta;
+    flux_var_ = (1.0f - kOnsetAlpha) * (flux_var_ + kOnsetAlpha * delta * delta);
+  }
+}
+
+} // namespace realtimeaudio
@@ -0,0 +1,80 @@
+#ifndef REALTIMEAUDIO_SPECTRAL_FEATURES_H
+#define REALTIMEAUDIO_SPECTRAL_FEATURES_H
+
+#include <cstdint>
+#include <vector>
+
+namespace realtimeaudio {
+
+// Feature bits, shared with AudioEngine.FEATURE_* and the JS names
+// 'centroid' | 'flux' | 'rolloff' | 'flatness' | 'onset' | 'pitch'.
+enum FeatureFlags : uint32_t {
+  kFeatureCentroid = 1u << 0,
+  kFeatureFlux = 1u << 1,
+  kFeatureRolloff = 1u << 2,
+  kFeatureFlatness = 1u << 3,
+  kFeatureOnset = 1u << 4,
+  kFeaturePitch = 1u << 5, // PitchDetector, run by the Analyzer
+  kFeatureSpectral = (1u << 5) - 1, // computed by FeatureExtractor
+  kFeatureAll = (1u << 6) - 1,
+};
+
+// Per-frame scalars; fields whose bit is not enabled stay 0.
+struct SpectralFeatures {
+  float centroid = 0.0f; // Hz, magnitude-weighted mean frequency
+  float flux = 0.0f;     // mean positive magnitude change since last frame
+  float rolloff = 0.0f;  // Hz below which kRolloffFraction of the energy lies
+  float flatness = 0.0f; // geometric / arithmetic mean of power, 0..1
+  bool onset = false;    // flux peaked above the adaptive threshold
+  float pitch = 0.0f;    // Hz, 0 when no periodicity was found
+  float pitchConfidence = 0.0f; // 0..1
+};
+
+// Reduces a magnitude spectrum to a few scalars so consumers can skip
+// shipping the spectrum itself. Only the enabled features are computed, in
+// at most two passes over the bins.
+//
+// Onsets are picked on the flux: a frame is an onset when its flux exceeds
+// the running mean by kOnsetSensitivity standard deviations (both tracked
+// with an exponential moving average), and at least kOnsetRefractory frames
+// passed since the previous one.
+class FeatureExtractor {
+public:
+  static constexpr float kRolloffFraction = 0.85f;
+  static constexpr float kOnsetSensitivity = 2.0f;
+  static constexpr float kOnsetMinFlux = 1e-4f;
+  static constexpr int kOnsetRefractory = 3;
+  // History kept for flux; larger spectra compute no flux
+  static constexpr int kMaxBins = 8192;
+
+  // Enables the features in `mask` (FeatureFlags; kFeaturePitch is left to
+  // the caller). `sampleRate` converts bins to Hz. Reserves the flux
+  // history, so call it off the audio path or once per session.
+  void configure(uint32_t mask, float sampleRate);
+  uint32_t mask() const { return mask_; }
+
+  // Forgets the previous frame and the onset statistics.
+  void reset();
+
+  // `spectrum` holds `bins` magnitudes spaced sampleRate / fftSize apart
+  // starting at DC. Allocation free.
+  void compute(const float *spectrum, int bins, int fftSize,
+               SpectralFeatures *out);
+
+private:
+  uint32_t mask_ = 0;
+  float sample_rate_ = 48000.0f;
+
+  // Flux history
+  std::vector<float> previous_;
+  int previous_bins_ = 0;
+
+  // Onset detection state
+  float flux_mean_ = 0.0f;
+  float flux_var_ = 0.0f;
+  int frames_since_onset_ = 0;
+};
+
+} // namespace realtimeaudio
+
+#endif // REALTIMEAUDIO_SPECTRAL_FEATURES_H
@@ -0,0 +1,293 @@
+#include "spectrogram.h"
+#include "analyzer.h"
+#include "pcm_kernel.h"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <new>
+#include <system_error>
+#include <thread>
+
+namespace realtimeaudio {
+
+namespace {
+
+// Fewer frames than this per worker cost more in plan setup than they save
+constexpr int kMinFramesPerThread = 16;
+
+struct Job {
+  SampleBuffer input;
+  float sampleRate;
+  SpectrogramOptions options;
+  int nfft;
+  int hop;
+  int bins;
+  int maxOut; // band scratch size
+  int valueBytes;
+  uint8_t *out;
+  std::atomic<bool> failed{false};
+};
+
+int bytesPerSample(SampleFormat format) {
+  switch (format) {
+  case SampleFormat::Pcm16:
+    return 2;
+  case SampleFormat::Pcm24:
+    return 3;
+  case SampleFormat::Float32:
+    return 4;
+  }
+  return 0;
+}
+
+float sampleAt(const uint8_t *p, SampleFormat format) {
+  switch (format) {
+  case SampleFormat::Pcm16: {
+    int16_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return (float)v * (1.0f / 32768.0f);
+  }
+  case SampleFormat::Pcm24: {
+    // Assemble in the top 24 bits so the shift sign-extends
+    const int32_t v = (int32_t)(((uint32_t)p[0] << 8) | ((uint32_t)p[1] << 16) |
+                                ((uint32_t)p[2] << 24)) >>
+                      8;
+    return (float)v * (1.0f / 8388608.0f);
+  }
+  case SampleFormat::Float32: {
+    float v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+  }
+  }
+  return 0.0f;
+}
+
+// Mono float frame of `n` samples from input frame `start`, zero-padded
+// past the end. Mono and stereo PCM16 / float go through the SIMD kernels.
+void loadFrame(const SampleBuffer &input, int64_t start, int n, float *out) {
+  const int count = (int)std::max<int64_t>(
+      0, std::min<int64_t>(n, input.frames - start));
+  const int channels = input.channels;
+  const uint8_t *base = static_cast<const uint8_t *>(input.samples) +
+                        start * channels * bytesPerSample(input.format);
+
+  if (channels == 1 && input.format == SampleFormat::Pcm16) {
+    FrameStats unused;
+    convertPcm16(reinterpret_cast<const int16_t *>(base), count, out, nullptr,
+                 nullptr, 0, &unused);
+  } else if (channels == 1 && input.format == SampleFormat::Float32) {
+    std::memcpy(out, base, count * sizeof(float));
+  } else if (channels == 2 && input.format == SampleFormat::Pcm16) {
+    splitStereoPcm16(reinterpret_cast<const int16_t *>(base), count, true,
+                     out, nullptr, nullptr, nullptr);
+  } else if (channels == 2 && input.format == SampleFormat::Float32) {
+    splitStereoFloat(reinterpret_cast<const float *>(base), count, true, out,
+                     nullptr, nullptr, nullptr);
+  } else {
+    const int bytes = bytesPerSample(input.format);
+    const float scale = 1.0f / (float)channels;
+    for (int i = 0; i < count; ++i) {
+      float sum = 0.0f;
+      for (int c = 0; c < channels; ++c)
+        sum += sampleAt(base + (i * channels + c) * bytes, input.format);
+      out[i] = sum * scale;
+    }
+  }
+  std::fill(out + count, out + n, 0.0f);
+}
+
+// Round-to-nearest-even float -> IEEE half
+uint16_t floatToHalf(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  const uint16_t sign = (uint16_t)((bits >> 16) & 0x8000u);
+  uint32_t mant = bits & 0x7fffffu;
+  const int exp = (int)((bits >> 23) & 0xffu) - 127 + 15;
+
+  if ((bits & 0x7fffffffu) >= 0x7f800000u) // inf / NaN
+    return sign | 0x7c00u | (mant != 0 ? 0x200u : 0u);
+  if (exp >= 31)
+    return sign | 0x7c00u;
+  if (exp <= 0) {
+    if (exp < -10)
+      return sign;
+    mant |= 0x800000u;
+    const int shift = 14 - exp;
+    uint32_t half = mant >> shift;
+    const uint32_t rem = mant & ((1u << shift) - 1);
+    const uint32_t halfway = 1u << (shift - 1);
+    if (rem > halfway || (rem == halfway && (half & 1u)))
+      ++half;
+    return sign | (uint16_t)half;
+  }
+  uint32_t half = ((uint32_t)exp << 10) | (mant >> 13);
+  const uint32_t rem = mant & 0x1fffu;
+  if (rem > 0x1000u || (rem == 0x1000u && (half & 1u)))
+    ++half; // may carry into the exponent, up to inf
+  return sign | (uint16_t)half;
+}
+
+void encodeRow(const Job &job, const float *values, uint8_t *row) {
+  encodeSpectrogramRow(values, job.bins, job.options.format,
+                       job.options.minDb, job.options.maxDb, row);
+}
+
+void runFrames(Job &job, Analyzer &analyzer, int begin, int end) {
+  const int half = job.nfft / 2;
+  std::vector<float> frame(job.nfft), magnitudes(half), mapped(job.maxOut);
+  const int64_t rowBytes = (int64_t)job.bins * job.valueBytes;
+
+  for (int f = begin; f < end && !job.failed.load(); ++f) {
+    loadFrame(job.input, (int64_t)f * job.hop, job.nfft, frame.data());
+    const int bins = analyzer.computeMagnitudes(frame.data(),
+                                                magnitudes.data(), half);
+    if (analyzer.mapBands(magnitudes.data(), bins, mapped.data(),
+                          job.maxOut) != job.bins) {
+      job.failed.store(true);
+      return;
+    }
+    encodeRow(job, mapped.data(), job.out + f * rowBytes);
+  }
+}
+
+// Worker thread body: its own plan, window reference and band table
+void runWorker(Job &job, int begin, int end) {
+  try {
+    Analyzer analyzer(job.nfft, job.options.backend, job.options.window);
+    if (!analyzer.isValid()) {
+      job.failed.store(true);
+      return;
+    }
+    analyzer.setBands(job.options.layout, job.options.bands, job.sampleRate);
+    runFrames(job, analyzer, begin, end);
+  } catch (const std::bad_alloc &) {
+    job.failed.store(true);
+  }
+}
+
+} // namespace
+
+void encodeSpectrogramRow(const float *values, int count,
+                          SpectrogramFormat format, float minDb, float maxDb,
+                          uint8_t *row) {
+  if (format == SpectrogramFormat::Float16) {
+    for (int i = 0; i < count; ++i) {
+      const uint16_t h = floatToHalf(values[i]);
+      std::memcpy(row + i * 2, &h, sizeof(h));
+    }
+    return;
+  }
+
+  const float scale = 255.0f / (maxDb - minDb);
+  for (int i = 0; i < count; ++i) {
+    if (values[i] <= 0.0f) {
+      row[i] = 0;
+      continue;
+    }
+    const float q = (20.0f * log10f(values[i]) - minDb) * scale;
+    row[i] = (uint8_t)(std::min(255.0f, std::max(0.0f, q)) + 0.5f);
+  }
+}
+
+SpectrogramFormat spectrogramFormatFromInt(int value) {
+  return value == (int)SpectrogramFormat::Float16 ? SpectrogramFormat::Float16
+                                                  : SpectrogramFormat::Db8;
+}
+
+bool computeSpectrogram(const SampleBuffer &input, float sampleRate,
+                        const SpectrogramOptions &options, Spectrogram *out) {
+  const int nfft = options.fftSize;
+  const int hop = options.hopSize > 0 ? options.hopSize : nfft / 2;
+  if (out == nullptr || nfft < 2 || nfft % 2 != 0 || hop <= 0 ||
+      input.samples == nullptr || input.channels <= 0 || input.frames <= 0 ||
+      bytesPerSample(input.format) == 0 ||
+      (options.format == SpectrogramFormat::Db8 &&
+       !(options.maxDb > options.minDb)))
+    return false;
+
+  const int64_t frames64 =
+      input.frames < nfft ? 1 : 1 + (input.frames - nfft) / hop;
+  if (frames64 > INT_MAX)
+    return false;
+  const int frames = (int)frames64;
+
+  // The calling thread's analyzer doubles as worker 0 and fixes the band
+  // count every row must have
+  Analyzer analyzer(nfft, options.backend, options.window);
+  if (!analyzer.isValid())
+    return false;
+  analyzer.setBands(options.layout, options.bands, sampleRate);
+
+  Job job;
+  job.input = input;
+  job.sampleRate = sampleRate;
+  job.options = options;
+  job.nfft = nfft;
+  job.hop = hop;
+  job.maxOut = std::max(nfft / 2, options.bands);
+  job.valueBytes = spectrogramValueBytes(options.format);
+
+  try {
+    const std::vector<float> silence(nfft / 2, 0.0f);
+    std::vector<float> mapped(job.maxOut);
+    job.bins =
+        analyzer.mapBands(silence.data(), nfft / 2, mapped.data(), job.maxOut);
+    if (job.bins <= 0)
+      return false;
+    out->data.resize((size_t)frames * job.bins * job.valueBytes);
+  } catch (const std::bad_alloc &) {
+    return false;
+  }
+  job.out = out->data.data();
+
+  int threads = options.threads > 0
+                    ? options.threads
+                    : (int)std::max(1u, std::thread::hardware_concurrency());
+  threads = std::max(
+      1, std::min({threads, kMaxSpectrogramThreads,
+                   frames / kMinFramesPerThread}));
+  const int perThread = (frames + threads - 1) / threads;
+
+  std::vector<std::thread> workers;
+  workers.reserve(threads - 1);
+  // Ranges whose thread could not be started run here instead
+  std::vector<int> local;
+  local.reserve(threads - 1);
+  for (int t = 1; t < threads; ++t) {
+    const int begin = t * perThread;
+    const int end = std::min(frames, begin + perThread);
+    if (begin >= end)
+      break;
+    try {
+      workers.emplace_back(runWorker, std::ref(job), begin, end);
+    } catch (const std::system_error &) {
+      local.push_back(t);
+    }
+  }
+
+  try {
+    runFrames(job, analyzer, 0, std::min(frames, perThread));
+    for (int t : local)
+      runFrames(job, analyzer, t * perThread,
+                std::min(frames, (t + 1) * perThread));
+  } catch (const std::bad_alloc &) {
+    job.failed.store(true);
+  }
+  for (std::thread &worker : workers)
+    worker.join();
+
+  if (job.failed.load()) {
+    out->data.clear();
+    return false;
+  }
+  out->frames = frames;
+  out->bins = job.bins;
+  out->hopSize = hop;
+  out->format = options.format;
+  return true;
+}
+
+} // namespace realtimeaudio
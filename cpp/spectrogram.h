@@ -0,0 +1,85 @@
+#ifndef REALTIMEAUDIO_SPECTROGRAM_H
+#define REALTIMEAUDIO_SPECTROGRAM_H
+
+#include "band_mapper.h"
+#include "fft_backend.h"
+#include "window.h"
+#include <cstdint>
+#include <vector>
+
+namespace realtimeaudio {
+
+enum class SampleFormat : int {
+  Pcm16 = 0,   // int16 little endian
+  Pcm24 = 1,   // packed 3-byte little endian
+  Float32 = 2, // [-1.0, 1.0]
+};
+
+// Interleaved input of any channel count; channels are averaged to mono.
+struct SampleBuffer {
+  const void *samples = nullptr;
+  SampleFormat format = SampleFormat::Pcm16;
+  int channels = 1;
+  int64_t frames = 0;
+};
+
+// Values are shared with the 'uint8' | 'float16' JS names.
+enum class SpectrogramFormat : int {
+  Db8 = 0,     // uint8: 0 at minDb (and below), 255 at maxDb
+  Float16 = 1, // IEEE half of the normalized magnitude
+};
+
+SpectrogramFormat spectrogramFormatFromInt(int value);
+
+// Bytes per value of `format`
+inline int spectrogramValueBytes(SpectrogramFormat format) {
+  return format == SpectrogramFormat::Float16 ? 2 : 1;
+}
+
+// Encodes `count` normalized magnitudes into `row` (count bytes for Db8,
+// 2 * count for Float16). Db8 needs maxDb > minDb.
+void encodeSpectrogramRow(const float *values, int count,
+                          SpectrogramFormat format, float minDb, float maxDb,
+                          uint8_t *row);
+
+struct SpectrogramOptions {
+  int fftSize = 1024;
+  // Samples between frames; <= 0 uses fftSize / 2
+  int hopSize = 0;
+  WindowType window = WindowType::Hann;
+  FftBackendType backend = FftBackendType::Auto;
+  // Same band mapping as live frames; bands <= 0 keeps fftSize / 2 bins
+  BandLayout layout = BandLayout::Linear;
+  int bands = 0;
+  SpectrogramFormat format = SpectrogramFormat::Db8;
+  float minDb = -100.0f;
+  float maxDb = 0.0f;
+  // Worker threads; <= 0 uses the hardware concurrency (capped at
+  // kMaxSpectrogramThreads)
+  int threads = 0;
+};
+
+constexpr int kMaxSpectrogramThreads = 8;
+
+// Row-major [frames][bins] matrix, 1 (Db8) or 2 (Float16) bytes per value.
+struct Spectrogram {
+  int frames = 0;
+  int bins = 0;
+  int hopSize = 0;
+  SpectrogramFormat format = SpectrogramFormat::Db8;
+  std::vector<uint8_t> data;
+};
+
+// Computes the whole STFT of `input` in one call, with magnitudes normalized
+// and band-mapped exactly like live frames. Frame i starts at i * hop; the
+// last frame is the last one that fits entirely (a clip shorter than
+// fftSize gives one zero-padded frame). Frames are split across worker
+// threads, each with its own Analyzer, so plans and scratch are never
+// shared. Returns false for an invalid size or buffer, or if a plan or the
+// output could not be allocated.
+bool computeSpectrogram(const SampleBuffer &input, float sampleRate,
+                        const SpectrogramOptions &options, Spectrogram *out);
+
+} // namespace realtimeaudio
+
+#endif // REALTIMEAUDIO_SPECTROGRAM_H
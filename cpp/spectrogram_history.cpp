@@ -0,0 +1,63 @@
+#include "spectrogram_history.h"
+
+#include <algorithm>
+#include <new>
+
+namespace realtimeaudio {
+
+SpectrogramHistory::SpectrogramHistory(uint32_t frames, uint32_t maxBins,
+                                       SpectrogramFormat format, float minDb,
+                                       float maxDb)
+    : frames_(std::max(frames, 1u)), slots_(frames_ + 1),
+      max_bins_(std::max(maxBins, 1u)), format_(format), min_db_(minDb),
+      max_db_(maxDb),
+      rows_offset_(sizeof(Header) + 2 * slots_ * sizeof(double)),
+      memory_(rows_offset_ + (size_t)2 * slots_ * max_bins_ *
+                                 spectrogramValueBytes(format),
+              0) {
+  Header *h = new (memory_.data()) Header;
+  h->sequence.store(0, std::memory_order_relaxed);
+  h->head = 0;
+  h->count = 0;
+  h->slots = slots_;
+  h->bins = 0;
+  h->maxBins = max_bins_;
+  h->format = (uint32_t)format_;
+  h->restarts = 0;
+  h->minDb = min_db_;
+  h->maxDb = max_db_;
+}
+
+void SpectrogramHistory::push(const float *values, uint32_t bins,
+                              double timestampMs) {
+  bins = std::min(bins, max_bins_);
+  if (values == nullptr || bins == 0)
+    return;
+
+  Header *h = header();
+  if (bins != h->bins) {
+    // Rows are packed at the new width from here on
+    h->bins = bins;
+    h->head = 0;
+    h->count = 0;
+    h->restarts++;
+  }
+
+  const size_t stride = (size_t)bins * spectrogramValueBytes(format_);
+  uint8_t *rows = memory_.data() + rows_offset_;
+  const uint32_t head = h->head;
+  uint8_t *row = rows + head * stride;
+  encodeSpectrogramRow(values, (int)bins, format_, min_db_, max_db_, row);
+  std::copy(row, row + stride, rows + (head + slots_) * stride);
+  timestamps()[head] = timestampMs;
+  timestamps()[head + slots_] = timestampMs;
+
+  h->head = head + 1 == slots_ ? 0 : head + 1;
+  h->count = std::min(h->count + 1, frames_);
+
+  const uint32_t seq = next_sequence_;
+  next_sequence_ = (seq == UINT32_MAX) ? 1 : seq + 1; // 0 stays "none"
+  h->sequence.store(seq, std::memory_order_release);
+}
+
+} // namespace realtimeaudio
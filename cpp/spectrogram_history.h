@@ -0,0 +1,103 @@
+#ifndef REALTIMEAUDIO_SPECTROGRAM_HISTORY_H
+#define REALTIMEAUDIO_SPECTROGRAM_HISTORY_H
+
+#include "spectrogram.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace realtimeaudio {
+
+// Rolling spectrogram of the live frames in one flat block of memory that
+// is exposed to JS as an ArrayBuffer, so a waterfall keeps its history
+// outside the JS heap.
+//
+// Layout (native endianness, mirrored by src/spectrogramHistory.ts):
+//
+//   header      u32 sequence    frames pushed so far (0 = none yet)
+//               u32 head        ring row the next frame goes to, < slots
+//               u32 count       valid rows, <= frames
+//               u32 slots       ring rows, frames + 1
+//               u32 bins        values per row, 0 until the first frame
+//               u32 maxBins     widest row the memory holds
+//               u32 format      SpectrogramFormat (0 uint8 dB, 1 float16)
+//               u32 restarts    bumped whenever `bins` changes
+//               f32 minDb, f32 maxDb
+//   timestamps  f64[2 * slots]          milliseconds since the epoch
+//   rows        [2 * slots][bins]       values encoded as for
+//                                       computeSpectrogram()
+//
+// Every row is written twice, at `head` and at `head + slots`, so the
+// newest n <= count rows always sit at indices [head + slots - n, head +
+// slots): any window reads as one contiguous view, without wrap-around. The
+// spare ring row is the one being written, so it is never part of a window.
+//
+// A single writer (the thread that publishes frames) pushes; readers take
+// (sequence, head, count, bins) and accept them if `sequence` is unchanged.
+// A window of n rows then stays intact for the next frames - n pushes.
+class SpectrogramHistory {
+public:
+  SpectrogramHistory(uint32_t frames, uint32_t maxBins,
+                     SpectrogramFormat format, float minDb, float maxDb);
+
+  SpectrogramHistory(const SpectrogramHistory &) = delete;
+  SpectrogramHistory &operator=(const SpectrogramHistory &) = delete;
+
+  uint32_t frames() const { return frames_; }
+  uint32_t maxBins() const { return max_bins_; }
+  SpectrogramFormat format() const { return format_; }
+  float minDb() const { return min_db_; }
+  float maxDb() const { return max_db_; }
+  uint32_t sequence() const {
+    return header()->sequence.load(std::memory_order_acquire);
+  }
+
+  uint8_t *data() { return memory_.data(); }
+  size_t size() const { return memory_.size(); }
+
+  // Appends one band-mapped frame, truncated to maxBins(); an empty frame
+  // is ignored. A frame of another width restarts the history at that
+  // width, since rows of different band layouts can't line up.
+  void push(const float *values, uint32_t bins, double timestampMs);
+
+private:
+  struct Header {
+    std::atomic<uint32_t> sequence;
+    uint32_t head;
+    uint32_t count;
+    uint32_t slots;
+    uint32_t bins;
+    uint32_t maxBins;
+    uint32_t format;
+    uint32_t restarts;
+    float minDb;
+    float maxDb;
+  };
+  static_assert(sizeof(Header) == 40, "header layout is shared with JS");
+
+  Header *header() { return reinterpret_cast<Header *>(memory_.data()); }
+  const Header *header() const {
+    return reinterpret_cast<const Header *>(memory_.data());
+  }
+  double *timestamps() {
+    return reinterpret_cast<double *>(memory_.data() + sizeof(Header));
+  }
+
+  uint32_t frames_;
+  uint32_t slots_; // frames_ + 1
+  uint32_t max_bins_;
+  SpectrogramFormat format_;
+  float min_db_;
+  float max_db_;
+  size_t rows_offset_;
+  std::vector<uint8_t> memory_; // 8-byte aligned via operator new
+
+  // Writer-side state
+  uint32_t next_sequence_ = 1;
+};
+
+} // namespace realtimeaudio
+
+#endif // REALTIMEAUDIO_SPECTROGRAM_HISTORY_H
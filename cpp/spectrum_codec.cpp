@@ -0,0 +1,119 @@
+#include "spectrum_codec.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace realtimeaudio {
+
+SpectrumFormat spectrumFormatFromInt(int value) {
+  switch (value) {
+  case (int)SpectrumFormat::Db8:
+    return SpectrumFormat::Db8;
+  case (int)SpectrumFormat::Db16:
+    return SpectrumFormat::Db16;
+  default:
+    return SpectrumFormat::Float;
+  }
+}
+
+bool SpectrumEncoder::configure(const SpectrumEncoding &encoding,
+                                int capacity) {
+  encoding_ = encoding;
+  levels_ = 0;
+  capacity_ = 0;
+  previous_count_ = -1;
+  if (encoding.format == SpectrumFormat::Float || capacity <= 0 ||
+      !(encoding.maxDb > encoding.minDb))
+    return false;
+
+  word_bytes_ = encoding.format == SpectrumFormat::Db16 ? 2 : 1;
+  current_.assign((size_t)capacity, 0);
+  previous_.assign((size_t)capacity, 0);
+  capacity_ = capacity;
+  levels_ = encoding.format == SpectrumFormat::Db16 ? 65535u : 255u;
+  return true;
+}
+
+void SpectrumEncoder::putWord(uint8_t *out, int index, uint32_t word) const {
+  if (word_bytes_ == 1) {
+    out[index] = (uint8_t)word;
+    return;
+  }
+  out[index * 2] = (uint8_t)(word & 0xff);
+  out[index * 2 + 1] = (uint8_t)(word >> 8);
+}
+
+int SpectrumEncoder::encodeDelta(int count, uint8_t *out) const {
+  // Fewer words than the keyframe's one per value, or not worth it
+  const int room = count - 1;
+  uint8_t *words = out + 1;
+  int written = 0;
+  int i = 0;
+  while (i < count) {
+    const uint32_t d = (uint32_t)(current_[i] - previous_[i]) & levels_;
+    if (d != 0) {
+      if (written + 1 > room)
+        return -1;
+      putWord(words, written++, d);
+      ++i;
+      continue;
+    }
+    int run = 1;
+    while (i + run < count && (uint32_t)run < levels_ &&
+           current_[i + run] == previous_[i + run])
+      ++run;
+    if (written + 2 > room)
+      return -1;
+    putWord(words, written++, 0);
+    putWord(words, written++, (uint32_t)run);
+    i += run;
+  }
+  out[0] = kSpectrumDelta;
+  return 1 + written * word_bytes_;
+}
+
+int SpectrumEncoder::encode(const float *values, int count, uint8_t *out,
+                            int outCapacity) {
+  if (!enabled() || values == nullptr || count <= 0)
+    return 0;
+  count = std::min(count, capacity_);
+  const int keyframeBytes = maxBytes(count);
+  if (out == nullptr || outCapacity < keyframeBytes)
+    return -1;
+
+  // Same mapping as the uint8 spectrogram, at 8 or 16 bits
+  const float minDb = encoding_.minDb;
+  const float top = (float)levels_;
+  const float scale = top / (encoding_.maxDb - minDb);
+  for (int i = 0; i < count; ++i) {
+    const float v = values[i];
+    if (!(v > 0.0f)) {
+      current_[i] = 0;
+      continue;
+    }
+    const float q = (20.0f * log10f(v) - minDb) * scale;
+    current_[i] = (uint16_t)(std::min(top, std::max(0.0f, q)) + 0.5f);
+  }
+
+  const int interval = encoding_.keyframeInterval;
+  int bytes = -1;
+  if (encoding_.delta && previous_count_ == count &&
+      (interval <= 0 || since_keyframe_ + 1 < interval))
+    bytes = encodeDelta(count, out);
+
+  if (bytes < 0) {
+    out[0] = kSpectrumKeyframe;
+    for (int i = 0; i < count; ++i)
+      putWord(out + 1, i, current_[i]);
+    bytes = keyframeBytes;
+    since_keyframe_ = 0;
+  } else {
+    ++since_keyframe_;
+  }
+
+  current_.swap(previous_);
+  previous_count_ = count;
+  return bytes;
+}
+
+} // namespace realtimeaudio
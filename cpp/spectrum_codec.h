@@ -0,0 +1,85 @@
+#ifndef REALTIMEAUDIO_SPECTRUM_CODEC_H
+#define REALTIMEAUDIO_SPECTRUM_CODEC_H
+
+#include <cstdint>
+#include <vector>
+
+namespace realtimeaudio {
+
+// Values are shared with the 'float' | 'uint8' | 'uint16' JS names.
+enum class SpectrumFormat : int {
+  Float = 0, // plain number arrays, not encoded
+  Db8 = 1,   // uint8: 0 at minDb (and below), 255 at maxDb
+  Db16 = 2,  // uint16 little endian: 0 at minDb, 65535 at maxDb
+};
+
+SpectrumFormat spectrumFormatFromInt(int value);
+
+struct SpectrumEncoding {
+  SpectrumFormat format = SpectrumFormat::Db8;
+  float minDb = -100.0f;
+  float maxDb = 0.0f;
+  // Code each frame against the previous one (see SpectrumEncoder)
+  bool delta = false;
+  // At most this many frames from one keyframe to the next, counting the
+  // keyframe; <= 0 only sends keyframes when a delta can't be used
+  int keyframeInterval = 30;
+};
+
+// First byte of every encoded frame
+constexpr uint8_t kSpectrumKeyframe = 1; // values follow as is
+constexpr uint8_t kSpectrumDelta = 0;    // differences to the previous frame
+
+// Quantizes band magnitudes to dB codes for compact event payloads:
+//
+//   keyframe  [1][q0][q1]...            one word (1 or 2 bytes) per value
+//   delta     [0][d or 0, run]...       d = (q - previous q) mod 2^bits;
+//                                       a 0 word is followed by the number
+//                                       of unchanged values it stands for
+//
+// A delta frame is only emitted when it is smaller than the keyframe, the
+// frame has as many values as the previous one and the keyframe interval
+// has not run out; so a listener that joins late, or a decoder that lost
+// its state, recovers at the next keyframe.
+//
+// Not thread-safe: one encoder per stream (the main spectrum, each
+// channel's spectrum), used by the delivering thread.
+class SpectrumEncoder {
+public:
+  // Sizes the state for frames of up to `capacity` values. Allocates, so
+  // call it before delivery starts. Returns false (and stays disabled) for
+  // SpectrumFormat::Float or an empty dB range.
+  bool configure(const SpectrumEncoding &encoding, int capacity);
+  bool enabled() const { return levels_ > 0; }
+  const SpectrumEncoding &encoding() const { return encoding_; }
+
+  // Bytes encode() may write for `count` values (the keyframe size)
+  int maxBytes(int count) const { return 1 + count * word_bytes_; }
+
+  // The next frame is a keyframe.
+  void reset() { previous_count_ = -1; }
+
+  // Encodes `count` magnitudes (clamped to the capacity) into `out`.
+  // Returns the bytes written, 0 for an empty frame or a disabled encoder,
+  // or -1 if `out` holds fewer than maxBytes(count).
+  int encode(const float *values, int count, uint8_t *out, int outCapacity);
+
+private:
+  // Delta frame of current_ against previous_; -1 once it would not be
+  // smaller than the keyframe
+  int encodeDelta(int count, uint8_t *out) const;
+  void putWord(uint8_t *out, int index, uint32_t word) const;
+
+  SpectrumEncoding encoding_;
+  uint32_t levels_ = 0; // highest code: 255 or 65535, 0 = disabled
+  int word_bytes_ = 1;
+  int capacity_ = 0;
+  std::vector<uint16_t> current_;
+  std::vector<uint16_t> previous_;
+  int previous_count_ = -1; // values in previous_, -1 = none
+  int since_keyframe_ = 0;  // frames since the last keyframe
+};
+
+} // namespace realtimeaudio
+
+#endif // REALTIMEAUDIO_SPECTRUM_CODEC_H
@@ -0,0 +1,241 @@
+#include "subscriber_graph.h"
+
+#include "analyzer.h"
+#include "frame_queue.h"
+#include "perf_stats.h"
+
+#include <algorithm>
+#include <new>
+
+namespace realtimeaudio {
+
+namespace {
+
+// Zeroes the features `mask` leaves out
+SpectralFeatures maskFeatures(const SpectralFeatures &f, uint32_t mask) {
+  SpectralFeatures out;
+  if ((mask & kFeatureCentroid) != 0)
+    out.centroid = f.centroid;
+  if ((mask & kFeatureFlux) != 0)
+    out.flux = f.flux;
+  if ((mask & kFeatureRolloff) != 0)
+    out.rolloff = f.rolloff;
+  if ((mask & kFeatureFlatness) != 0)
+    out.flatness = f.flatness;
+  if ((mask & kFeatureOnset) != 0)
+    out.onset = f.onset;
+  if ((mask & kFeaturePitch) != 0) {
+    out.pitch = f.pitch;
+    out.pitchConfidence = f.pitchConfidence;
+  }
+  return out;
+}
+
+bool spectral(const SubscriberConfig &config) {
+  return config.spectrum || config.features != 0;
+}
+
+// Third-octave bands follow the range, so they map whatever `bands` says
+bool mapped(const SubscriberConfig &config) {
+  return config.bands > 0 || config.layout == BandLayout::ThirdOctave;
+}
+
+} // namespace
+
+SubscriberGraph::~SubscriberGraph() {
+  delete pending_.exchange(nullptr);
+  delete retired_.exchange(nullptr);
+  delete live_;
+}
+
+bool SubscriberGraph::set(int32_t id, const SubscriberConfig &config) {
+  SubscriberConfig clamped = config;
+  clamped.rateHz = std::min(std::max(config.rateHz, kMinRateHz), kMaxRateHz);
+  clamped.features &= kFeatureAll;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = std::find_if(configs_.begin(), configs_.end(),
+                         [id](const auto &entry) { return entry.first == id; });
+  if (it != configs_.end()) {
+    it->second = clamped;
+  } else {
+    if ((int)configs_.size() >= kMaxSubscribers)
+      return false;
+    configs_.emplace_back(id, clamped);
+  }
+  return publishSet();
+}
+
+bool SubscriberGraph::remove(int32_t id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = std::find_if(configs_.begin(), configs_.end(),
+                         [id](const auto &entry) { return entry.first == id; });
+  if (it == configs_.end())
+    return false;
+  configs_.erase(it);
+  return publishSet();
+}
+
+void SubscriberGraph::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  configs_.clear();
+  publishSet();
+}
+
+int SubscriberGraph::count() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return (int)configs_.size();
+}
+
+void SubscriberGraph::setSpectrum(int fftSize, float sampleRate) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (fftSize == fft_size_ && sampleRate == sample_rate_)
+    return;
+  fft_size_ = fftSize;
+  sample_rate_ = sampleRate;
+  publishSet();
+}
+
+uint32_t SubscriberGraph::featureMask() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint32_t mask = 0;
+  for (const auto &entry : configs_)
+    mask |= entry.second.features;
+  return mask;
+}
+
+bool SubscriberGraph::wantsMeters() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return std::any_of(configs_.begin(), configs_.end(),
+                     [](const auto &entry) { return entry.second.meters; });
+}
+
+bool SubscriberGraph::wantsSpectrum() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return std::any_of(configs_.begin(), configs_.end(),
+                     [](const auto &entry) { return spectral(entry.second); });
+}
+
+bool SubscriberGraph::publishSet() {
+  delete retired_.exchange(nullptr);
+  Set *set = new (std::nothrow) Set();
+  if (set == nullptr)
+    return false;
+  try {
+    set->nodes.resize(configs_.size());
+  } catch (const std::bad_alloc &) {
+    delete set;
+    return false;
+  }
+  set->fftSize = fft_size_;
+  set->sampleRate = sample_rate_;
+  for (size_t i = 0; i < configs_.size(); ++i) {
+    Node &node = set->nodes[i];
+    node.id = configs_[i].first;
+    node.config = configs_[i].second;
+    node.intervalNs = (int64_t)(1e9 / node.config.rateHz);
+    if (node.config.spectrum && mapped(node.config) && fft_size_ > 0 &&
+        sample_rate_ > 0.0f)
+      node.mapper.configure(node.config.layout, fft_size_ / 2,
+                            node.config.bands, fft_size_, sample_rate_);
+  }
+  // A set the audio thread never adopted is simply replaced
+  delete pending_.exchange(set);
+  return true;
+}
+
+int SubscriberGraph::poll(int64_t nowNs) {
+  if (Set *next = pending_.exchange(nullptr)) {
+    // Surviving subscribers keep their schedule; new ones are due now
+    if (live_ != nullptr) {
+      for (Node &node : next->nodes) {
+        for (const Node &old : live_->nodes) {
+          if (old.id == node.id) {
+            node.nextNs = old.nextNs;
+            break;
+          }
+        }
+      }
+    }
+    // Freed by the next control call; if the slot is still occupied the
+    // older set is freed here (rare)
+    delete retired_.exchange(live_);
+    live_ = next;
+  }
+  if (live_ == nullptr)
+    return 0;
+
+  int bits = 0;
+  for (Node &node : live_->nodes) {
+    node.due = nowNs >= node.nextNs;
+    if (node.due)
+      bits |= kDue | (spectral(node.config) ? kSpectral : 0);
+  }
+  return bits;
+}
+
+int SubscriberGraph::mapBands(Node &node, const float *spectrum, int bins,
+                              int nfft, float sampleRate, float *out,
+                              int maxOut) {
+  const SubscriberConfig &c = node.config;
+  const bool passThrough =
+      !mapped(c) || nfft <= 0 || sampleRate <= 0.0f ||
+      (c.layout == BandLayout::Linear && c.bands >= nfft / 2);
+  if (passThrough) {
+    const int count = std::max(0, std::min(bins, maxOut));
+    std::copy(spectrum, spectrum + count, out);
+    return count;
+  }
+  const int bands = node.mapper.configure(c.layout, bins, c.bands, nfft,
+                                          sampleRate);
+  if (bands <= 0 || bands > maxOut)
+    return 0;
+  node.mapper.apply(spectrum, out);
+  return bands;
+}
+
+int SubscriberGraph::publish(FrameQueue &queue, Analyzer &analyzer,
+                             const float *magnitudes, int bins, float rms,
+                             float peak, double timestampMs,
+                             uint32_t bufferSize, int64_t nowNs) {
+  if (live_ == nullptr)
+    return 0;
+  PerfStats *perf = analyzer.perfStats();
+  PerfScope scope(perf, PerfStage::Publish);
+
+  int pushed = 0;
+  for (Node &node : live_->nodes) {
+    if (!node.due)
+      continue;
+    node.due = false;
+
+    float *dst = queue.beginPush();
+    FrameInfo info;
+    info.timestampMs = timestampMs;
+    info.rms = rms;
+    info.peak = peak;
+    if (node.config.spectrum && magnitudes != nullptr && bins > 0)
+      info.bins = (uint32_t)mapBands(node, magnitudes, bins, analyzer.size(),
+                                     live_->sampleRate, dst,
+                                     (int)queue.capacity());
+    info.bufferSize = bufferSize;
+    info.fftSize = (uint32_t)analyzer.size();
+    info.pushedNs = PerfStats::nowNs();
+    info.features = maskFeatures(analyzer.features(), node.config.features);
+    if (node.config.meters)
+      info.meters = analyzer.meters();
+    info.subscriber = node.id;
+    queue.endPush(info);
+    ++pushed;
+
+    // Whole intervals keep the average rate; resync after a stall
+    node.nextNs += node.intervalNs;
+    if (node.nextNs <= nowNs)
+      node.nextNs = nowNs + node.intervalNs;
+  }
+  if (perf != nullptr && pushed > 0)
+    perf->observeQueue(queue.size(), queue.dropped());
+  return pushed;
+}
+
+} // namespace realtimeaudio
@@ -0,0 +1,120 @@
+#ifndef REALTIMEAUDIO_SUBSCRIBER_GRAPH_H
+#define REALTIMEAUDIO_SUBSCRIBER_GRAPH_H
+
+#include "band_mapper.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace realtimeaudio {
+
+class Analyzer;
+class FrameQueue;
+
+// What one consumer wants from the shared analysis
+struct SubscriberConfig {
+  float rateHz = 30.0f; // frames per second, clamped to [kMinRateHz, kMaxRateHz]
+  bool spectrum = true; // ship the spectrum, mapped per `layout` / `bands`
+  BandLayout layout = BandLayout::Linear;
+  int bands = 0;         // <= 0 ships raw bins, except for ThirdOctave
+  uint32_t features = 0; // FeatureFlags; the rest are zeroed
+  bool meters = false;   // the analyzer's meter readings (RMS, LUFS)
+};
+
+// Fan-out of one Analyzer's frames to several consumers. The engine still
+// runs one STFT per hop; each subscriber only adds its own band mapping
+// and schedule, and gets its frames through the engine's FrameQueue with
+// FrameInfo::subscriber set to its id. Subscriber frames carry the mapped
+// downmix spectrum, the levels and the requested features and meters;
+// channel spectra and the voice gate stay with the main stream.
+//
+// Subscribers are added and removed on control threads, which build a new
+// immutable set (including the band tables) and hand it to the audio
+// thread through an atomic slot, as Analyzer does with its plans; the
+// audio thread adopts it at the next poll() and keeps each surviving
+// subscriber's schedule. The audio side never locks or allocates, except
+// that a band table is rebuilt if the FFT size or rate differs from the
+// one set on the control side.
+class SubscriberGraph {
+public:
+  static constexpr int kMaxSubscribers = 8;
+  static constexpr float kMinRateHz = 1.0f;
+  static constexpr float kMaxRateHz = 120.0f;
+
+  // poll() bits
+  static constexpr int kDue = 1;      // some subscriber is due
+  static constexpr int kSpectral = 2; // and needs the magnitudes
+
+  SubscriberGraph() = default;
+  ~SubscriberGraph();
+
+  SubscriberGraph(const SubscriberGraph &) = delete;
+  SubscriberGraph &operator=(const SubscriberGraph &) = delete;
+
+  // Control threads. Adds `id`, or replaces its config; false when
+  // kMaxSubscribers others exist or on allocation failure.
+  bool set(int32_t id, const SubscriberConfig &config);
+  bool remove(int32_t id);
+  void clear();
+  int count() const;
+  // Spectrum geometry the band tables are built for ahead of time
+  void setSpectrum(int fftSize, float sampleRate);
+
+  // Products some subscriber asks for; sessions compute their union
+  uint32_t featureMask() const;
+  bool wantsMeters() const;
+  bool wantsSpectrum() const;
+
+  // Audio thread. Adopts a pending set and marks the subscribers due at
+  // `nowNs` (any monotonic clock, as long as it doesn't change); returns
+  // kDue / kSpectral bits.
+  int poll(int64_t nowNs);
+
+  // Pushes one frame into `queue` for every subscriber poll() marked due,
+  // mapping `bins` magnitudes of the analyzer's current size each (null or
+  // 0 for levels only), and moves their schedules on. Features and meters
+  // come from `analyzer`. Returns the frames pushed.
+  int publish(FrameQueue &queue, Analyzer &analyzer, const float *magnitudes,
+              int bins, float rms, float peak, double timestampMs,
+              uint32_t bufferSize, int64_t nowNs);
+
+private:
+  struct Node {
+    int32_t id = 0;
+    SubscriberConfig config;
+    int64_t intervalNs = 0;
+    int64_t nextNs = 0;
+    bool due = false;
+    BandMapper mapper;
+  };
+  struct Set {
+    std::vector<Node> nodes;
+    int fftSize = 0; // geometry the band tables were built for
+    float sampleRate = 0.0f;
+  };
+
+  // Builds the set for configs_ and hands it to the audio thread; called
+  // with mutex_ held
+  bool publishSet();
+  // Maps (or copies) `bins` magnitudes into `out` for `node`
+  static int mapBands(Node &node, const float *spectrum, int bins, int nfft,
+                      float sampleRate, float *out, int maxOut);
+
+  // Control side
+  mutable std::mutex mutex_;
+  std::vector<std::pair<int32_t, SubscriberConfig>> configs_;
+  int fft_size_ = 0;
+  float sample_rate_ = 0.0f;
+
+  // Handoff slots as in Analyzer: control -> audio (pending) and back
+  // (retired, freed by the next control call or the destructor)
+  std::atomic<Set *> pending_{nullptr};
+  std::atomic<Set *> retired_{nullptr};
+  Set *live_ = nullptr; // audio thread only
+};
+
+} // namespace realtimeaudio
+
+#endif // REALTIMEAUDIO_SUBSCRIBER_GRAPH_H
@@ -0,0 +1,126 @@
+// Checks the pitch estimate, in cents, from the low limit up.
+//
+//   cmake -S android -B build && cmake --build build
+//   ctest --test-dir build
+//
+// Feeds one-second tones through a 2048-point Hann Analyzer at 48 kHz and
+// reads the pitch of the last frame: sines and five-harmonic tones at
+// 50-80 Hz, near the lowest detectable pitch (2 * rate / nfft, 47 Hz),
+// where a circular autocorrelation would alias long lags, and a few
+// mid-range tones, which must be all but exact. The fixed-point and stereo
+// paths rebuild the frame the detector sees differently, so they are run
+// too.
+
+#include "analyzer.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using realtimeaudio::Analyzer;
+using realtimeaudio::ChannelMode;
+using realtimeaudio::FftBackendType;
+
+namespace {
+
+constexpr float kRate = 48000.0f;
+constexpr int kNfft = 2048;
+constexpr int kReadFrames = 512;
+constexpr long kLength = (long)kRate;
+constexpr float kMinConfidence = 0.8f;
+
+struct Tone {
+  float frequency;
+  int harmonics; // partials at 1/h amplitude
+  double maxCents;
+};
+
+struct Path {
+  const char *name;
+  FftBackendType backend;
+  ChannelMode mode;
+  bool pcm16;
+};
+
+float sample(const Tone &tone, long t) {
+  double v = 0.0;
+  for (int h = 1; h <= tone.harmonics; ++h)
+    v += std::sin(2.0 * M_PI * tone.frequency * h * t / kRate) / h;
+  return (float)(0.4 * v / tone.harmonics);
+}
+
+// Pitch and confidence of the last frame of `tone`
+void detect(const Path &path, const Tone &tone, float *pitch,
+            float *confidence) {
+  Analyzer analyzer(kNfft, path.backend, realtimeaudio::WindowType::Hann,
+                    path.mode);
+  analyzer.setHopSize(kNfft / 2);
+  analyzer.setFeatures(realtimeaudio::kFeaturePitch, kRate);
+  const int channels = analyzer.inputChannels();
+  std::vector<float> read(kReadFrames * channels);
+  std::vector<int16_t> pcm(kReadFrames * channels);
+  std::vector<float> magnitudes(kNfft / 2);
+  for (long t = 0; t + kReadFrames <= kLength; t += kReadFrames) {
+    for (int i = 0; i < kReadFrames; ++i) {
+      for (int c = 0; c < channels; ++c) {
+        // Stereo: the tone on the left only, so the detector must see the
+        // downmix and not one channel
+        const float v = c == 0 ? sample(tone, t + i) : 0.0f;
+        read[i * channels + c] = v;
+        pcm[i * channels + c] = (int16_t)std::lrint(v * 32767.0f);
+      }
+    }
+    const int count = kReadFrames * channels;
+    if (path.pcm16)
+      analyzer.processPcm16(pcm.data(), count, kNfft, magnitudes.data(),
+                            (int)magnitudes.size(), nullptr);
+    else
+      analyzer.processFloat(read.data(), count, kNfft, magnitudes.data(),
+                            (int)magnitudes.size(), nullptr);
+  }
+  *pitch = analyzer.features().pitch;
+  *confidence = analyzer.features().pitchConfidence;
+}
+
+} // namespace
+
+int main() {
+  const Path paths[] = {
+      {"float", FftBackendType::Auto, ChannelMode::Mono, false},
+      {"kissfft-q15", FftBackendType::KissQ15, ChannelMode::Mono, true},
+      {"stereo", FftBackendType::Auto, ChannelMode::Stereo, false},
+  };
+  const Tone tones[] = {
+      // Low limit: under three periods per frame
+      {50.0f, 1, 5.0},    {55.0f, 1, 5.0},   {60.0f, 1, 5.0},
+      {70.0f, 1, 5.0},    {80.0f, 1, 5.0},   {55.0f, 5, 5.0},
+      {60.0f, 5, 5.0},    {70.0f, 5, 5.0},   {80.0f, 5, 5.0},
+      // Mid range
+      {110.0f, 1, 0.5},   {220.0f, 5, 0.5},  {440.0f, 1, 0.5},
+      {440.0f, 5, 0.5},   {1000.0f, 1, 0.5}, {2500.0f, 1, 0.5},
+  };
+
+  bool ok = true;
+  for (const Path &path : paths) {
+    int failed = 0;
+    for (const Tone &tone : tones) {
+      float pitch = 0.0f, confidence = 0.0f;
+      detect(path, tone, &pitch, &confidence);
+      const double cents =
+          pitch > 0.0f ? 1200.0 * std::log2(pitch / tone.frequency) : 1e9;
+      const bool good =
+          std::fabs(cents) <= tone.maxCents && confidence >= kMinConfidence;
+      if (!good)
+        std::printf("FAIL %-12s %7.1f Hz x%d -> %.2f Hz (%+.1f cents, "
+                    "confidence %.2f)\n",
+                    path.name, tone.frequency, tone.harmonics, pitch, cents,
+                    confidence);
+      failed += good ? 0 : 1;
+    }
+    std::printf("%s %-12s %d of %d tones off\n", failed == 0 ? "ok  " : "FAIL",
+                path.name, failed, (int)(sizeof(tones) / sizeof(tones[0])));
+    ok = ok && failed == 0;
+  }
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,343 @@
+// Asserts the per-frame native path allocates nothing once warm.
+//
+//   cmake -S android -B build && cmake --build build
+//   ctest --test-dir build
+//
+// Drives the same calls as the Android capture loops for every backend and
+// channel mode: registered-buffer PCM16 processing with features, level
+// meters and the voice activity gate (open from the first read), band
+// mapping into the FrameQueue (pushFrame) and the spectrogram
+// history, the delivery-side pop with compact spectrum encoding and a
+// FrameStore publish. Heap use is counted by replacing the global operator
+// new, so any allocation after warm-up fails the test. A live FFT resize is
+// included: the plan is prepared off the "audio thread" and must only be
+// swapped in. Stage timing (PerfStats) stays attached throughout, as it is
+// in the app. Delta-coded spectra are decoded again and must match the
+// keyframe-only encoding of the same frames.
+
+#include "analyzer.h"
+#include "frame_queue.h"
+#include "frame_store.h"
+#include "perf_stats.h"
+#include "spectrogram_history.h"
+#include "spectrum_codec.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+namespace {
+
+std::atomic<long> g_allocations{0};
+
+} // namespace
+
+void *operator new(std::size_t size) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void *p = std::malloc(size ? size : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) { return operator new(size); }
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  return std::malloc(size ? size : 1);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &tag) noexcept {
+  return operator new(size, tag);
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+
+using realtimeaudio::Analyzer;
+using realtimeaudio::BandLayout;
+using realtimeaudio::ChannelMode;
+using realtimeaudio::FftBackendType;
+using realtimeaudio::FrameInfo;
+using realtimeaudio::FrameQueue;
+using realtimeaudio::FrameStore;
+using realtimeaudio::kFeatureAll;
+using realtimeaudio::PerfScope;
+using realtimeaudio::PerfStage;
+using realtimeaudio::PerfStats;
+using realtimeaudio::SpectrogramHistory;
+using realtimeaudio::SpectrumEncoder;
+using realtimeaudio::SpectrumEncoding;
+using realtimeaudio::SpectrumFormat;
+
+namespace {
+
+// Applies one encoded frame (cpp/spectrum_codec.h) to `codes`; false if it
+// is malformed or a delta without a matching previous frame
+bool decodeSpectrum(const uint8_t *data, int bytes, int wordBytes,
+                    std::vector<uint16_t> &codes, int *count) {
+  auto word = [&](int i) -> uint32_t {
+    const uint8_t *w = data + 1 + i * wordBytes;
+    return wordBytes == 1 ? w[0] : (uint32_t)(w[0] | (w[1] << 8));
+  };
+  const int words = (bytes - 1) / wordBytes;
+  const uint32_t mask = wordBytes == 1 ? 0xffu : 0xffffu;
+  if (data[0] == realtimeaudio::kSpectrumKeyframe) {
+    for (int i = 0; i < words; ++i)
+      codes[i] = (uint16_t)word(i);
+    *count = words;
+    return true;
+  }
+  int i = 0;
+  for (int w = 0; w < words; ++w) {
+    const uint32_t d = word(w);
+    if (d == 0) {
+      if (++w >= words)
+        return false;
+      i += (int)word(w);
+      continue;
+    }
+    if (i >= *count)
+      return false;
+    codes[i] = (uint16_t)((codes[i] + d) & mask);
+    ++i;
+  }
+  return i == *count;
+}
+
+constexpr int kReadFrames = 256;
+constexpr int kMaxBins = 8192;
+constexpr int kWarmupReads = 32;
+constexpr int kMeasuredReads = 256;
+
+struct Case {
+  const char *name;
+  FftBackendType backend;
+  ChannelMode mode;
+};
+
+// One capture session: analyzer, registered buffers, queue and store set up
+// as AudioEngine.start() does, then reads until `reads` are done
+class Session {
+public:
+  Session(const Case &c, int nfft)
+      : analyzer_(nfft, c.backend, realtimeaudio::WindowType::Hann, c.mode),
+        channels_(analyzer_.inputChannels()),
+        pcm_(kReadFrames * channels_), output_(kMaxBins + 1), stats_(2),
+        queue_(8, kMaxBins * 3), store_(kMaxBins), popped_(kMaxBins * 3),
+        encoded_(1 + kMaxBins * 2), keyframe_(1 + kMaxBins * 2),
+        codes_(kMaxBins), reference_(kMaxBins),
+        history_(256, kMaxBins, realtimeaudio::SpectrogramFormat::Db8,
+                 -100.0f, 0.0f) {
+    analyzer_.setHopSize(nfft / 4);
+    analyzer_.setBands(BandLayout::Mel, 64, 48000.0f);
+    analyzer_.setFeatures(kFeatureAll, 48000.0f);
+    analyzer_.setSmoothing(true, 0.5f);
+    analyzer_.setMeters(true, realtimeaudio::MeterSettings(), 48000.0f);
+    // The steady tone would sit on the noise floor: fixed threshold only,
+    // opening at once so every read still takes frames
+    realtimeaudio::VoiceActivitySettings voice;
+    voice.noiseMarginDb = 0.0f;
+    voice.attackMs = 0.0f;
+    analyzer_.setVoiceActivity(true, voice, 48000.0f);
+    analyzer_.setBuffers(pcm_.data(), (int)pcm_.size(), output_.data(),
+                         (int)output_.size(), stats_.data());
+    analyzer_.setPerfStats(&perf_);
+    analyzer_.setHistory(&history_);
+
+    SpectrumEncoding encoding;
+    encoding.format = SpectrumFormat::Db8;
+    encoding.delta = true;
+    delta_.configure(encoding, kMaxBins);
+    encoding.delta = false;
+    plain_.configure(encoding, kMaxBins);
+  }
+
+  bool valid() const { return analyzer_.isValid(); }
+  Analyzer &analyzer() { return analyzer_; }
+
+  // A 440 Hz tone plus a little noise, so features and pitch do real work
+  void read(int nfft) {
+    for (int i = 0; i < kReadFrames; ++i) {
+      const double t = (double)(sample_++) / 48000.0;
+      const double v = 0.4 * std::sin(2.0 * M_PI * 440.0 * t) +
+                       0.01 * ((double)(std::rand() % 2001) / 1000.0 - 1.0);
+      for (int c = 0; c < channels_; ++c)
+        pcm_[i * channels_ + c] = (int16_t)(v * (c == 0 ? 32767.0 : 16000.0));
+    }
+
+    const int bins = analyzer_.processRegistered(kReadFrames * channels_,
+                                                 nfft, true);
+    if (bins > 0)
+      last_bins_ = bins;
+
+    perf_.countRead(bins > 0);
+
+    // pushFrame(): band-map the spectrum straight into the queue slot
+    {
+      PerfScope publish(&perf_, PerfStage::Publish);
+      float *dst = queue_.beginPush();
+      FrameInfo info;
+      info.rms = stats_[0];
+      info.peak = stats_[1];
+      info.fftSize = (uint32_t)nfft;
+      info.bins = (uint32_t)analyzer_.mapBands(analyzer_.registeredOutput(),
+                                               last_bins_, dst, kMaxBins);
+      if (SpectrogramHistory *history = analyzer_.history())
+        history->push(dst, info.bins, (double)sample_ / 48.0);
+      info.features = analyzer_.features();
+      info.meters = analyzer_.meters();
+      info.voice = analyzer_.voiceActivity();
+      if (channels_ > 1) {
+        info.channels = Analyzer::kMaxChannels;
+        info.channelLevels[0] = analyzer_.channelLevels(0);
+        info.channelLevels[1] = analyzer_.channelLevels(1);
+        info.channelBins = (uint32_t)analyzer_.mapChannelBands(
+            dst + info.bins, (int)queue_.capacity() - (int)info.bins);
+      }
+      info.pushedNs = PerfStats::nowNs();
+      queue_.endPush(info);
+      perf_.observeQueue(queue_.size(), queue_.dropped());
+    }
+
+    // Delivery thread side
+    FrameInfo out;
+    queue_.pop(out, popped_.data(), (uint32_t)popped_.size());
+    perf_.record(PerfStage::Queue, PerfStats::nowNs() - out.pushedNs);
+    encode(out.bins);
+
+    // Shared-memory delivery
+    float *slot = store_.beginFrame();
+    const int mapped = analyzer_.mapBands(analyzer_.registeredOutput(),
+                                          last_bins_, slot, kMaxBins);
+    store_.endFrame((uint32_t)mapped, stats_[0], stats_[1], 0.0);
+  }
+
+  const PerfStats &perf() const { return perf_; }
+  const SpectrogramHistory &history() const { return history_; }
+  int deltaFrames() const { return delta_frames_; }
+  bool decoded() const { return decoded_; }
+
+private:
+  // Compact payload of the popped spectrum, checked against a keyframe
+  void encode(uint32_t bins) {
+    const int bytes = delta_.encode(popped_.data(), (int)bins, encoded_.data(),
+                                    (int)encoded_.size());
+    const int reference = plain_.encode(popped_.data(), (int)bins,
+                                        keyframe_.data(), (int)keyframe_.size());
+    if (bytes <= 0)
+      return;
+    if (encoded_[0] == realtimeaudio::kSpectrumDelta)
+      ++delta_frames_;
+    int referenceCount = 0;
+    decoded_ = decoded_ &&
+               decodeSpectrum(encoded_.data(), bytes, 1, codes_, &count_) &&
+               decodeSpectrum(keyframe_.data(), reference, 1, reference_,
+                              &referenceCount) &&
+               count_ == referenceCount &&
+               std::equal(codes_.begin(), codes_.begin() + count_,
+                          reference_.begin());
+  }
+
+  PerfStats perf_;
+  Analyzer analyzer_;
+  int channels_;
+  std::vector<int16_t> pcm_;
+  std::vector<float> output_;
+  std::vector<float> stats_;
+  FrameQueue queue_;
+  FrameStore store_;
+  std::vector<float> popped_;
+  SpectrumEncoder delta_;
+  SpectrumEncoder plain_;
+  std::vector<uint8_t> encoded_;
+  std::vector<uint8_t> keyframe_;
+  std::vector<uint16_t> codes_;
+  std::vector<uint16_t> reference_;
+  int count_ = 0;
+  int delta_frames_ = 0;
+  bool decoded_ = true;
+  long sample_ = 0;
+  int last_bins_ = 0;
+  SpectrogramHistory history_;
+};
+
+bool runCase(const Case &c) {
+  const int nfft = 1024;
+  Session session(c, nfft);
+  if (!session.valid()) {
+    std::printf("FAIL %-22s no plan\n", c.name);
+    return false;
+  }
+
+  for (int i = 0; i < kWarmupReads; ++i)
+    session.read(nfft);
+
+  const long before = g_allocations.load();
+  for (int i = 0; i < kMeasuredReads; ++i)
+    session.read(nfft);
+  const long steady = g_allocations.load() - before;
+
+  // Live resize: the control thread prepares, the read only swaps
+  const int resized = 2048;
+  session.analyzer().preparePlan(resized);
+  const long beforeSwap = g_allocations.load();
+  for (int i = 0; i < kMeasuredReads; ++i)
+    session.read(resized);
+  const long swap = g_allocations.load() - beforeSwap;
+
+  realtimeaudio::PerfSnapshot perf;
+  session.perf().snapshot(&perf);
+  const uint64_t reads = kWarmupReads + 2 * kMeasuredReads;
+  const bool counted = perf.reads == reads &&
+                       perf.stages[(int)PerfStage::Analyze].count == reads &&
+                       perf.stages[(int)PerfStage::Fft].count > 0;
+
+  // The tone is well above silence on every meter
+  const realtimeaudio::MeterLevels &meters = session.analyzer().meters();
+  const bool metered = meters.rms > 0.1f && meters.peakHold > 0.3f &&
+                       meters.momentaryLufs > -30.0f;
+
+  // Frames between hops repeat and the tone is steady, so many go out as
+  // deltas; every one must decode to the keyframe values
+  const bool encoded = session.decoded() && session.deltaFrames() > 0;
+
+  // Every pushed frame lands in the history ring, wrapping many times
+  const bool recorded = session.history().sequence() == reads;
+
+  const bool ok = steady == 0 && swap == 0 && counted && metered && encoded &&
+                  recorded;
+  std::printf("%s %-22s steady %ld allocs / %d reads, resize %ld, "
+              "%d delta frames%s%s%s%s\n",
+              ok ? "ok  " : "FAIL", c.name, steady, kMeasuredReads, swap,
+              session.deltaFrames(), counted ? "" : ", perf counters off",
+              metered ? "" : ", meters off",
+              encoded ? "" : ", encoding off",
+              recorded ? "" : ", history off");
+  return ok;
+}
+
+} // namespace
+
+int main() {
+  const Case cases[] = {
+      {"auto/mono", FftBackendType::Auto, ChannelMode::Mono},
+      {"kissfft/mono", FftBackendType::Kiss, ChannelMode::Mono},
+      {"realfft/mono", FftBackendType::Real, ChannelMode::Mono},
+      {"kissfft-q15/mono", FftBackendType::KissQ15, ChannelMode::Mono},
+      {"kissfft-q31/mono", FftBackendType::KissQ31, ChannelMode::Mono},
+      {"auto/stereo", FftBackendType::Auto, ChannelMode::Stereo},
+      {"auto/midside", FftBackendType::Auto, ChannelMode::MidSide},
+      {"kissfft-q15/stereo", FftBackendType::KissQ15, ChannelMode::Stereo},
+  };
+
+  bool ok = true;
+  for (const Case &c : cases)
+    ok = runCase(c) && ok;
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
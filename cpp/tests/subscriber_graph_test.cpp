@@ -0,0 +1,216 @@
+// Checks the subscriber fan-out: one FFT per hop, however many subscribe.
+//
+//   cmake -S android -B build && cmake --build build
+//   ctest --test-dir build
+//
+// Runs an Analyzer over two seconds of a tone in 256-sample reads with four
+// subscribers: 32 log bands at 30 Hz, raw bins at 60 Hz, meters only at
+// 10 Hz and third-octave bands at 15 Hz with no band count, which must still
+// be mapped. Each must get its own frame count and shape, the FFT count must
+// match a run without subscribers, and a subscriber added or removed mid-run
+// must start or stop without disturbing the others.
+
+#include "analyzer.h"
+#include "frame_queue.h"
+#include "perf_stats.h"
+#include "subscriber_graph.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+using realtimeaudio::Analyzer;
+using realtimeaudio::BandLayout;
+using realtimeaudio::FrameInfo;
+using realtimeaudio::FrameQueue;
+using realtimeaudio::PerfSnapshot;
+using realtimeaudio::PerfStage;
+using realtimeaudio::PerfStats;
+using realtimeaudio::SubscriberConfig;
+using realtimeaudio::SubscriberGraph;
+
+namespace {
+
+constexpr float kRate = 48000.0f;
+constexpr int kNfft = 1024;
+constexpr int kReadFrames = 256;
+constexpr long kLength = (long)(2.0 * kRate);
+constexpr long kSwitch = kLength / 2 / kReadFrames * kReadFrames;
+
+enum : int32_t { kBands = 1, kRaw = 2, kMeters = 3, kLate = 4, kOctave = 5 };
+
+struct Counts {
+  int frames = 0;
+  bool shaped = true; // every frame had the expected bins and products
+};
+
+struct Result {
+  uint64_t ffts = 0;
+  int mainFrames = 0;
+  std::map<int32_t, Counts> subscribers;
+};
+
+// `subscribe` off runs the same reads with no graph attached
+Result run(bool subscribe) {
+  Analyzer analyzer(kNfft);
+  analyzer.setHopSize(kNfft / 4);
+  analyzer.setFeatures(realtimeaudio::kFeatureAll, kRate);
+  analyzer.setMeters(true, realtimeaudio::MeterSettings(), kRate);
+  PerfStats perf;
+  analyzer.setPerfStats(&perf);
+
+  SubscriberGraph graph;
+  graph.setSpectrum(kNfft, kRate);
+  if (subscribe) {
+    SubscriberConfig bands;
+    bands.rateHz = 30.0f;
+    bands.layout = BandLayout::Log;
+    bands.bands = 32;
+    bands.features = realtimeaudio::kFeatureCentroid;
+    SubscriberConfig raw;
+    raw.rateHz = 60.0f;
+    SubscriberConfig meters;
+    meters.rateHz = 10.0f;
+    meters.spectrum = false;
+    meters.meters = true;
+    SubscriberConfig octave;
+    octave.rateHz = 15.0f;
+    octave.layout = BandLayout::ThirdOctave;
+    graph.set(kBands, bands);
+    graph.set(kRaw, raw);
+    graph.set(kMeters, meters);
+    graph.set(kOctave, octave);
+    analyzer.setSubscribers(&graph);
+  }
+
+  FrameQueue queue(16, kNfft);
+  std::vector<float> read(kReadFrames);
+  std::vector<float> magnitudes(kNfft / 2);
+  std::vector<float> popped(kNfft);
+  realtimeaudio::FrameStats stats;
+  Result result;
+  int lastBins = 0;
+  // The band count the layout's range gives
+  realtimeaudio::BandMapper reference;
+  const int octaveBands = reference.configure(BandLayout::ThirdOctave,
+                                              kNfft / 2, 0, kNfft, kRate);
+  for (long t = 0; t + kReadFrames <= kLength; t += kReadFrames) {
+    for (int i = 0; i < kReadFrames; ++i)
+      read[i] = (float)(0.3 * std::sin(2.0 * M_PI * 440.0 * (t + i) / kRate));
+
+    // Capture clock: the end of this read
+    const int64_t nowNs = (int64_t)((t + kReadFrames) * 1e9 / kRate);
+    if (subscribe && t == kSwitch) {
+      // Mid-run: the raw subscriber goes, a late one arrives
+      graph.remove(kRaw);
+      SubscriberConfig late;
+      late.rateHz = 20.0f;
+      late.bands = 16;
+      graph.set(kLate, late);
+    }
+
+    const int due = subscribe ? graph.poll(nowNs) : 0;
+    const int bins = analyzer.processFloat(read.data(), kReadFrames, kNfft,
+                                           magnitudes.data(),
+                                           (int)magnitudes.size(), &stats);
+    if (bins > 0)
+      lastBins = bins;
+
+    FrameInfo info;
+    info.bins = (uint32_t)lastBins;
+    queue.push(info, magnitudes.data());
+    if ((due & SubscriberGraph::kDue) != 0)
+      graph.publish(queue, analyzer, magnitudes.data(),
+                    (due & SubscriberGraph::kSpectral) ? lastBins : 0,
+                    stats.rms, stats.peak, nowNs / 1e6,
+                    (uint32_t)kReadFrames, nowNs);
+
+    FrameInfo out;
+    while (queue.pop(out, popped.data(), (uint32_t)popped.size())) {
+      if (out.subscriber < 0) {
+        ++result.mainFrames;
+        continue;
+      }
+      Counts &counts = result.subscribers[out.subscriber];
+      ++counts.frames;
+      bool shaped = true;
+      switch (out.subscriber) {
+      case kBands:
+        shaped = out.bins == 32 && out.features.centroid > 0.0f &&
+                 out.features.flux == 0.0f && out.meters.rms == 0.0f;
+        break;
+      case kRaw:
+        shaped = out.bins == kNfft / 2 && out.features.centroid == 0.0f;
+        break;
+      case kMeters:
+        shaped = out.bins == 0 && out.meters.peak > 0.1f &&
+                 out.features.centroid == 0.0f;
+        break;
+      case kLate:
+        shaped = out.bins == 16;
+        break;
+      case kOctave:
+        shaped = octaveBands > 0 && out.bins == (uint32_t)octaveBands;
+        break;
+      }
+      counts.shaped = counts.shaped && shaped;
+    }
+  }
+
+  PerfSnapshot snapshot;
+  perf.snapshot(&snapshot);
+  result.ffts = snapshot.stages[(int)PerfStage::Fft].count;
+  return result;
+}
+
+// Frames expected at `rateHz` over `seconds`, the first one at once
+bool near(int frames, float rateHz, double seconds) {
+  const double expected = rateHz * seconds;
+  return std::fabs(frames - expected) <= 2.0;
+}
+
+} // namespace
+
+int main() {
+  const Result plain = run(false);
+  const Result fanned = run(true);
+
+  const double seconds = (double)kLength / kRate;
+  const double before = (double)kSwitch / kRate;
+  struct Expect {
+    const char *name;
+    int32_t id;
+    float rateHz;
+    double seconds;
+  };
+  const Expect expects[] = {
+      {"32 log bands @ 30 Hz", kBands, 30.0f, seconds},
+      {"raw bins @ 60 Hz", kRaw, 60.0f, before},
+      {"meters only @ 10 Hz", kMeters, 10.0f, seconds},
+      {"late 16 bands @ 20 Hz", kLate, 20.0f, seconds - before},
+      {"1/3 octave @ 15 Hz", kOctave, 15.0f, seconds},
+  };
+
+  bool ok = true;
+  for (const Expect &e : expects) {
+    const auto it = fanned.subscribers.find(e.id);
+    const Counts counts = it != fanned.subscribers.end() ? it->second : Counts();
+    const bool timed = near(counts.frames, e.rateHz, e.seconds);
+    const bool good = timed && counts.shaped;
+    std::printf("%s %-22s %d frames%s%s\n", good ? "ok  " : "FAIL", e.name,
+                counts.frames, timed ? "" : ", off rate",
+                counts.shaped ? "" : ", wrong shape");
+    ok = ok && good;
+  }
+
+  // The FFT runs once per hop either way, and the main stream is unchanged
+  const bool shared = fanned.ffts == plain.ffts && plain.ffts > 0 &&
+                      fanned.mainFrames == plain.mainFrames;
+  std::printf("%s shared FFT: %llu hops with subscribers, %llu without\n",
+              shared ? "ok  " : "FAIL", (unsigned long long)fanned.ffts,
+              (unsigned long long)plain.ffts);
+  ok = ok && shared;
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
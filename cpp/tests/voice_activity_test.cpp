@@ -0,0 +1,128 @@
+// Checks the voice activity gate and that it holds the FFT back.
+//
+//   cmake -S android -B build && cmake --build build
+//   ctest --test-dir build
+//
+// Feeds an Analyzer background noise, a click, a tone with a gap shorter
+// than the release time and noise again, at several read sizes. The gate
+// must open and close once each, at times set by attackMs / releaseMs and
+// not by the read size. No FFT may run while it is closed, and the read that
+// opens it must take a frame at once.
+
+#include "analyzer.h"
+#include "perf_stats.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using realtimeaudio::Analyzer;
+using realtimeaudio::PerfSnapshot;
+using realtimeaudio::PerfStage;
+using realtimeaudio::PerfStats;
+using realtimeaudio::VoiceActivitySettings;
+
+namespace {
+
+constexpr float kRate = 48000.0f;
+constexpr int kNfft = 1024;
+
+// Sample `t` of the test signal: noise at -66 dBFS, a 5 ms click at 0.5 s,
+// a -20 dBFS tone from 1.0 to 2.2 s with 150 ms of noise at 1.6 s, then
+// noise until 3.5 s
+struct Signal {
+  static constexpr long kLength = (long)(3.5 * kRate);
+
+  static float at(long t) {
+    const double s = (double)t / kRate;
+    const double noise = 0.001 * ((double)(std::rand() % 2001) / 1000.0 - 1.0);
+    const bool click = s >= 0.5 && s < 0.505;
+    const bool tone = s >= 1.0 && s < 2.2 && !(s >= 1.6 && s < 1.75);
+    if (click)
+      return (float)(0.5 + noise);
+    if (tone)
+      return (float)(0.14 * std::sin(2.0 * M_PI * 440.0 * s) + noise);
+    return (float)noise;
+  }
+};
+
+struct Result {
+  long opened = -1; // sample where the gate opened
+  long closed = -1;
+  int transitions = 0;
+  bool frameOnOpen = false; // the opening read took a frame
+  bool fftWhileClosed = false;
+};
+
+Result run(int readFrames) {
+  Analyzer analyzer(kNfft);
+  analyzer.setHopSize(kNfft / 2);
+  VoiceActivitySettings settings;
+  settings.attackMs = 30.0f;
+  settings.releaseMs = 400.0f;
+  analyzer.setVoiceActivity(true, settings, kRate);
+  PerfStats perf;
+  analyzer.setPerfStats(&perf);
+
+  std::vector<float> read(readFrames);
+  std::vector<float> magnitudes(kNfft / 2);
+  realtimeaudio::FrameStats stats;
+  Result result;
+  std::srand(7);
+  for (long t = 0; t + readFrames <= Signal::kLength; t += readFrames) {
+    for (int i = 0; i < readFrames; ++i)
+      read[i] = Signal::at(t + i);
+
+    PerfSnapshot before;
+    perf.snapshot(&before);
+    const bool wasGated = analyzer.gated();
+    const int bins = analyzer.processFloat(read.data(), readFrames, kNfft,
+                                           magnitudes.data(),
+                                           (int)magnitudes.size(), &stats);
+    PerfSnapshot after;
+    perf.snapshot(&after);
+    const bool ffts = after.stages[(int)PerfStage::Fft].count >
+                      before.stages[(int)PerfStage::Fft].count;
+
+    const realtimeaudio::VoiceActivity &vad = analyzer.voiceActivity();
+    if (vad.changed) {
+      ++result.transitions;
+      if (vad.active) {
+        result.opened = t + readFrames;
+        result.frameOnOpen = wasGated && bins > 0;
+      } else {
+        result.closed = t + readFrames;
+      }
+    }
+    if (analyzer.gated() && ffts)
+      result.fftWhileClosed = true;
+  }
+  return result;
+}
+
+} // namespace
+
+int main() {
+  bool ok = true;
+  for (int readFrames : {128, 256, 480, 1024}) {
+    const Result r = run(readFrames);
+    const double openedMs = r.opened * 1000.0 / kRate;
+    const double closedMs = r.closed * 1000.0 / kRate;
+    const double readMs = readFrames * 1000.0 / kRate;
+    // Opens attackMs into the tone, closes releaseMs after it ends. Time
+    // counts in whole reads and the edges fall inside one, so allow two.
+    const bool timed = std::fabs(openedMs - 1030.0) <= 2.0 * readMs &&
+                       std::fabs(closedMs - 2600.0) <= 2.0 * readMs;
+    const bool good = r.transitions == 2 && timed && r.frameOnOpen &&
+                      !r.fftWhileClosed;
+    std::printf("%s reads of %4d: opened %.1f ms, closed %.1f ms, "
+                "%d transitions%s%s%s\n",
+                good ? "ok  " : "FAIL", readFrames, openedMs, closedMs,
+                r.transitions, timed ? "" : ", off time",
+                r.frameOnOpen ? "" : ", no frame on open",
+                r.fftWhileClosed ? ", FFT while closed" : "");
+    ok = ok && good;
+  }
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
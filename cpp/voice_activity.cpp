@@ -0,0 +1,86 @@
+#include "voice_activity.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace realtimeaudio {
+
+namespace {
+
+// How fast the noise floor may rise towards louder reads
+constexpr float kFloorRiseDbPerSecond = 3.0f;
+
+} // namespace
+
+void VoiceActivityDetector::configure(const VoiceActivitySettings &settings,
+                                      float sampleRate) {
+  if (!(sampleRate > 0.0f)) {
+    disable();
+    return;
+  }
+  settings_.thresholdDb = std::max(settings.thresholdDb, kSilenceDb);
+  settings_.hysteresisDb = std::max(settings.hysteresisDb, 0.0f);
+  settings_.noiseMarginDb = std::max(settings.noiseMarginDb, 0.0f);
+  settings_.attackMs = std::max(settings.attackMs, 0.0f);
+  settings_.releaseMs = std::max(settings.releaseMs, 0.0f);
+  sample_rate_ = sampleRate;
+  reset();
+}
+
+void VoiceActivityDetector::disable() {
+  sample_rate_ = 0.0f;
+  reset();
+}
+
+void VoiceActivityDetector::reset() {
+  state_ = VoiceActivity();
+  floor_valid_ = false;
+  above_ms_ = 0.0f;
+  below_ms_ = 0.0f;
+}
+
+void VoiceActivityDetector::update(float rms, int frames) {
+  state_.changed = false;
+  if (!enabled() || frames <= 0)
+    return;
+
+  const float ms = (float)frames * 1000.0f / sample_rate_;
+  const float level =
+      rms > 0.0f ? std::max(kSilenceDb, 20.0f * std::log10(rms)) : kSilenceDb;
+  if (!floor_valid_) {
+    state_.noiseFloorDb = level;
+    floor_valid_ = true;
+  }
+
+  const float open =
+      settings_.noiseMarginDb > 0.0f
+          ? std::max(settings_.thresholdDb,
+                     state_.noiseFloorDb + settings_.noiseMarginDb)
+          : settings_.thresholdDb;
+  const float close = open - settings_.hysteresisDb;
+  if (!state_.active) {
+    above_ms_ = level > open ? above_ms_ + ms : 0.0f;
+    if (above_ms_ >= settings_.attackMs && level > open) {
+      state_.active = true;
+      state_.changed = true;
+      below_ms_ = 0.0f;
+    }
+  } else {
+    below_ms_ = level < close ? below_ms_ + ms : 0.0f;
+    if (below_ms_ >= settings_.releaseMs && level < close) {
+      state_.active = false;
+      state_.changed = true;
+      above_ms_ = 0.0f;
+    }
+  }
+
+  // After the decision, so a loud read never raises its own threshold
+  state_.noiseFloorDb =
+      level < state_.noiseFloorDb
+          ? level
+          : std::min(level, state_.noiseFloorDb +
+                                kFloorRiseDbPerSecond * ms / 1000.0f);
+  state_.levelDb = level;
+}
+
+} // namespace realtimeaudio
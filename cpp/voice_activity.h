@@ -0,0 +1,67 @@
+#ifndef REALTIMEAUDIO_VOICE_ACTIVITY_H
+#define REALTIMEAUDIO_VOICE_ACTIVITY_H
+
+namespace realtimeaudio {
+
+// Level reported for digital silence
+constexpr float kSilenceDb = -120.0f;
+
+// Gate thresholds (dBFS RMS) and timing (milliseconds)
+struct VoiceActivitySettings {
+  float thresholdDb = -50.0f;  // opens above this level
+  float hysteresisDb = 6.0f;   // closes this far below the opening level
+  float noiseMarginDb = 10.0f; // and must clear the noise floor by this
+  float attackMs = 30.0f;      // above the opening level this long to open
+  float releaseMs = 500.0f;    // below the closing level this long to close
+};
+
+// Gate state after the latest read
+struct VoiceActivity {
+  bool active = false;  // open: the analysis stages run
+  bool changed = false; // set only by the read that opened or closed it
+  float levelDb = kSilenceDb;      // RMS of the latest read
+  float noiseFloorDb = kSilenceDb; // tracked background level
+};
+
+// Energy gate with hysteresis in level and time, deciding per read whether
+// the spectral stages are worth running. Each read's RMS (in dB) is compared
+// with an opening level of max(thresholdDb, noise floor + noiseMarginDb)
+// and a closing level hysteresisDb below it; the gate opens after attackMs
+// above the one and closes after releaseMs below the other, so syllable
+// gaps and single clicks don't toggle it. Times accumulate per read from
+// the read's duration, so the behaviour doesn't depend on the read size.
+//
+// The noise floor follows drops in level at once and rises at a few dB per
+// second, so it settles on the quietest recent reads: a steady fan or hum
+// eventually counts as background and closes the gate too. noiseMarginDb
+// 0 leaves only the fixed threshold.
+//
+// It uses levels only, never the spectrum, since the point is to decide
+// before the FFT runs. Not thread-safe; owned by one Analyzer.
+class VoiceActivityDetector {
+public:
+  // Clears the state; the gate starts closed.
+  void configure(const VoiceActivitySettings &settings, float sampleRate);
+  void disable();
+  bool enabled() const { return sample_rate_ > 0.0f; }
+  const VoiceActivitySettings &settings() const { return settings_; }
+
+  void reset();
+
+  // One read of `frames` frames with RMS `rms` (linear full scale).
+  void update(float rms, int frames);
+
+  const VoiceActivity &state() const { return state_; }
+
+private:
+  VoiceActivitySettings settings_;
+  float sample_rate_ = 0.0f;
+  VoiceActivity state_;
+  bool floor_valid_ = false;
+  float above_ms_ = 0.0f; // time above the opening level while closed
+  float below_ms_ = 0.0f; // time below the closing level while open
+};
+
+} // namespace realtimeaudio
+
+#endif // REALTIMEAUDIO_VOICE_ACTIVITY_H
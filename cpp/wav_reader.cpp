@@ -0,0 +1,129 @@
+#include "wav_reader.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <new>
+
+namespace realtimeaudio {
+
+namespace {
+
+constexpr uint16_t kFormatPcm = 1;
+constexpr uint16_t kFormatFloat = 3;
+constexpr uint16_t kFormatExtensible = 0xfffe;
+
+struct FileCloser {
+  void operator()(FILE *file) const { std::fclose(file); }
+};
+
+uint16_t le16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+
+uint32_t le32(const uint8_t *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+         ((uint32_t)p[3] << 24);
+}
+
+bool readBytes(FILE *file, void *out, size_t size) {
+  return std::fread(out, 1, size, file) == size;
+}
+
+} // namespace
+
+const char *wavStatusMessage(WavStatus status) {
+  switch (status) {
+  case WavStatus::Ok:
+    return "ok";
+  case WavStatus::OpenFailed:
+    return "could not open the file";
+  case WavStatus::NotWav:
+    return "not a RIFF/WAVE file";
+  case WavStatus::UnsupportedFormat:
+    return "only 16/24-bit PCM and 32-bit float WAV files are supported";
+  case WavStatus::OutOfMemory:
+    return "not enough memory for the samples";
+  }
+  return "unknown error";
+}
+
+WavStatus readWav(const char *path, WavFile *out) {
+  std::unique_ptr<FILE, FileCloser> file(std::fopen(path, "rb"));
+  if (file == nullptr)
+    return WavStatus::OpenFailed;
+
+  uint8_t riff[12];
+  if (!readBytes(file.get(), riff, sizeof(riff)) ||
+      std::memcmp(riff, "RIFF", 4) != 0 || std::memcmp(riff + 8, "WAVE", 4) != 0)
+    return WavStatus::NotWav;
+
+  bool haveFormat = false;
+  int bytes = 0;
+  uint8_t header[8];
+  while (readBytes(file.get(), header, sizeof(header))) {
+    const uint32_t size = le32(header + 4);
+
+    if (std::memcmp(header, "fmt ", 4) == 0) {
+      uint8_t fmt[40] = {};
+      if (size < 16 || !readBytes(file.get(), fmt, std::min<size_t>(size, 40)))
+        return WavStatus::NotWav;
+      if (size > 40)
+        std::fseek(file.get(), (long)(size - 40), SEEK_CUR);
+      if (size & 1)
+        std::fseek(file.get(), 1, SEEK_CUR);
+
+      uint16_t tag = le16(fmt);
+      // EXTENSIBLE carries the real tag in the first two subformat GUID bytes
+      if (tag == kFormatExtensible && size >= 40)
+        tag = le16(fmt + 24);
+      const int channels = le16(fmt + 2);
+      const int bits = le16(fmt + 14);
+      if (tag == kFormatPcm && bits == 16)
+        out->format = SampleFormat::Pcm16;
+      else if (tag == kFormatPcm && bits == 24)
+        out->format = SampleFormat::Pcm24;
+      else if (tag == kFormatFloat && bits == 32)
+        out->format = SampleFormat::Float32;
+      else
+        return WavStatus::UnsupportedFormat;
+      if (channels <= 0 || le16(fmt + 12) != channels * bits / 8)
+        return WavStatus::UnsupportedFormat;
+
+      out->channels = channels;
+      out->sampleRate = (int)le32(fmt + 4);
+      bytes = channels * bits / 8;
+      haveFormat = true;
+      continue;
+    }
+
+    if (std::memcmp(header, "data", 4) == 0) {
+      if (!haveFormat)
+        return WavStatus::NotWav;
+      // Streaming writers leave the size at 0 or ~0; read to the end then
+      const long start = std::ftell(file.get());
+      std::fseek(file.get(), 0, SEEK_END);
+      const int64_t available = (int64_t)std::ftell(file.get()) - start;
+      std::fseek(file.get(), start, SEEK_SET);
+      int64_t dataBytes = size == 0 || size == 0xffffffffu
+                              ? available
+                              : std::min<int64_t>(size, available);
+      out->frames = dataBytes / bytes;
+      dataBytes = out->frames * bytes;
+
+      try {
+        out->data.resize((size_t)dataBytes);
+      } catch (const std::bad_alloc &) {
+        return WavStatus::OutOfMemory;
+      }
+      if (!readBytes(file.get(), out->data.data(), (size_t)dataBytes))
+        return WavStatus::NotWav;
+      return WavStatus::Ok;
+    }
+
+    // Skip other chunks (LIST, fact, ...), which are padded to even sizes
+    if (std::fseek(file.get(), (long)size + (size & 1), SEEK_CUR) != 0)
+      break;
+  }
+  return WavStatus::NotWav;
+}
+
+} // namespace realtimeaudio
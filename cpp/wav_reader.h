@@ -0,0 +1,41 @@
+#ifndef REALTIMEAUDIO_WAV_READER_H
+#define REALTIMEAUDIO_WAV_READER_H
+
+#include "spectrogram.h"
+#include <cstdint>
+#include <vector>
+
+namespace realtimeaudio {
+
+enum class WavStatus : int {
+  Ok = 0,
+  OpenFailed,        // missing or unreadable file
+  NotWav,            // no RIFF/WAVE header, or no fmt / data chunk
+  UnsupportedFormat, // anything but 16/24-bit PCM or 32-bit float
+  OutOfMemory,
+};
+
+const char *wavStatusMessage(WavStatus status);
+
+// Samples of a RIFF/WAVE file, kept in the file's own encoding (interleaved)
+// so a long clip costs no more memory than on disk.
+struct WavFile {
+  SampleFormat format = SampleFormat::Pcm16;
+  int channels = 0;
+  int sampleRate = 0;
+  int64_t frames = 0;
+  std::vector<uint8_t> data;
+
+  SampleBuffer buffer() const {
+    return SampleBuffer{data.data(), format, channels, frames};
+  }
+};
+
+// Reads a whole PCM WAV file (WAVE_FORMAT_PCM, IEEE_FLOAT or EXTENSIBLE with
+// either subformat). A truncated data chunk is read up to the last complete
+// frame.
+WavStatus readWav(const char *path, WavFile *out);
+
+} // namespace realtimeaudio
+
+#endif // REALTIMEAUDIO_WAV_READER_H
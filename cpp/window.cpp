@@ -0,0 +1,100 @@
+#include "window.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <new>
+#include <utility>
+
+namespace realtimeaudio {
+
+namespace {
+
+// Generalized cosine windows: w(i) = sum_k (-1)^k a_k cos(2 pi k i / (n - 1))
+struct CosineTerms {
+  double a[5];
+  int count;
+};
+
+CosineTerms termsFor(WindowType type) {
+  switch (type) {
+  case WindowType::Hann:
+    return {{0.5, 0.5}, 2};
+  case WindowType::Hamming:
+    return {{0.54, 0.46}, 2};
+  case WindowType::Blackman:
+    return {{0.42, 0.5, 0.08}, 3};
+  case WindowType::BlackmanHarris:
+    return {{0.35875, 0.48829, 0.14128, 0.01168}, 4};
+  case WindowType::FlatTop:
+    return {{0.21557895, 0.41663158, 0.277263158, 0.083578947, 0.006947368},
+            5};
+  case WindowType::Rectangular:
+    break;
+  }
+  return {{1.0}, 1};
+}
+
+std::shared_ptr<const WindowTable> buildTable(WindowType type, int n) {
+  std::shared_ptr<WindowTable> table(new (std::nothrow) WindowTable());
+  if (table == nullptr)
+    return nullptr;
+  table->type = type;
+  table->values.resize(n);
+  table->valuesQ15.resize(n);
+
+  const CosineTerms terms = termsFor(type);
+  const double step = n > 1 ? 2.0 * M_PI / (double)(n - 1) : 0.0;
+  double sum = 0.0;
+  for (int i = 0; i < n; ++i) {
+    double w = 0.0;
+    for (int k = 0; k < terms.count; ++k) {
+      const double term = terms.a[k] * cos(step * k * i);
+      w += (k & 1) ? -term : term;
+    }
+    table->values[i] = (float)w;
+    table->valuesQ15[i] =
+        (int16_t)std::lrint(std::max(-1.0, std::min(w, 32767.0 / 32768.0)) *
+                            32768.0);
+    sum += w;
+  }
+  table->coherentGain = sum > 0.0 ? (float)(sum / n) : 1.0f;
+  return table;
+}
+
+} // namespace
+
+WindowType windowTypeFromInt(int value) {
+  switch (value) {
+  case (int)WindowType::Hamming:
+    return WindowType::Hamming;
+  case (int)WindowType::Blackman:
+    return WindowType::Blackman;
+  case (int)WindowType::Rectangular:
+    return WindowType::Rectangular;
+  case (int)WindowType::BlackmanHarris:
+    return WindowType::BlackmanHarris;
+  case (int)WindowType::FlatTop:
+    return WindowType::FlatTop;
+  default:
+    return WindowType::Hann;
+  }
+}
+
+std::shared_ptr<const WindowTable> windowTable(WindowType type, int n) {
+  if (n <= 0)
+    return nullptr;
+
+  static std::mutex mutex;
+  static std::map<std::pair<int, int>, std::shared_ptr<const WindowTable>>
+      cache;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  std::shared_ptr<const WindowTable> &entry = cache[{(int)type, n}];
+  if (entry == nullptr)
+    entry = buildTable(type, n);
+  return entry;
+}
+
+} // namespace realtimeaudio
@@ -0,0 +1,45 @@
+#ifndef REALTIMEAUDIO_WINDOW_H
+#define REALTIMEAUDIO_WINDOW_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace realtimeaudio {
+
+// Values are shared with AudioEngine.WINDOW_*, RTAAnalyzer and the JS names
+// 'hanning' | 'hamming' | 'blackman' | 'rectangular' | 'blackmanharris' |
+// 'flattop'.
+enum class WindowType : int {
+  Hann = 0,
+  Hamming = 1,
+  Blackman = 2,
+  Rectangular = 3,
+  BlackmanHarris = 4, // 4-term, -92 dB sidelobes
+  FlatTop = 5,        // amplitude-accurate (< 0.01 dB scalloping)
+};
+
+WindowType windowTypeFromInt(int value);
+
+// A symmetric window of `size()` coefficients (denominator n - 1, like the
+// original Hann table) with its coherent gain, sum(w) / n. Dividing
+// magnitudes by the coherent gain makes a bin-centred sine read its
+// amplitude whatever the window.
+struct WindowTable {
+  WindowType type;
+  std::vector<float> values;
+  std::vector<int16_t> valuesQ15; // for the fixed-point backends
+  float coherentGain;
+
+  int size() const { return (int)values.size(); }
+};
+
+// Returns the shared, immutable table for (`type`, `n`), building it on first
+// use. Tables are cached for the life of the process, so re-creating an
+// engine or switching back to an earlier configuration costs a lookup, not a
+// cosine pass. Thread-safe; returns nullptr for n <= 0.
+std::shared_ptr<const WindowTable> windowTable(WindowType type, int n);
+
+} // namespace realtimeaudio
+
+#endif // REALTIMEAUDIO_WINDOW_H
@@ -0,0 +1,174 @@
+#import <Foundation/Foundation.h>
+
+#ifdef __cplusplus
+namespace realtimeaudio {
+class Analyzer;
+}
+#endif
+
+@class RTAPerfStats;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Features of one frame (cpp/spectral_features.h); fields whose feature is
+/// not enabled are 0.
+typedef struct {
+  float centroid; // Hz
+  float flux;
+  float rolloff; // Hz
+  float flatness; // 0..1
+  bool onset;
+  float pitch; // Hz, 0 when unpitched
+  float pitchConfidence; // 0..1
+} RTASpectralFeatures;
+
+/// Meter readings after the latest buffer (cpp/level_meter.h); levels are
+/// linear full scale.
+typedef struct {
+  float rms; // sliding-window RMS through attack / release
+  float peak; // instant attack, released
+  float peakHold; // highest sample over the hold window
+  float momentaryLufs; // EBU R128, 400 ms
+  float shortTermLufs; // EBU R128, 3 s
+} RTAMeterLevels;
+
+/// Voice activity gate after the latest buffer (cpp/voice_activity.h).
+typedef struct {
+  bool active; // open: the FFT and feature stages run
+  bool changed; // this buffer opened or closed it
+  float levelDb; // dBFS RMS of the buffer
+  float noiseFloorDb; // tracked background level
+} RTAVoiceActivity;
+
+/**
+ * Objective-C face of the shared C++ Analyzer (cpp/analyzer.h), the same
+ * analysis core the Android module runs: STFT history, Hann window, FFT,
+ * magnitudes normalized by fftSize / 2, band mapping and level smoothing.
+ * Not thread-safe; drive it from the audio tap only.
+ */
+@interface RTAAnalyzer : NSObject
+
+/// Backend values match FftBackendType: 0 auto, 1 kissfft, 2 realfft,
+/// 3 accelerate, 4 kissfft-q15, 5 kissfft-q31.
++ (NSInteger)backendFromName:(nullable NSString *)name;
+/// Layout values match BandLayout: 0 linear, 1 log, 2 mel, 3 octave.
++ (NSInteger)layoutFromName:(nullable NSString *)name;
+/// Window values match WindowType: 0 hanning, 1 hamming, 2 blackman,
+/// 3 rectangular, 4 blackmanharris, 5 flattop.
++ (NSInteger)windowFromName:(nullable NSString *)name;
+/// Mode values match ChannelMode: 0 mono, 1 stereo, 2 midside.
++ (NSInteger)channelModeFromName:(nullable NSString *)name;
+/// Bits match FeatureFlags for 'centroid', 'flux', 'rolloff', 'flatness',
+/// 'onset' and 'pitch'; unknown names are ignored.
++ (NSUInteger)featureMaskFromNames:(nullable NSArray<NSString *> *)names;
+
+/// nil if no FFT plan could be created for `fftSize`. The stereo channel
+/// modes keep a history per channel and add per-channel spectra and levels.
+- (nullable instancetype)initWithFftSize:(NSInteger)fftSize
+                                 backend:(NSInteger)backend
+                                  window:(NSInteger)window
+                             channelMode:(NSInteger)channelMode NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// Size of the live plan; follows the fftSize passed to processSamples.
+@property (nonatomic, readonly) NSInteger fftSize;
+/// Implementation behind the current plan, e.g. "accelerate".
+@property (nonatomic, readonly) NSString *backendName;
+/// Samples between STFT frames; 0 takes a frame after every buffer.
+@property (nonatomic) NSInteger hopSize;
+
+/// Builds the plan for `fftSize` on the calling thread so the tap only swaps
+/// it in once it passes the new size. The one method that may be called off
+/// the tap thread.
+- (BOOL)preparePlanWithFftSize:(NSInteger)fftSize;
+
+- (void)setSmoothingEnabled:(BOOL)enabled factor:(float)factor;
+
+/// Times the analyze, fft and features stages into `stats` (kept strongly);
+/// nil stops timing. Call it before the tap starts.
+- (void)attachPerfStats:(nullable RTAPerfStats *)stats;
+
+/// Spectral features computed on every frame taken from now on; 0 disables
+/// the stage. Reserves the flux history, so call it before the tap starts.
+- (void)setFeatures:(NSUInteger)mask sampleRate:(double)sampleRate;
+/// Features of the newest frame; `onset` is only set right after the
+/// processSamples call that took it.
+@property (nonatomic, readonly) RTASpectralFeatures features;
+
+/// Sliding-window RMS, peak hold and LUFS meters over every sample processed
+/// from now on, independent of the buffer size; times are in milliseconds
+/// and NO disables them. Allocates the windows, so call it before the tap
+/// starts.
+- (void)setMetersEnabled:(BOOL)enabled
+                windowMs:(float)windowMs
+                attackMs:(float)attackMs
+               releaseMs:(float)releaseMs
+                  holdMs:(float)holdMs
+              sampleRate:(double)sampleRate;
+@property (nonatomic, readonly) RTAMeterLevels meters;
+
+/// Energy gate over every buffer processed from now on: it opens once the
+/// level has stayed above max(thresholdDb, noise floor + noiseMarginDb) for
+/// attackMs and closes after releaseMs below hysteresisDb under that. While
+/// it is closed no frame is taken, so the FFT and features are skipped; the
+/// buffer that opens it takes one at once. Starts closed; NO disables it.
+- (void)setVoiceActivityEnabled:(BOOL)enabled
+                    thresholdDb:(float)thresholdDb
+                   hysteresisDb:(float)hysteresisDb
+                  noiseMarginDb:(float)noiseMarginDb
+                       attackMs:(float)attackMs
+                      releaseMs:(float)releaseMs
+                     sampleRate:(double)sampleRate;
+@property (nonatomic, readonly) RTAVoiceActivity voiceActivity;
+/// The gate is enabled and closed.
+@property (nonatomic, readonly) BOOL gated;
+
+/// `bands` <= 0 ships raw bins; `bands` is ignored for octave.
+- (void)setBandLayout:(NSInteger)layout bands:(NSInteger)bands sampleRate:(double)sampleRate;
+
+/// Appends `count` mono samples to the history of an `fftSize` STFT and
+/// writes the smoothed levels. When `magnitudes` is non-null and a hop has
+/// elapsed, up to `capacity` magnitudes are produced. Returns the bins
+/// written (0 when no frame was taken).
+- (NSInteger)processSamples:(const float *)samples
+                      count:(NSInteger)count
+                    fftSize:(NSInteger)fftSize
+                 magnitudes:(nullable float *)magnitudes
+                   capacity:(NSInteger)capacity
+                        rms:(float *)rms
+                       peak:(float *)peak;
+
+/// processSamples for planar stereo: `count` frames from each of `left` and
+/// `right`. Mono mode downmixes them into the history in the same pass;
+/// the stereo modes also fill the channel spectra and levels.
+- (NSInteger)processLeft:(const float *)left
+                   right:(const float *)right
+                   count:(NSInteger)count
+                 fftSize:(NSInteger)fftSize
+              magnitudes:(nullable float *)magnitudes
+                capacity:(NSInteger)capacity
+                     rms:(float *)rms
+                    peak:(float *)peak;
+
+/// Channel 0 / 1 (left / right, or mid / side) of the newest frame,
+/// `channelBins` magnitudes; NULL in mono mode.
+- (nullable const float *)channelSpectrum:(NSInteger)channel;
+@property (nonatomic, readonly) NSInteger channelBins;
+/// Unsmoothed levels of channel 0 / 1 over the last buffer.
+- (void)channelLevels:(NSInteger)channel rms:(float *)rms peak:(float *)peak;
+
+/// Band-maps (or copies) `bins` magnitudes into `output`. Returns the number
+/// of floats written.
+- (NSInteger)mapBands:(const float *)spectrum
+                 bins:(NSInteger)bins
+               output:(float *)output
+             capacity:(NSInteger)capacity;
+
+#ifdef __cplusplus
+/// Owned by the receiver; valid for its lifetime.
+@property (nonatomic, readonly) realtimeaudio::Analyzer *core;
+#endif
+
+@end
+
+NS_ASSUME_NONNULL_END
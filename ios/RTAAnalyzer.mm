@@ -0,0 +1,277 @@
+#import "RTAAnalyzer.h"
+#import "RTAPerfStats.h"
+
+#include "analyzer.h"
+
+#include <memory>
+#include <new>
+
+using realtimeaudio::Analyzer;
+using realtimeaudio::BandLayout;
+using realtimeaudio::ChannelMode;
+using realtimeaudio::FftBackendType;
+using realtimeaudio::FrameStats;
+using realtimeaudio::MeterLevels;
+using realtimeaudio::MeterSettings;
+using realtimeaudio::SpectralFeatures;
+using realtimeaudio::VoiceActivity;
+using realtimeaudio::VoiceActivitySettings;
+using realtimeaudio::WindowType;
+
+@implementation RTAAnalyzer {
+  std::unique_ptr<Analyzer> _analyzer;
+  RTAPerfStats *_perfStats;
+}
+
++ (NSInteger)backendFromName:(NSString *)name
+{
+  if ([name isEqualToString:@"kissfft"]) {
+    return (NSInteger)FftBackendType::Kiss;
+  }
+  if ([name isEqualToString:@"realfft"]) {
+    return (NSInteger)FftBackendType::Real;
+  }
+  if ([name isEqualToString:@"accelerate"]) {
+    return (NSInteger)FftBackendType::Accelerate;
+  }
+  if ([name isEqualToString:@"kissfft-q15"]) {
+    return (NSInteger)FftBackendType::KissQ15;
+  }
+  if ([name isEqualToString:@"kissfft-q31"]) {
+    return (NSInteger)FftBackendType::KissQ31;
+  }
+  return (NSInteger)FftBackendType::Auto;
+}
+
++ (NSInteger)layoutFromName:(NSString *)name
+{
+  if ([name isEqualToString:@"log"]) {
+    return (NSInteger)BandLayout::Log;
+  }
+  if ([name isEqualToString:@"mel"]) {
+    return (NSInteger)BandLayout::Mel;
+  }
+  if ([name isEqualToString:@"octave"]) {
+    return (NSInteger)BandLayout::ThirdOctave;
+  }
+  return (NSInteger)BandLayout::Linear;
+}
+
++ (NSInteger)windowFromName:(NSString *)name
+{
+  NSArray<NSString *> *names =
+      @[ @"hanning", @"hamming", @"blackman", @"rectangular", @"blackmanharris", @"flattop" ];
+  NSUInteger index = name ? [names indexOfObject:name] : NSNotFound;
+  return index == NSNotFound ? (NSInteger)WindowType::Hann : (NSInteger)index;
+}
+
++ (NSInteger)channelModeFromName:(NSString *)name
+{
+  if ([name isEqualToString:@"stereo"]) {
+    return (NSInteger)ChannelMode::Stereo;
+  }
+  if ([name isEqualToString:@"midside"]) {
+    return (NSInteger)ChannelMode::MidSide;
+  }
+  return (NSInteger)ChannelMode::Mono;
+}
+
++ (NSUInteger)featureMaskFromNames:(NSArray<NSString *> *)names
+{
+  NSArray<NSString *> *known = @[ @"centroid", @"flux", @"rolloff", @"flatness", @"onset", @"pitch" ];
+  NSUInteger mask = 0;
+  for (NSString *name in names) {
+    NSUInteger bit = [known indexOfObject:name];
+    if (bit != NSNotFound) {
+      mask |= 1u << bit;
+    }
+  }
+  return mask;
+}
+
+- (instancetype)initWithFftSize:(NSInteger)fftSize
+                        backend:(NSInteger)backend
+                         window:(NSInteger)window
+                    channelMode:(NSInteger)channelMode
+{
+  if ((self = [super init])) {
+    _analyzer.reset(new (std::nothrow) Analyzer((int)fftSize,
+                                                realtimeaudio::fftBackendFromInt((int)backend),
+                                                realtimeaudio::windowTypeFromInt((int)window),
+                                                realtimeaudio::channelModeFromInt((int)channelMode)));
+    if (!_analyzer || !_analyzer->isValid()) {
+      return nil;
+    }
+  }
+  return self;
+}
+
+- (NSInteger)fftSize
+{
+  return _analyzer->size();
+}
+
+- (NSString *)backendName
+{
+  return [NSString stringWithUTF8String:_analyzer->backendName()];
+}
+
+- (NSInteger)hopSize
+{
+  return _analyzer->hopSize();
+}
+
+- (void)setHopSize:(NSInteger)hopSize
+{
+  _analyzer->setHopSize((int)hopSize);
+}
+
+- (BOOL)preparePlanWithFftSize:(NSInteger)fftSize
+{
+  return _analyzer->preparePlan((int)fftSize);
+}
+
+- (void)setSmoothingEnabled:(BOOL)enabled factor:(float)factor
+{
+  _analyzer->setSmoothing(enabled, factor);
+}
+
+- (void)attachPerfStats:(RTAPerfStats *)stats
+{
+  _perfStats = stats;
+  _analyzer->setPerfStats(stats != nil ? stats.stats : nullptr);
+}
+
+- (void)setFeatures:(NSUInteger)mask sampleRate:(double)sampleRate
+{
+  _analyzer->setFeatures((uint32_t)mask, (float)sampleRate);
+}
+
+- (RTASpectralFeatures)features
+{
+  const SpectralFeatures &f = _analyzer->features();
+  return (RTASpectralFeatures){f.centroid, f.flux, f.rolloff, f.flatness, f.onset,
+                               f.pitch, f.pitchConfidence};
+}
+
+- (void)setMetersEnabled:(BOOL)enabled
+                windowMs:(float)windowMs
+                attackMs:(float)attackMs
+               releaseMs:(float)releaseMs
+                  holdMs:(float)holdMs
+              sampleRate:(double)sampleRate
+{
+  MeterSettings settings;
+  settings.windowMs = windowMs;
+  settings.attackMs = attackMs;
+  settings.releaseMs = releaseMs;
+  settings.holdMs = holdMs;
+  _analyzer->setMeters(enabled, settings, (float)sampleRate);
+}
+
+- (RTAMeterLevels)meters
+{
+  const MeterLevels &m = _analyzer->meters();
+  return (RTAMeterLevels){m.rms, m.peak, m.peakHold, m.momentaryLufs, m.shortTermLufs};
+}
+
+- (void)setVoiceActivityEnabled:(BOOL)enabled
+                    thresholdDb:(float)thresholdDb
+                   hysteresisDb:(float)hysteresisDb
+                  noiseMarginDb:(float)noiseMarginDb
+                       attackMs:(float)attackMs
+                      releaseMs:(float)releaseMs
+                     sampleRate:(double)sampleRate
+{
+  VoiceActivitySettings settings;
+  settings.thresholdDb = thresholdDb;
+  settings.hysteresisDb = hysteresisDb;
+  settings.noiseMarginDb = noiseMarginDb;
+  settings.attackMs = attackMs;
+  settings.releaseMs = releaseMs;
+  _analyzer->setVoiceActivity(enabled, settings, (float)sampleRate);
+}
+
+- (RTAVoiceActivity)voiceActivity
+{
+  const VoiceActivity &v = _analyzer->voiceActivity();
+  return (RTAVoiceActivity){v.active, v.changed, v.levelDb, v.noiseFloorDb};
+}
+
+- (BOOL)gated
+{
+  return _analyzer->gated();
+}
+
+- (void)setBandLayout:(NSInteger)layout bands:(NSInteger)bands sampleRate:(double)sampleRate
+{
+  _analyzer->setBands(realtimeaudio::bandLayoutFromInt((int)layout), (int)bands,
+                      (float)sampleRate);
+}
+
+- (NSInteger)processSamples:(const float *)samples
+                      count:(NSInteger)count
+                    fftSize:(NSInteger)fftSize
+                 magnitudes:(float *)magnitudes
+                   capacity:(NSInteger)capacity
+                        rms:(float *)rms
+                       peak:(float *)peak
+{
+  FrameStats stats;
+  const int bins = _analyzer->processFloat(samples, (int)count, (int)fftSize, magnitudes,
+                                           (int)capacity, &stats);
+  _analyzer->smoothLevels(&stats);
+  *rms = stats.rms;
+  *peak = stats.peak;
+  return bins;
+}
+
+- (NSInteger)processLeft:(const float *)left
+                   right:(const float *)right
+                   count:(NSInteger)count
+                 fftSize:(NSInteger)fftSize
+              magnitudes:(float *)magnitudes
+                capacity:(NSInteger)capacity
+                     rms:(float *)rms
+                    peak:(float *)peak
+{
+  FrameStats stats;
+  const int bins = _analyzer->processPlanar(left, right, (int)count, (int)fftSize, magnitudes,
+                                            (int)capacity, &stats);
+  _analyzer->smoothLevels(&stats);
+  *rms = stats.rms;
+  *peak = stats.peak;
+  return bins;
+}
+
+- (const float *)channelSpectrum:(NSInteger)channel
+{
+  return _analyzer->channelSpectrum((int)channel);
+}
+
+- (NSInteger)channelBins
+{
+  return _analyzer->channelBins();
+}
+
+- (void)channelLevels:(NSInteger)channel rms:(float *)rms peak:(float *)peak
+{
+  const FrameStats &levels = _analyzer->channelLevels((int)channel);
+  *rms = levels.rms;
+  *peak = levels.peak;
+}
+
+- (NSInteger)mapBands:(const float *)spectrum
+                 bins:(NSInteger)bins
+               output:(float *)output
+             capacity:(NSInteger)capacity
+{
+  return _analyzer->mapBands(spectrum, (int)bins, output, (int)capacity);
+}
+
+- (Analyzer *)core
+{
+  return _analyzer.get();
+}
+
+@end
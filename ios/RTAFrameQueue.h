@@ -0,0 +1,79 @@
+#import <Foundation/Foundation.h>
+
+#import "RTAAnalyzer.h"
+
+#ifdef __cplusplus
+namespace realtimeaudio {
+class FrameQueue;
+}
+#endif
+
+@class RTAPerfStats;
+@class RTASpectrogramHistory;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Values carried with one queued frame (FrameInfo in cpp/frame_queue.h).
+typedef struct {
+  double timestampMs;
+  float rms;
+  float peak;
+  NSInteger bufferSize; // frames in the tap buffer that produced it
+  NSInteger fftSize;
+  RTASpectralFeatures features;
+  RTAMeterLevels meters;
+  RTAVoiceActivity voice;
+  // Stereo channel modes: `channels` spectra of `channelBins` floats follow
+  // the frame's bins in the popped data
+  NSInteger channels;
+  NSInteger channelBins;
+  float channelRms[2];
+  float channelPeak[2];
+  // RTASubscriberGraph frames: the subscriber's id; -1 for the main stream
+  NSInteger subscriber;
+} RTAFrameInfo;
+
+/**
+ * Objective-C face of the shared C++ FrameQueue (cpp/frame_queue.h), the
+ * lock-free ring the Android capture thread hands frames to its delivery
+ * thread through. The tap pushes and never waits; when the ring is full the
+ * oldest frame is dropped and counted. One thread pushes, one pops.
+ */
+@interface RTAFrameQueue : NSObject
+
+/// `capacity` floats per slot, covering the bins and any channel spectra.
+/// Queue waits are timed into `stats` (kept strongly). nil without memory.
+- (nullable instancetype)initWithSlots:(NSUInteger)slots
+                              capacity:(NSUInteger)capacity
+                             perfStats:(nullable RTAPerfStats *)stats NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// Producer. Band-maps `count` magnitudes (0 for a levels-only frame)
+/// straight into the next slot, with the channel spectra of the stereo
+/// modes after them, and takes the features, meters and gate state from
+/// `analyzer`. The mapped bins also go to `history` when given.
+- (void)pushMagnitudes:(nullable const float *)magnitudes
+                 count:(NSInteger)count
+              analyzer:(RTAAnalyzer *)analyzer
+               history:(nullable RTASpectrogramHistory *)history
+                   rms:(float)rms
+                  peak:(float)peak
+           timestampMs:(double)timestampMs
+            bufferSize:(NSInteger)bufferSize;
+
+/// Consumer. Copies the oldest frame's bins, then its channel spectra, into
+/// `output` (up to `capacity` floats). Returns the bin count, or -1 when
+/// the queue is empty.
+- (NSInteger)popFrame:(float *)output capacity:(NSInteger)capacity info:(RTAFrameInfo *)info;
+
+/// Frames dropped because the consumer fell behind, since creation.
+@property (nonatomic, readonly) NSUInteger dropped;
+
+#ifdef __cplusplus
+/// Owned by the receiver; valid for its lifetime.
+@property (nonatomic, readonly) realtimeaudio::FrameQueue *queue;
+#endif
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,135 @@
+#import "RTAFrameQueue.h"
+#import "RTAPerfStats.h"
+#import "RTASpectrogramHistory.h"
+
+#include <algorithm>
+#include <memory>
+#include <new>
+
+#include "analyzer.h"
+#include "frame_queue.h"
+#include "perf_stats.h"
+#include "spectrogram_history.h"
+
+using realtimeaudio::Analyzer;
+using realtimeaudio::FrameInfo;
+using realtimeaudio::FrameQueue;
+using realtimeaudio::PerfScope;
+using realtimeaudio::PerfStage;
+using realtimeaudio::PerfStats;
+
+@implementation RTAFrameQueue {
+  std::unique_ptr<FrameQueue> _queue;
+  RTAPerfStats *_perfStats;
+}
+
+- (instancetype)initWithSlots:(NSUInteger)slots
+                     capacity:(NSUInteger)capacity
+                    perfStats:(RTAPerfStats *)stats
+{
+  if (slots == 0 || capacity == 0) {
+    return nil;
+  }
+  if (self = [super init]) {
+    try {
+      _queue = std::make_unique<FrameQueue>((uint32_t)slots, (uint32_t)capacity);
+    } catch (const std::bad_alloc &) {
+      return nil;
+    }
+    _perfStats = stats;
+  }
+  return self;
+}
+
+- (void)pushMagnitudes:(const float *)magnitudes
+                 count:(NSInteger)count
+              analyzer:(RTAAnalyzer *)analyzer
+               history:(RTASpectrogramHistory *)history
+                   rms:(float)rms
+                  peak:(float)peak
+           timestampMs:(double)timestampMs
+            bufferSize:(NSInteger)bufferSize
+{
+  Analyzer *core = analyzer.core;
+  PerfStats *perf = _perfStats != nil ? _perfStats.stats : nullptr;
+  PerfScope scope(perf, PerfStage::Publish);
+
+  float *dst = _queue->beginPush();
+  const int capacity = (int)_queue->capacity();
+  int bins = 0;
+  if (magnitudes != nullptr && count > 0) {
+    bins = core->mapBands(magnitudes, (int)count, dst, capacity);
+  }
+  if (history != nil && bins > 0) {
+    history.history->push(dst, (uint32_t)bins, timestampMs);
+  }
+
+  FrameInfo info;
+  info.timestampMs = timestampMs;
+  info.rms = rms;
+  info.peak = peak;
+  info.bins = (uint32_t)bins;
+  info.bufferSize = (uint32_t)std::max<NSInteger>(bufferSize, 0);
+  info.fftSize = (uint32_t)core->size();
+  info.pushedNs = PerfStats::nowNs();
+  info.features = core->features();
+  info.meters = core->meters();
+  info.voice = core->voiceActivity();
+  if (core->channelMode() != realtimeaudio::ChannelMode::Mono) {
+    // Channel spectra follow the main bins, mapped like them
+    info.channels = Analyzer::kMaxChannels;
+    info.channelLevels[0] = core->channelLevels(0);
+    info.channelLevels[1] = core->channelLevels(1);
+    if (bins > 0) {
+      info.channelBins = (uint32_t)core->mapChannelBands(dst + bins, capacity - bins);
+    }
+  }
+  _queue->endPush(info);
+  if (perf != nullptr) {
+    perf->observeQueue(_queue->size(), _queue->dropped());
+  }
+}
+
+- (NSInteger)popFrame:(float *)output capacity:(NSInteger)capacity info:(RTAFrameInfo *)info
+{
+  FrameInfo frame;
+  if (!_queue->pop(frame, output, (uint32_t)std::max<NSInteger>(capacity, 0))) {
+    return -1;
+  }
+  if (_perfStats != nil) {
+    _perfStats.stats->record(PerfStage::Queue, PerfStats::nowNs() - frame.pushedNs);
+  }
+
+  const realtimeaudio::SpectralFeatures &f = frame.features;
+  const realtimeaudio::MeterLevels &m = frame.meters;
+  const realtimeaudio::VoiceActivity &v = frame.voice;
+  info->timestampMs = frame.timestampMs;
+  info->rms = frame.rms;
+  info->peak = frame.peak;
+  info->bufferSize = frame.bufferSize;
+  info->fftSize = frame.fftSize;
+  info->features = (RTASpectralFeatures){f.centroid, f.flux, f.rolloff, f.flatness, f.onset,
+                                         f.pitch, f.pitchConfidence};
+  info->meters = (RTAMeterLevels){m.rms, m.peak, m.peakHold, m.momentaryLufs, m.shortTermLufs};
+  info->voice = (RTAVoiceActivity){v.active, v.changed, v.levelDb, v.noiseFloorDb};
+  info->channels = frame.channels;
+  info->channelBins = frame.channelBins;
+  for (int c = 0; c < 2; ++c) {
+    info->channelRms[c] = frame.channelLevels[c].rms;
+    info->channelPeak[c] = frame.channelLevels[c].peak;
+  }
+  info->subscriber = frame.subscriber;
+  return frame.bins;
+}
+
+- (NSUInteger)dropped
+{
+  return (NSUInteger)_queue->dropped();
+}
+
+- (FrameQueue *)queue
+{
+  return _queue.get();
+}
+
+@end
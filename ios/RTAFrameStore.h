@@ -0,0 +1,28 @@
+#import <Foundation/Foundation.h>
+
+@class RCTBridge;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Objective-C face of the shared C++ FrameStore (cpp/frame_store.h) so the
+ * Swift module can publish frames into memory that JS reads as an
+ * ArrayBuffer. Publishing must happen from a single thread.
+ */
+@interface RTAFrameStore : NSObject
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// Installs the buffer as a JS global; call on the JS thread. NO without JSI.
+- (BOOL)installInBridge:(RCTBridge *)bridge;
+
+- (void)publishBins:(nullable const float *)bins
+              count:(NSInteger)count
+                rms:(float)rms
+               peak:(float)peak
+        timestampMs:(double)timestampMs;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,46 @@
+#import "RTAFrameStore.h"
+
+#import <React/RCTBridge+Private.h>
+#import <jsi/jsi.h>
+
+#include <algorithm>
+#include <memory>
+
+#include "frame_bindings.h"
+#include "frame_store.h"
+
+using realtimeaudio::FrameStore;
+
+@implementation RTAFrameStore {
+  std::shared_ptr<FrameStore> _store;
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity
+{
+  if (self = [super init]) {
+    _store = std::make_shared<FrameStore>((uint32_t)capacity);
+  }
+  return self;
+}
+
+- (BOOL)installInBridge:(RCTBridge *)bridge
+{
+  RCTCxxBridge *cxxBridge = (RCTCxxBridge *)bridge;
+  if (![cxxBridge respondsToSelector:@selector(runtime)] || cxxBridge.runtime == nullptr) {
+    return NO;
+  }
+  auto *runtime = static_cast<facebook::jsi::Runtime *>(cxxBridge.runtime);
+  realtimeaudio::installFrameBindings(*runtime, _store);
+  return YES;
+}
+
+- (void)publishBins:(const float *)bins
+              count:(NSInteger)count
+                rms:(float)rms
+               peak:(float)peak
+        timestampMs:(double)timestampMs
+{
+  _store->publish(bins, (uint32_t)std::max<NSInteger>(count, 0), rms, peak, timestampMs);
+}
+
+@end
@@ -0,0 +1,52 @@
+#import <Foundation/Foundation.h>
+
+#ifdef __cplusplus
+namespace realtimeaudio {
+class PerfStats;
+}
+#endif
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Stage values match PerfStage (cpp/perf_stats.h).
+typedef NS_ENUM(NSInteger, RTAPerfStage) {
+  RTAPerfStageRead = 0,
+  RTAPerfStageAnalyze = 1,
+  RTAPerfStageFft = 2,
+  RTAPerfStageFeatures = 3,
+  RTAPerfStagePublish = 4,
+  RTAPerfStageQueue = 5,
+  RTAPerfStageDeliver = 6,
+};
+
+/**
+ * Objective-C face of the shared C++ PerfStats (cpp/perf_stats.h): lock-free
+ * per-stage timings and drop counters that the tap records and any thread
+ * may snapshot. Attach it to an RTAAnalyzer to get the analyze, fft and
+ * features stages; the module times the rest.
+ */
+@interface RTAPerfStats : NSObject
+
+/// Zeroes every counter for a new session; `tracing` also wraps each stage
+/// in an os_signpost interval (Points of Interest in Instruments).
+- (void)resetWithTracing:(BOOL)tracing;
+
+/// Returns the start time to pass to endStage:start:.
+- (int64_t)beginStage:(RTAPerfStage)stage;
+- (void)endStage:(RTAPerfStage)stage start:(int64_t)startNs;
+
+- (void)countRead:(BOOL)emitted;
+- (void)countOverruns:(NSUInteger)count;
+
+/// Same shape as getPerformanceStats() in JS: counters plus a `stages`
+/// dictionary of {count, meanUs, p50Us, p95Us, p99Us, maxUs, histogram}.
+- (NSDictionary<NSString *, id> *)snapshot;
+
+#ifdef __cplusplus
+/// Owned by the receiver; valid for its lifetime.
+@property (nonatomic, readonly) realtimeaudio::PerfStats *stats;
+#endif
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,82 @@
+#import "RTAPerfStats.h"
+
+#include "perf_stats.h"
+
+using realtimeaudio::kPerfBuckets;
+using realtimeaudio::kPerfStageCount;
+using realtimeaudio::PerfSnapshot;
+using realtimeaudio::PerfStage;
+using realtimeaudio::PerfStageStats;
+using realtimeaudio::PerfStats;
+
+@implementation RTAPerfStats {
+  PerfStats _stats;
+}
+
+- (PerfStats *)stats
+{
+  return &_stats;
+}
+
+- (void)resetWithTracing:(BOOL)tracing
+{
+  _stats.reset();
+  _stats.setTracing(tracing);
+}
+
+- (int64_t)beginStage:(RTAPerfStage)stage
+{
+  return _stats.begin((PerfStage)stage);
+}
+
+- (void)endStage:(RTAPerfStage)stage start:(int64_t)startNs
+{
+  _stats.end((PerfStage)stage, startNs);
+}
+
+- (void)countRead:(BOOL)emitted
+{
+  _stats.countRead(emitted);
+}
+
+- (void)countOverruns:(NSUInteger)count
+{
+  _stats.countOverruns((uint64_t)count);
+}
+
+- (NSDictionary<NSString *, id> *)snapshot
+{
+  PerfSnapshot snapshot;
+  _stats.snapshot(&snapshot);
+
+  NSMutableDictionary<NSString *, id> *stages = [NSMutableDictionary dictionaryWithCapacity:kPerfStageCount];
+  for (int i = 0; i < kPerfStageCount; ++i) {
+    const PerfStageStats &s = snapshot.stages[i];
+    NSMutableArray<NSNumber *> *histogram = [NSMutableArray arrayWithCapacity:kPerfBuckets];
+    for (int b = 0; b < kPerfBuckets; ++b) {
+      [histogram addObject:@(s.histogram[b])];
+    }
+    stages[@(realtimeaudio::perfStageName((PerfStage)i))] = @{
+      @"count": @(s.count),
+      @"meanUs": @(s.meanUs),
+      @"p50Us": @(s.p50Us),
+      @"p95Us": @(s.p95Us),
+      @"p99Us": @(s.p99Us),
+      @"maxUs": @(s.maxUs),
+      @"histogram": histogram,
+    };
+  }
+
+  return @{
+    @"elapsedMs": @(snapshot.elapsedMs),
+    @"reads": @(snapshot.reads),
+    @"rateLimitedFrames": @(snapshot.rateLimited),
+    @"readOverruns": @(snapshot.overruns),
+    @"queueDepth": @(snapshot.queueDepth),
+    @"maxQueueDepth": @(snapshot.maxQueueDepth),
+    @"queueDroppedFrames": @(snapshot.queueDropped),
+    @"stages": stages,
+  };
+}
+
+@end
@@ -0,0 +1,47 @@
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Objective-C face of the batch spectrogram (cpp/spectrogram.h): the whole
+ * STFT of a decoded clip in one call, spread over worker threads that each
+ * own their plan. Frames match what RTAAnalyzer produces live for the same
+ * size, window and band settings. One instance per call; not thread-safe.
+ */
+@interface RTASpectrogram : NSObject
+
+@property (nonatomic) NSInteger fftSize;
+/// Samples between frames; <= 0 uses fftSize / 2. Holds the hop used after
+/// a successful compute.
+@property (nonatomic) NSInteger hopSize;
+/// RTAAnalyzer windowFromName / backendFromName / layoutFromName values.
+@property (nonatomic) NSInteger window;
+@property (nonatomic) NSInteger backend;
+@property (nonatomic) NSInteger bandLayout;
+/// <= 0 keeps fftSize / 2 raw bins.
+@property (nonatomic) NSInteger bands;
+/// Format values match SpectrogramFormat: 0 uint8 dB, 1 float16 magnitude.
+@property (nonatomic) NSInteger format;
+@property (nonatomic) float minDb;
+@property (nonatomic) float maxDb;
+/// <= 0 uses one thread per core (at most 8).
+@property (nonatomic) NSInteger threads;
+
+/// Matrix shape of the last successful compute.
+@property (nonatomic, readonly) NSInteger frames;
+@property (nonatomic, readonly) NSInteger bins;
+
++ (NSInteger)formatFromName:(nullable NSString *)name;
+
+/// Computes the spectrogram of `frameCount` interleaved frames of
+/// `channels` float samples (averaged to mono). Returns the row-major
+/// [frames][bins] matrix, or nil for an invalid size or on allocation
+/// failure.
+- (nullable NSData *)computeWithSamples:(const float *)samples
+                             frameCount:(NSInteger)frameCount
+                               channels:(NSInteger)channels
+                             sampleRate:(double)sampleRate;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,70 @@
+#import "RTASpectrogram.h"
+
+#include "spectrogram.h"
+
+using realtimeaudio::bandLayoutFromInt;
+using realtimeaudio::computeSpectrogram;
+using realtimeaudio::fftBackendFromInt;
+using realtimeaudio::SampleBuffer;
+using realtimeaudio::SampleFormat;
+using realtimeaudio::Spectrogram;
+using realtimeaudio::SpectrogramFormat;
+using realtimeaudio::SpectrogramOptions;
+using realtimeaudio::spectrogramFormatFromInt;
+using realtimeaudio::windowTypeFromInt;
+
+@implementation RTASpectrogram
+
++ (NSInteger)formatFromName:(NSString *)name
+{
+  if ([name isEqualToString:@"float16"]) {
+    return (NSInteger)SpectrogramFormat::Float16;
+  }
+  return (NSInteger)SpectrogramFormat::Db8;
+}
+
+- (instancetype)init
+{
+  if ((self = [super init])) {
+    SpectrogramOptions defaults;
+    _fftSize = defaults.fftSize;
+    _minDb = defaults.minDb;
+    _maxDb = defaults.maxDb;
+  }
+  return self;
+}
+
+- (NSData *)computeWithSamples:(const float *)samples
+                    frameCount:(NSInteger)frameCount
+                      channels:(NSInteger)channels
+                    sampleRate:(double)sampleRate
+{
+  SpectrogramOptions options;
+  options.fftSize = (int)_fftSize;
+  options.hopSize = (int)_hopSize;
+  options.window = windowTypeFromInt((int)_window);
+  options.backend = fftBackendFromInt((int)_backend);
+  options.layout = bandLayoutFromInt((int)_bandLayout);
+  options.bands = (int)_bands;
+  options.format = spectrogramFormatFromInt((int)_format);
+  options.minDb = _minDb;
+  options.maxDb = _maxDb;
+  options.threads = (int)_threads;
+
+  SampleBuffer input;
+  input.samples = samples;
+  input.format = SampleFormat::Float32;
+  input.channels = (int)channels;
+  input.frames = frameCount;
+
+  Spectrogram result;
+  if (!computeSpectrogram(input, (float)sampleRate, options, &result)) {
+    return nil;
+  }
+  _frames = result.frames;
+  _bins = result.bins;
+  _hopSize = result.hopSize;
+  return [NSData dataWithBytes:result.data.data() length:result.data.size()];
+}
+
+@end
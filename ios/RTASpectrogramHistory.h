@@ -0,0 +1,41 @@
+#import <Foundation/Foundation.h>
+
+#ifdef __cplusplus
+namespace realtimeaudio {
+class SpectrogramHistory;
+}
+#endif
+
+@class RCTBridge;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Objective-C face of the shared C++ SpectrogramHistory
+ * (cpp/spectrogram_history.h): a rolling frames x bins spectrogram in memory
+ * that JS reads as an ArrayBuffer. Frames must be pushed from a single
+ * thread.
+ */
+@interface RTASpectrogramHistory : NSObject
+
+/// `float16` NO stores uint8 dB codes over [minDb, maxDb]. nil without memory.
+- (nullable instancetype)initWithFrames:(NSUInteger)frames
+                                maxBins:(NSUInteger)maxBins
+                                float16:(BOOL)float16
+                                  minDb:(float)minDb
+                                  maxDb:(float)maxDb NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// Installs the buffer as a JS global; call on the JS thread. NO without JSI.
+- (BOOL)installInBridge:(RCTBridge *)bridge;
+
+- (void)pushBins:(const float *)bins count:(NSInteger)count timestampMs:(double)timestampMs;
+
+#ifdef __cplusplus
+/// Owned by the receiver; valid for its lifetime.
+@property (nonatomic, readonly) realtimeaudio::SpectrogramHistory *history;
+#endif
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,59 @@
+#import "RTASpectrogramHistory.h"
+
+#import <React/RCTBridge+Private.h>
+#import <jsi/jsi.h>
+
+#include <algorithm>
+#include <memory>
+#include <new>
+
+#include "frame_bindings.h"
+#include "spectrogram_history.h"
+
+using realtimeaudio::SpectrogramFormat;
+using realtimeaudio::SpectrogramHistory;
+
+@implementation RTASpectrogramHistory {
+  std::shared_ptr<SpectrogramHistory> _history;
+}
+
+- (instancetype)initWithFrames:(NSUInteger)frames
+                       maxBins:(NSUInteger)maxBins
+                       float16:(BOOL)float16
+                         minDb:(float)minDb
+                         maxDb:(float)maxDb
+{
+  if (self = [super init]) {
+    try {
+      _history = std::make_shared<SpectrogramHistory>(
+          (uint32_t)frames, (uint32_t)maxBins,
+          float16 ? SpectrogramFormat::Float16 : SpectrogramFormat::Db8, minDb, maxDb);
+    } catch (const std::bad_alloc &) {
+      return nil;
+    }
+  }
+  return self;
+}
+
+- (BOOL)installInBridge:(RCTBridge *)bridge
+{
+  RCTCxxBridge *cxxBridge = (RCTCxxBridge *)bridge;
+  if (![cxxBridge respondsToSelector:@selector(runtime)] || cxxBridge.runtime == nullptr) {
+    return NO;
+  }
+  auto *runtime = static_cast<facebook::jsi::Runtime *>(cxxBridge.runtime);
+  realtimeaudio::installHistoryBindings(*runtime, _history);
+  return YES;
+}
+
+- (void)pushBins:(const float *)bins count:(NSInteger)count timestampMs:(double)timestampMs
+{
+  _history->push(bins, (uint32_t)std::max<NSInteger>(count, 0), timestampMs);
+}
+
+- (SpectrogramHistory *)history
+{
+  return _history.get();
+}
+
+@end
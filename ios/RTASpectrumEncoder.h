@@ -0,0 +1,39 @@
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Values match SpectrumFormat (cpp/spectrum_codec.h).
+typedef NS_ENUM(NSInteger, RTASpectrumFormat) {
+  RTASpectrumFormatFloat = 0,
+  RTASpectrumFormatUInt8 = 1,
+  RTASpectrumFormatUInt16 = 2,
+};
+
+/**
+ * Objective-C face of the shared C++ SpectrumEncoder (cpp/spectrum_codec.h):
+ * quantizes one stream of spectra to dB codes, optionally delta-coded
+ * against the previous frame. Use one per stream, from one thread.
+ */
+@interface RTASpectrumEncoder : NSObject
+
+/// 'float' | 'uint8' | 'uint16'; anything else is float.
++ (RTASpectrumFormat)formatFromName:(nullable NSString *)name;
+
+/// nil for RTASpectrumFormatFloat or maxDb <= minDb.
+- (nullable instancetype)initWithFormat:(RTASpectrumFormat)format
+                                  minDb:(float)minDb
+                                  maxDb:(float)maxDb
+                                  delta:(BOOL)delta
+                       keyframeInterval:(NSInteger)keyframeInterval
+                               capacity:(NSInteger)capacity NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// Base64 of the encoded frame; nil for an empty one.
+- (nullable NSString *)encodeBase64:(const float *)values count:(NSInteger)count;
+
+/// The next frame is a keyframe.
+- (void)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
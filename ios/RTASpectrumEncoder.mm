@@ -0,0 +1,64 @@
+#import "RTASpectrumEncoder.h"
+
+#include <vector>
+
+#include "spectrum_codec.h"
+
+using realtimeaudio::SpectrumEncoder;
+using realtimeaudio::SpectrumEncoding;
+
+@implementation RTASpectrumEncoder {
+  SpectrumEncoder _encoder;
+  std::vector<uint8_t> _bytes; // reused frame buffer
+}
+
++ (RTASpectrumFormat)formatFromName:(NSString *)name
+{
+  if ([name isEqualToString:@"uint8"]) {
+    return RTASpectrumFormatUInt8;
+  }
+  if ([name isEqualToString:@"uint16"]) {
+    return RTASpectrumFormatUInt16;
+  }
+  return RTASpectrumFormatFloat;
+}
+
+- (instancetype)initWithFormat:(RTASpectrumFormat)format
+                         minDb:(float)minDb
+                         maxDb:(float)maxDb
+                         delta:(BOOL)delta
+              keyframeInterval:(NSInteger)keyframeInterval
+                      capacity:(NSInteger)capacity
+{
+  if (self = [super init]) {
+    SpectrumEncoding encoding;
+    encoding.format = realtimeaudio::spectrumFormatFromInt((int)format);
+    encoding.minDb = minDb;
+    encoding.maxDb = maxDb;
+    encoding.delta = delta;
+    encoding.keyframeInterval = (int)keyframeInterval;
+    if (!_encoder.configure(encoding, (int)capacity)) {
+      return nil;
+    }
+    _bytes.resize((size_t)_encoder.maxBytes((int)capacity));
+  }
+  return self;
+}
+
+- (NSString *)encodeBase64:(const float *)values count:(NSInteger)count
+{
+  const int bytes = _encoder.encode(values, (int)count, _bytes.data(), (int)_bytes.size());
+  if (bytes <= 0) {
+    return nil;
+  }
+  // Wraps the reused buffer; only the string is allocated
+  NSData *data = [NSData dataWithBytesNoCopy:_bytes.data() length:(NSUInteger)bytes freeWhenDone:NO];
+  return [data base64EncodedStringWithOptions:0];
+}
+
+- (void)reset
+{
+  _encoder.reset();
+}
+
+@end
@@ -0,0 +1,64 @@
+#import <Foundation/Foundation.h>
+
+@class RTAAnalyzer;
+@class RTAFrameQueue;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// poll: bits (SubscriberGraph::kDue / kSpectral).
+typedef NS_OPTIONS(NSInteger, RTASubscriberPoll) {
+  RTASubscriberPollDue = 1,      // some subscriber is due
+  RTASubscriberPollSpectral = 2, // and needs the magnitudes
+};
+
+/**
+ * Objective-C face of the shared C++ SubscriberGraph
+ * (cpp/subscriber_graph.h): per-consumer bands, rates and products fanned
+ * out of one analyzer's frames, as on Android. Subscribers are set and
+ * removed on any thread; poll and publish belong to the tap.
+ */
+@interface RTASubscriberGraph : NSObject
+
+/// At most this many subscribers at a time.
+@property (class, nonatomic, readonly) NSInteger maxSubscribers;
+
+/// Adds `subscriberId` or replaces its subscription; NO when the graph is
+/// full. `layout` as for RTAAnalyzer, `bands` <= 0 ships raw bins and
+/// `features` holds FeatureFlags bits.
+- (BOOL)setSubscriber:(NSInteger)subscriberId
+               rateHz:(float)rateHz
+             spectrum:(BOOL)spectrum
+               layout:(NSInteger)layout
+                bands:(NSInteger)bands
+             features:(NSUInteger)features
+               meters:(BOOL)meters;
+- (BOOL)removeSubscriber:(NSInteger)subscriberId;
+
+/// Session geometry, so band tables are built here and not in the tap.
+- (void)setFftSize:(NSInteger)fftSize sampleRate:(double)sampleRate;
+
+/// What some subscriber asks for; sessions compute the union.
+@property (nonatomic, readonly) NSUInteger featureMask;
+@property (nonatomic, readonly) BOOL wantsMeters;
+@property (nonatomic, readonly) BOOL wantsSpectrum;
+
+/// Tap. Marks the subscribers due at `nowNs` (host time in ns).
+- (RTASubscriberPoll)poll:(int64_t)nowNs;
+
+/// Tap. Pushes a frame into `queue` for each subscriber poll: marked due,
+/// mapping `count` magnitudes (0 for levels only) in its own bands, with
+/// the features and meters it asked for from `analyzer`. Returns the
+/// frames pushed.
+- (NSInteger)publishMagnitudes:(nullable const float *)magnitudes
+                         count:(NSInteger)count
+                      analyzer:(RTAAnalyzer *)analyzer
+                         queue:(RTAFrameQueue *)queue
+                           rms:(float)rms
+                          peak:(float)peak
+                   timestampMs:(double)timestampMs
+                    bufferSize:(NSInteger)bufferSize
+                         nowNs:(int64_t)nowNs;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,96 @@
+#import "RTASubscriberGraph.h"
+#import "RTAAnalyzer.h"
+#import "RTAFrameQueue.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "analyzer.h"
+#include "frame_queue.h"
+#include "subscriber_graph.h"
+
+using realtimeaudio::SubscriberConfig;
+using realtimeaudio::SubscriberGraph;
+
+@implementation RTASubscriberGraph {
+  std::unique_ptr<SubscriberGraph> _graph;
+}
+
++ (NSInteger)maxSubscribers
+{
+  return SubscriberGraph::kMaxSubscribers;
+}
+
+- (instancetype)init
+{
+  if (self = [super init]) {
+    _graph = std::make_unique<SubscriberGraph>();
+  }
+  return self;
+}
+
+- (BOOL)setSubscriber:(NSInteger)subscriberId
+               rateHz:(float)rateHz
+             spectrum:(BOOL)spectrum
+               layout:(NSInteger)layout
+                bands:(NSInteger)bands
+             features:(NSUInteger)features
+               meters:(BOOL)meters
+{
+  SubscriberConfig config;
+  config.rateHz = rateHz;
+  config.spectrum = spectrum;
+  config.layout = realtimeaudio::bandLayoutFromInt((int)layout);
+  config.bands = (int)bands;
+  config.features = (uint32_t)features;
+  config.meters = meters;
+  return _graph->set((int32_t)subscriberId, config);
+}
+
+- (BOOL)removeSubscriber:(NSInteger)subscriberId
+{
+  return _graph->remove((int32_t)subscriberId);
+}
+
+- (void)setFftSize:(NSInteger)fftSize sampleRate:(double)sampleRate
+{
+  _graph->setSpectrum((int)fftSize, (float)sampleRate);
+}
+
+- (NSUInteger)featureMask
+{
+  return _graph->featureMask();
+}
+
+- (BOOL)wantsMeters
+{
+  return _graph->wantsMeters();
+}
+
+- (BOOL)wantsSpectrum
+{
+  return _graph->wantsSpectrum();
+}
+
+- (RTASubscriberPoll)poll:(int64_t)nowNs
+{
+  return (RTASubscriberPoll)_graph->poll(nowNs);
+}
+
+- (NSInteger)publishMagnitudes:(const float *)magnitudes
+                         count:(NSInteger)count
+                      analyzer:(RTAAnalyzer *)analyzer
+                         queue:(RTAFrameQueue *)queue
+                           rms:(float)rms
+                          peak:(float)peak
+                   timestampMs:(double)timestampMs
+                    bufferSize:(NSInteger)bufferSize
+                         nowNs:(int64_t)nowNs
+{
+  return _graph->publish(*queue.queue, *analyzer.core, magnitudes,
+                         magnitudes != nullptr ? (int)count : 0, rms, peak,
+                         timestampMs, (uint32_t)std::max<NSInteger>(bufferSize, 0),
+                         nowNs);
+}
+
+@end
@@ -11,6 +11,9 @@ RCT_EXTERN_METHOD(startAnalysis:(NSDictionary *)config
 RCT_EXTERN_METHOD(stopAnalysis:(RCTPromiseResolveBlock)resolve
                   withRejecter:(RCTPromiseRejectBlock)reject)
 
+RCT_EXTERN_METHOD(getPerformanceStats:(RCTPromiseResolveBlock)resolve
+                  withRejecter:(RCTPromiseRejectBlock)reject)
+
 RCT_EXTERN_METHOD(isAnalyzing:(RCTPromiseResolveBlock)resolve
                   withRejecter:(RCTPromiseRejectBlock)reject)
 
@@ -37,10 +40,28 @@ RCT_EXTERN_METHOD(setFftConfig:(nonnull NSNumber *)fftSize
                   withResolver:(RCTPromiseResolveBlock)resolve
                   withRejecter:(RCTPromiseRejectBlock)reject)
 
+RCT_EXTERN_METHOD(addAnalysisSubscriber:(nonnull NSNumber *)id
+                  options:(NSDictionary *)options
+                  withResolver:(RCTPromiseResolveBlock)resolve
+                  withRejecter:(RCTPromiseRejectBlock)reject)
+
+RCT_EXTERN_METHOD(removeAnalysisSubscriber:(nonnull NSNumber *)id
+                  withResolver:(RCTPromiseResolveBlock)resolve
+                  withRejecter:(RCTPromiseRejectBlock)reject)
+
 RCT_EXTERN_METHOD(enableDebugLogging:(RCTPromiseResolveBlock)resolve
                   withRejecter:(RCTPromiseRejectBlock)reject)
 
 RCT_EXTERN_METHOD(disableDebugLogging:(RCTPromiseResolveBlock)resolve
                   withRejecter:(RCTPromiseRejectBlock)reject)
 
+RCT_EXTERN__BLOCKING_SYNCHRONOUS_METHOD(installFrameBuffer)
+
+RCT_EXTERN__BLOCKING_SYNCHRONOUS_METHOD(installSpectrogramHistory:(NSDictionary *)options)
+
+RCT_EXTERN_METHOD(computeSpectrogram:(NSString *)path
+                  options:(NSDictionary *)options
+                  withResolver:(RCTPromiseResolveBlock)resolve
+                  withRejecter:(RCTPromiseRejectBlock)reject)
+
 @end
\ No newline at end of file
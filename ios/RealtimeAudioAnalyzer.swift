@@ -1,6 +1,5 @@
 import Foundation
 import AVFoundation
-import Accelerate
 import React
 import os.log
 
@@ -23,22 +22,124 @@ class RealtimeAudioAnalyzer: RCTEventEmitter {
   private var smoothingEnabled: Bool = true
   private var smoothingFactor: Float = 0.5
   private var fftSize: Int = 1024
+  private var hopSize: Int = 0 // samples between STFT frames, 0 = per buffer
   private var downsampleBins: Int = -1
-
-  // FFT state
-  private var fftSetup: vDSP_DFT_Setup?
-  private var logN: vDSP_Length = 10
-  private var lastCallbackTime: TimeInterval = 0
-  private var smoothRms: Float = 0
-  private var smoothPeak: Float = 0
+  private var bandLayout: String = "linear" // 'linear' | 'log' | 'mel' | 'octave'
+  private var fftBackend: String = "auto" // 'auto' | 'kissfft' | 'realfft' | 'accelerate' | 'kissfft-q15' | 'kissfft-q31'
+  private var windowFunction: String = "hanning"
+  // Spectral features computed natively per frame, in FeatureFlags order
+  private var features: [String] = []
+  private var channelMode: String = "mono" // 'mono' | 'stereo' | 'midside'
+  private var traceStages: Bool = false // os_signpost intervals per stage
+  // Read-size independent meters (sliding RMS, peak hold, LUFS); times in ms
+  private var metersEnabled: Bool = false
+  private var meterWindowMs: Float = 300
+  private var meterAttackMs: Float = 10
+  private var meterReleaseMs: Float = 300
+  private var peakHoldMs: Float = 1500
+  private static let maxMeterMs: Float = 10000
+  // Voice activity gate (cpp/voice_activity.h): levels in dBFS, times in ms.
+  // While closed the FFT and features are skipped and frames drop to
+  // vadSilentRateHz, 0 sending only the transitions.
+  private var voiceActivityEnabled: Bool = false
+  private var vadThresholdDb: Float = -50
+  private var vadHysteresisDb: Float = 6
+  private var vadNoiseMarginDb: Float = 10
+  private var vadAttackMs: Float = 30
+  private var vadReleaseMs: Float = 500
+  private var vadSilentRateHz: Double = 0
+  // Compact spectra: dB codes over [spectrumMinDb, spectrumMaxDb] instead of
+  // number arrays, optionally delta-coded against the previous frame
+  private var spectrumFormat: String = "float" // 'float' | 'uint8' | 'uint16'
+  private var spectrumMinDb: Float = -100
+  private var spectrumMaxDb: Float = 0
+  private var spectrumDelta: Bool = false
+  private var keyframeInterval: Int = 30
+  // One per stream (the spectrum, then each channel); empty for 'float'
+  private var spectrumEncoders: [RTASpectrumEncoder] = []
+
+  // Shared C++ analysis core (cpp/analyzer.h): STFT history, window, FFT,
+  // bands and smoothing, identical to the Android pipeline
+  private var analyzer: RTAAnalyzer?
+  // Host time (seconds) of the next emission; the tap schedules on the
+  // AVAudioTime of each buffer rather than the wall clock
+  private var nextCallbackTime: TimeInterval = 0
+  // Host time -> Unix time, taken once per session for event timestamps
+  private var epochOffset: TimeInterval = 0
+  // Stage timings and drop counters, kept across sessions so they can be
+  // read after stopAnalysis()
+  private let perfStats = RTAPerfStats()
+  // Per-consumer fan-out of the session's frames (addAnalysisSubscriber),
+  // kept across sessions like perfStats. The delivery thread reads the
+  // subscriptions to shape each subscriber's event.
+  private let subscriberGraph = RTASubscriberGraph()
+  private var subscriptions: [Int: (features: [String], meters: Bool)] = [:]
+  private let subscriptionsLock = NSLock()
+  // What the session computes: its own features and meters plus those
+  // subscribers asked for when it started
+  private var sessionFeatures: [String] = []
+  private var sessionMeters = false
 
   // Pre-allocated buffers (avoid allocation in callback as much as possible)
-  private var window: [Float] = []
-  private var windowedInput: [Float] = []
-  private var fftReal: [Float] = []
-  private var fftImag: [Float] = []
-  private var zerosImag: [Float] = []
-  private var magnitudes: [Float] = []
+  private var magnitudes: [Float] = [] // newest STFT frame
+  private var lastBins: Int = 0        // valid bins in magnitudes
+  private var lastFrameFftSize: Int = 0 // size lastBins was produced at
+  // Transform size the tap runs at; set after the plan is prepared
+  private var analysisFftSize: Int = 0
+  private var bandOutput: [Float] = [] // reused band values
+  private var inputSampleRate: Double = 0
+  private var inputChannelCount = 0
+
+  // Tap -> delivery thread frame queue, as on Android: the tap maps each due
+  // frame into a slot and signals; payloads, events and notifications are
+  // built on the delivery thread, never on the render thread
+  private var frameQueue: RTAFrameQueue?
+  private var deliveryThread: Thread?
+  private var deliverySignal = DispatchSemaphore(value: 0)
+  private var deliveryDone = DispatchSemaphore(value: 0)
+  private var deliveryFrame: [Float] = [] // popped bins and channel spectra
+  // Eight slots cover ~65 ms of backlog at 120 Hz, plus one per
+  // subscriber that may come due with a main frame
+  private static let frameQueueSlots = 8 + RTASubscriberGraph.maxSubscribers
+  // Fallback wake-up in case a signal is missed
+  private static let deliveryIdleMs = 100
+
+  // Settings setSmoothing and setFftConfig change while the tap runs, as
+  // one plain-value snapshot. Control methods run on a concurrent queue, so
+  // they replace it under liveConfigLock; the tap only try()s the lock and
+  // keeps its last copy when it is busy, so it never blocks or reads the
+  // control-side fields.
+  private struct LiveConfig: Equatable {
+    var smoothingEnabled = true
+    var smoothingFactor: Float = 0.5
+    var bandLayout = 0 // RTAAnalyzer.layout(fromName:)
+    var bands = -1
+    var fftSize = 0 // analysisFftSize
+  }
+  private var liveConfig = LiveConfig()
+  private let liveConfigLock = NSLock()
+  // Tap thread only: its copy of liveConfig, and the one last handed to
+  // the analyzer
+  private var tapConfig = LiveConfig()
+  private var appliedConfig: LiveConfig?
+
+  // Shared-memory frame delivery (frameDelivery: 'jsi')
+  private static let frameBufferCapacity = 8192
+  private static let maxFftSize = 16384
+
+  // Names accepted for windowFunction, in WindowType order
+  private static let windowFunctions = ["hanning", "hamming", "blackman", "rectangular", "blackmanharris", "flattop"]
+  private static let featureNames = ["centroid", "flux", "rolloff", "flatness", "onset", "pitch"]
+  // Names accepted for channelMode, in ChannelMode order
+  private static let channelModes = ["mono", "stereo", "midside"]
+  private static let dataNotification = NSNotification.Name("RealtimeAudioAnalyzer:onData")
+  private var frameStore: RTAFrameStore?
+  private var sharedFrames = false
+  // Rolling spectrogram of the delivered frames (installSpectrogramHistory)
+  private var spectrogramHistory: RTASpectrogramHistory?
+  private static let historyDefaultFrames = 512
+  private static let historyMaxFrames = 8192
+  private static let historyDefaultBins = 2048
 
   // MARK: - Error Handling and Logging Utilities
   
@@ -106,6 +207,14 @@ class RealtimeAudioAnalyzer: RCTEventEmitter {
       }
     }
     
+    // Validate hopSize if provided (0 = one STFT frame per buffer)
+    if let hopSize = config["hopSize"] as? NSNumber {
+      let hop = hopSize.intValue
+      if hop < 0 || hop > 16384 {
+        return (false, "hopSize must be between 0 and 16384, got: \(hop)")
+      }
+    }
+    
     // Validate callbackRateHz if provided
     if let callbackRate = config["callbackRateHz"] as? NSNumber {
       let rate = callbackRate.doubleValue
@@ -121,6 +230,56 @@ class RealtimeAudioAnalyzer: RCTEventEmitter {
         return (false, "downsampleBins must be -1 (disabled) or a positive integer, got: \(bins)")
       }
     }
+
+    // Validate fftBackend if provided
+    if let backend = config["fftBackend"] as? String {
+      if !["auto", "kissfft", "realfft", "accelerate", "kissfft-q15", "kissfft-q31"].contains(backend) {
+        return (false, "fftBackend must be 'auto', 'kissfft', 'realfft', 'accelerate', 'kissfft-q15' or 'kissfft-q31', got: \(backend)")
+      }
+    }
+
+    // Validate windowFunction if provided
+    if let window = config["windowFunction"] as? String {
+      if !Self.windowFunctions.contains(window) {
+        return (false, "windowFunction must be one of \(Self.windowFunctions.joined(separator: ", ")), got: \(window)")
+      }
+    }
+
+    // Validate features if provided
+    if let requested = config["features"] {
+      guard let names = requested as? [String] else {
+        return (false, "features must be an array of feature names")
+      }
+      if let unknown = names.first(where: { !Self.featureNames.contains($0) }) {
+        return (false, "features must only contain \(Self.featureNames.joined(separator: ", ")), got: \(unknown)")
+      }
+    }
+
+    // Validate channelMode if provided
+    if let mode = config["channelMode"] as? String {
+      if !Self.channelModes.contains(mode) {
+        return (false, "channelMode must be one of \(Self.channelModes.joined(separator: ", ")), got: \(mode)")
+      }
+    }
+
+    // Validate bandLayout if provided
+    if let layout = config["bandLayout"] as? String {
+      if !["linear", "log", "mel", "octave"].contains(layout) {
+        return (false, "bandLayout must be 'linear', 'log', 'mel' or 'octave', got: \(layout)")
+      }
+    }
+
+    // Validate the compact spectrum encoding if provided
+    if let format = config["spectrumFormat"] as? String {
+      if !["float", "uint8", "uint16"].contains(format) {
+        return (false, "spectrumFormat must be 'float', 'uint8' or 'uint16', got: \(format)")
+      }
+    }
+    let minDb = (config["spectrumMinDb"] as? NSNumber)?.doubleValue ?? -100
+    let maxDb = (config["spectrumMaxDb"] as? NSNumber)?.doubleValue ?? 0
+    if !(maxDb > minDb) {
+      return (false, "spectrumMaxDb must be above spectrumMinDb, got: \(minDb)..\(maxDb)")
+    }
     
     return (true, nil)
   }
@@ -217,7 +376,8 @@ class RealtimeAudioAnalyzer: RCTEventEmitter {
   }
 
   override func supportedEvents() -> [String]! {
-    return ["RealtimeAudioAnalyzer:onData", "AudioAnalysisData"]
+    return ["RealtimeAudioAnalyzer:onData", "AudioAnalysisData", "RealtimeAudioAnalyzer:onVoiceActivity",
+            "RealtimeAudioAnalyzer:onSubscriberData"]
   }
 
   // ✅ Fix 2: In many RN versions this is a *property*, not a method.
@@ -236,7 +396,9 @@ class RealtimeAudioAnalyzer: RCTEventEmitter {
         "startAnalysis", "stopAnalysis", "isAnalyzing",
         "start", "stop", "isRunning", 
         "getAnalysisConfig", "setSmoothing", "setFftConfig",
-        "enableDebugLogging", "disableDebugLogging"
+        "enableDebugLogging", "disableDebugLogging",
+        "installFrameBuffer", "installSpectrogramHistory", "getPerformanceStats",
+        "addAnalysisSubscriber", "removeAnalysisSubscriber"
       ]
     ]
   }
@@ -262,15 +424,11 @@ class RealtimeAudioAnalyzer: RCTEventEmitter {
 
   // MARK: - Cleanup
 
-  private func cleanupFft() {
-    if let setup = fftSetup {
-      vDSP_DFT_DestroySetup(setup)
-      fftSetup = nil
-    }
-  }
-
-  deinit {
-    cleanupFft()
+  private func releaseAnalyzer() {
+    stopDelivery()
+    frameQueue = nil
+    analyzer = nil
+    appliedConfig = nil
   }
 
   // MARK: - Public API (Primary Methods)
@@ -310,13 +468,7 @@ class RealtimeAudioAnalyzer: RCTEventEmitter {
       smoothingFactor = Float(max(0, min(1, smoothingDouble))) // Validate range
       smoothingEnabled = smoothingDouble > 0
     }
-    if let windowFunc = config["windowFunction"] as? String {
-      // Store window function preference (currently only hanning is implemented)
-      // Future enhancement: support different window functions
-      if windowFunc != "hanning" {
-        os_log("Warning: Only 'hanning' window function is currently supported, got: %{public}@", log: Self.logger, type: .default, windowFunc)
-      }
-    }
+    if let windowFunc = config["windowFunction"] as? String { windowFunction = windowFunc }
     
     // Legacy support for additional config options
     if let bufSize = config["bufferSize"] as? NSNumber { 
@@ -326,6 +478,10 @@ class RealtimeAudioAnalyzer: RCTEventEmitter {
       callbackRateHz = max(1, min(120, cbRate.doubleValue)) // Validate range
     }
     if let emit = config["emitFft"] as? Bool { emitFft = emit }
+    if let names = config["features"] as? [String] {
+      features = Self.featureNames.filter { names.contains($0) }
+    }
+    if let mode = config["channelMode"] as? String { channelMode = mode }
     if let se = config["smoothingEnabled"] as? Bool { 
       smoothingEnabled = se 
       // If smoothingEnabled is explicitly set to false, ensure smoothing is 0
@@ -342,6 +498,41 @@ class RealtimeAudioAnalyzer: RCTEventEmitter {
       }
     }
     if let ds = config["downsampleBins"] as? NSNumber { downsampleBins = ds.intValue }
+    if let layout = config["bandLayout"] as? String { bandLayout = layout }
+    if let backend = config["fftBackend"] as? String { fftBackend = backend }
+    if let hop = config["hopSize"] as? NSNumber { hopSize = max(0, hop.intValue) }
+    traceStages = config["traceStages"] as? Bool ?? false
+    metersEnabled = config["meters"] as? Bool ?? false
+    func meterMs(_ key: String, _ current: Float) -> Float {
+      guard let value = config[key] as? NSNumber else { return current }
+      return max(0, min(Self.maxMeterMs, value.floatValue))
+    }
+    meterWindowMs = max(1, meterMs("meterWindowMs", meterWindowMs))
+    meterAttackMs = meterMs("meterAttackMs", meterAttackMs)
+    meterReleaseMs = meterMs("meterReleaseMs", meterReleaseMs)
+    peakHoldMs = meterMs("peakHoldMs", peakHoldMs)
+    voiceActivityEnabled = config["voiceActivity"] as? Bool ?? false
+    if let value = config["vadThresholdDb"] as? NSNumber { vadThresholdDb = value.floatValue }
+    if let value = config["vadHysteresisDb"] as? NSNumber { vadHysteresisDb = max(0, value.floatValue) }
+    if let value = config["vadNoiseMarginDb"] as? NSNumber { vadNoiseMarginDb = max(0, value.floatValue) }
+    vadAttackMs = meterMs("vadAttackMs", vadAttackMs)
+    vadReleaseMs = meterMs("vadReleaseMs", vadReleaseMs)
+    if let value = config["vadSilentRateHz"] as? NSNumber {
+      vadSilentRateHz = max(0, min(callbackRateHz, value.doubleValue))
+    }
+    spectrumFormat = config["spectrumFormat"] as? String ?? "float"
+    spectrumMinDb = (config["spectrumMinDb"] as? NSNumber)?.floatValue ?? -100
+    spectrumMaxDb = (config["spectrumMaxDb"] as? NSNumber)?.floatValue ?? 0
+    spectrumDelta = config["spectrumDelta"] as? Bool ?? false
+    keyframeInterval = max(0, (config["keyframeInterval"] as? NSNumber)?.intValue ?? 30)
+    sharedFrames = false
+    if let delivery = config["frameDelivery"] as? String, delivery == "jsi" {
+      if frameStore != nil {
+        sharedFrames = true
+      } else {
+        os_log("frameDelivery 'jsi' requested before installFrameBuffer(); using events", log: Self.logger, type: .default)
+      }
+    }
 
     // Permissions
     let session = AVAudioSession.sharedInstance()
@@ -371,6 +562,149 @@ class RealtimeAudioAnalyzer: RCTEventEmitter {
     }
   }
 
+  // Installs the shared frame buffer as a JS global. Runs synchronously on
+  // the JS thread, which is where the runtime may be touched.
+  @objc(installFrameBuffer)
+  func installFrameBuffer() -> NSNumber {
+    logMethodCall("installFrameBuffer")
+    guard let bridge = bridge else {
+      logMethodResult("installFrameBuffer", success: false, error: "Bridge not available")
+      return false
+    }
+    let store = frameStore ?? RTAFrameStore(capacity: UInt(Self.frameBufferCapacity))
+    guard store.install(in: bridge) else {
+      logMethodResult("installFrameBuffer", success: false, error: "JSI runtime not available")
+      return false
+    }
+    frameStore = store
+    logMethodResult("installFrameBuffer", success: true)
+    return true
+  }
+
+  // Allocates the spectrogram history and installs it as a JS global (on
+  // the JS thread, like installFrameBuffer). The tap reads the history
+  // without a lock, so replacing it is refused while analysis runs.
+  @objc(installSpectrogramHistory:)
+  func installSpectrogramHistory(options: NSDictionary) -> NSNumber {
+    logMethodCall("installSpectrogramHistory", parameters: options as? [String: Any])
+    guard !running else {
+      logMethodResult("installSpectrogramHistory", success: false, error: "Must be called before startAnalysis()")
+      return false
+    }
+    guard let bridge = bridge else {
+      logMethodResult("installSpectrogramHistory", success: false, error: "Bridge not available")
+      return false
+    }
+    let frames = (options["frames"] as? NSNumber)?.intValue ?? Self.historyDefaultFrames
+    let maxBins = (options["maxBins"] as? NSNumber)?.intValue ?? Self.historyDefaultBins
+    let float16 = options["format"] as? String == "float16"
+    let minDb = (options["minDb"] as? NSNumber)?.floatValue ?? -100
+    let maxDb = (options["maxDb"] as? NSNumber)?.floatValue ?? 0
+    guard (1...Self.historyMaxFrames).contains(frames),
+          (1...Self.frameBufferCapacity).contains(maxBins),
+          maxDb > minDb else {
+      logMethodResult("installSpectrogramHistory", success: false,
+                      error: "Invalid options: \(frames) frames, \(maxBins) bins, \(minDb)..\(maxDb) dB")
+      return false
+    }
+    guard let history = RTASpectrogramHistory(frames: UInt(frames), maxBins: UInt(maxBins),
+                                              float16: float16, minDb: minDb, maxDb: maxDb) else {
+      logMethodResult("installSpectrogramHistory", success: false, error: "Out of memory")
+      return false
+    }
+    guard history.install(in: bridge) else {
+      logMethodResult("installSpectrogramHistory", success: false, error: "JSI runtime not available")
+      return false
+    }
+    spectrogramHistory = history
+    logMethodResult("installSpectrogramHistory", success: true)
+    return true
+  }
+
+  // Offline spectrogram of a recorded clip, independent of capture. The file
+  // is decoded to interleaved float by AVAudioFile and the matrix computed
+  // by the shared core on worker threads; it is returned base64-encoded.
+  @objc(computeSpectrogram:options:withResolver:withRejecter:)
+  func computeSpectrogram(path: String,
+                          options: NSDictionary,
+                          resolve: @escaping RCTPromiseResolveBlock,
+                          reject: @escaping RCTPromiseRejectBlock) {
+    logMethodCall("computeSpectrogram", parameters: ["path": path])
+
+    let core = RTASpectrogram()
+    core.fftSize = (options["fftSize"] as? NSNumber)?.intValue ?? 1024
+    core.hopSize = (options["hopSize"] as? NSNumber)?.intValue ?? 0
+    core.bands = (options["downsampleBins"] as? NSNumber)?.intValue ?? 0
+    core.window = RTAAnalyzer.window(fromName: options["windowFunction"] as? String)
+    core.backend = RTAAnalyzer.backend(fromName: options["fftBackend"] as? String)
+    core.bandLayout = RTAAnalyzer.layout(fromName: options["bandLayout"] as? String)
+    core.format = RTASpectrogram.format(fromName: options["format"] as? String)
+    core.minDb = (options["minDb"] as? NSNumber)?.floatValue ?? core.minDb
+    core.maxDb = (options["maxDb"] as? NSNumber)?.floatValue ?? core.maxDb
+    core.threads = (options["threads"] as? NSNumber)?.intValue ?? 0
+
+    if core.fftSize < 2 || core.fftSize > Self.maxFftSize || core.fftSize % 2 != 0 {
+      let errorMsg = "fftSize must be an even number between 2 and \(Self.maxFftSize), got: \(core.fftSize)"
+      logMethodResult("computeSpectrogram", success: false, error: errorMsg)
+      reject("E_INVALID_PARAMETER", errorMsg, nil)
+      return
+    }
+
+    let url = path.hasPrefix("file://") ? (URL(string: path) ?? URL(fileURLWithPath: path))
+                                        : URL(fileURLWithPath: path)
+    DispatchQueue.global(qos: .userInitiated).async {
+      do {
+        let file = try AVAudioFile(forReading: url, commonFormat: .pcmFormatFloat32, interleaved: true)
+        let format = file.processingFormat
+        guard file.length > 0, file.length <= AVAudioFramePosition(UInt32.max),
+              let buffer = AVAudioPCMBuffer(pcmFormat: format, frameCapacity: AVAudioFrameCount(file.length)) else {
+          throw NSError(domain: "RealtimeAudioAnalyzer", code: -1,
+                        userInfo: [NSLocalizedDescriptionKey: "Empty or oversized audio file: \(path)"])
+        }
+        try file.read(into: buffer)
+
+        // Interleaved: channel 0 holds every channel's samples
+        guard let samples = buffer.floatChannelData?[0],
+              let data = core.compute(withSamples: samples,
+                                      frameCount: Int(buffer.frameLength),
+                                      channels: Int(format.channelCount),
+                                      sampleRate: format.sampleRate) else {
+          let errorMsg = "Could not compute a spectrogram with fftSize \(core.fftSize)"
+          self.logMethodResult("computeSpectrogram", success: false, error: errorMsg)
+          reject("E_SPECTROGRAM_FAILED", errorMsg, nil)
+          return
+        }
+
+        self.logMethodResult("computeSpectrogram", success: true)
+        resolve([
+          "frames": core.frames,
+          "bins": core.bins,
+          "fftSize": core.fftSize,
+          "hopSize": core.hopSize,
+          "sampleRate": format.sampleRate,
+          "format": core.format == 1 ? "float16" : "uint8",
+          "minDb": Double(core.minDb),
+          "maxDb": Double(core.maxDb),
+          "data": data.base64EncodedString()
+        ])
+      } catch {
+        self.logMethodResult("computeSpectrogram", success: false, error: error.localizedDescription)
+        reject("E_FILE_READ_FAILED", "Could not read \(path): \(error.localizedDescription)", error)
+      }
+    }
+  }
+
+  // Per-stage timings of the current (or last) session. The tap has no
+  // blocking read, so that stage stays empty on iOS; queue is the wait
+  // between the tap and the delivery thread.
+  @objc(getPerformanceStats:withRejecter:)
+  func getPerformanceStats(resolve: @escaping RCTPromiseResolveBlock,
+                           reject: @escaping RCTPromiseRejectBlock) {
+    logMethodCall("getPerformanceStats")
+    logMethodResult("getPerformanceStats", success: true)
+    resolve(perfStats.snapshot())
+  }
+
   @objc(stopAnalysis:withRejecter:)
   func stopAnalysis(resolve: @escaping RCTPromiseResolveBlock,
                     reject: @escaping RCTPromiseRejectBlock) {
@@ -392,15 +726,15 @@ class RealtimeAudioAnalyzer: RCTEventEmitter {
       // Deactivate audio session
       try AVAudioSession.sharedInstance().setActive(false, options: .notifyOthersOnDeactivation)
       
-      // Clean up FFT resources
-      cleanupFft()
+      // Release the analysis core
+      releaseAnalyzer()
       running = false
       
       logMethodResult("stopAnalysis", success: true)
       resolve(nil)
     } catch {
       // Even if session deactivation fails, we should still clean up and mark as stopped
-      cleanupFft()
+      releaseAnalyzer()
       running = false
       
       let (errorCode, errorMessage) = handleAudioEngineError(error, operation: "stop analysis")
@@ -437,6 +771,7 @@ class RealtimeAudioAnalyzer: RCTEventEmitter {
     let factorFloat = factor.floatValue
     smoothingEnabled = enabled
     smoothingFactor = factorFloat
+    publishLiveConfig()
     
     logMethodResult("setSmoothing", success: true)
     resolve(nil)
@@ -462,14 +797,85 @@ class RealtimeAudioAnalyzer: RCTEventEmitter {
     let fftSizeInt = fftSize.intValue
     let downsampleBinsInt = downsampleBins.intValue
     
-    // Store only (dynamic resize in-flight is risky). Recommend restart to apply.
+    // Applied live: the new plan is built here, off the audio thread, and
+    // the tap swaps it in once it sees the new analysis size
+    if running, let core = analyzer {
+      let n = analysisSize(forFftSize: fftSizeInt)
+      if n != analysisFftSize && !core.preparePlan(withFftSize: n) {
+        os_log("Warning: could not prepare an FFT plan for size %d", log: Self.logger, type: .default, n)
+      }
+      analysisFftSize = n
+    }
+    if running {
+      subscriberGraph.setFftSize(analysisFftSize, sampleRate: inputSampleRate)
+    }
     self.fftSize = fftSizeInt
     self.downsampleBins = downsampleBinsInt
+    publishLiveConfig()
     
     logMethodResult("setFftConfig", success: true)
     resolve(nil)
   }
 
+  // MARK: - Subscriptions
+
+  // Adds (or replaces) subscriber `id`, served from the session's one FFT
+  // with its own bands, rate and products; resolves false when the graph
+  // is full. Features and meters the session does not compute yet start
+  // with the next startAnalysis().
+  @objc(addAnalysisSubscriber:options:withResolver:withRejecter:)
+  func addAnalysisSubscriber(id: NSNumber,
+                             options: NSDictionary,
+                             resolve: @escaping RCTPromiseResolveBlock,
+                             reject: @escaping RCTPromiseRejectBlock) {
+    logMethodCall("addAnalysisSubscriber", parameters: options as? [String: Any])
+
+    let rateHz = (options["callbackRateHz"] as? NSNumber)?.doubleValue ?? 30
+    if rateHz < 1 || rateHz > 120 {
+      let errorMsg = "callbackRateHz must be between 1 and 120, got: \(rateHz)"
+      logMethodResult("addAnalysisSubscriber", success: false, error: errorMsg)
+      reject("E_INVALID_CONFIG", errorMsg, nil)
+      return
+    }
+    let names = (options["features"] as? [String] ?? []).filter { Self.featureNames.contains($0) }
+    let meters = (options["meters"] as? NSNumber)?.boolValue ?? false
+    let subscriberId = id.intValue
+
+    // Published before the tap can queue frames for it
+    subscriptionsLock.lock()
+    let previous = subscriptions[subscriberId]
+    subscriptions[subscriberId] = (names, meters)
+    subscriptionsLock.unlock()
+    let added = subscriberGraph.setSubscriber(
+      subscriberId,
+      rateHz: Float(rateHz),
+      spectrum: (options["emitFft"] as? NSNumber)?.boolValue ?? true,
+      layout: RTAAnalyzer.layout(fromName: options["bandLayout"] as? String),
+      bands: (options["downsampleBins"] as? NSNumber)?.intValue ?? 0,
+      features: RTAAnalyzer.featureMask(fromNames: names),
+      meters: meters)
+    if !added {
+      subscriptionsLock.lock()
+      subscriptions[subscriberId] = previous
+      subscriptionsLock.unlock()
+    }
+
+    logMethodResult("addAnalysisSubscriber", success: added)
+    resolve(added)
+  }
+
+  @objc(removeAnalysisSubscriber:withResolver:withRejecter:)
+  func removeAnalysisSubscriber(id: NSNumber,
+                                resolve: @escaping RCTPromiseResolveBlock,
+                                reject: @escaping RCTPromiseRejectBlock) {
+    logMethodCall("removeAnalysisSubscriber", parameters: ["id": id])
+    let removed = subscriberGraph.removeSubscriber(id.intValue)
+    subscriptionsLock.lock()
+    subscriptions[id.intValue] = nil
+    subscriptionsLock.unlock()
+    resolve(removed)
+  }
+
   // MARK: - Legacy Method Aliases (for backward compatibility)
 
   @objc(start:withResolver:withRejecter:)
@@ -503,14 +909,22 @@ class RealtimeAudioAnalyzer: RCTEventEmitter {
       "fftSize": fftSize,
       "sampleRate": targetSampleRate,
       "smoothing": smoothingEnabled ? Double(smoothingFactor) : 0.0,
-      "windowFunction": "hanning", // Default window function
+      "windowFunction": windowFunction,
       // Additional configuration state for completeness
       "bufferSize": Int(bufferSize),
+      "hopSize": hopSize,
       "callbackRateHz": callbackRateHz,
       "emitFft": emitFft,
       "smoothingEnabled": smoothingEnabled,
       "smoothingFactor": Double(smoothingFactor),
-      "downsampleBins": downsampleBins
+      "downsampleBins": downsampleBins,
+      "bandLayout": bandLayout,
+      "fftBackend": fftBackend,
+      "features": features,
+      "channelMode": channelMode,
+      "meters": metersEnabled,
+      "voiceActivity": voiceActivityEnabled,
+      "spectrumFormat": spectrumFormat
     ]
     
     logMethodResult("getAnalysisConfig", success: true)
@@ -524,10 +938,12 @@ class RealtimeAudioAnalyzer: RCTEventEmitter {
     do {
       let session = AVAudioSession.sharedInstance()
       
-      // Configure audio session with detailed error handling
+      // Configure audio session with detailed error handling. Voice
+      // processing is mono, so the stereo modes use the default mode.
+      let stereo = channelMode != "mono"
       do {
         try session.setCategory(.playAndRecord,
-                                mode: .voiceChat,
+                                mode: stereo ? .default : .voiceChat,
                                 options: [.defaultToSpeaker, .allowBluetoothHFP])
       } catch {
         let (errorCode, errorMessage) = handleAudioEngineError(error, operation: "set audio session category")
@@ -560,6 +976,15 @@ class RealtimeAudioAnalyzer: RCTEventEmitter {
         return
       }
 
+      if stereo && session.maximumInputNumberOfChannels >= 2 {
+        do {
+          try session.setPreferredInputNumberOfChannels(2)
+        } catch {
+          // Mono inputs are analyzed as identical left and right channels
+          os_log("Warning: Could not request a stereo input: %{public}@", log: Self.logger, type: .default, error.localizedDescription)
+        }
+      }
+
       let engine = AVAudioEngine()
       audioEngine = engine
 
@@ -581,7 +1006,14 @@ class RealtimeAudioAnalyzer: RCTEventEmitter {
         return
       }
 
-      setupFftIfNeeded()
+      perfStats.reset(withTracing: traceStages)
+      inputChannelCount = Int(hardwareFormat.channelCount)
+      if !setupAnalyzer(sampleRate: hardwareFormat.sampleRate) {
+        let errorMsg = "Failed to create the FFT plan"
+        logMethodResult("startEngine", success: false, error: errorMsg)
+        reject("E_FFT_SETUP_FAILED", errorMsg, nil)
+        return
+      }
 
       do {
         inputNode.installTap(onBus: bus, bufferSize: bufferSize, format: hardwareFormat) { [weak self] buffer, time in
@@ -613,37 +1045,159 @@ class RealtimeAudioAnalyzer: RCTEventEmitter {
     }
   }
 
-  private func setupFftIfNeeded() {
-    cleanupFft()
+  private func setupAnalyzer(sampleRate: Double) -> Bool {
+    releaseAnalyzer()
 
-    // Use power-of-2 based on bufferSize or fftSize (prefer fftSize if set)
-    let desired = max(256, emitFft ? fftSize : Int(bufferSize))
-    let n = nextPowerOfTwo(desired)
-    logN = vDSP_Length(round(log2(Double(n))))
+    let n = analysisSize(forFftSize: fftSize)
 
-    do {
-      fftSetup = vDSP_DFT_zop_CreateSetup(nil, vDSP_Length(n), vDSP_DFT_Direction.FORWARD)
-      
-      if fftSetup == nil {
-        os_log("Error: Failed to create FFT setup for size %d", log: Self.logger, type: .error, n)
-        return
+    guard let core = RTAAnalyzer(fftSize: n,
+                                 backend: RTAAnalyzer.backend(fromName: fftBackend),
+                                 window: RTAAnalyzer.window(fromName: windowFunction),
+                                 channelMode: RTAAnalyzer.channelMode(fromName: channelMode)) else {
+      os_log("Error: Failed to create FFT setup for size %d", log: Self.logger, type: .error, n)
+      return false
+    }
+    core.hopSize = hopSize
+    let subscribed = subscriberGraph.featureMask
+    sessionFeatures = Self.featureNames.enumerated().filter {
+      features.contains($0.element) || subscribed & (UInt(1) << UInt($0.offset)) != 0
+    }.map { $0.element }
+    sessionMeters = metersEnabled || subscriberGraph.wantsMeters
+    core.setFeatures(RTAAnalyzer.featureMask(fromNames: sessionFeatures), sampleRate: sampleRate)
+    // Subscribers that want meters get the default ballistics
+    core.setMetersEnabled(sessionMeters, windowMs: meterWindowMs, attackMs: meterAttackMs,
+                          releaseMs: meterReleaseMs, holdMs: peakHoldMs, sampleRate: sampleRate)
+    core.setVoiceActivityEnabled(voiceActivityEnabled, thresholdDb: vadThresholdDb,
+                                 hysteresisDb: vadHysteresisDb, noiseMarginDb: vadNoiseMarginDb,
+                                 attackMs: vadAttackMs, releaseMs: vadReleaseMs, sampleRate: sampleRate)
+    core.attach(perfStats)
+    analyzer = core
+    analysisFftSize = n
+    publishLiveConfig()
+    tapConfig = liveConfig
+    subscriberGraph.setFftSize(n, sampleRate: sampleRate)
+
+    // Sized for the largest FFT so live size changes never allocate in the tap
+    magnitudes = [Float](repeating: 0, count: Self.maxFftSize / 2)
+    lastBins = 0
+    lastFrameFftSize = n
+    // Third-octave layouts can exceed downsampleBins, so size for either
+    bandOutput = [Float](repeating: 0, count: max(Self.maxFftSize / 2, downsampleBins))
+    inputSampleRate = sampleRate
+    nextCallbackTime = 0
+    epochOffset = Date().timeIntervalSince1970 - AVAudioTime.seconds(forHostTime: mach_absolute_time())
+    let streams = channelMode == "mono" ? 1 : 3
+    spectrumEncoders = (0..<streams).compactMap { _ in
+      RTASpectrumEncoder(format: RTASpectrumEncoder.format(fromName: spectrumFormat),
+                         minDb: spectrumMinDb, maxDb: spectrumMaxDb, delta: spectrumDelta,
+                         keyframeInterval: keyframeInterval, capacity: bandOutput.count)
+    }
+
+    // Slots hold the bins, then both channels' bands in the stereo modes
+    let capacity = bandOutput.count * (channelMode == "mono" ? 1 : 3)
+    guard let queue = RTAFrameQueue(slots: UInt(Self.frameQueueSlots), capacity: UInt(capacity),
+                                    perfStats: perfStats) else {
+      os_log("Error: Failed to allocate the frame queue", log: Self.logger, type: .error)
+      releaseAnalyzer()
+      return false
+    }
+    frameQueue = queue
+    deliveryFrame = [Float](repeating: 0, count: capacity)
+    startDelivery(queue)
+
+    os_log("FFT setup completed successfully for size %d (%{public}@)", log: Self.logger, type: .info, n, core.backendName)
+    return true
+  }
+
+  // Only the `names` features, keyed by their JS names
+  private func featurePayload(_ f: RTASpectralFeatures, names: [String]) -> [String: Any] {
+    var out: [String: Any] = [:]
+    for name in names {
+      switch name {
+      case "centroid": out[name] = f.centroid
+      case "flux": out[name] = f.flux
+      case "rolloff": out[name] = f.rolloff
+      case "flatness": out[name] = f.flatness
+      case "onset": out[name] = f.onset
+      case "pitch":
+        out[name] = f.pitch
+        out["pitchConfidence"] = f.pitchConfidence
+      default: break
       }
+    }
+    return out
+  }
 
-      window = [Float](repeating: 0, count: n)
-      vDSP_hann_window(&window, vDSP_Length(n), Int32(vDSP_HANN_NORM))
+  private func meterPayload(_ m: RTAMeterLevels) -> [String: Any] {
+    return [
+      "rms": m.rms,
+      "peak": m.peak,
+      "peakHold": m.peakHold,
+      "momentaryLufs": m.momentaryLufs,
+      "shortTermLufs": m.shortTermLufs
+    ]
+  }
 
-      windowedInput = [Float](repeating: 0, count: n)
-      fftReal = [Float](repeating: 0, count: n)
-      fftImag = [Float](repeating: 0, count: n)
-      zerosImag = [Float](repeating: 0, count: n)
-      magnitudes = [Float](repeating: 0, count: n / 2)
-      
-      os_log("FFT setup completed successfully for size %d", log: Self.logger, type: .info, n)
-    } catch {
-      os_log("Error setting up FFT: %{public}@", log: Self.logger, type: .error, error.localizedDescription)
+  // {active, levelDb, noiseFloorDb}, also the body of onVoiceActivity events
+  private func voiceActivityPayload(_ voice: RTAVoiceActivity) -> [String: Any] {
+    return [
+      "active": voice.active,
+      "levelDb": voice.levelDb,
+      "noiseFloorDb": voice.noiseFloorDb
+    ]
+  }
+
+  // Sent on every gate transition, also with shared frames
+  private func sendVoiceActivity(_ voice: RTAVoiceActivity, timestampMs: Double) {
+    guard bridge != nil else { return }
+    var body = voiceActivityPayload(voice)
+    body["timestamp"] = timestampMs
+    sendEvent(withName: "RealtimeAudioAnalyzer:onVoiceActivity", body: body)
+  }
+
+  // Levels and band-mapped spectra of both channels of a popped frame; the
+  // spectra follow its `bins` in deliveryFrame
+  private func channelPayload(_ info: RTAFrameInfo, bins: Int) -> [[String: Any]] {
+    let perChannel = info.channelBins
+    let levels = [(info.channelRms.0, info.channelPeak.0), (info.channelRms.1, info.channelPeak.1)]
+    return (0..<2).map { c -> [String: Any] in
+      let start = bins + c * perChannel
+      var channel: [String: Any] = ["volume": levels[c].0, "peak": levels[c].1]
+      if spectrumEncoders.count > c + 1 {
+        channel["frequencyData"] = []
+        if perChannel > 0 {
+          channel["spectrum"] = deliveryFrame.withUnsafeBufferPointer { values in
+            spectrumPayload(spectrumEncoders[c + 1], values.baseAddress! + start, count: perChannel)
+          }
+        }
+      } else {
+        channel["frequencyData"] = perChannel == 0 ? [] : Array(deliveryFrame[start..<start + perChannel])
+      }
+      return channel
     }
   }
 
+  // {format, bins, minDb, maxDb, data} of one encoded frame, for
+  // SpectrumDecoder in JS; nil for an empty frame
+  private func spectrumPayload(_ encoder: RTASpectrumEncoder, _ values: UnsafePointer<Float>,
+                               count: Int) -> [String: Any]? {
+    guard let data = encoder.encodeBase64(values, count: count) else { return nil }
+    return [
+      "format": spectrumFormat,
+      "bins": count,
+      "minDb": spectrumMinDb,
+      "maxDb": spectrumMaxDb,
+      "data": data
+    ]
+  }
+
+  // Power-of-2 transform size for the configured fftSize (or bufferSize
+  // when neither the spectrum nor features are computed)
+  private func analysisSize(forFftSize size: Int) -> Int {
+    let spectral = emitFft || !features.isEmpty || subscriberGraph.wantsSpectrum
+    return min(Self.maxFftSize, nextPowerOfTwo(max(256, spectral ? size : Int(bufferSize))))
+  }
+
   private func nextPowerOfTwo(_ x: Int) -> Int {
     var v = 1
     while v < x { v <<= 1 }
@@ -672,134 +1226,313 @@ class RealtimeAudioAnalyzer: RCTEventEmitter {
       return
     }
 
-    // Rate-limit callback emissions
-    let now = Date().timeIntervalSince1970
-    if callbackRateHz > 0, now - lastCallbackTime < (1.0 / callbackRateHz) {
-      return
+    guard let core = analyzer else { return }
+    let tapStartNs = DispatchTime.now().uptimeNanoseconds
+    applyLiveConfig(core, sampleRate: buffer.format.sampleRate)
+
+    // Rate-limit callback emissions. The analysis core ingests every buffer
+    // (history, RMS/peak, smoothing) like Android; the FFT and the band
+    // mapping only run for frames that are actually emitted. Advancing by
+    // whole intervals keeps the average rate at callbackRateHz even though
+    // buffers only arrive on tap boundaries. A closed voice gate drops the
+    // rate to vadSilentRateHz (none at 0). The schedule runs on the
+    // buffer's host time, which costs no system call on the render thread.
+    let now = AVAudioTime.seconds(forHostTime: time.isHostTimeValid ? time.hostTime : mach_absolute_time())
+    let gated = core.gated
+    let scheduled = gated && vadSilentRateHz == 0 ? false : now >= nextCallbackTime
+    // Subscribers run on their own schedules, off the same transform
+    let nowNs = Int64(now * 1e9)
+    let wanted = subscriberGraph.poll(nowNs)
+    var due = scheduled
+    // A tap that takes longer than the audio it carries is an overrun: the
+    // render thread has to drop buffers to keep up
+    let bufferNs = UInt64(Double(frameCount) / buffer.format.sampleRate * 1e9)
+    defer {
+      perfStats.countRead(due)
+      if DispatchTime.now().uptimeNanoseconds - tapStartNs > bufferNs {
+        perfStats.countOverruns(1)
+      }
     }
-    lastCallbackTime = now
-
-    // Downmix to mono without allocating big arrays
-    // (We will reuse windowedInput as our mono scratch buffer for first `frameCount` samples)
-    let monoCount = min(frameCount, windowedInput.count)
-    if channelCount == 1 {
-      // copy
-      let src = channelData[0]
-      for i in 0..<monoCount { windowedInput[i] = src[i] }
-    } else {
-      let l = channelData[0]
-      let r = channelData[1]
-      for i in 0..<monoCount { windowedInput[i] = (l[i] + r[i]) * 0.5 }
+    // Features need the magnitudes even when the spectrum is not shipped.
+    // While gated they are requested on every buffer: the core skips the
+    // transform until the gate opens, then takes that frame at once.
+    let withFft = ((scheduled || gated) && (emitFft || !features.isEmpty)) ||
+      wanted.contains(.spectral)
+
+    let n = tapConfig.fftSize
+    if n != lastFrameFftSize {
+      // Native history restarts; don't re-send the old frame
+      lastBins = 0
+      lastFrameFftSize = n
     }
 
-    // RMS + Peak
+    // The core reads the tap's channels directly: stereo input is split
+    // (or, in mono mode, downmixed) natively in one vectorized pass; a mono
+    // input feeds both channels of the stereo modes
     var rms: Float = 0
     var peak: Float = 0
-    windowedInput.withUnsafeBufferPointer { ptr in
-      vDSP_rmsqv(ptr.baseAddress!, 1, &rms, vDSP_Length(monoCount))
-      vDSP_maxmgv(ptr.baseAddress!, 1, &peak, vDSP_Length(monoCount))
+    let left = channelData[0]
+    let right = channelData[min(1, channelCount - 1)]
+    let bins = magnitudes.withUnsafeMutableBufferPointer { mags -> Int in
+      let out = withFft ? mags.baseAddress : nil
+      if channelCount == 1 && channelMode == "mono" {
+        return core.processSamples(left, count: frameCount, fftSize: n,
+                                   magnitudes: out, capacity: mags.count, rms: &rms, peak: &peak)
+      }
+      return core.processLeft(left, right: right, count: frameCount, fftSize: n,
+                              magnitudes: out, capacity: mags.count, rms: &rms, peak: &peak)
+    }
+    // Between hops the most recent STFT frame is re-sent
+    if bins > 0 { lastBins = bins }
+
+    // Transitions go out at once, whatever the schedule; there is no
+    // spectrum to ship while gated
+    let voiceChanged = voiceActivityEnabled && core.voiceActivity.changed
+    due = scheduled || voiceChanged
+    if wanted.contains(.due), let queue = frameQueue {
+      let spectral = wanted.contains(.spectral) && !core.gated
+      magnitudes.withUnsafeBufferPointer { mags in
+        _ = subscriberGraph.publishMagnitudes(spectral ? mags.baseAddress : nil,
+                                              count: spectral ? lastBins : 0,
+                                              analyzer: core, queue: queue, rms: rms, peak: peak,
+                                              timestampMs: (now + epochOffset) * 1000,
+                                              bufferSize: frameCount, nowNs: nowNs)
+      }
+      deliverySignal.signal()
+    }
+    guard due, let queue = frameQueue else { return }
+    let shipFft = withFft && emitFft && !core.gated && lastBins > 0
+    let rate = core.gated ? vadSilentRateHz : callbackRateHz
+    let interval = rate > 0 ? 1.0 / rate : 0
+    nextCallbackTime += interval
+    if voiceChanged || nextCallbackTime <= now {
+      // A transition, or fell behind (first buffer or a stall): resync
+      nextCallbackTime = now + interval
+    }
+    let timestampMs = (now + epochOffset) * 1000
+
+    // Shared frames replace the event payload entirely; only gate
+    // transitions still go through the queue, for onVoiceActivity
+    if sharedFrames, let store = frameStore {
+      let publishStart = perfStats.beginStage(.publish)
+      var frameBins = 0
+      if shipFft {
+        frameBins = magnitudes.withUnsafeBufferPointer { mags in
+          bandOutput.withUnsafeMutableBufferPointer { out in
+            core.mapBands(mags.baseAddress!, bins: lastBins, output: out.baseAddress!, capacity: out.count)
+          }
+        }
+      }
+      bandOutput.withUnsafeBufferPointer { values in
+        if frameBins > 0, let history = spectrogramHistory {
+          history.pushBins(values.baseAddress!, count: frameBins, timestampMs: timestampMs)
+        }
+        store.publishBins(values.baseAddress, count: frameBins, rms: rms, peak: peak, timestampMs: timestampMs)
+      }
+      perfStats.endStage(.publish, start: publishStart)
+      if voiceChanged {
+        queue.pushMagnitudes(nil, count: 0, analyzer: core, history: nil, rms: rms, peak: peak,
+                             timestampMs: timestampMs, bufferSize: frameCount)
+        deliverySignal.signal()
+      }
+      return
     }
 
-    // Smoothing
-    if smoothingEnabled {
-      smoothRms = smoothRms + (rms - smoothRms) * smoothingFactor
-      smoothPeak = smoothPeak + (peak - smoothPeak) * smoothingFactor
-      rms = smoothRms
-      peak = smoothPeak
-    } else {
-      smoothRms = rms
-      smoothPeak = peak
+    // Band-maps the frame straight into a queue slot (and the history);
+    // the delivery thread takes it from there
+    magnitudes.withUnsafeBufferPointer { mags in
+      queue.pushMagnitudes(shipFft ? mags.baseAddress : nil, count: shipFft ? lastBins : 0,
+                           analyzer: core, history: spectrogramHistory, rms: rms, peak: peak,
+                           timestampMs: timestampMs, bufferSize: frameCount)
     }
+    deliverySignal.signal()
+  }
 
-    // FFT
-    var fftData: [Float] = []
-    if emitFft, let setup = fftSetup {
-      let n = window.count
-      let count = min(monoCount, n)
+  // Control threads: snapshots the live settings for the tap
+  private func publishLiveConfig() {
+    let config = LiveConfig(smoothingEnabled: smoothingEnabled, smoothingFactor: smoothingFactor,
+                            bandLayout: RTAAnalyzer.layout(fromName: bandLayout),
+                            bands: downsampleBins, fftSize: analysisFftSize)
+    liveConfigLock.lock()
+    liveConfig = config
+    liveConfigLock.unlock()
+  }
 
-      // Apply window + zero pad (reusing windowedInput)
-      for i in 0..<count {
-        windowedInput[i] = windowedInput[i] * window[i]
-      }
-      if count < n {
-        for i in count..<n { windowedInput[i] = 0 }
+  // Hands smoothing and band settings changed by setSmoothing/setFftConfig
+  // to the analyzer from the tap thread, which owns it.
+  private func applyLiveConfig(_ core: RTAAnalyzer, sampleRate: Double) {
+    if liveConfigLock.try() {
+      tapConfig = liveConfig
+      liveConfigLock.unlock()
+    }
+    let live = tapConfig
+    guard live != appliedConfig else { return }
+    if appliedConfig?.smoothingEnabled != live.smoothingEnabled ||
+        appliedConfig?.smoothingFactor != live.smoothingFactor {
+      core.setSmoothingEnabled(live.smoothingEnabled, factor: live.smoothingFactor)
+    }
+    if appliedConfig?.bandLayout != live.bandLayout || appliedConfig?.bands != live.bands {
+      core.setBandLayout(live.bandLayout, bands: live.bands, sampleRate: sampleRate)
+      if bandOutput.count < live.bands {
+        bandOutput = [Float](repeating: 0, count: live.bands)
       }
+    }
+    appliedConfig = live
+  }
 
-      // Execute FFT (real input + zero imag)
-      vDSP_DFT_Execute(setup, windowedInput, zerosImag, &fftReal, &fftImag)
+  // MARK: - Delivery
 
-      // Magnitudes (n/2)
-      magnitudes.withUnsafeMutableBufferPointer { magPtr in
-        fftReal.withUnsafeMutableBufferPointer { realPtr in
-          fftImag.withUnsafeMutableBufferPointer { imagPtr in
-            var split = DSPSplitComplex(realp: realPtr.baseAddress!, imagp: imagPtr.baseAddress!)
-            vDSP_zvabs(&split, 1, magPtr.baseAddress!, 1, vDSP_Length(n / 2))
-          }
-        }
+  private func startDelivery(_ queue: RTAFrameQueue) {
+    let signal = DispatchSemaphore(value: 0)
+    let done = DispatchSemaphore(value: 0)
+    let thread = Thread { [weak self] in
+      while !Thread.current.isCancelled {
+        _ = signal.wait(timeout: .now() + .milliseconds(Self.deliveryIdleMs))
+        self?.deliverFrames(queue)
       }
+      done.signal()
+    }
+    thread.name = "RealtimeAudioDelivery"
+    thread.qualityOfService = .userInteractive
+    deliverySignal = signal
+    deliveryDone = done
+    deliveryThread = thread
+    thread.start()
+  }
 
-      // Normalize
-      var scale = (2.0 / Float(n))
-      vDSP_vsmul(magnitudes, 1, &scale, &magnitudes, 1, vDSP_Length(n / 2))
+  // Call once the tap is removed; frames still queued are dropped
+  private func stopDelivery() {
+    guard let thread = deliveryThread else { return }
+    thread.cancel()
+    deliverySignal.signal()
+    if deliveryDone.wait(timeout: .now() + 1) == .timedOut {
+      os_log("Warning: delivery thread did not stop in time", log: Self.logger, type: .default)
+    }
+    deliveryThread = nil
+  }
 
-      // Downsample
-      if downsampleBins > 0, downsampleBins < (n / 2) {
-        fftData = resample(magnitudes, targetCount: downsampleBins)
-      } else {
-        fftData = magnitudes
+  // Drains the queue on the delivery thread
+  private func deliverFrames(_ queue: RTAFrameQueue) {
+    var info = RTAFrameInfo()
+    while true {
+      let bins = deliveryFrame.withUnsafeMutableBufferPointer { out in
+        queue.popFrame(out.baseAddress!, capacity: out.count, info: &info)
       }
+      guard bins >= 0 else { return }
+      if info.subscriber >= 0 {
+        sendSubscriberFrame(info, bins: bins, dropped: queue.dropped)
+        continue
+      }
+      if voiceActivityEnabled && info.voice.changed {
+        sendVoiceActivity(info.voice, timestampMs: info.timestampMs)
+      }
+      // Shared frames were published by the tap
+      if !sharedFrames {
+        sendFrame(info, bins: bins, dropped: queue.dropped)
+      }
+    }
+  }
+
+  // Float spectra in the subscriber's bands, levels and its features and
+  // meters; frames for a subscriber removed since they were queued are
+  // dropped
+  private func sendSubscriberFrame(_ info: RTAFrameInfo, bins frameBins: Int, dropped: UInt) {
+    subscriptionsLock.lock()
+    let subscription = subscriptions[info.subscriber]
+    subscriptionsLock.unlock()
+    guard let subscription = subscription, bridge != nil else { return }
+    let deliverStart = perfStats.beginStage(.deliver)
+
+    var payload: [String: Any] = [
+      "subscriberId": info.subscriber,
+      "timestamp": info.timestampMs,
+      "volume": info.rms,
+      "peak": info.peak,
+      "frequencyData": Array(deliveryFrame.prefix(frameBins)),
+      "sampleRate": inputSampleRate,
+      "bufferSize": info.bufferSize,
+      "fftSize": info.fftSize,
+      "droppedFrames": dropped
+    ]
+    let names = subscription.features.filter { sessionFeatures.contains($0) }
+    if !names.isEmpty {
+      payload["features"] = featurePayload(info.features, names: names)
+    }
+    if subscription.meters && sessionMeters {
+      payload["meters"] = meterPayload(info.meters)
+    }
+    sendEvent(withName: "RealtimeAudioAnalyzer:onSubscriberData", body: payload)
+    perfStats.endStage(.deliver, start: deliverStart)
+  }
+
+  private func sendFrame(_ info: RTAFrameInfo, bins frameBins: Int, dropped: UInt) {
+    let deliverStart = perfStats.beginStage(.deliver)
+
+    // Bridge the spectrum and the payload to Foundation once: the two event
+    // names and the notification then share one NSArray and one
+    // NSDictionary instead of each bridging the Swift values again. Compact
+    // spectra replace the array with one encoded string.
+    let encoded = !spectrumEncoders.isEmpty
+    let fftData: NSArray = frameBins == 0 || encoded ? [] : deliveryFrame.withUnsafeBufferPointer { values in
+      NSArray(array: values.prefix(frameBins).map { NSNumber(value: $0) })
     }
 
     // Emit
-    let payload: [String: Any] = [
-      "timestamp": now * 1000,
-      "rms": rms,
-      "peak": peak,
-      "volume": rms,
-      "fft": fftData,
+    var payload: [String: Any] = [
+      "timestamp": info.timestampMs,
+      "rms": info.rms,
+      "peak": info.peak,
+      "volume": info.rms,
       "frequencyData": fftData,
       "timeData": [],
-      "sampleRate": buffer.format.sampleRate,
-      "bufferSize": frameCount,
-      "channelCount": channelCount
+      "sampleRate": inputSampleRate,
+      "bufferSize": info.bufferSize,
+      "fftSize": info.fftSize,
+      "channelCount": inputChannelCount,
+      "droppedFrames": dropped
     ]
-    
+    if encoded {
+      if frameBins > 0 {
+        payload["spectrum"] = deliveryFrame.withUnsafeBufferPointer { values in
+          spectrumPayload(spectrumEncoders[0], values.baseAddress!, count: frameBins)
+        }
+      }
+    } else {
+      // Legacy alias of frequencyData
+      payload["fft"] = fftData
+    }
+    if !features.isEmpty {
+      payload["features"] = featurePayload(info.features, names: features)
+    }
+    if metersEnabled {
+      payload["meters"] = meterPayload(info.meters)
+    }
+    if voiceActivityEnabled {
+      payload["voiceActivity"] = voiceActivityPayload(info.voice)
+    }
+    if info.channels > 0 {
+      payload["channels"] = channelPayload(info, bins: frameBins)
+    }
+    let body = payload as NSDictionary
+
     // Send React Native events if bridge is available
     if bridge != nil {
-      sendEvent(withName: "RealtimeAudioAnalyzer:onData", body: payload)
-      sendEvent(withName: "AudioAnalysisData", body: payload)
+      sendEvent(withName: "RealtimeAudioAnalyzer:onData", body: body)
+      // Compact payloads drop the duplicate legacy event along with `fft`
+      if !encoded {
+        sendEvent(withName: "AudioAnalysisData", body: body)
+      }
     } else {
       os_log("Warning: Bridge not available, cannot send events to JavaScript", log: Self.logger, type: .default)
     }
-    
+
     // Also post to NotificationCenter for native iOS usage
     NotificationCenter.default.post(
-      name: NSNotification.Name("RealtimeAudioAnalyzer:onData"),
+      name: Self.dataNotification,
       object: self,
-      userInfo: payload
+      userInfo: body as? [AnyHashable: Any]
     )
-  }
-
-  private func resample(_ input: [Float], targetCount: Int) -> [Float] {
-    let sourceCount = input.count
-    if targetCount <= 0 || sourceCount == 0 { return [] }
-    if targetCount >= sourceCount { return input }
-
-    var result = [Float](repeating: 0, count: targetCount)
-    let ratio = Float(sourceCount) / Float(targetCount)
-
-    for i in 0..<targetCount {
-      let start = Int(Float(i) * ratio)
-      let end = min(Int(Float(i + 1) * ratio), sourceCount)
-      if start >= end {
-        result[i] = input[min(start, sourceCount - 1)]
-        continue
-      }
-      var sum: Float = 0
-      for j in start..<end { sum += input[j] }
-      result[i] = sum / Float(end - start)
-    }
-    return result
+    perfStats.endStage(.deliver, start: deliverStart)
   }
 }
 
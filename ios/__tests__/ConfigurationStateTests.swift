@@ -100,6 +100,12 @@ class ConfigurationStateTests: XCTestCase {
                     XCTAssertNotNil(configDict["sampleRate"])
                     XCTAssertNotNil(configDict["windowFunction"])
                     XCTAssertNotNil(configDict["bufferSize"])
+                    XCTAssertNotNil(configDict["hopSize"])
+                    XCTAssertNotNil(configDict["bandLayout"])
+                    XCTAssertNotNil(configDict["fftBackend"])
+                    XCTAssertNotNil(configDict["features"])
+                    XCTAssertNotNil(configDict["channelMode"])
+                    XCTAssertEqual(configDict["spectrumFormat"] as? String, "float")
                     XCTAssertNotNil(configDict["callbackRateHz"])
                     XCTAssertNotNil(configDict["emitFft"])
                     
@@ -186,8 +186,9 @@ class RealtimeAudioAnalyzerTests: XCTestCase {
         XCTAssertTrue(supportedEvents!.contains(legacyEventName), "Should support legacy event name: \(legacyEventName)")
         XCTAssertTrue(supportedEvents!.contains(newEventName), "Should support new event name: \(newEventName)")
         
-        // Verify both events are in the supported list
-        XCTAssertEqual(supportedEvents!.count, 2, "Should support exactly 2 event names")
+        // Verify both events are in the supported list, next to the voice
+        // activity and subscriber events
+        XCTAssertEqual(supportedEvents!.count, 4, "Should support exactly 4 event names")
     }
     
     // MARK: - Test JavaScript bridge methods (Task 5.3)
@@ -326,6 +327,41 @@ class RealtimeAudioAnalyzerTests: XCTestCase {
         wait(for: [expectation], timeout: 5.0)
     }
     
+    func testAnalysisSubscriberLifecycle() {
+        let expectation = XCTestExpectation(description: "Test subscriber add and remove")
+        let options: NSDictionary = ["callbackRateHz": 10, "downsampleBins": 32, "bandLayout": "log", "meters": true]
+
+        analyzer.addAnalysisSubscriber(id: NSNumber(value: 1), options: options, resolve: { result in
+            XCTAssertEqual(result as? Bool, true, "addAnalysisSubscriber should resolve true")
+            self.analyzer.removeAnalysisSubscriber(id: NSNumber(value: 1), resolve: { result in
+                XCTAssertEqual(result as? Bool, true, "removeAnalysisSubscriber should resolve true")
+                expectation.fulfill()
+            }, reject: { code, message, error in
+                XCTFail("removeAnalysisSubscriber should not reject. Code: \(code ?? "nil")")
+                expectation.fulfill()
+            })
+        }, reject: { code, message, error in
+            XCTFail("addAnalysisSubscriber should not reject. Code: \(code ?? "nil"), Message: \(message ?? "nil")")
+            expectation.fulfill()
+        })
+
+        wait(for: [expectation], timeout: 5.0)
+    }
+
+    func testAnalysisSubscriberRejectsInvalidRate() {
+        let expectation = XCTestExpectation(description: "Test subscriber rate validation")
+
+        analyzer.addAnalysisSubscriber(id: NSNumber(value: 2), options: ["callbackRateHz": 500], resolve: { _ in
+            XCTFail("addAnalysisSubscriber should reject callbackRateHz 500")
+            expectation.fulfill()
+        }, reject: { code, message, error in
+            XCTAssertEqual(code, "E_INVALID_CONFIG")
+            expectation.fulfill()
+        })
+
+        wait(for: [expectation], timeout: 5.0)
+    }
+
     func testLegacyMethodsStillWork() {
         let expectation = XCTestExpectation(description: "Test legacy start/stop methods")
         
@@ -511,9 +547,11 @@ class RealtimeAudioAnalyzerTests: XCTestCase {
         let supportedEvents = analyzer.supportedEvents()
         
         XCTAssertNotNil(supportedEvents, "supportedEvents should not return nil")
-        XCTAssertEqual(supportedEvents!.count, 2, "Should support exactly 2 event names")
+        XCTAssertEqual(supportedEvents!.count, 4, "Should support exactly 4 event names")
         XCTAssertTrue(supportedEvents!.contains("RealtimeAudioAnalyzer:onData"), "Should support legacy event name")
         XCTAssertTrue(supportedEvents!.contains("AudioAnalysisData"), "Should support new event name")
+        XCTAssertTrue(supportedEvents!.contains("RealtimeAudioAnalyzer:onVoiceActivity"), "Should support the voice activity event")
+        XCTAssertTrue(supportedEvents!.contains("RealtimeAudioAnalyzer:onSubscriberData"), "Should support the subscriber event")
     }
     
     func testMethodQueueConfiguration() {
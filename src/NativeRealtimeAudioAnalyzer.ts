@@ -4,8 +4,257 @@ import { TurboModuleRegistry } from 'react-native';
 export type AnalysisConfig = {
   fftSize?: number;
   sampleRate?: number;
-  windowFunction?: 'hanning' | 'hamming' | 'blackman' | 'rectangular';
+  // Analysis window (default: 'hanning'). Magnitudes are corrected for the
+  // window's coherent gain, so levels are comparable across windows.
+  windowFunction?:
+    | 'hanning'
+    | 'hamming'
+    | 'blackman'
+    | 'rectangular'
+    | 'blackmanharris'
+    | 'flattop';
   smoothing?: number;
+  // Samples per capture read; defaults to fftSize
+  bufferSize?: number;
+  // Samples between STFT frames; 0 (default) takes one frame per read
+  hopSize?: number;
+  // Events per second, 1-120 (default: 30). Level metrics and smoothing
+  // still run on every capture buffer; the FFT only runs for emitted frames.
+  callbackRateHz?: number;
+  // Include the spectrum in events (default: true)
+  emitFft?: boolean;
+  // Per-frame spectral scalars computed natively and sent as `features` in
+  // events (default: none). They run even with emitFft false, so a screen
+  // that only needs e.g. onsets can skip shipping spectra altogether. Not
+  // carried by the shared frame buffer. 'pitch' adds a fundamental-frequency
+  // estimate for two FFTs of twice fftSize per frame.
+  features?: Array<
+    'centroid' | 'flux' | 'rolloff' | 'flatness' | 'onset' | 'pitch'
+  >;
+  // Input channels (default: 'mono', which downmixes stereo inputs).
+  // 'stereo' adds left/right levels and spectra as `channels` in events and
+  // 'midside' adds mid (L + R) / 2 and side (L - R) / 2 instead; the
+  // top-level values stay those of the downmix. Not carried by the shared
+  // frame buffer.
+  channelMode?: 'mono' | 'stereo' | 'midside';
+  // Native meters over every captured sample, sent as `meters` in events
+  // (default: false): a sliding-window RMS with attack/release ballistics,
+  // a decaying peak, a peak hold and EBU R128 momentary / short-term
+  // loudness. Unlike volume / peak they do not depend on bufferSize or on
+  // `smoothing`. Not carried by the shared frame buffer.
+  meters?: boolean;
+  meterWindowMs?: number; // sliding RMS window (default: 300)
+  meterAttackMs?: number; // RMS rise time constant, 0 = instant (default: 10)
+  meterReleaseMs?: number; // RMS and peak fall time constant (default: 300)
+  peakHoldMs?: number; // peak hold window (default: 1500)
+  // Native voice activity gate (default: false). An energy gate with
+  // hysteresis: it opens once the level has stayed above
+  // max(vadThresholdDb, noise floor + vadNoiseMarginDb) for vadAttackMs and
+  // closes after vadReleaseMs below vadHysteresisDb under that. While it is
+  // closed the FFT and features are skipped and events drop to
+  // vadSilentRateHz; every transition forces an event, carries
+  // `voiceActivity` and also fires onVoiceActivity (with frameDelivery
+  // 'jsi' too).
+  voiceActivity?: boolean;
+  vadThresholdDb?: number; // dBFS RMS, lowest opening level (default: -50)
+  vadHysteresisDb?: number; // closing level below the opening one (default: 6)
+  // Opening level above the tracked noise floor, 0 = fixed threshold only
+  // (default: 10)
+  vadNoiseMarginDb?: number;
+  vadAttackMs?: number; // time above the opening level to open (default: 30)
+  vadReleaseMs?: number; // time below the closing level to close (default: 500)
+  // Event rate while closed, up to callbackRateHz; 0 = transitions only
+  // (default: 0)
+  vadSilentRateHz?: number;
+  // Compact spectra (default: 'float', plain number arrays). 'uint8' /
+  // 'uint16' quantize each band to a dB code over [spectrumMinDb,
+  // spectrumMaxDb] and send it base64-encoded as `spectrum` in events (and
+  // in each of `channels`), leaving frequencyData empty; decode it with
+  // SpectrumDecoder. On iOS this mode also drops the duplicate 'fft' field
+  // and 'AudioAnalysisData' event.
+  spectrumFormat?: 'float' | 'uint8' | 'uint16';
+  spectrumMinDb?: number; // code 0, and everything below (default: -100)
+  spectrumMaxDb?: number; // highest code (default: 0)
+  // Send frames as differences to the previous one, which mostly repeat
+  // (default: false)
+  spectrumDelta?: boolean;
+  // With spectrumDelta: a full frame at least every this many frames, so
+  // late listeners can start decoding; 0 = only when needed (default: 30)
+  keyframeInterval?: number;
+  // Number of output bands (-1 = raw FFT bins); also set by setFftConfig()
+  downsampleBins?: number;
+  // How bins are grouped into downsampleBins bands (default: 'linear').
+  // 'octave' uses 1/3-octave bands from 20 Hz up, ignoring downsampleBins.
+  bandLayout?: 'linear' | 'log' | 'mel' | 'octave';
+  // FFT implementation of the shared native core (default: 'auto', which
+  // picks 'accelerate' on iOS and 'realfft' on Android for power-of-two
+  // sizes). 'accelerate' is Apple-only and falls back to 'auto' elsewhere.
+  // 'kissfft-q15' / 'kissfft-q31' analyze 16-bit PCM in fixed point, for
+  // devices without a fast FPU (Q15 trades precision for speed).
+  fftBackend?:
+    | 'auto'
+    | 'kissfft'
+    | 'realfft'
+    | 'accelerate'
+    | 'kissfft-q15'
+    | 'kissfft-q31';
+  // 'jsi' publishes frames to a shared ArrayBuffer (see frameBuffer.ts)
+  // instead of emitting onData events (default: 'events')
+  frameDelivery?: 'events' | 'jsi';
+  // Android capture path: 'aaudio' captures and analyzes in a native
+  // low-latency AAudio callback, falling back to AudioRecord below API 26
+  // (default: 'audiorecord')
+  captureBackend?: 'audiorecord' | 'aaudio';
+  // Android: core class the capture thread (or AAudio callback thread) is
+  // pinned to. 'little' is the slowest cluster, 'big' every core outside
+  // it; 'any' lets the scheduler move it. Either way it runs with
+  // audio-class priority (default: 'any').
+  cpuAffinity?: 'any' | 'little' | 'big';
+  // Wrap each pipeline stage in a systrace section (Android, "rta:*" in
+  // Perfetto) or os_signpost interval (iOS, Points of Interest in
+  // Instruments). Stage timings for getPerformanceStats() are collected
+  // either way (default: false).
+  traceStages?: boolean;
+};
+
+// Durations of one pipeline stage over the session, in microseconds.
+// Percentiles are interpolated from the histogram, so they are estimates.
+export type StageTiming = {
+  count: number;
+  meanUs: number;
+  p50Us: number;
+  p95Us: number;
+  p99Us: number;
+  maxUs: number;
+  // histogram[i] counts durations in [2^i, 2^(i+1)) us; [0] starts at 0
+  // and the last of the 16 buckets is open-ended
+  histogram: number[];
+};
+
+// Core cluster, by maximum frequency: 'big' is the fastest (or the only)
+// one, 'unknown' a core without cpufreq data
+export type CoreClass = 'unknown' | 'little' | 'mid' | 'big';
+
+// Scheduling and placement of the Android capture thread
+export type CaptureThreadStats = {
+  realtime: boolean; // SCHED_FIFO, as AAudio usually grants
+  nice: number; // -19 for THREAD_PRIORITY_URGENT_AUDIO
+  pinned: boolean; // restricted to cpuAffinity
+  cpu: number; // core of the latest read
+  coreClass: CoreClass; // class of that core
+  migrations: number; // reads that ran on another core than the read before
+  coreReads: { [C in CoreClass]: number }; // reads per core class
+};
+
+// Pipeline counters since startAnalysis(), kept after stopAnalysis().
+// Follow a frame: read -> analyze (fft, features inside it) -> publish ->
+// queue (Android) -> deliver; whatever the JS side sees beyond that is JS
+// thread latency (Date.now() - event.timestamp). Stages a platform does not
+// have report count 0.
+export type PerformanceStats = {
+  elapsedMs: number;
+  // Capture reads (buffers, AAudio blocks) analyzed
+  reads: number;
+  // Reads analyzed but not emitted because of callbackRateHz
+  rateLimitedFrames: number;
+  // AAudio xruns, otherwise reads that took longer to process than the
+  // audio they carried
+  readOverruns: number;
+  // Capture -> delivery queue (Android): depth at the last push, its
+  // maximum and the frames dropped because the consumer fell behind
+  queueDepth: number;
+  maxQueueDepth: number;
+  queueDroppedFrames: number;
+  stages: {
+    read: StageTiming; // blocking in AudioRecord.read
+    analyze: StageTiming; // conversion, levels and any frame
+    fft: StageTiming; // window, transform, magnitudes
+    features: StageTiming; // spectral features and pitch
+    publish: StageTiming; // band mapping into the queue / frame buffer
+    queue: StageTiming; // wait between capture and delivery threads
+    deliver: StageTiming; // building and emitting the event
+  };
+  thread?: CaptureThreadStats; // Android
+};
+
+// Rolling native spectrogram of the live frames (installSpectrogramHistory),
+// read through SpectrogramHistoryReader. Rows hold the frames as delivered:
+// band-mapped, at the callbackRateHz rate.
+export type SpectrogramHistoryOptions = {
+  // Rows kept (default 512, at most 8192)
+  frames?: number;
+  // Widest frame kept (default 2048); wider frames are truncated
+  maxBins?: number;
+  // 'uint8' (default): dB mapped from [minDb, maxDb] to 0-255.
+  // 'float16': IEEE half magnitudes, normalized like frequencyData.
+  format?: 'uint8' | 'float16';
+  minDb?: number; // default -100
+  maxDb?: number; // default 0
+};
+
+// One consumer's share of the live analysis (addAnalysisSubscriber). All
+// subscribers are served from the session's one FFT per hop; only the band
+// mapping, the schedule and the products picked here are per subscriber.
+export type SubscriberOptions = {
+  // Frames per second, 1-120 (default: 30), independent of the session's
+  callbackRateHz?: number;
+  // Include the spectrum (default: true)
+  emitFft?: boolean;
+  // Bands per frame (default: the raw fftSize / 2 bins)
+  downsampleBins?: number;
+  bandLayout?: 'linear' | 'log' | 'mel' | 'octave';
+  // Features and meters come from the session: ones it does not compute
+  // yet are added from the next startAnalysis()
+  features?: Array<
+    'centroid' | 'flux' | 'rolloff' | 'flatness' | 'onset' | 'pitch'
+  >;
+  meters?: boolean; // default meter ballistics unless the session sets them
+};
+
+// Offline analysis of a recorded clip (computeSpectrogram). Frames are
+// normalized and band-mapped like live ones; the fields shared with
+// AnalysisConfig take the same values and defaults.
+export type SpectrogramOptions = {
+  fftSize?: number;
+  // Samples between frames (default: fftSize / 2)
+  hopSize?: number;
+  windowFunction?:
+    | 'hanning'
+    | 'hamming'
+    | 'blackman'
+    | 'rectangular'
+    | 'blackmanharris'
+    | 'flattop';
+  fftBackend?:
+    | 'auto'
+    | 'kissfft'
+    | 'realfft'
+    | 'accelerate'
+    | 'kissfft-q15'
+    | 'kissfft-q31';
+  bandLayout?: 'linear' | 'log' | 'mel' | 'octave';
+  // Bands per frame (default: fftSize / 2 raw bins)
+  downsampleBins?: number;
+  // 'uint8' (default): dB mapped from [minDb, maxDb] to 0-255.
+  // 'float16': IEEE half magnitudes, two bytes per value.
+  format?: 'uint8' | 'float16';
+  minDb?: number; // default -100
+  maxDb?: number; // default 0
+  // Worker threads (default: one per core, at most 8)
+  threads?: number;
+};
+
+export type SpectrogramResult = {
+  frames: number;
+  bins: number;
+  fftSize: number;
+  hopSize: number;
+  sampleRate: number;
+  format: string;
+  minDb: number;
+  maxDb: number;
+  // Base64 of the row-major [frames][bins] matrix; see decodeSpectrogram()
+  data: string;
 };
 
 export interface Spec extends TurboModule {
@@ -26,7 +275,34 @@ export interface Spec extends TurboModule {
 
   // Optional extra controls you expose
   setSmoothing(enabled: boolean, factor: number): Promise<void>;
+  // Applies live: the new FFT plan is built off the audio thread and swapped
+  // in, so resizing during capture does not drop a read
   setFftConfig(fftSize: number, downsampleBins: number): Promise<void>;
+
+  // Adds (or replaces) subscriber `id`, whose frames arrive as
+  // onSubscriberData events tagged with it. Subscriptions outlive sessions.
+  // Resolves false when 8 others exist.
+  addAnalysisSubscriber(id: number, options: SubscriberOptions): Promise<boolean>;
+  removeAnalysisSubscriber(id: number): Promise<boolean>;
+
+  // Installs global.__RealtimeAudioAnalyzerFrameBuffer (JSI ArrayBuffer over
+  // native memory). Returns false when JSI is unavailable (e.g. remote debug).
+  installFrameBuffer(): boolean;
+
+  // Allocates the native spectrogram history and installs it as
+  // global.__RealtimeAudioAnalyzerHistoryBuffer, replacing any previous
+  // one. Sessions started afterwards record every delivered frame into it;
+  // returns false while analysis runs, for invalid options or without JSI.
+  installSpectrogramHistory(options: SpectrogramHistoryOptions): boolean;
+
+  // Computes the spectrogram of an audio file in one native call, spread
+  // over worker threads. Android reads 16/24-bit PCM and float WAV files;
+  // iOS reads any format AVAudioFile can decode. Multichannel audio is
+  // averaged to mono.
+  computeSpectrogram(path: string, options: SpectrogramOptions): Promise<SpectrogramResult>;
+
+  // Always-on stage timings and drop counters of the native pipeline
+  getPerformanceStats(): Promise<PerformanceStats>;
 }
 
 /**
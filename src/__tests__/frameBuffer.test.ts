@@ -0,0 +1,98 @@
+/**
+ * Shared frame buffer reader tests
+ * SharedFrameReader: empty buffer, zero-copy reads of the newest slot, reads
+ * during the next write, and overwritten-frame detection.
+ */
+
+import { SharedFrameReader } from '../frameBuffer';
+
+const HEADER_BYTES = 16;
+const SLOT_HEADER_BYTES = 24;
+
+function createStore(capacity: number) {
+  const stride = SLOT_HEADER_BYTES + capacity * 4;
+  const buffer = new ArrayBuffer(HEADER_BYTES + 2 * stride);
+  const header = new Uint32Array(buffer, 0, 4);
+  header[2] = 2;
+  header[3] = capacity;
+  let nextSequence = 1;
+
+  const slotBase = (slot: number) => HEADER_BYTES + slot * stride;
+
+  return {
+    buffer,
+    // Mirrors FrameStore::beginFrame(): invalidate the unpublished slot
+    begin(): number {
+      const slot = (header[1] + 1) % 2;
+      new Uint32Array(buffer, slotBase(slot), 1)[0] = 0;
+      return slot;
+    },
+    // Mirrors FrameStore::endFrame()
+    end(slot: number, bins: number[], rms: number, peak: number, timestamp: number) {
+      const base = slotBase(slot);
+      new Float32Array(buffer, base + SLOT_HEADER_BYTES, capacity).set(bins);
+      new Uint32Array(buffer, base, 2)[1] = bins.length;
+      new Float32Array(buffer, base + 8, 2).set([rms, peak]);
+      new Float64Array(buffer, base + 16, 1)[0] = timestamp;
+      const sequence = nextSequence++;
+      new Uint32Array(buffer, base, 1)[0] = sequence;
+      header[1] = slot;
+      header[0] = sequence;
+    },
+    publish(bins: number[], rms = 0.5, peak = 0.75, timestamp = 1000) {
+      this.end(this.begin(), bins, rms, peak, timestamp);
+    },
+  };
+}
+
+describe('SharedFrameReader', () => {
+  it('returns null before the first frame', () => {
+    const store = createStore(8);
+    const reader = new SharedFrameReader(store.buffer);
+
+    expect(reader.sequence).toBe(0);
+    expect(reader.read()).toBeNull();
+  });
+
+  it('reads the newest frame without copying', () => {
+    const store = createStore(8);
+    const reader = new SharedFrameReader(store.buffer);
+
+    store.publish([1, 2, 3], 0.25, 0.5, 1234);
+    store.publish([4, 5], 0.125, 0.75, 5678);
+
+    const frame = reader.read();
+    expect(frame).not.toBeNull();
+    expect(frame!.sequence).toBe(2);
+    expect(Array.from(frame!.spectrum)).toEqual([4, 5]);
+    expect(frame!.rms).toBeCloseTo(0.125);
+    expect(frame!.peak).toBeCloseTo(0.75);
+    expect(frame!.timestamp).toBe(5678);
+    expect(frame!.spectrum.buffer).toBe(store.buffer);
+  });
+
+  it('still reads the published slot while the next one is being written', () => {
+    const store = createStore(8);
+    const reader = new SharedFrameReader(store.buffer);
+
+    store.publish([1, 2, 3]);
+    const slot = store.begin(); // writer is mid-frame in the other slot
+
+    expect(Array.from(reader.read()!.spectrum)).toEqual([1, 2, 3]);
+    store.end(slot, [9], 0, 0, 0);
+    expect(Array.from(reader.read()!.spectrum)).toEqual([9]);
+  });
+
+  it('reports when a held frame has been overwritten', () => {
+    const store = createStore(8);
+    const reader = new SharedFrameReader(store.buffer);
+
+    store.publish([1]);
+    const frame = reader.read()!;
+    store.publish([2]);
+    expect(reader.isCurrent(frame)).toBe(true); // other slot was written
+
+    store.publish([3]);
+    expect(reader.isCurrent(frame)).toBe(false); // its slot was reused
+  });
+});
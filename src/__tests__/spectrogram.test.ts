@@ -0,0 +1,71 @@
+/**
+ * Spectrogram decoding tests
+ * decodeBase64 padding, halfToFloat special values, and decodeSpectrogram()
+ * on uint8 dB and float16 magnitude payloads.
+ */
+
+import { decodeBase64, decodeSpectrogram, halfToFloat } from '../spectrogram';
+
+function result(format: 'uint8' | 'float16', bytes: number[], frames: number, bins: number) {
+  return {
+    frames,
+    bins,
+    fftSize: 8,
+    hopSize: 4,
+    sampleRate: 8000,
+    format,
+    minDb: -100,
+    maxDb: 0,
+    data: Buffer.from(bytes).toString('base64'),
+  };
+}
+
+describe('decodeBase64', () => {
+  it('matches Buffer for every padding length', () => {
+    for (const length of [0, 1, 2, 3, 4, 5, 255]) {
+      const bytes = Array.from({ length }, (_, i) => (i * 37 + 11) & 0xff);
+      const encoded = Buffer.from(bytes).toString('base64');
+      expect(Array.from(decodeBase64(encoded))).toEqual(bytes);
+    }
+  });
+});
+
+describe('halfToFloat', () => {
+  it('decodes normal, subnormal and special values', () => {
+    expect(halfToFloat(0x3c00)).toBe(1);
+    expect(halfToFloat(0xc000)).toBe(-2);
+    expect(halfToFloat(0x3555)).toBeCloseTo(0.33325, 5);
+    expect(halfToFloat(0x0001)).toBe(2 ** -24);
+    expect(halfToFloat(0x0000)).toBe(0);
+    expect(halfToFloat(0x7c00)).toBe(Infinity);
+    expect(halfToFloat(0x7e00)).toBeNaN();
+  });
+});
+
+describe('decodeSpectrogram', () => {
+  it('maps uint8 values back onto the dB range', () => {
+    const decoded = decodeSpectrogram(result('uint8', [0, 255, 51, 204], 2, 2));
+
+    expect(decoded.format).toBe('uint8');
+    expect(Array.from(decoded.raw)).toEqual([0, 255, 51, 204]);
+    expect(decoded.values[0]).toBeCloseTo(-100);
+    expect(decoded.values[1]).toBeCloseTo(0);
+    expect(decoded.values[2]).toBeCloseTo(-80);
+    expect(Array.from(decoded.frame(1))).toEqual([
+      decoded.values[2],
+      decoded.values[3],
+    ]);
+    expect(decoded.frameTime(1)).toBeCloseTo(0.0005);
+  });
+
+  it('reads little-endian float16 magnitudes', () => {
+    // 1.0, 0.5, 0.25
+    const decoded = decodeSpectrogram(
+      result('float16', [0x00, 0x3c, 0x00, 0x38, 0x00, 0x34], 3, 1)
+    );
+
+    expect(decoded.format).toBe('float16');
+    expect(Array.from(decoded.raw)).toEqual([0x3c00, 0x3800, 0x3400]);
+    expect(Array.from(decoded.values)).toEqual([1, 0.5, 0.25]);
+  });
+});
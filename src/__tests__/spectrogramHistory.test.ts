@@ -0,0 +1,136 @@
+/**
+ * Spectrogram history reader tests
+ * SpectrogramHistoryReader: row order across the ring wrap, zero-copy views,
+ * timestamp selection, uint8/float16 rows and reused-window detection.
+ */
+
+import { SpectrogramHistoryReader } from '../spectrogramHistory';
+
+const HEADER_BYTES = 40;
+
+function createHistory(frames: number, maxBins: number, format = 0) {
+  const slots = frames + 1;
+  const valueBytes = format === 1 ? 2 : 1;
+  const rowsOffset = HEADER_BYTES + 2 * slots * 8;
+  const buffer = new ArrayBuffer(rowsOffset + 2 * slots * maxBins * valueBytes);
+  const header = new Uint32Array(buffer, 0, 8);
+  header[3] = slots;
+  header[5] = maxBins;
+  header[6] = format;
+  new Float32Array(buffer, 32, 2).set([-100, 0]);
+  const times = new Float64Array(buffer, HEADER_BYTES, 2 * slots);
+
+  return {
+    buffer,
+    // Mirrors SpectrogramHistory::push() with already encoded values
+    push(values: number[], timestamp: number) {
+      const bins = values.length;
+      if (bins !== header[4]) {
+        header[4] = bins;
+        header[1] = 0;
+        header[2] = 0;
+        header[7]++;
+      }
+      const head = header[1];
+      const Row = format === 1 ? Uint16Array : Uint8Array;
+      for (const index of [head, head + slots]) {
+        new Row(buffer, rowsOffset + index * bins * valueBytes, bins).set(values);
+        times[index] = timestamp;
+      }
+      header[1] = (head + 1) % slots;
+      header[2] = Math.min(header[2] + 1, frames);
+      header[0]++;
+    },
+  };
+}
+
+describe('SpectrogramHistoryReader', () => {
+  it('returns null before the first frame', () => {
+    const history = createHistory(4, 8);
+    const reader = new SpectrogramHistoryReader(history.buffer);
+    expect(reader.sequence).toBe(0);
+    expect(reader.capacity).toBe(4);
+    expect(reader.latest(4)).toBeNull();
+    expect(reader.range(0, 1000)).toBeNull();
+  });
+
+  it('reads the newest rows oldest first, across the wrap', () => {
+    const history = createHistory(4, 8);
+    const reader = new SpectrogramHistoryReader(history.buffer);
+    for (let i = 1; i <= 7; i++) history.push([i, i * 10], i * 100);
+
+    const window = reader.latest(10)!;
+    expect(window.frames).toBe(4);
+    expect(window.bins).toBe(2);
+    expect(window.sequence).toBe(7);
+    expect(Array.from(window.timestamps)).toEqual([400, 500, 600, 700]);
+    expect(Array.from(window.raw)).toEqual([4, 40, 5, 50, 6, 60, 7, 70]);
+    expect(Array.from(window.frame(3))).toEqual([7, 70]);
+
+    const newest = reader.latest(2)!;
+    expect(Array.from(newest.timestamps)).toEqual([600, 700]);
+  });
+
+  it('views native memory without copying', () => {
+    const history = createHistory(4, 8);
+    const reader = new SpectrogramHistoryReader(history.buffer);
+    history.push([1, 2, 3], 100);
+
+    const window = reader.latest(1)!;
+    expect(window.raw.buffer).toBe(history.buffer);
+    expect(window.timestamps.buffer).toBe(history.buffer);
+  });
+
+  it('selects rows by timestamp', () => {
+    const history = createHistory(8, 4);
+    const reader = new SpectrogramHistoryReader(history.buffer);
+    for (let i = 1; i <= 10; i++) history.push([i], i * 100);
+
+    const window = reader.range(450, 800)!;
+    expect(Array.from(window.timestamps)).toEqual([500, 600, 700, 800]);
+    expect(Array.from(window.raw)).toEqual([5, 6, 7, 8]);
+    // The newest row of the window is two frames old
+    expect(window.sequence).toBe(8);
+
+    expect(reader.range(0, 250)).toBeNull(); // rotated out
+    expect(reader.range(1100, 1200)).toBeNull();
+  });
+
+  it('decodes uint8 codes to dB and float16 to magnitudes', () => {
+    const bytes = createHistory(2, 4);
+    bytes.push([0, 255, 51], 100);
+    const db = new SpectrogramHistoryReader(bytes.buffer).latest(1)!;
+    const out = new Float32Array(8);
+    const values = db.decode(out);
+    expect(values).toBe(out);
+    expect(values[0]).toBeCloseTo(-100);
+    expect(values[1]).toBeCloseTo(0);
+    expect(values[2]).toBeCloseTo(-80);
+
+    const halves = createHistory(2, 4, 1);
+    halves.push([0x3c00, 0x3800], 100); // 1.0, 0.5
+    const window = new SpectrogramHistoryReader(halves.buffer).latest(1)!;
+    expect(window.format).toBe('float16');
+    expect(Array.from(window.decode())).toEqual([1, 0.5]);
+  });
+
+  it('tells when the writer reused a window', () => {
+    const history = createHistory(4, 4);
+    const reader = new SpectrogramHistoryReader(history.buffer);
+    history.push([1], 100);
+    history.push([2], 200);
+
+    const window = reader.latest(2)!;
+    history.push([3], 300);
+    history.push([4], 400);
+    expect(reader.isCurrent(window)).toBe(true);
+    history.push([5], 500);
+    expect(reader.isCurrent(window)).toBe(false);
+
+    // A new band count restarts the history
+    const current = reader.latest(1)!;
+    history.push([6, 6], 600);
+    expect(reader.isCurrent(current)).toBe(false);
+    expect(reader.latest(4)!.frames).toBe(1);
+  });
+});
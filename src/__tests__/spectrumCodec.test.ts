@@ -0,0 +1,74 @@
+/**
+ * Compact spectrum decoding tests
+ * SpectrumDecoder: uint8 and uint16 keyframes, delta frames with zero runs,
+ * waiting for a keyframe, and output array reuse.
+ */
+
+import { SpectrumDecoder, type EncodedSpectrum } from '../spectrumCodec';
+
+function frame(format: 'uint8' | 'uint16', bytes: number[], bins: number): EncodedSpectrum {
+  return {
+    format,
+    bins,
+    minDb: -100,
+    maxDb: 0,
+    data: Buffer.from(bytes).toString('base64'),
+  };
+}
+
+describe('SpectrumDecoder', () => {
+  it('maps uint8 keyframe codes onto the dB range', () => {
+    const decoder = new SpectrumDecoder();
+    const values = decoder.decode(frame('uint8', [1, 0, 255, 51], 3));
+
+    expect(values).not.toBeNull();
+    expect(Array.from(values!)).toHaveLength(3);
+    expect(values![0]).toBeCloseTo(-100);
+    expect(values![1]).toBeCloseTo(0);
+    expect(values![2]).toBeCloseTo(-80);
+  });
+
+  it('reads little-endian uint16 codes', () => {
+    const decoder = new SpectrumDecoder();
+    const values = decoder.decode(frame('uint16', [1, 0xff, 0xff, 0x00, 0x00], 2));
+
+    expect(values![0]).toBeCloseTo(0);
+    expect(values![1]).toBeCloseTo(-100);
+  });
+
+  it('applies deltas, zero runs and wrap-around to the previous frame', () => {
+    const decoder = new SpectrumDecoder();
+    decoder.decode(frame('uint8', [1, 10, 20, 30, 40], 4));
+
+    // Two unchanged bands, +5, then -10 coded as 246
+    const values = decoder.decode(frame('uint8', [0, 0, 2, 5, 246], 4));
+    const step = 100 / 255;
+    expect(values![0]).toBeCloseTo(-100 + 10 * step);
+    expect(values![1]).toBeCloseTo(-100 + 20 * step);
+    expect(values![2]).toBeCloseTo(-100 + 35 * step);
+    expect(values![3]).toBeCloseTo(-100 + 30 * step);
+  });
+
+  it('waits for a keyframe before decoding deltas', () => {
+    const decoder = new SpectrumDecoder();
+    expect(decoder.decode(frame('uint8', [0, 0, 3], 3))).toBeNull();
+
+    decoder.decode(frame('uint8', [1, 1, 2, 3], 3));
+    expect(decoder.decode(frame('uint8', [0, 0, 3], 3))).not.toBeNull();
+
+    // A delta for a different band count can't apply
+    expect(decoder.decode(frame('uint8', [0, 0, 4], 4))).toBeNull();
+    expect(decoder.decode(frame('uint8', [0, 0, 3], 3))).toBeNull();
+
+    decoder.decode(frame('uint8', [1, 1, 2, 3], 3));
+    decoder.reset();
+    expect(decoder.decode(frame('uint8', [0, 0, 3], 3))).toBeNull();
+  });
+
+  it('reuses its output array', () => {
+    const decoder = new SpectrumDecoder();
+    const first = decoder.decode(frame('uint8', [1, 1, 2], 2));
+    const second = decoder.decode(frame('uint8', [0, 0, 2], 2));
+    expect(second).toBe(first);
+  });
+});
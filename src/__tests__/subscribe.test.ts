@@ -0,0 +1,109 @@
+/**
+ * Analysis subscription tests
+ * Drives RealtimeAudioAnalyzer.subscribe() against a mocked native module:
+ * ids, per-subscriber event filtering and removal.
+ */
+
+const mockListeners: Array<(e: any) => void> = [];
+
+jest.mock('react-native', () => ({
+  NativeModules: {
+    RealtimeAudioAnalyzer: {
+      addAnalysisSubscriber: jest.fn(() => Promise.resolve(true)),
+      removeAnalysisSubscriber: jest.fn(() => Promise.resolve(true)),
+    },
+  },
+  NativeEventEmitter: jest.fn(() => ({
+    addListener: jest.fn((_event: string, listener: (e: any) => void) => {
+      mockListeners.push(listener);
+      return {
+        remove: () => {
+          const index = mockListeners.indexOf(listener);
+          if (index >= 0) mockListeners.splice(index, 1);
+        },
+      };
+    }),
+    removeAllListeners: jest.fn(),
+  })),
+  Platform: { select: () => '' },
+  TurboModuleRegistry: { get: () => null },
+}));
+jest.mock('../demo', () => ({}));
+
+import { NativeModules } from 'react-native';
+import RealtimeAudioAnalyzer from '../index';
+
+const emit = (e: any) => mockListeners.slice().forEach((listener) => listener(e));
+const flush = () => new Promise((resolve) => setImmediate(resolve));
+
+describe('RealtimeAudioAnalyzer.subscribe', () => {
+  const native = NativeModules.RealtimeAudioAnalyzer as any;
+
+  beforeEach(() => {
+    jest.clearAllMocks();
+  });
+
+  it('registers each subscriber under its own id', () => {
+    const meter = { callbackRateHz: 30, downsampleBins: 32, bandLayout: 'log' as const };
+    const lufs = { callbackRateHz: 10, emitFft: false, meters: true };
+    const a = RealtimeAudioAnalyzer.subscribe(meter, jest.fn());
+    const b = RealtimeAudioAnalyzer.subscribe(lufs, jest.fn());
+
+    const [[idA, optionsA], [idB, optionsB]] = native.addAnalysisSubscriber.mock.calls;
+    expect(idA).not.toBe(idB);
+    expect(optionsA).toEqual(meter);
+    expect(optionsB).toEqual(lufs);
+    a.remove();
+    b.remove();
+  });
+
+  it('delivers only the frames tagged with the subscriber', () => {
+    const first = jest.fn();
+    const second = jest.fn();
+    const a = RealtimeAudioAnalyzer.subscribe({}, first);
+    const b = RealtimeAudioAnalyzer.subscribe({}, second);
+    const [[idA], [idB]] = native.addAnalysisSubscriber.mock.calls;
+
+    emit({ subscriberId: idA, frequencyData: [1, 2] });
+    emit({ subscriberId: idB, frequencyData: [3] });
+    emit({ subscriberId: idB, frequencyData: [4] });
+
+    expect(first).toHaveBeenCalledTimes(1);
+    expect(first.mock.calls[0][0].frequencyData).toEqual([1, 2]);
+    expect(second).toHaveBeenCalledTimes(2);
+    a.remove();
+    b.remove();
+  });
+
+  it('unregisters natively once on remove()', () => {
+    const listener = jest.fn();
+    const subscription = RealtimeAudioAnalyzer.subscribe({}, listener);
+    const [[id]] = native.addAnalysisSubscriber.mock.calls;
+
+    subscription.remove();
+    subscription.remove();
+    emit({ subscriberId: id, frequencyData: [] });
+
+    expect(native.removeAnalysisSubscriber).toHaveBeenCalledTimes(1);
+    expect(native.removeAnalysisSubscriber).toHaveBeenCalledWith(id);
+    expect(listener).not.toHaveBeenCalled();
+  });
+
+  it('drops the listener when the native side refuses the subscriber', async () => {
+    const warn = jest.spyOn(console, 'warn').mockImplementation(() => {});
+    native.addAnalysisSubscriber.mockImplementationOnce(() => Promise.resolve(false));
+    const listener = jest.fn();
+    RealtimeAudioAnalyzer.subscribe({}, listener);
+    const [[id]] = native.addAnalysisSubscriber.mock.calls;
+    await flush();
+
+    emit({ subscriberId: id, frequencyData: [] });
+    expect(listener).not.toHaveBeenCalled();
+    expect(native.removeAnalysisSubscriber).toHaveBeenCalledWith(id);
+    warn.mockRestore();
+  });
+
+  it('rejects a missing listener', () => {
+    expect(() => RealtimeAudioAnalyzer.subscribe({}, undefined as any)).toThrow(TypeError);
+  });
+});
@@ -0,0 +1,40 @@
+/**
+ * Voice activity listener tests
+ * Registers RealtimeAudioAnalyzer.onVoiceActivity() against a mocked
+ * event emitter.
+ */
+
+const mockAddListener = jest.fn((_event: string, _listener: (e: any) => void) => ({
+  remove: jest.fn(),
+}));
+
+jest.mock('react-native', () => ({
+  NativeModules: { RealtimeAudioAnalyzer: {} },
+  NativeEventEmitter: jest.fn(() => ({
+    addListener: (event: string, listener: (e: any) => void) => mockAddListener(event, listener),
+    removeAllListeners: jest.fn(),
+  })),
+  Platform: { select: () => '' },
+  TurboModuleRegistry: { get: () => null },
+}));
+jest.mock('../demo', () => ({}));
+
+import RealtimeAudioAnalyzer from '../index';
+
+describe('RealtimeAudioAnalyzer.onVoiceActivity', () => {
+  beforeEach(() => {
+    mockAddListener.mockClear();
+  });
+
+  it('listens to the voice activity event', () => {
+    const listener = jest.fn();
+    const subscription = RealtimeAudioAnalyzer.onVoiceActivity(listener);
+
+    expect(mockAddListener).toHaveBeenCalledWith('RealtimeAudioAnalyzer:onVoiceActivity', listener);
+    expect(subscription).toHaveProperty('remove');
+  });
+
+  it('rejects a missing listener', () => {
+    expect(() => RealtimeAudioAnalyzer.onVoiceActivity(undefined as any)).toThrow(TypeError);
+  });
+});
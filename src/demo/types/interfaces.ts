@@ -49,7 +49,13 @@ export interface AnalysisConfig {
   smoothing?: number;                  // Smoothing factor (0.0-1.0)
 }
 
-export type WindowFunction = 'hanning' | 'hamming' | 'blackman' | 'rectangular';
+export type WindowFunction =
+  | 'hanning'
+  | 'hamming'
+  | 'blackman'
+  | 'rectangular'
+  | 'blackmanharris'
+  | 'flattop';
 
 export type PermissionStatus = 'granted' | 'denied' | 'undetermined' | 'blocked';
 
@@ -0,0 +1,92 @@
+/**
+ * Reader for the shared-memory frame buffer published by the native
+ * FrameStore (cpp/frame_store.h). The layout below must stay in sync with it.
+ *
+ *   header   u32 sequence, u32 slot, u32 slotCount, u32 capacity
+ *   slot[i]  u32 sequence, u32 bins, f32 rms, f32 peak, f64 timestamp,
+ *            f32 data[capacity]
+ *
+ * The native side double-buffers: it writes the slot that is not published
+ * and then bumps the sequence, so reads never block the audio thread.
+ */
+
+export const FRAME_BUFFER_GLOBAL = '__RealtimeAudioAnalyzerFrameBuffer';
+
+const HEADER_BYTES = 16;
+const SLOT_HEADER_BYTES = 24;
+const MAX_READ_ATTEMPTS = 4;
+
+export type SharedFrame = {
+  // Increases by one per published frame
+  sequence: number;
+  timestamp: number;
+  rms: number;
+  peak: number;
+  // Zero-copy view of native memory. It stays valid until the writer reuses
+  // the slot (two frames later); copy it (`spectrum.slice()`) to keep it.
+  spectrum: Float32Array;
+};
+
+export class SharedFrameReader {
+  private readonly header: Uint32Array;
+  private readonly slotMeta: Uint32Array[] = [];
+  private readonly slotLevels: Float32Array[] = [];
+  private readonly slotTime: Float64Array[] = [];
+  private readonly slotData: Float32Array[] = [];
+
+  constructor(buffer: ArrayBuffer) {
+    this.header = new Uint32Array(buffer, 0, 4);
+    const slotCount = this.header[2];
+    const capacity = this.header[3];
+    const stride = SLOT_HEADER_BYTES + capacity * 4;
+
+    // Views are created once; read() only slices them
+    for (let i = 0; i < slotCount; i++) {
+      const base = HEADER_BYTES + i * stride;
+      this.slotMeta.push(new Uint32Array(buffer, base, 2));
+      this.slotLevels.push(new Float32Array(buffer, base + 8, 2));
+      this.slotTime.push(new Float64Array(buffer, base + 16, 1));
+      this.slotData.push(new Float32Array(buffer, base + SLOT_HEADER_BYTES, capacity));
+    }
+  }
+
+  /** Sequence of the newest published frame (0 = none yet). */
+  get sequence(): number {
+    return this.header[0];
+  }
+
+  /**
+   * Returns the newest frame, or null if nothing was published yet (or the
+   * writer kept overtaking the read, which only happens under heavy load).
+   */
+  read(): SharedFrame | null {
+    for (let attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++) {
+      const sequence = this.header[0];
+      if (sequence === 0) return null;
+      const slot = this.header[1];
+      const meta = this.slotMeta[slot];
+      if (meta === undefined || meta[0] !== sequence) continue; // being rewritten
+
+      const frame: SharedFrame = {
+        sequence,
+        timestamp: this.slotTime[slot][0],
+        rms: this.slotLevels[slot][0],
+        peak: this.slotLevels[slot][1],
+        spectrum: this.slotData[slot].subarray(0, meta[1]),
+      };
+      if (meta[0] === sequence) return frame;
+    }
+    return null;
+  }
+
+  /** True while `frame.spectrum` still holds the data it was read with. */
+  isCurrent(frame: SharedFrame): boolean {
+    return this.slotMeta.some((meta) => meta[0] === frame.sequence);
+  }
+}
+
+/** Reader over the installed global buffer, or null if not installed. */
+export function getSharedFrameReader(): SharedFrameReader | null {
+  const buffer = (globalThis as any)[FRAME_BUFFER_GLOBAL];
+  return buffer instanceof ArrayBuffer ? new SharedFrameReader(buffer) : null;
+}
@@ -1,8 +1,28 @@
 import { NativeEventEmitter, NativeModules, Platform } from 'react-native';
 import NativeRealtimeAudioAnalyzer, {
   type AnalysisConfig,
+  type PerformanceStats,
+  type SpectrogramHistoryOptions,
+  type SpectrogramOptions,
+  type SpectrogramResult,
+  type SubscriberOptions,
   type Spec as TurboSpec,
 } from './NativeRealtimeAudioAnalyzer';
+import { getSharedFrameReader, type SharedFrameReader } from './frameBuffer';
+import {
+  getSpectrogramHistoryReader,
+  type SpectrogramHistoryReader,
+} from './spectrogramHistory';
+import type { EncodedSpectrum } from './spectrumCodec';
+
+export { SharedFrameReader, getSharedFrameReader } from './frameBuffer';
+export type { SharedFrame } from './frameBuffer';
+export { decodeSpectrogram } from './spectrogram';
+export type { DecodedSpectrogram } from './spectrogram';
+export { SpectrumDecoder } from './spectrumCodec';
+export type { EncodedSpectrum } from './spectrumCodec';
+export { SpectrogramHistoryReader, getSpectrogramHistoryReader } from './spectrogramHistory';
+export type { HistoryWindow } from './spectrogramHistory';
 
 // Export demo component and utilities
 export { 
@@ -62,20 +82,98 @@ if (!RealtimeAudioAnalysisModule) {
   throw new Error(LINKING_ERROR);
 }
 
-export type { AnalysisConfig };
+export type {
+  AnalysisConfig,
+  SpectrogramHistoryOptions,
+  SpectrogramOptions,
+  SpectrogramResult,
+  SubscriberOptions,
+};
+export type {
+  CaptureThreadStats,
+  CoreClass,
+  PerformanceStats,
+  StageTiming,
+} from './NativeRealtimeAudioAnalyzer';
 
 export interface AudioAnalysisEvent {
-  frequencyData: number[];
+  frequencyData: number[]; // empty with a compact spectrumFormat
+  // spectrumFormat 'uint8' / 'uint16': the spectrum, see SpectrumDecoder
+  spectrum?: EncodedSpectrum;
   timeData: number[];
   volume: number;
   peak: number;
   timestamp: number;
   rms?: number;
   fft?: number[];
+  droppedFrames?: number; // Frames dropped because delivery fell behind
+  // Only the features requested in AnalysisConfig.features are present
+  features?: SpectralFeatures;
+  // channelMode 'stereo': [left, right]; 'midside': [mid, side]
+  channels?: ChannelData[];
+  // Present when AnalysisConfig.meters is set
+  meters?: LevelMeters;
+  // Present when AnalysisConfig.voiceActivity is set
+  voiceActivity?: VoiceActivity;
+}
+
+// subscribe(): one frame for one subscriber, in its bands and at its rate
+export interface SubscriberFrameEvent {
+  subscriberId: number;
+  frequencyData: number[]; // empty with emitFft false
+  volume: number;
+  peak: number;
+  timestamp: number;
+  sampleRate: number;
+  fftSize: number;
+  bufferSize: number;
+  droppedFrames: number;
+  // Only the features requested in SubscriberOptions.features are present
+  features?: SpectralFeatures;
+  // Present when SubscriberOptions.meters is set
+  meters?: LevelMeters;
+}
+
+export interface VoiceActivity {
+  active: boolean; // the gate is open: spectra and features are analyzed
+  levelDb: number; // dBFS RMS of the latest read, -120 = silence
+  noiseFloorDb: number; // tracked background level
+}
+
+// onVoiceActivity: sent when the gate opens or closes
+export interface VoiceActivityEvent extends VoiceActivity {
+  timestamp: number;
+}
+
+export interface LevelMeters {
+  rms: number; // sliding-window RMS of the downmix, linear full scale
+  peak: number; // sample peak, instant attack, meterReleaseMs decay
+  peakHold: number; // highest sample over the last peakHoldMs
+  momentaryLufs: number; // K-weighted loudness over 400 ms, -120 = silence
+  shortTermLufs: number; // K-weighted loudness over 3 s, -120 = silence
+}
+
+export interface ChannelData {
+  volume: number; // RMS of the channel over the read (unsmoothed)
+  peak: number;
+  frequencyData: number[]; // band-mapped like frequencyData, empty if not shipped
+  spectrum?: EncodedSpectrum; // instead of frequencyData, like the event's
+}
+
+export interface SpectralFeatures {
+  centroid?: number; // Hz, magnitude-weighted mean frequency
+  flux?: number; // mean positive magnitude change since the previous frame
+  rolloff?: number; // Hz below which 85% of the spectral energy lies
+  flatness?: number; // 0 (tonal) .. 1 (noise-like)
+  onset?: boolean; // true on the frame where an onset was detected
+  pitch?: number; // Hz, 0 when no periodicity was found
+  pitchConfidence?: number; // 0..1, autocorrelation at the detected period
 }
 
 const EVENT_ON_DATA = 'RealtimeAudioAnalyzer:onData';
 const EVENT_COMPAT = 'AudioAnalysisData';
+const EVENT_VOICE_ACTIVITY = 'RealtimeAudioAnalyzer:onVoiceActivity';
+const EVENT_SUBSCRIBER = 'RealtimeAudioAnalyzer:onSubscriberData';
 
 // NativeEventEmitter requires a module instance on iOS; safe to pass on Android too.
 const eventEmitter = new NativeEventEmitter(RealtimeAudioAnalysisModule as any);
@@ -122,11 +220,68 @@ function removeListenersCompat(eventOrCount?: string | number) {
   // We can't reliably remove by count; remove our known events safely.
   eventEmitter.removeAllListeners(EVENT_ON_DATA);
   eventEmitter.removeAllListeners(EVENT_COMPAT);
+  eventEmitter.removeAllListeners(EVENT_VOICE_ACTIVITY);
+  eventEmitter.removeAllListeners(EVENT_SUBSCRIBER);
+}
+
+// Native subscriber ids, allocated here; never reused within a JS runtime
+let nextSubscriberId = 1;
+
+/**
+ * Registers a consumer with its own bins, rate and products. The native
+ * engine runs one FFT per hop for all of them and fans out only what each
+ * asked for; frames reach `listener` while analysis runs, alongside onData.
+ * remove() unregisters it.
+ */
+function subscribe(
+  options: SubscriberOptions,
+  listener: (e: SubscriberFrameEvent) => void
+): Subscription {
+  if (typeof listener !== 'function') {
+    throw new TypeError('RealtimeAudioAnalyzer.subscribe(options, listener): listener must be a function');
+  }
+  const id = nextSubscriberId++;
+  const events = eventEmitter.addListener(EVENT_SUBSCRIBER, (e: SubscriberFrameEvent) => {
+    if (e.subscriberId === id) listener(e);
+  });
+  let removed = false;
+  const remove = () => {
+    if (removed) return;
+    removed = true;
+    events.remove();
+    Promise.resolve(RealtimeAudioAnalysisModule.removeAnalysisSubscriber?.(id)).catch(() => {});
+  };
+  Promise.resolve(RealtimeAudioAnalysisModule.addAnalysisSubscriber?.(id, options))
+    .then((added: boolean | undefined) => {
+      if (added !== true && !removed) {
+        console.warn('RealtimeAudioAnalyzer: subscriber not added (too many subscribers?)');
+        remove();
+      }
+    })
+    .catch((error: unknown) => {
+      console.warn('RealtimeAudioAnalyzer: subscribe failed', error);
+      remove();
+    });
+  return { remove };
+}
+
+// Installs the JSI frame buffer once; false if the native side can't (no
+// JSI, e.g. remote debugging), in which case events remain the only path.
+let frameBufferInstalled = false;
+function installFrameBuffer(): boolean {
+  if (!frameBufferInstalled) {
+    frameBufferInstalled = RealtimeAudioAnalysisModule.installFrameBuffer?.() === true;
+  }
+  return frameBufferInstalled;
 }
 
 const RealtimeAudioAnalyzer = {
   // Core methods
   startAnalysis(config: AnalysisConfig = {}): Promise<void> {
+    if (config.frameDelivery === 'jsi' && !installFrameBuffer()) {
+      console.warn('RealtimeAudioAnalyzer: JSI frame buffer unavailable, using events');
+      config = { ...config, frameDelivery: 'events' };
+    }
     return RealtimeAudioAnalysisModule.startAnalysis(config);
   },
 
@@ -151,6 +306,40 @@ const RealtimeAudioAnalyzer = {
     return RealtimeAudioAnalysisModule.setFftConfig(fftSize, downsampleBins);
   },
 
+  // Shared-memory frame delivery (use with frameDelivery: 'jsi'). Poll the
+  // reader, e.g. once per requestAnimationFrame, and compare `sequence`.
+  installFrameBuffer,
+
+  getFrameReader(): SharedFrameReader | null {
+    return installFrameBuffer() ? getSharedFrameReader() : null;
+  },
+
+  // Native rolling spectrogram of the live frames, kept outside the JS
+  // heap. Install before startAnalysis(); read time ranges or the latest
+  // rows as zero-copy views, e.g. for a waterfall.
+  installSpectrogramHistory(options: SpectrogramHistoryOptions = {}): boolean {
+    return RealtimeAudioAnalysisModule.installSpectrogramHistory?.(options) === true;
+  },
+
+  getSpectrogramHistory(): SpectrogramHistoryReader | null {
+    return getSpectrogramHistoryReader();
+  },
+
+  // Offline analysis of a recorded clip in one native call; independent of
+  // live capture. Pass the result to decodeSpectrogram() for typed arrays.
+  computeSpectrogram(
+    path: string,
+    options: SpectrogramOptions = {}
+  ): Promise<SpectrogramResult> {
+    return RealtimeAudioAnalysisModule.computeSpectrogram(path, options);
+  },
+
+  // Native per-stage timings and drop counters of the current (or last)
+  // session, e.g. to tell a slow FFT from a busy JS thread
+  getPerformanceStats(): Promise<PerformanceStats> {
+    return RealtimeAudioAnalysisModule.getPerformanceStats();
+  },
+
   // Backward-compatible aliases
   start(config: AnalysisConfig = {}): Promise<void> {
     const fn = RealtimeAudioAnalysisModule.start ?? RealtimeAudioAnalysisModule.startAnalysis;
@@ -175,6 +364,19 @@ const RealtimeAudioAnalyzer = {
     return eventEmitter.addListener(EVENT_ON_DATA, listener);
   },
 
+  // Voice activity gate transitions (AnalysisConfig.voiceActivity)
+  onVoiceActivity(listener: (e: VoiceActivityEvent) => void): Subscription {
+    if (typeof listener !== 'function') {
+      throw new TypeError(
+        'RealtimeAudioAnalyzer.onVoiceActivity(listener): listener must be a function'
+      );
+    }
+    return eventEmitter.addListener(EVENT_VOICE_ACTIVITY, listener);
+  },
+
+  // Per-consumer frames from the shared analysis (see subscribe())
+  subscribe,
+
   // Event emitter API (backward compatible + safer)
   addListener: addListenerCompat,
   removeListeners: removeListenersCompat,
@@ -0,0 +1,95 @@
+/**
+ * Decoding of computeSpectrogram() results. The native side (see
+ * cpp/spectrogram.h) returns a row-major [frames][bins] matrix as base64:
+ *
+ *   'uint8'    one byte per value, 0 = minDb (or below), 255 = maxDb
+ *   'float16'  little-endian IEEE half magnitudes, normalized like the
+ *              live frequencyData
+ */
+
+import type { SpectrogramResult } from './NativeRealtimeAudioAnalyzer';
+
+export type DecodedSpectrogram = {
+  frames: number;
+  bins: number;
+  fftSize: number;
+  hopSize: number;
+  sampleRate: number;
+  format: 'uint8' | 'float16';
+  // Encoded values as shipped: Uint8Array for 'uint8', half bits for 'float16'
+  raw: Uint8Array | Uint16Array;
+  // dB for 'uint8' (quantized to (maxDb - minDb) / 255), magnitudes for
+  // 'float16'
+  values: Float32Array;
+  // Start of frame `index` in seconds
+  frameTime(index: number): number;
+  // Row view into `values`, no copy
+  frame(index: number): Float32Array;
+};
+
+const BASE64 = 'ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/';
+const BASE64_LOOKUP = new Uint8Array(128);
+for (let i = 0; i < BASE64.length; i++) BASE64_LOOKUP[BASE64.charCodeAt(i)] = i;
+
+// atob is missing on older Hermes versions, and would build a string first
+export function decodeBase64(data: string): Uint8Array {
+  let length = data.length;
+  while (length > 0 && data[length - 1] === '=') length--;
+  const out = new Uint8Array((length * 3) >> 2);
+  let o = 0;
+  for (let i = 0; i < length; i += 4) {
+    const a = BASE64_LOOKUP[data.charCodeAt(i)];
+    const b = BASE64_LOOKUP[data.charCodeAt(i + 1)];
+    const c = i + 2 < length ? BASE64_LOOKUP[data.charCodeAt(i + 2)] : 0;
+    const d = i + 3 < length ? BASE64_LOOKUP[data.charCodeAt(i + 3)] : 0;
+    const bits = (a << 18) | (b << 12) | (c << 6) | d;
+    out[o++] = bits >> 16;
+    if (o < out.length) out[o++] = (bits >> 8) & 0xff;
+    if (o < out.length) out[o++] = bits & 0xff;
+  }
+  return out;
+}
+
+export function halfToFloat(bits: number): number {
+  const sign = bits & 0x8000 ? -1 : 1;
+  const exp = (bits >> 10) & 0x1f;
+  const mant = bits & 0x3ff;
+  if (exp === 0) return sign * mant * 2 ** -24;
+  if (exp === 31) return mant ? NaN : sign * Infinity;
+  return sign * (1 + mant / 1024) * 2 ** (exp - 15);
+}
+
+export function decodeSpectrogram(result: SpectrogramResult): DecodedSpectrogram {
+  const bytes = decodeBase64(result.data);
+  const count = result.frames * result.bins;
+  const values = new Float32Array(count);
+  let raw: Uint8Array | Uint16Array;
+
+  if (result.format === 'float16') {
+    // Copy so the view is 2-byte aligned regardless of the decode buffer
+    raw = new Uint16Array(count);
+    for (let i = 0; i < count; i++) {
+      raw[i] = bytes[i * 2] | (bytes[i * 2 + 1] << 8);
+      values[i] = halfToFloat(raw[i]);
+    }
+  } else {
+    raw = bytes.subarray(0, count);
+    const step = (result.maxDb - result.minDb) / 255;
+    for (let i = 0; i < count; i++) values[i] = result.minDb + raw[i] * step;
+  }
+
+  const hopSeconds = result.hopSize / result.sampleRate;
+  return {
+    frames: result.frames,
+    bins: result.bins,
+    fftSize: result.fftSize,
+    hopSize: result.hopSize,
+    sampleRate: result.sampleRate,
+    format: result.format === 'float16' ? 'float16' : 'uint8',
+    raw,
+    values,
+    frameTime: (index: number) => index * hopSeconds,
+    frame: (index: number) =>
+      values.subarray(index * result.bins, (index + 1) * result.bins),
+  };
+}
@@ -0,0 +1,185 @@
+/**
+ * Reader for the native spectrogram history (cpp/spectrogram_history.h), a
+ * rolling frames x bins matrix of the delivered live frames kept in native
+ * memory. The layout below must stay in sync with it.
+ *
+ *   header      u32 sequence, head, count, slots, bins, maxBins, format,
+ *               restarts; f32 minDb, maxDb
+ *   timestamps  f64[2 * slots]
+ *   rows        [2 * slots][bins], uint8 dB codes or float16 magnitudes
+ *
+ * The native side writes every row twice (at head and head + slots), so the
+ * newest rows are always contiguous and windows are views, never copies.
+ */
+
+import { halfToFloat } from './spectrogram';
+
+export const HISTORY_BUFFER_GLOBAL = '__RealtimeAudioAnalyzerHistoryBuffer';
+
+const HEADER_BYTES = 40;
+const MAX_READ_ATTEMPTS = 4;
+const FORMAT_FLOAT16 = 1;
+
+export type HistoryWindow = {
+  // Sequence of the newest row; see SpectrogramHistoryReader.isCurrent()
+  sequence: number;
+  // Native restart count; the history restarts when the band count changes
+  restarts: number;
+  frames: number;
+  bins: number;
+  format: 'uint8' | 'float16';
+  minDb: number;
+  maxDb: number;
+  // Zero-copy views of native memory, oldest row first: one timestamp (ms
+  // since the epoch) per row, and the [frames][bins] encoded values. Copy
+  // them (`slice()`) to keep them past isCurrent().
+  timestamps: Float64Array;
+  raw: Uint8Array | Uint16Array;
+  // Row view into `raw`, no copy
+  frame(index: number): Uint8Array | Uint16Array;
+  // dB for 'uint8', magnitudes for 'float16', into `out` when it is large
+  // enough (frames * bins), otherwise into a new array
+  decode(out?: Float32Array): Float32Array;
+};
+
+type Snapshot = {
+  sequence: number;
+  head: number;
+  count: number;
+  bins: number;
+  restarts: number;
+};
+
+export class SpectrogramHistoryReader {
+  private readonly buffer: ArrayBuffer;
+  private readonly header: Uint32Array;
+  private readonly range32: Float32Array;
+  private readonly times: Float64Array;
+  private readonly slots: number;
+  private readonly rowsOffset: number;
+  private readonly wide: boolean;
+
+  constructor(buffer: ArrayBuffer) {
+    this.buffer = buffer;
+    this.header = new Uint32Array(buffer, 0, 8);
+    this.range32 = new Float32Array(buffer, 32, 2);
+    this.slots = this.header[3];
+    this.times = new Float64Array(buffer, HEADER_BYTES, 2 * this.slots);
+    this.rowsOffset = HEADER_BYTES + 2 * this.slots * 8;
+    this.wide = this.header[6] === FORMAT_FLOAT16;
+  }
+
+  /** Frames pushed so far (0 = none yet). */
+  get sequence(): number {
+    return this.header[0];
+  }
+
+  /** Rows the history keeps. */
+  get capacity(): number {
+    return this.slots - 1;
+  }
+
+  /** The newest `count` rows (fewer if not recorded yet), or null if none. */
+  latest(count: number): HistoryWindow | null {
+    return this.read((s, end) => {
+      const n = Math.min(Math.max(0, Math.floor(count)), s.count);
+      return [end - n, end];
+    });
+  }
+
+  /**
+   * Rows with startMs <= timestamp <= endMs, or null if there are none. Rows
+   * are found by binary search on their timestamps, no scan.
+   */
+  range(startMs: number, endMs: number): HistoryWindow | null {
+    return this.read((s, end) => {
+      const first = this.lowerBound(end - s.count, end, startMs);
+      return [first, this.lowerBound(first, end, endMs, true)];
+    });
+  }
+
+  /**
+   * True while the views of `window` still hold the rows they were read
+   * with: the writer reuses a row `capacity - window.frames + 1` pushes
+   * after it was the newest, or at once when the band count changes.
+   */
+  isCurrent(window: HistoryWindow): boolean {
+    const elapsed = (this.header[0] - window.sequence) >>> 0;
+    return this.header[7] === window.restarts && elapsed <= this.capacity - window.frames;
+  }
+
+  // First index in [begin, end) whose timestamp is >= value (> with
+  // `after`); timestamps increase along the mirrored rows of a window
+  private lowerBound(begin: number, end: number, value: number, after = false): number {
+    while (begin < end) {
+      const mid = (begin + end) >>> 1;
+      const t = this.times[mid];
+      if (after ? t <= value : t < value) begin = mid + 1;
+      else end = mid;
+    }
+    return begin;
+  }
+
+  // Takes a consistent header snapshot and builds the views over the
+  // mirrored rows [first, end) that `pick` selects, given the index one past
+  // the newest row
+  private read(pick: (s: Snapshot, end: number) => [number, number]): HistoryWindow | null {
+    for (let attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++) {
+      const s: Snapshot = {
+        sequence: this.header[0],
+        head: this.header[1],
+        count: this.header[2],
+        bins: this.header[4],
+        restarts: this.header[7],
+      };
+      if (s.sequence === 0 || s.count === 0 || s.bins === 0) return null;
+      const newest = s.head + this.slots;
+      const [first, end] = pick(s, newest);
+      if (this.header[0] === s.sequence && this.header[7] === s.restarts) {
+        return end > first ? this.window(s, first, end, newest) : null;
+      }
+    }
+    return null;
+  }
+
+  private window(s: Snapshot, first: number, end: number, newest: number): HistoryWindow {
+    const frames = end - first;
+    const bins = s.bins;
+    const wide = this.wide;
+    const base = this.rowsOffset + first * bins * (wide ? 2 : 1);
+    const raw = wide
+      ? new Uint16Array(this.buffer, base, frames * bins)
+      : new Uint8Array(this.buffer, base, frames * bins);
+    const minDb = this.range32[0];
+    const maxDb = this.range32[1];
+    return {
+      sequence: s.sequence - (newest - end),
+      restarts: s.restarts,
+      frames,
+      bins,
+      format: wide ? 'float16' : 'uint8',
+      minDb,
+      maxDb,
+      timestamps: this.times.subarray(first, first + frames),
+      raw,
+      frame: (index: number) => raw.subarray(index * bins, (index + 1) * bins),
+      decode: (out?: Float32Array) => {
+        const values =
+          out !== undefined && out.length >= raw.length ? out : new Float32Array(raw.length);
+        if (wide) {
+          for (let i = 0; i < raw.length; i++) values[i] = halfToFloat(raw[i]);
+        } else {
+          const step = (maxDb - minDb) / 255;
+          for (let i = 0; i < raw.length; i++) values[i] = minDb + raw[i] * step;
+        }
+        return values;
+      },
+    };
+  }
+}
+
+/** Reader over the installed global buffer, or null if not installed. */
+export function getSpectrogramHistoryReader(): SpectrogramHistoryReader | null {
+  const buffer = (globalThis as any)[HISTORY_BUFFER_GLOBAL];
+  return buffer instanceof ArrayBuffer ? new SpectrogramHistoryReader(buffer) : null;
+}
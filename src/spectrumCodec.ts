@@ -0,0 +1,87 @@
+/**
+ * Decoding of compact event spectra (AnalysisConfig.spectrumFormat 'uint8'
+ * or 'uint16'). The native side (see cpp/spectrum_codec.h) sends each frame
+ * base64-encoded, starting with a flag byte:
+ *
+ *   1  keyframe  one code per band (1 or 2 bytes, little endian)
+ *   0  delta     per band (code - previous code) mod 2^bits; a 0 word is
+ *                followed by the number of unchanged bands it stands for
+ *
+ * Code 0 is spectrumMinDb (or below), the highest code spectrumMaxDb.
+ */
+
+import { decodeBase64 } from './spectrogram';
+
+export type EncodedSpectrum = {
+  format: 'uint8' | 'uint16';
+  bins: number;
+  minDb: number;
+  maxDb: number;
+  data: string;
+};
+
+const KEYFRAME = 1;
+
+/**
+ * Turns one stream of encoded frames (event.spectrum, or the spectrum of
+ * one channel) back into dB values. Delta frames depend on the frames
+ * before them, so use one decoder per stream and feed it every event.
+ */
+export class SpectrumDecoder {
+  private codes = new Uint16Array(0);
+  private count = -1; // valid codes, -1 = waiting for a keyframe
+  private values = new Float32Array(0);
+
+  /**
+   * dB per band, or null if the frame is a delta and no keyframe was seen
+   * yet (decoding resumes at the next one). The array is reused by the next
+   * call; copy it (`slice()`) to keep it.
+   */
+  decode(spectrum: EncodedSpectrum): Float32Array | null {
+    const bytes = decodeBase64(spectrum.data);
+    if (bytes.length === 0) return null;
+    const wide = spectrum.format === 'uint16';
+    const wordBytes = wide ? 2 : 1;
+    const mask = wide ? 0xffff : 0xff;
+    const words = Math.floor((bytes.length - 1) / wordBytes);
+    const word = (i: number) =>
+      wide ? bytes[1 + i * 2] | (bytes[2 + i * 2] << 8) : bytes[1 + i];
+
+    if (bytes[0] === KEYFRAME) {
+      if (this.codes.length < words) this.codes = new Uint16Array(words);
+      for (let i = 0; i < words; i++) this.codes[i] = word(i);
+      this.count = words;
+    } else {
+      if (this.count !== spectrum.bins) {
+        this.count = -1;
+        return null;
+      }
+      let band = 0;
+      for (let w = 0; w < words; w++) {
+        const d = word(w);
+        if (d === 0) {
+          band += word(++w);
+        } else {
+          this.codes[band] = (this.codes[band] + d) & mask;
+          band++;
+        }
+      }
+      if (band !== this.count) {
+        this.count = -1; // corrupt
+        return null;
+      }
+    }
+
+    if (this.values.length !== this.count) this.values = new Float32Array(this.count);
+    const step = (spectrum.maxDb - spectrum.minDb) / mask;
+    for (let i = 0; i < this.count; i++) {
+      this.values[i] = spectrum.minDb + this.codes[i] * step;
+    }
+    return this.values;
+  }
+
+  /** Forgets the previous frame; decoding restarts at the next keyframe. */
+  reset(): void {
+    this.count = -1;
+  }
+}